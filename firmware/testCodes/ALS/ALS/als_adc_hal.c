@@ -0,0 +1,180 @@
+/******************************************************************************
+* File Name:   als_adc_hal.c
+*
+* Description: SAR ADC + DMA backend for the ALS stream, see als_adc_hal.h.
+*
+*******************************************************************************/
+
+#include "als_adc_hal.h"
+
+static void adc_event_cb(void *arg, cyhal_adc_event_t event)
+{
+    als_adc_hal_t *hal = (als_adc_hal_t *)arg;
+    if ((event & CYHAL_ADC_ASYNC_READ_COMPLETE) == 0u)
+    {
+        return;
+    }
+
+    if (hal->oneshot_busy)
+    {
+        hal->oneshot_busy = false;
+    }
+    else if (hal->done != NULL)
+    {
+        hal->done(hal->done_arg, CY_RSLT_SUCCESS);
+    }
+}
+
+static cy_rslt_t configure(als_adc_hal_t *hal, bool continuous)
+{
+    const cyhal_adc_config_t cfg = {
+        .continuous_scanning = continuous,
+        .average_count       = hal->average_count,
+        .vneg                = CYHAL_ADC_VNEG_VSSA,
+        .vref                = CYHAL_ADC_REF_VDDA,
+        .ext_vref            = NC,
+        .ext_vref_mv         = 0,
+        .is_bypassed         = false,
+        .bypass_pin          = NC,
+        .resolution          = ALS_ADC_RESOLUTION_BITS
+    };
+    return cyhal_adc_configure(&hal->adc, &cfg);
+}
+
+static cy_rslt_t hal_start(void *ctx, uint32_t rate_hz, als_adc_done_cb_t done, void *done_arg)
+{
+    als_adc_hal_t *hal = (als_adc_hal_t *)ctx;
+    hal->done = done;
+    hal->done_arg = done_arg;
+    hal->oneshot_cfg = false;
+
+    cy_rslt_t rslt = configure(hal, true);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+
+    /* The rate applies to full sequencer scans. The SAR clock divider bounds
+     * the slowest reachable rate, the HAL rejects rates it cannot hit. */
+    return cyhal_adc_set_sample_rate(&hal->adc, rate_hz);
+}
+
+static cy_rslt_t hal_read_async(void *ctx, int32_t *dst, size_t num_scans)
+{
+    als_adc_hal_t *hal = (als_adc_hal_t *)ctx;
+    return cyhal_adc_read_async(&hal->adc, num_scans, dst);
+}
+
+static void hal_stop(void *ctx)
+{
+    als_adc_hal_t *hal = (als_adc_hal_t *)ctx;
+    (void)cyhal_adc_read_async_abort(&hal->adc);
+    hal->done = NULL;
+}
+
+cy_rslt_t als_adc_hal_init(als_adc_hal_t *hal, const als_adc_chan_t *table,
+                           size_t num_channels, als_adc_backend_t *backend)
+{
+    if ((num_channels == 0u) || (num_channels > ALS_ADC_MAX_CHANNELS))
+    {
+        return ALS_ADC_RSLT_BAD_ARG;
+    }
+
+    hal->num_channels = 0u;
+    hal->average_count = 1u;
+    hal->done = NULL;
+    hal->oneshot_busy = false;
+    hal->oneshot_cfg = false;
+
+    cy_rslt_t rslt = cyhal_adc_init(&hal->adc, table[0].pin, NULL);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+
+    for (size_t i = 0; i < num_channels; ++i)
+    {
+        const cyhal_adc_channel_config_t chan_config = {
+            .enable_averaging   = table[i].averaging,
+            .min_acquisition_ns = table[i].min_acquisition_ns,
+            .enabled            = true
+        };
+        rslt = cyhal_adc_channel_init_diff(&hal->chan[i], &hal->adc, table[i].pin,
+                                           CYHAL_ADC_VNEG, &chan_config);
+        if (rslt != CY_RSLT_SUCCESS)
+        {
+            als_adc_hal_free(hal);
+            return rslt;
+        }
+        hal->num_channels = i + 1u;
+    }
+
+    rslt = cyhal_adc_set_async_mode(&hal->adc, CYHAL_ASYNC_DMA, CYHAL_DMA_PRIORITY_DEFAULT);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        als_adc_hal_free(hal);
+        return rslt;
+    }
+
+    cyhal_adc_register_callback(&hal->adc, adc_event_cb, hal);
+    cyhal_adc_enable_event(&hal->adc, CYHAL_ADC_ASYNC_READ_COMPLETE, CYHAL_ISR_PRIORITY_DEFAULT, true);
+
+    backend->start = hal_start;
+    backend->read_async = hal_read_async;
+    backend->stop = hal_stop;
+    backend->ctx = hal;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t als_adc_hal_set_averaging(als_adc_hal_t *hal, uint16_t average_count)
+{
+    if ((average_count == 0u) || (average_count > ALS_ADC_MAX_AVERAGE) ||
+        ((average_count & (average_count - 1u)) != 0u))
+    {
+        return ALS_ADC_RSLT_BAD_ARG;
+    }
+    hal->average_count = average_count;
+    hal->oneshot_cfg = false;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t als_adc_hal_read_scan(als_adc_hal_t *hal, int32_t *vec)
+{
+    cy_rslt_t rslt;
+
+    /* Reprogramming the SAR costs more than a short scan: only when the
+     * stream or a new average count changed it */
+    if (!hal->oneshot_cfg)
+    {
+        rslt = configure(hal, false);
+        if (rslt != CY_RSLT_SUCCESS)
+        {
+            return rslt;
+        }
+        hal->oneshot_cfg = true;
+    }
+
+    hal->oneshot_busy = true;
+    rslt = cyhal_adc_read_async(&hal->adc, 1u, vec);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        hal->oneshot_busy = false;
+        return rslt;
+    }
+
+    while (hal->oneshot_busy)
+    {
+        /* One pass takes a few microseconds per channel. */
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+void als_adc_hal_free(als_adc_hal_t *hal)
+{
+    for (size_t i = 0; i < hal->num_channels; ++i)
+    {
+        cyhal_adc_channel_free(&hal->chan[i]);
+    }
+    hal->num_channels = 0u;
+    cyhal_adc_free(&hal->adc);
+}
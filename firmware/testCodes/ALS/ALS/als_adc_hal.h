@@ -0,0 +1,63 @@
+/******************************************************************************
+* File Name:   als_adc_hal.h
+*
+* Description: SAR ADC backend for the ALS stream. All channels of the
+*              channel table are enabled in the SAR sequencer, so one trigger
+*              converts the ALS and every external input in a single pass.
+*              In streaming mode the SAR scans continuously and the HAL moves
+*              results with DMA straight into the stream buffers.
+*
+*******************************************************************************/
+
+#ifndef ALS_ADC_HAL_H_
+#define ALS_ADC_HAL_H_
+
+#include "cyhal.h"
+#include "als_stream.h"
+
+/* Resolution of the raw counts delivered by cyhal_adc_read_async(). */
+#define ALS_ADC_RESOLUTION_BITS           (12u)
+
+/* SAR sequencer depth on PSoC 6. */
+#define ALS_ADC_MAX_CHANNELS              (16u)
+
+/* Hardware averaging: power of two, applies to rows with averaging set. */
+#define ALS_ADC_MAX_AVERAGE               (256u)
+
+#define ALS_ADC_RSLT_BAD_ARG            (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x48))
+
+/* One row of the channel table; inputs are single-ended against VNEG. */
+typedef struct
+{
+    cyhal_gpio_t pin;
+    bool         averaging;
+    uint32_t     min_acquisition_ns;
+} als_adc_chan_t;
+
+typedef struct
+{
+    cyhal_adc_t          adc;
+    cyhal_adc_channel_t  chan[ALS_ADC_MAX_CHANNELS];
+    size_t               num_channels;
+    uint16_t             average_count;
+    als_adc_done_cb_t    done;
+    void                *done_arg;
+    volatile bool        oneshot_busy;
+    bool                 oneshot_cfg;   /* SAR set up for single scans */
+} als_adc_hal_t;
+
+/* Claims the SAR and every channel of table, fills in backend. Channel 0
+ * claims the SAR block, so it must be an input routed to the SAR. */
+cy_rslt_t als_adc_hal_init(als_adc_hal_t *hal, const als_adc_chan_t *table,
+                           size_t num_channels, als_adc_backend_t *backend);
+
+/* Sets the hardware average count, takes effect on the next stream start. */
+cy_rslt_t als_adc_hal_set_averaging(als_adc_hal_t *hal, uint16_t average_count);
+
+/* Runs one sequencer pass and writes one sample per channel to vec. Only valid
+ * while the stream is stopped; blocks until the scan is done. */
+cy_rslt_t als_adc_hal_read_scan(als_adc_hal_t *hal, int32_t *vec);
+
+void als_adc_hal_free(als_adc_hal_t *hal);
+
+#endif /* ALS_ADC_HAL_H_ */
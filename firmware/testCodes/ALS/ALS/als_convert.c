@@ -0,0 +1,57 @@
+/******************************************************************************
+* File Name:   als_convert.c
+*
+* Description: Integer ALS conversion, see als_convert.h.
+*
+*******************************************************************************/
+
+#include "als_convert.h"
+
+/* counts -> mV as Q16 multiplier, rounded. */
+#define ALS_MV_PER_COUNT_Q16  ((uint32_t)((((uint64_t)ALS_VREF_MV << 16) + (ALS_COUNTS_MAX / 2u)) / ALS_COUNTS_MAX))
+
+/* counts -> uV as Q16 multiplier, rounded; applied to counts in Q(frac). */
+#define ALS_UV_PER_COUNT_Q16  ((uint64_t)((((uint64_t)ALS_VREF_MV * 1000u << 16) + (ALS_COUNTS_MAX / 2u)) / ALS_COUNTS_MAX))
+
+/* uV -> mlux as Q24 multiplier, rounded: the photocurrent is uV / LOAD_OHM
+ * uA, and mlux = uA * LUX_PER_UA_X1000. */
+#define ALS_MLUX_PER_UV_Q24  ((uint64_t)((((uint64_t)ALS_LUX_PER_UA_X1000 << 24) + (ALS_LOAD_OHM / 2u)) / ALS_LOAD_OHM))
+
+#define ALS_DARK_UV           ((uint32_t)ALS_DARK_MV * 1000u)
+#define ALS_VREF_UV           ((uint32_t)ALS_VREF_MV * 1000u)
+
+/* Full scale must fit the 32-bit result */
+_Static_assert(((((uint64_t)ALS_VREF_UV * ALS_MLUX_PER_UV_Q24) + (1u << 23)) >> 24) <= UINT32_MAX,
+               "ALS_LOAD_OHM too small for a 32-bit mlux result");
+
+uint32_t als_counts_to_mv(int32_t counts)
+{
+    if (counts <= 0)
+    {
+        return 0u;
+    }
+    uint32_t c = ((uint32_t)counts > ALS_COUNTS_MAX) ? ALS_COUNTS_MAX : (uint32_t)counts;
+    return (c * ALS_MV_PER_COUNT_Q16 + 0x8000u) >> 16;
+}
+
+uint32_t als_counts_q_to_uv(int32_t counts_q, uint32_t frac_bits)
+{
+    if (counts_q <= 0)
+    {
+        return 0u;
+    }
+    uint32_t max_q = ALS_COUNTS_MAX << frac_bits;
+    uint32_t c = ((uint32_t)counts_q > max_q) ? max_q : (uint32_t)counts_q;
+    uint32_t shift = 16u + frac_bits;
+    return (uint32_t)(((uint64_t)c * ALS_UV_PER_COUNT_Q16 + (1ull << (shift - 1u))) >> shift);
+}
+
+uint32_t als_uv_to_mlux(uint32_t uv)
+{
+    if (uv <= ALS_DARK_UV)
+    {
+        return 0u;
+    }
+    uv = (uv > ALS_VREF_UV) ? ALS_VREF_UV : uv;
+    return (uint32_t)((((uint64_t)(uv - ALS_DARK_UV) * ALS_MLUX_PER_UV_Q24) + (1u << 23)) >> 24);
+}
@@ -0,0 +1,49 @@
+/******************************************************************************
+* File Name:   als_convert.h
+*
+* Description: Integer conversion of raw ALS counts to millivolt, and of
+*              decimated counts (with fraction bits) to microvolt and lux.
+*              The sensor's photocurrent is proportional to illuminance, so
+*              the calibration folds into one multiplier that the compiler
+*              evaluates from the constants below; the runtime path is one
+*              multiply-shift per step.
+*
+*******************************************************************************/
+
+#ifndef ALS_CONVERT_H_
+#define ALS_CONVERT_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define ALS_VREF_MV                       (3300u)
+#define ALS_COUNTS_BITS                   (12u)
+#define ALS_COUNTS_MAX                    ((1u << ALS_COUNTS_BITS) - 1u)
+
+/* TEMT6000 phototransistor into a load resistor: Ipc = V / R, and the sensor
+ * gives ~2 lux per uA of photocurrent. Override per board or after calibration. */
+#ifndef ALS_LOAD_OHM
+#define ALS_LOAD_OHM                      (10000u)
+#endif
+#ifndef ALS_LUX_PER_UA_X1000
+#define ALS_LUX_PER_UA_X1000              (2000u)
+#endif
+/* Dark offset of the divider in mV, subtracted before scaling. */
+#ifndef ALS_DARK_MV
+#define ALS_DARK_MV                       (0u)
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+uint32_t als_counts_to_mv(int32_t counts);
+
+/* counts_q is in Q(frac_bits), frac_bits <= 8, so the fraction bits of a
+ * decimator output survive the conversion; 1 uV is below the LSB of any
+ * such input. */
+uint32_t als_counts_q_to_uv(int32_t counts_q, uint32_t frac_bits);
+uint32_t als_uv_to_mlux(uint32_t uv);
+
+#endif /* ALS_CONVERT_H_ */
@@ -0,0 +1,114 @@
+/******************************************************************************
+* File Name:   als_decim.c
+*
+* Description: Boxcar / CIC2 decimator, see als_decim.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "als_decim.h"
+
+/* log2(x) in Q8, x >= 1. */
+static uint32_t log2_q8(uint32_t x)
+{
+    uint32_t ip = 0u;
+    while ((x >> ip) > 1u)
+    {
+        ip++;
+    }
+
+    /* Normalise mantissa to Q16 in [1, 2) and square it for each fraction bit. */
+    uint64_t m = ((uint64_t)x << 16) >> ip;
+    uint32_t fp = 0u;
+    for (uint32_t bit = 0x80u; bit != 0u; bit >>= 1)
+    {
+        m = (m * m) >> 16;
+        if (m >= (2u << 16))
+        {
+            m >>= 1;
+            fp |= bit;
+        }
+    }
+    return (ip << 8) | fp;
+}
+
+cy_rslt_t als_decim_init(als_decim_t *d, als_decim_mode_t mode, uint32_t factor)
+{
+    if ((factor == 0u) || (factor > ALS_DECIM_MAX_FACTOR) ||
+        ((mode != ALS_DECIM_BOXCAR) && (mode != ALS_DECIM_CIC2)))
+    {
+        return ALS_DECIM_RSLT_BAD_ARG;
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->mode = mode;
+    d->factor = factor;
+
+    /* DC gain of a CIC is R^order. */
+    uint64_t gain = (mode == ALS_DECIM_CIC2) ? ((uint64_t)factor * factor) : factor;
+    d->norm_q32 = ((1ull << 32) + (gain / 2u)) / gain;
+    d->settle = (uint32_t)mode - 1u;
+    return CY_RSLT_SUCCESS;
+}
+
+size_t als_decim_process(als_decim_t *d, const int32_t *in, size_t n, size_t stride,
+                         int32_t *out)
+{
+    size_t produced = 0u;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        d->integ[0] += (uint32_t)in[i * stride];
+        if (d->mode == ALS_DECIM_CIC2)
+        {
+            d->integ[1] += d->integ[0];
+        }
+
+        if (++d->phase < d->factor)
+        {
+            continue;
+        }
+        d->phase = 0u;
+
+        uint32_t y;
+        if (d->mode == ALS_DECIM_BOXCAR)
+        {
+            /* Boxcar: dump and reset the accumulator. */
+            y = d->integ[0];
+            d->integ[0] = 0u;
+        }
+        else
+        {
+            /* Comb section at the low rate, modulo arithmetic undoes any
+             * integrator wrap-around. */
+            uint32_t c0 = d->integ[1] - d->comb[0];
+            d->comb[0] = d->integ[1];
+            y = c0 - d->comb[1];
+            d->comb[1] = c0;
+        }
+
+        if (d->settle > 0u)
+        {
+            d->settle--;
+            continue;
+        }
+
+        /* Rounded: norm_q32 itself is rounded either way, and truncating
+         * would put a DC input one Q step low */
+        int64_t scaled = ((int64_t)(int32_t)y * (int64_t)d->norm_q32 +
+                          (1ll << (31u - ALS_DECIM_FRAC_BITS))) >> (32u - ALS_DECIM_FRAC_BITS);
+        out[produced++] = (int32_t)scaled;
+    }
+    return produced;
+}
+
+uint32_t als_decim_enob_q8(uint32_t adc_bits, uint32_t osr)
+{
+    if (osr == 0u)
+    {
+        osr = 1u;
+    }
+    uint32_t enob = (adc_bits << 8) + (log2_q8(osr) / 2u);
+    uint32_t carried = (adc_bits + ALS_DECIM_FRAC_BITS) << 8;
+    return (enob < carried) ? enob : carried;
+}
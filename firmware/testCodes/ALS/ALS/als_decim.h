@@ -0,0 +1,67 @@
+/******************************************************************************
+* File Name:   als_decim.h
+*
+* Description: Software decimation stage for oversampled ADC channels. A
+*              boxcar (CIC order 1) or CIC order 2 filter sums R input
+*              samples per output; the result keeps ALS_DECIM_FRAC_BITS of
+*              extra resolution below one ADC count.
+*
+*******************************************************************************/
+
+#ifndef ALS_DECIM_H_
+#define ALS_DECIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define ALS_DECIM_MAX_FACTOR              (256u)
+
+/* Outputs are ADC counts in Q(ALS_DECIM_FRAC_BITS). */
+#define ALS_DECIM_FRAC_BITS               (4u)
+
+#define ALS_DECIM_RSLT_BAD_ARG            (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x50))
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef enum
+{
+    ALS_DECIM_BOXCAR = 1,
+    ALS_DECIM_CIC2   = 2
+} als_decim_mode_t;
+
+typedef struct
+{
+    als_decim_mode_t mode;
+    uint32_t         factor;     /* R, input samples per output */
+    uint32_t         phase;      /* inputs since the last output */
+    uint32_t         integ[2];   /* integrators, modulo 2^32 */
+    uint32_t         comb[2];    /* comb delay elements */
+    uint64_t         norm_q32;   /* 2^32 / R^order, rounded */
+    uint32_t         settle;     /* outputs to drop after (re)configuration */
+} als_decim_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t als_decim_init(als_decim_t *d, als_decim_mode_t mode, uint32_t factor);
+
+/* Feeds n samples taken every stride entries of in; writes at most
+ * n / factor + 1 outputs and returns how many were written. */
+size_t als_decim_process(als_decim_t *d, const int32_t *in, size_t n, size_t stride,
+                         int32_t *out);
+
+/* Effective resolution in Q8 bits of the decimator output for adc_bits
+ * input samples and a software factor osr, assuming white noise of at least
+ * one LSB at the input: bits + log2(osr) / 2, capped at the
+ * adc_bits + ALS_DECIM_FRAC_BITS the output carries. Hardware averaging does
+ * not count: the SAR shifts its average back to adc_bits, which lowers the
+ * noise but adds no bits (and below one LSB of noise, the software gain
+ * shrinks too, so this is an upper bound). */
+uint32_t als_decim_enob_q8(uint32_t adc_bits, uint32_t osr);
+
+#endif /* ALS_DECIM_H_ */
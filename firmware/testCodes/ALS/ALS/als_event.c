@@ -0,0 +1,64 @@
+/******************************************************************************
+* File Name:   als_event.c
+*
+* Description: Deadband / heartbeat filter for ALS readings, see als_event.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "als_event.h"
+
+void als_event_init(als_event_t *ev, const als_event_cfg_t *cfg)
+{
+    memset(ev, 0, sizeof(*ev));
+    ev->cfg = *cfg;
+}
+
+als_event_kind_t als_event_offer(als_event_t *ev, uint32_t mlux, uint32_t now_ms)
+{
+    als_event_kind_t kind = ALS_EVENT_NONE;
+    ev->seen++;
+
+    if (!ev->have_last)
+    {
+        kind = ALS_EVENT_CHANGE;
+    }
+    else
+    {
+        uint32_t delta = (mlux > ev->last_mlux) ? (mlux - ev->last_mlux) : (ev->last_mlux - mlux);
+        uint32_t band = (uint32_t)(((uint64_t)ev->last_mlux * ev->cfg.deadband_permille) / 1000u);
+        if (band < ev->cfg.deadband_mlux)
+        {
+            band = ev->cfg.deadband_mlux;
+        }
+
+        if (delta > band)
+        {
+            kind = ALS_EVENT_CHANGE;
+        }
+        else if ((ev->cfg.max_silence_ms != 0u) &&
+                 ((uint32_t)(now_ms - ev->last_ms) >= ev->cfg.max_silence_ms))
+        {
+            kind = ALS_EVENT_HEARTBEAT;
+            ev->heartbeats++;
+        }
+    }
+
+    if (kind != ALS_EVENT_NONE)
+    {
+        ev->have_last = true;
+        ev->last_mlux = mlux;
+        ev->last_ms = now_ms;
+        ev->reported++;
+    }
+    return kind;
+}
+
+uint32_t als_event_suppressed_permille(const als_event_t *ev)
+{
+    if (ev->seen == 0u)
+    {
+        return 0u;
+    }
+    return (uint32_t)(((uint64_t)(ev->seen - ev->reported) * 1000u) / ev->seen);
+}
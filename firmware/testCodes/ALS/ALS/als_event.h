@@ -0,0 +1,51 @@
+/******************************************************************************
+* File Name:   als_event.h
+*
+* Description: Change-driven reporting for the ALS channel. A reading only
+*              leaves the acquisition stage when it moved more than the
+*              deadband away from the last reported value, or when nothing
+*              was reported for max_silence_ms (heartbeat).
+*
+*******************************************************************************/
+
+#ifndef ALS_EVENT_H_
+#define ALS_EVENT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t deadband_mlux;     /* absolute deadband */
+    uint32_t deadband_permille; /* relative deadband, the larger of both wins */
+    uint32_t max_silence_ms;    /* heartbeat, 0 disables it */
+} als_event_cfg_t;
+
+typedef enum
+{
+    ALS_EVENT_NONE = 0,
+    ALS_EVENT_CHANGE,
+    ALS_EVENT_HEARTBEAT
+} als_event_kind_t;
+
+typedef struct
+{
+    als_event_cfg_t cfg;
+    bool            have_last;
+    uint32_t        last_mlux;
+    uint32_t        last_ms;
+    uint32_t        seen;        /* readings offered */
+    uint32_t        reported;    /* readings that passed */
+    uint32_t        heartbeats;  /* of which forced by the heartbeat */
+} als_event_t;
+
+void als_event_init(als_event_t *ev, const als_event_cfg_t *cfg);
+
+/* Offers one reading taken at now_ms. Returns the reason it must be reported,
+ * or ALS_EVENT_NONE if it is to be dropped. */
+als_event_kind_t als_event_offer(als_event_t *ev, uint32_t mlux, uint32_t now_ms);
+
+/* Share of readings suppressed so far, in permille. */
+uint32_t als_event_suppressed_permille(const als_event_t *ev);
+
+#endif /* ALS_EVENT_H_ */
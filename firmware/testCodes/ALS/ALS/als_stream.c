@@ -0,0 +1,212 @@
+/******************************************************************************
+* File Name:   als_stream.c
+*
+* Description: Continuous ALS acquisition engine, see als_stream.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "als_stream.h"
+
+#if defined(CY_USING_HAL)
+#include "cyhal_system.h"
+#define ALS_CRITICAL_ENTER(st)  ((st) = cyhal_system_critical_section_enter())
+#define ALS_CRITICAL_EXIT(st)   cyhal_system_critical_section_exit(st)
+#else
+/* Host mock delivers completions from the caller's thread. */
+#define ALS_CRITICAL_ENTER(st)  ((st) = 0u)
+#define ALS_CRITICAL_EXIT(st)   ((void)(st))
+#endif
+
+/* Ownership of each half of the double buffer. */
+enum
+{
+    BUF_FREE = 0,
+    BUF_DMA,        /* backend is converting into it */
+    BUF_READY,      /* full, waiting for als_stream_process() */
+    BUF_USER        /* consumer callback is reading it */
+};
+
+static cy_rslt_t kick(als_stream_t *s, uint8_t idx)
+{
+    s->state[idx] = BUF_DMA;
+    return s->backend->read_async(s->backend->ctx, s->buf[idx], s->cfg.block_scans);
+}
+
+/* Completion handler, runs in ISR context on target. */
+static void on_done(void *arg, cy_rslt_t status)
+{
+    als_stream_t *s = (als_stream_t *)arg;
+    uint8_t idx = (s->state[0] == BUF_DMA) ? 0u : 1u;
+    uint8_t other = idx ^ 1u;
+
+    if (!s->running)
+    {
+        s->state[idx] = BUF_FREE;
+        return;
+    }
+
+    if (status != CY_RSLT_SUCCESS)
+    {
+        s->stats.errors++;
+        (void)kick(s, idx);
+        return;
+    }
+
+    if (s->state[other] == BUF_USER)
+    {
+        /* Consumer still busy with the other half: drop this block. */
+        s->stats.overruns++;
+        (void)kick(s, idx);
+        return;
+    }
+
+    if (s->state[other] == BUF_READY)
+    {
+        /* Consumer never picked up the previous block: keep the newest one. */
+        s->stats.overruns++;
+    }
+
+    s->seq[idx] = s->next_seq++;
+    s->state[idx] = BUF_READY;
+    if (kick(s, other) != CY_RSLT_SUCCESS)
+    {
+        s->stats.errors++;
+        s->state[other] = BUF_FREE;
+    }
+
+    if (s->on_ready != NULL)
+    {
+        s->on_ready(s->on_ready_arg);
+    }
+}
+
+cy_rslt_t als_stream_init(als_stream_t *s, const als_adc_backend_t *backend,
+                          const als_stream_cfg_t *cfg)
+{
+    if ((s == NULL) || (backend == NULL) || (cfg == NULL) ||
+        (cfg->block_scans == 0u) || (cfg->num_channels == 0u) ||
+        ((cfg->block_scans * cfg->num_channels) > ALS_STREAM_BLOCK_SAMPLES_MAX) ||
+        (cfg->rate_hz < ALS_STREAM_RATE_MIN_HZ) || (cfg->rate_hz > ALS_STREAM_RATE_MAX_HZ))
+    {
+        return ALS_STREAM_RSLT_BAD_ARG;
+    }
+
+    memset(s, 0, sizeof(*s));
+    s->backend = backend;
+    s->cfg = *cfg;
+    return CY_RSLT_SUCCESS;
+}
+
+void als_stream_set_ready_hook(als_stream_t *s, void (*hook)(void *arg), void *arg)
+{
+    s->on_ready = hook;
+    s->on_ready_arg = arg;
+}
+
+cy_rslt_t als_stream_start(als_stream_t *s)
+{
+    if (s->running)
+    {
+        return ALS_STREAM_RSLT_BUSY;
+    }
+
+    cy_rslt_t rslt = s->backend->start(s->backend->ctx, s->cfg.rate_hz, on_done, s);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+
+    s->state[0] = BUF_FREE;
+    s->state[1] = BUF_FREE;
+    s->running = true;
+
+    rslt = kick(s, 0u);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        als_stream_stop(s);
+    }
+    return rslt;
+}
+
+void als_stream_stop(als_stream_t *s)
+{
+    uint32_t irq;
+    ALS_CRITICAL_ENTER(irq);
+    s->running = false;
+    ALS_CRITICAL_EXIT(irq);
+
+    s->backend->stop(s->backend->ctx);
+    s->state[0] = BUF_FREE;
+    s->state[1] = BUF_FREE;
+}
+
+cy_rslt_t als_stream_set_rate(als_stream_t *s, uint32_t rate_hz)
+{
+    if ((rate_hz < ALS_STREAM_RATE_MIN_HZ) || (rate_hz > ALS_STREAM_RATE_MAX_HZ))
+    {
+        return ALS_STREAM_RSLT_BAD_ARG;
+    }
+
+    bool was_running = s->running;
+    if (was_running)
+    {
+        als_stream_stop(s);
+    }
+    s->cfg.rate_hz = rate_hz;
+    return was_running ? als_stream_start(s) : CY_RSLT_SUCCESS;
+}
+
+bool als_stream_process(als_stream_t *s, als_block_cb_t cb, void *arg)
+{
+    uint32_t irq;
+    int idx = -1;
+
+    ALS_CRITICAL_ENTER(irq);
+    if (s->state[0] == BUF_READY)
+    {
+        idx = 0;
+    }
+    else if (s->state[1] == BUF_READY)
+    {
+        idx = 1;
+    }
+    if (idx >= 0)
+    {
+        s->state[idx] = BUF_USER;
+    }
+    ALS_CRITICAL_EXIT(irq);
+
+    if (idx < 0)
+    {
+        return false;
+    }
+
+    cb(s->buf[idx], s->cfg.block_scans, s->cfg.num_channels, s->seq[idx], arg);
+
+    ALS_CRITICAL_ENTER(irq);
+    s->state[idx] = BUF_FREE;
+    s->stats.blocks++;
+    s->stats.samples += (uint32_t)(s->cfg.block_scans * s->cfg.num_channels);
+    if (s->running && (s->state[0] != BUF_DMA) && (s->state[1] != BUF_DMA))
+    {
+        /* A restart failed in the ISR; retry now that a half is free. */
+        if (kick(s, (uint8_t)idx) != CY_RSLT_SUCCESS)
+        {
+            s->state[idx] = BUF_FREE;
+        }
+    }
+    ALS_CRITICAL_EXIT(irq);
+    return true;
+}
+
+void als_stream_get_stats(const als_stream_t *s, als_stream_stats_t *out)
+{
+    uint32_t irq;
+    ALS_CRITICAL_ENTER(irq);
+    out->blocks = s->stats.blocks;
+    out->samples = s->stats.samples;
+    out->overruns = s->stats.overruns;
+    out->errors = s->stats.errors;
+    ALS_CRITICAL_EXIT(irq);
+}
@@ -0,0 +1,103 @@
+/******************************************************************************
+* File Name:   als_stream.h
+*
+* Description: Continuous ALS acquisition engine. The ADC backend converts
+*              into one half of a double buffer while the consumer works on
+*              the other half; full blocks are handed over from the
+*              completion interrupt and drained from the main loop.
+*              A block holds num_scans sequencer scans; each scan is a packed
+*              vector with one sample per channel, in channel-table order.
+*
+*******************************************************************************/
+
+#ifndef ALS_STREAM_H_
+#define ALS_STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Upper bound for one block (scans x channels), sets the size of the static
+ * double buffer. */
+#define ALS_STREAM_BLOCK_SAMPLES_MAX      (256u)
+
+#define ALS_STREAM_RATE_MIN_HZ            (1u)
+#define ALS_STREAM_RATE_MAX_HZ            (100000u)
+
+#define ALS_STREAM_RSLT_BAD_ARG           (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x40))
+#define ALS_STREAM_RSLT_BUSY              (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x41))
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+/* Called by the backend (normally from an ISR) when a read_async completes. */
+typedef void (*als_adc_done_cb_t)(void *arg, cy_rslt_t status);
+
+/* Hardware abstraction: the SAR/DMA backend on target, a mock on the host. */
+typedef struct
+{
+    cy_rslt_t (*start)(void *ctx, uint32_t rate_hz, als_adc_done_cb_t done, void *done_arg);
+    cy_rslt_t (*read_async)(void *ctx, int32_t *dst, size_t num_scans);
+    void      (*stop)(void *ctx);
+    void      *ctx;
+} als_adc_backend_t;
+
+typedef struct
+{
+    uint32_t rate_hz;        /* scans per second */
+    size_t   block_scans;    /* scans per delivered block */
+    size_t   num_channels;   /* samples per scan, must match the backend */
+} als_stream_cfg_t;
+
+typedef struct
+{
+    uint32_t blocks;         /* blocks handed to the consumer */
+    uint32_t samples;        /* samples handed to the consumer */
+    uint32_t overruns;       /* blocks dropped because the consumer was late */
+    uint32_t errors;         /* backend errors reported on completion */
+} als_stream_stats_t;
+
+/* Consumer callback, runs in the context that calls als_stream_process(). */
+typedef void (*als_block_cb_t)(const int32_t *samples, size_t num_scans,
+                               size_t num_channels, uint32_t seq, void *arg);
+
+typedef struct
+{
+    const als_adc_backend_t *backend;
+    als_stream_cfg_t         cfg;
+    int32_t                  buf[2][ALS_STREAM_BLOCK_SAMPLES_MAX];
+    volatile uint8_t         state[2];
+    volatile uint32_t        seq[2];
+    volatile uint32_t        next_seq;
+    volatile als_stream_stats_t stats;
+    void                   (*on_ready)(void *arg);
+    void                    *on_ready_arg;
+    bool                     running;
+} als_stream_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t als_stream_init(als_stream_t *s, const als_adc_backend_t *backend,
+                          const als_stream_cfg_t *cfg);
+
+/* Optional hook called from the completion ISR when a block is ready, e.g. to
+ * wake a task. The block itself is only delivered by als_stream_process(). */
+void als_stream_set_ready_hook(als_stream_t *s, void (*hook)(void *arg), void *arg);
+
+cy_rslt_t als_stream_start(als_stream_t *s);
+void als_stream_stop(als_stream_t *s);
+
+/* Changes the scan rate; the stream is restarted if it was running. */
+cy_rslt_t als_stream_set_rate(als_stream_t *s, uint32_t rate_hz);
+
+/* Delivers at most one ready block to cb. Returns true if a block was delivered. */
+bool als_stream_process(als_stream_t *s, als_block_cb_t cb, void *arg);
+
+void als_stream_get_stats(const als_stream_t *s, als_stream_stats_t *out);
+
+#endif /* ALS_STREAM_H_ */
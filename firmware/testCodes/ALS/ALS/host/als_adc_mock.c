@@ -0,0 +1,92 @@
+/******************************************************************************
+* File Name:   als_adc_mock.c
+*
+* Description: Host-side ADC backend for the ALS stream, see als_adc_mock.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "als_adc_mock.h"
+
+static cy_rslt_t mock_start(void *ctx, uint32_t rate_hz, als_adc_done_cb_t done, void *done_arg)
+{
+    als_adc_mock_t *mock = (als_adc_mock_t *)ctx;
+    mock->rate_hz = rate_hz;
+    mock->done = done;
+    mock->done_arg = done_arg;
+    mock->dst = NULL;
+    mock->frac_us = 0u;
+    mock->running = true;
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_rslt_t mock_read_async(void *ctx, int32_t *dst, size_t num_scans)
+{
+    als_adc_mock_t *mock = (als_adc_mock_t *)ctx;
+    if (mock->dst != NULL)
+    {
+        return ALS_STREAM_RSLT_BUSY;
+    }
+    mock->dst = dst;
+    mock->want = num_scans;
+    mock->filled = 0u;
+    return CY_RSLT_SUCCESS;
+}
+
+static void mock_stop(void *ctx)
+{
+    als_adc_mock_t *mock = (als_adc_mock_t *)ctx;
+    mock->running = false;
+    mock->dst = NULL;
+}
+
+void als_adc_mock_init(als_adc_mock_t *mock, size_t num_channels, als_mock_gen_t gen,
+                       void *gen_arg, als_adc_backend_t *backend)
+{
+    memset(mock, 0, sizeof(*mock));
+    mock->num_channels = num_channels;
+    mock->gen = gen;
+    mock->gen_arg = gen_arg;
+
+    backend->start = mock_start;
+    backend->read_async = mock_read_async;
+    backend->stop = mock_stop;
+    backend->ctx = mock;
+}
+
+void als_adc_mock_advance(als_adc_mock_t *mock, uint64_t elapsed_us)
+{
+    if (!mock->running)
+    {
+        return;
+    }
+
+    uint64_t total = mock->frac_us + elapsed_us * mock->rate_hz;
+    uint64_t n = total / 1000000u;
+    mock->frac_us = total % 1000000u;
+
+    while ((n > 0u) && mock->running)
+    {
+        uint64_t scan = mock->scan_no++;
+        n--;
+        mock->conversions += mock->num_channels;
+
+        if (mock->dst == NULL)
+        {
+            mock->lost++;
+            continue;
+        }
+
+        int32_t *vec = &mock->dst[mock->filled * mock->num_channels];
+        for (size_t ch = 0; ch < mock->num_channels; ++ch)
+        {
+            vec[ch] = mock->gen(scan, ch, mock->gen_arg);
+        }
+        if (++mock->filled == mock->want)
+        {
+            /* Like the DMA ISR: the next read is queued from the callback. */
+            mock->dst = NULL;
+            mock->done(mock->done_arg, CY_RSLT_SUCCESS);
+        }
+    }
+}
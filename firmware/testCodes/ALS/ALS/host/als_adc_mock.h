@@ -0,0 +1,43 @@
+/******************************************************************************
+* File Name:   als_adc_mock.h
+*
+* Description: Host-side ADC backend for the ALS stream. Samples come from a
+*              generator callback and completions fire while simulated time
+*              is advanced, so block delivery, overruns and throughput can be
+*              exercised on Linux. Not part of the firmware build (.cyignore).
+*
+*******************************************************************************/
+
+#ifndef ALS_ADC_MOCK_H_
+#define ALS_ADC_MOCK_H_
+
+#include "als_stream.h"
+
+/* Returns the raw count of channel ch in scan number n. */
+typedef int32_t (*als_mock_gen_t)(uint64_t n, size_t ch, void *arg);
+
+typedef struct
+{
+    als_mock_gen_t     gen;
+    void              *gen_arg;
+    size_t             num_channels;
+    uint32_t           rate_hz;
+    bool               running;
+    als_adc_done_cb_t  done;
+    void              *done_arg;
+    int32_t           *dst;         /* pending read, NULL if idle */
+    size_t             want;        /* scans */
+    size_t             filled;      /* scans */
+    uint64_t           scan_no;     /* scans produced since start */
+    uint64_t           lost;        /* scans converted with no read pending */
+    uint64_t           frac_us;     /* sub-scan remainder of advanced time */
+    uint64_t           conversions; /* channel conversions performed */
+} als_adc_mock_t;
+
+void als_adc_mock_init(als_adc_mock_t *mock, size_t num_channels, als_mock_gen_t gen,
+                       void *gen_arg, als_adc_backend_t *backend);
+
+/* Simulates elapsed_us of continuous conversion, firing completions inline. */
+void als_adc_mock_advance(als_adc_mock_t *mock, uint64_t elapsed_us);
+
+#endif /* ALS_ADC_MOCK_H_ */
@@ -0,0 +1,159 @@
+/******************************************************************************
+* File Name:   als_convert_check.c
+*
+* Description: Host accuracy check and benchmark for als_convert: every raw
+*              count, every microvolt and every Q0/Q4/Q8 decimator output
+*              against a double reference of the same calibration, that
+*              each fraction step still moves the result, out-of-range
+*              inputs and monotonicity,
+*              then the integer path timed against the float expression it
+*              replaces. Exits non-zero if an error bound is exceeded.
+*
+*                cc -O2 -I.. -o als_convert_check als_convert_check.c \
+*                   ../als_convert.c -lm
+*
+*              Other calibrations build the same way with e.g.
+*              -DALS_LOAD_OHM=4700 -DALS_DARK_MV=12.
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "als_convert.h"
+
+#define ROUNDS              (20000u)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double ref_mv(int32_t counts)
+{
+    return (double)counts * ALS_VREF_MV / ALS_COUNTS_MAX;
+}
+
+static double ref_mlux(double mv)
+{
+    return (mv <= ALS_DARK_MV) ? 0.0 : (mv - ALS_DARK_MV) * 1000.0 * ALS_LUX_PER_UA_X1000 / ALS_LOAD_OHM;
+}
+
+/* What main.c did per sample, kept out of line like the integer path */
+__attribute__((noinline)) static float float_mlux(int32_t raw)
+{
+    float v = ((float)raw / (16.0f * ALS_COUNTS_MAX)) * (ALS_VREF_MV / 1000.0f);
+    return v * (1e6f * ALS_LUX_PER_UA_X1000 / ALS_LOAD_OHM);
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void accuracy(void)
+{
+    double worst_mv = 0.0, worst_mlux = 0.0;
+    bool mono = true;
+    char line[96];
+
+    for (int32_t c = 0; c <= (int32_t)ALS_COUNTS_MAX; ++c)
+    {
+        worst_mv = fmax(worst_mv, fabs((double)als_counts_to_mv(c) - ref_mv(c)));
+    }
+    for (uint32_t uv = 0; uv <= ALS_VREF_MV * 1000u; ++uv)
+    {
+        uint32_t m = als_uv_to_mlux(uv);
+        worst_mlux = fmax(worst_mlux, fabs((double)m - ref_mlux(uv * 1e-3)));
+        mono &= (uv == 0u) || (m >= als_uv_to_mlux(uv - 1u));
+    }
+
+    /* Rounding plus the multiplier's own error over full scale */
+    snprintf(line, sizeof(line), "counts -> mV, worst %.3f mV (rounding: 0.5)", worst_mv);
+    check(worst_mv <= 0.53, line);
+    snprintf(line, sizeof(line), "uV -> mlux, worst %.3f mlux (rounding: 0.5)", worst_mlux);
+    check(worst_mlux <= 0.6, line);
+    check(mono, "uV -> mlux monotonic");
+
+    /* Decimator outputs: every fraction step must still move the result */
+    for (uint32_t frac = 0; frac <= 8u; frac += 4u)
+    {
+        double worst_uv = 0.0, worst_chain = 0.0;
+        bool steps = true;
+
+        for (int32_t q = 0; q <= (int32_t)(ALS_COUNTS_MAX << frac); ++q)
+        {
+            uint32_t uv = als_counts_q_to_uv(q, frac);
+            double ref = ref_mv(q) / (double)(1u << frac) * 1000.0;
+            worst_uv = fmax(worst_uv, fabs((double)uv - ref));
+            worst_chain = fmax(worst_chain, fabs((double)als_uv_to_mlux(uv) - ref_mlux(ref * 1e-3)));
+            steps &= (q == 0) || (uv > als_counts_q_to_uv(q - 1, frac));
+        }
+        snprintf(line, sizeof(line), "Q%lu counts -> uV, worst %.3f uV", (unsigned long)frac, worst_uv);
+        check(worst_uv <= 0.53, line);
+        snprintf(line, sizeof(line), "Q%lu counts -> mlux, worst %.3f mlux", (unsigned long)frac, worst_chain);
+        check(worst_chain <= 0.75, line);
+        snprintf(line, sizeof(line), "Q%lu counts -> uV, every step resolved", (unsigned long)frac);
+        check(steps, line);
+    }
+    check((als_counts_to_mv(-7) == 0u) && (als_counts_to_mv(5000) == ALS_VREF_MV), "counts clamped to 0..full scale");
+    check((als_counts_q_to_uv(-7, 4u) == 0u) &&
+          (als_counts_q_to_uv(5000 << 4, 4u) == als_counts_q_to_uv(ALS_COUNTS_MAX << 4, 4u)), "Q counts clamped to 0..full scale");
+    check(als_uv_to_mlux(4000000u) == als_uv_to_mlux(ALS_VREF_MV * 1000u), "uV clamped to full scale");
+}
+
+static void bench(void)
+{
+    static int32_t raw[ALS_COUNTS_MAX + 1u];
+    volatile uint32_t sink_u = 0u;
+    volatile float sink_f = 0.0f;
+    uint32_t acc_u = 0u;
+    float acc_f = 0.0f;
+
+    for (uint32_t i = 0; i <= ALS_COUNTS_MAX; ++i)
+    {
+        raw[i] = (int32_t)((i * 2654435761u) >> 16);     /* Q4 counts */
+    }
+
+    double t0 = now_s();
+    for (uint32_t r = 0; r < ROUNDS; ++r)
+    {
+        for (uint32_t i = 0; i <= ALS_COUNTS_MAX; ++i)
+        {
+            acc_u += als_uv_to_mlux(als_counts_q_to_uv(raw[i], 4u));
+        }
+        sink_u = acc_u;
+    }
+    double t_int = now_s() - t0;
+
+    t0 = now_s();
+    for (uint32_t r = 0; r < ROUNDS; ++r)
+    {
+        for (uint32_t i = 0; i <= ALS_COUNTS_MAX; ++i)
+        {
+            acc_f += float_mlux(raw[i]);
+        }
+        sink_f = acc_f;
+    }
+    double t_flt = now_s() - t0;
+
+    double n = (double)ROUNDS * (ALS_COUNTS_MAX + 1u);
+    printf("integer Q4 -> mlux      %6.2f ns/sample\n", t_int / n * 1e9);
+    printf("float reference         %6.2f ns/sample\n", t_flt / n * 1e9);
+    (void)sink_u;
+    (void)sink_f;
+}
+
+int main(void)
+{
+    accuracy();
+    bench();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
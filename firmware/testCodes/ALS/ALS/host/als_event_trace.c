@@ -0,0 +1,219 @@
+/******************************************************************************
+* File Name:   als_event_trace.c
+*
+* Description: Host tool for als_event: runs light traces through the
+*              deadband / heartbeat filter with the settings of main.c and
+*              prints how many readings leave the acquisition stage. Checks
+*              that the last reported value never strays from the light by
+*              more than the deadband plus the sensor noise, and that the
+*              heartbeat gap is kept.
+*
+*              Without arguments it runs built-in traces (office under
+*              fixed lighting, a window through an overcast day, a dark
+*              night, lights switched on and off). Recorded traces are
+*              given as files with one "t_ms,mlux" line per reading:
+*
+*                cc -O2 -I.. -o als_event_trace als_event_trace.c \
+*                   ../als_event.c -lm
+*                ./als_event_trace [trace.csv ...]
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "als_event.h"
+
+/* As in main.c */
+#define DEADBAND_MLUX       (2000u)
+#define DEADBAND_PERMILLE   (20u)
+#define MAX_SILENCE_MS      (60000u)
+
+#define RATE_HZ             (10u)       /* preset 3 output rate */
+#define NOISE_MLUX          (300.0)     /* sensor noise, RMS */
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double uniform(void)
+{
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static double gauss(void)
+{
+    /* Box-Muller */
+    double u = uniform() + 1e-12;
+    double v = uniform();
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/* Noise-free light in mlux at t seconds */
+typedef double (*light_fn)(double t);
+
+static double office(double t)
+{
+    /* 450 lux with someone passing the sensor now and then */
+    double shade = (fmod(t, 1800.0) < 4.0) ? 0.6 : 1.0;
+    return 450000.0 * shade;
+}
+
+static double window_day(double t)
+{
+    double h = t / 3600.0;
+    double sun = (h < 6.0 || h > 20.0) ? 0.0 : sin(M_PI * (h - 6.0) / 14.0);
+    double cloud = 0.75 + 0.25 * sin(t / 700.0) * sin(t / 2300.0);
+    return 20000000.0 * sun * cloud + 5000.0;
+}
+
+static double night(double t)
+{
+    (void)t;
+    return 800.0;
+}
+
+static double switching(double t)
+{
+    /* On for 20 min, off for 10, dimmed for 10 */
+    double m = fmod(t, 2400.0);
+    return (m < 1200.0) ? 500000.0 : ((m < 1800.0) ? 2000.0 : 150000.0);
+}
+
+typedef struct
+{
+    als_event_t ev;
+    uint32_t    max_gap_ms;
+    uint32_t    max_step_ms;    /* longest interval between readings */
+    uint32_t    prev_ms;
+    double      worst_excess;   /* tracking error beyond the deadband, mlux */
+    bool        have_truth;
+} run_t;
+
+static void run_init(run_t *r)
+{
+    const als_event_cfg_t cfg = { DEADBAND_MLUX, DEADBAND_PERMILLE, MAX_SILENCE_MS };
+    als_event_init(&r->ev, &cfg);
+    r->max_gap_ms = 0u;
+    r->max_step_ms = 0u;
+    r->worst_excess = 0.0;
+}
+
+static void run_offer(run_t *r, uint32_t mlux, uint32_t now_ms, double truth)
+{
+    uint32_t prev_ms = r->ev.last_ms;
+    bool had = r->ev.have_last;
+
+    if (r->ev.seen > 0u)
+    {
+        uint32_t step = now_ms - r->prev_ms;
+        r->max_step_ms = (step > r->max_step_ms) ? step : r->max_step_ms;
+    }
+    r->prev_ms = now_ms;
+
+    if ((als_event_offer(&r->ev, mlux, now_ms) != ALS_EVENT_NONE) && had)
+    {
+        uint32_t gap = now_ms - prev_ms;
+        r->max_gap_ms = (gap > r->max_gap_ms) ? gap : r->max_gap_ms;
+    }
+    if (r->have_truth)
+    {
+        double band = fmax(DEADBAND_MLUX, r->ev.last_mlux * DEADBAND_PERMILLE / 1000.0);
+        r->worst_excess = fmax(r->worst_excess, fabs(truth - (double)r->ev.last_mlux) - band);
+    }
+}
+
+static void report(const char *name, const run_t *r, double hours)
+{
+    char line[96];
+    const als_event_t *ev = &r->ev;
+
+    printf("%-22s %8lu readings -> %6lu sent (%lu heartbeats), %5.1f/h, %lu.%lu %% suppressed\n",
+           name, (unsigned long)ev->seen, (unsigned long)ev->reported, (unsigned long)ev->heartbeats,
+           ev->reported / hours, (unsigned long)(als_event_suppressed_permille(ev) / 10u),
+           (unsigned long)(als_event_suppressed_permille(ev) % 10u));
+    snprintf(line, sizeof(line), "%s: heartbeat gap %lu ms at most", name, (unsigned long)r->max_gap_ms);
+    /* A heartbeat can only go out with the next reading */
+    check(r->max_gap_ms < MAX_SILENCE_MS + r->max_step_ms, line);
+    if (r->have_truth)
+    {
+        /* Noise can push a reading to the edge of the band on either side */
+        snprintf(line, sizeof(line), "%s: tracks the light within band + %.0f mlux",
+                 name, fmax(r->worst_excess, 0.0));
+        check(r->worst_excess <= 4.0 * NOISE_MLUX, line);
+    }
+}
+
+static double synthetic(const char *name, light_fn light, double hours)
+{
+    run_t r;
+    uint32_t n = (uint32_t)(hours * 3600.0 * RATE_HZ);
+
+    srand(3);
+    run_init(&r);
+    r.have_truth = true;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        double t = (double)i / RATE_HZ;
+        double truth = light(t);
+        double v = truth + NOISE_MLUX * gauss();
+        run_offer(&r, (v < 0.0) ? 0u : (uint32_t)v, (uint32_t)(t * 1000.0), truth);
+    }
+    report(name, &r, hours);
+    return als_event_suppressed_permille(&r.ev) / 10.0;
+}
+
+static void recorded(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    run_t r;
+    unsigned long t_ms, mlux;
+    unsigned long first = 0u, last = 0u;
+    char buf[128];
+
+    if (f == NULL)
+    {
+        perror(path);
+        failures++;
+        return;
+    }
+    run_init(&r);
+    r.have_truth = false;
+    while (fgets(buf, sizeof(buf), f) != NULL)
+    {
+        if (sscanf(buf, "%lu,%lu", &t_ms, &mlux) != 2)
+        {
+            continue;       /* header or comment */
+        }
+        first = (r.ev.seen == 0u) ? t_ms : first;
+        last = t_ms;
+        run_offer(&r, (uint32_t)mlux, (uint32_t)t_ms, 0.0);
+    }
+    fclose(f);
+    report(path, &r, fmax((double)(last - first) / 3.6e6, 1e-3));
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            recorded(argv[i]);
+        }
+    }
+    else
+    {
+        check(synthetic("office, fixed light", office, 8.0) >= 99.5, "office: at least 99.5 % suppressed");
+        check(synthetic("window, overcast day", window_day, 24.0) >= 99.0, "window: at least 99 % suppressed");
+        check(synthetic("night", night, 10.0) >= 99.8, "night: at least 99.8 % suppressed");
+        check(synthetic("lights switching", switching, 4.0) >= 99.5, "switching: at least 99.5 % suppressed");
+    }
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
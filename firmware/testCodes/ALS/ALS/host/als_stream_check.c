@@ -0,0 +1,272 @@
+/******************************************************************************
+* File Name:   als_stream_check.c
+*
+* Description: Host checks for als_stream on the mock ADC backend: gap-free
+*              block delivery at rates from a few Hz to the maximum, block
+*              contents against the generator, overruns with a consumer that
+*              polls too seldom or holds a block too long, and a restart on
+*              a rate change. Ends with the host throughput of the engine.
+*              Prints one line per check and exits non-zero if any failed.
+*
+*                cc -O2 -I.. -Iemu -o als_stream_check als_stream_check.c \
+*                   als_adc_mock.c ../als_stream.c
+*
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "als_adc_mock.h"
+
+#define NCH                 (3u)
+#define BLOCK_SCANS         (ALS_STREAM_BLOCK_SAMPLES_MAX / 4u / NCH)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+/* Scan number and channel encoded in the sample */
+static int32_t gen(uint64_t n, size_t ch, void *arg)
+{
+    (void)arg;
+    return (int32_t)(((n & 0x07FFFFFFu) << 4) | ch);
+}
+
+typedef struct
+{
+    uint32_t      blocks;
+    uint32_t      last_seq;
+    uint32_t      seq_gaps;         /* sequence numbers skipped */
+    uint64_t      next_scan;        /* expected first scan if nothing dropped */
+    bool          contiguous;       /* every block is consecutive scans */
+    bool          seq_rising;       /* strictly, gaps counted apart */
+    bool          no_gaps;          /* no scan missing between blocks */
+    uint64_t      sum;
+    als_adc_mock_t *hold_mock;      /* advance this while holding the block */
+    uint64_t      hold_us;
+} sink_t;
+
+static void sink(const int32_t *x, size_t num_scans, size_t num_channels, uint32_t seq, void *arg)
+{
+    sink_t *k = (sink_t *)arg;
+    uint64_t first = (uint64_t)x[0] >> 4;
+
+    for (size_t i = 0; i < num_scans; ++i)
+    {
+        for (size_t ch = 0; ch < num_channels; ++ch)
+        {
+            int32_t v = x[i * num_channels + ch];
+            k->contiguous &= (v == gen(first + i, ch, NULL));
+            k->sum += (uint32_t)v;
+        }
+    }
+    if (k->blocks == 0u)
+    {
+        k->seq_gaps = seq;
+    }
+    else
+    {
+        k->seq_rising &= (seq > k->last_seq);
+        k->seq_gaps += seq - k->last_seq - 1u;
+    }
+    k->no_gaps &= (first == k->next_scan);
+    k->next_scan = first + num_scans;
+    k->last_seq = seq;
+    k->blocks++;
+
+    if (k->hold_mock != NULL)
+    {
+        als_adc_mock_advance(k->hold_mock, k->hold_us);
+    }
+}
+
+static void sink_reset(sink_t *k)
+{
+    memset(k, 0, sizeof(*k));
+    k->contiguous = true;
+    k->seq_rising = true;
+    k->no_gaps = true;
+}
+
+static void setup(als_stream_t *s, als_adc_mock_t *m, als_adc_backend_t *be, uint32_t rate_hz)
+{
+    als_stream_cfg_t cfg = { rate_hz, BLOCK_SCANS, NCH };
+
+    als_adc_mock_init(m, NCH, gen, NULL, be);
+    if ((als_stream_init(s, be, &cfg) != CY_RSLT_SUCCESS) || (als_stream_start(s) != CY_RSLT_SUCCESS))
+    {
+        check(false, "init and start");
+    }
+}
+
+/* Polls often enough for any rate: twice per block, at most every 1 ms */
+static uint64_t poll_us(uint32_t rate_hz)
+{
+    uint64_t half = (uint64_t)BLOCK_SCANS * 500000u / rate_hz;
+    return (half < 1000u) ? half : 1000u;
+}
+
+/* Runs seconds of simulated time in steps of step_us, polling after each */
+static void run(als_stream_t *s, als_adc_mock_t *m, sink_t *k, uint32_t seconds, uint64_t step_us)
+{
+    for (uint64_t t = 0; t < (uint64_t)seconds * 1000000u; t += step_us)
+    {
+        als_adc_mock_advance(m, step_us);
+        while (als_stream_process(s, sink, k))
+        {
+        }
+    }
+}
+
+static void bad_args(void)
+{
+    als_adc_mock_t m;
+    als_adc_backend_t be;
+    als_stream_t s;
+    als_stream_cfg_t cfg = { 1000u, BLOCK_SCANS, NCH };
+
+    als_adc_mock_init(&m, NCH, gen, NULL, &be);
+    cfg.block_scans = ALS_STREAM_BLOCK_SAMPLES_MAX / NCH + 1u;
+    check(als_stream_init(&s, &be, &cfg) == ALS_STREAM_RSLT_BAD_ARG, "block larger than the buffer rejected");
+    cfg.block_scans = BLOCK_SCANS;
+    cfg.rate_hz = ALS_STREAM_RATE_MAX_HZ + 1u;
+    check(als_stream_init(&s, &be, &cfg) == ALS_STREAM_RSLT_BAD_ARG, "rate above maximum rejected");
+}
+
+static void delivery(void)
+{
+    static const uint32_t rates[] = { 5u, 100u, 1000u, 20000u, ALS_STREAM_RATE_MAX_HZ };
+    char line[96];
+
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r)
+    {
+        als_adc_mock_t m;
+        als_adc_backend_t be;
+        als_stream_t s;
+        als_stream_stats_t st;
+        sink_t k;
+        uint32_t seconds = (rates[r] < 100u) ? 60u : 4u;
+
+        sink_reset(&k);
+        setup(&s, &m, &be, rates[r]);
+        run(&s, &m, &k, seconds, poll_us(rates[r]));
+        als_stream_get_stats(&s, &st);
+
+        uint32_t expect = (uint32_t)(m.scan_no / BLOCK_SCANS);
+        snprintf(line, sizeof(line), "%6lu Hz: %lu blocks in %lu s, no overruns or lost scans",
+                 (unsigned long)rates[r], (unsigned long)st.blocks, (unsigned long)seconds);
+        check((st.blocks == expect) && (k.blocks == expect) && (st.overruns == 0u) && (m.lost == 0u), line);
+        snprintf(line, sizeof(line), "%6lu Hz: contents, sequence and scan order intact", (unsigned long)rates[r]);
+        check(k.contiguous && k.seq_rising && (k.seq_gaps == 0u) && k.no_gaps &&
+              (st.samples == expect * BLOCK_SCANS * NCH), line);
+    }
+}
+
+static void late_poll(void)
+{
+    als_adc_mock_t m;
+    als_adc_backend_t be;
+    als_stream_t s;
+    als_stream_stats_t st;
+    sink_t k;
+    char line[96];
+
+    /* 1 kHz, about 3 blocks per 100 ms poll: the newest one is kept */
+    sink_reset(&k);
+    setup(&s, &m, &be, 1000u);
+    run(&s, &m, &k, 10u, 100000u);
+    als_stream_get_stats(&s, &st);
+
+    uint32_t produced = (uint32_t)(m.scan_no / BLOCK_SCANS);
+    snprintf(line, sizeof(line), "late poll: %lu delivered + %lu overruns = %lu produced",
+             (unsigned long)st.blocks, (unsigned long)st.overruns, (unsigned long)produced);
+    check((st.overruns > 0u) && (st.blocks + st.overruns == produced), line);
+    check(k.contiguous && k.seq_rising && (m.lost == 0u), "late poll: blocks intact, backend never starved");
+    snprintf(line, sizeof(line), "late poll: %lu sequence numbers skipped", (unsigned long)k.seq_gaps);
+    check(k.seq_gaps == st.overruns, line);
+}
+
+static void long_hold(void)
+{
+    als_adc_mock_t m;
+    als_adc_backend_t be;
+    als_stream_t s;
+    als_stream_stats_t st;
+    sink_t k;
+    char line[96];
+
+    /* Callback holds its half for 4 block times: those blocks are dropped */
+    sink_reset(&k);
+    setup(&s, &m, &be, 1000u);
+    k.hold_mock = &m;
+    k.hold_us = 4u * BLOCK_SCANS * 1000u;
+    run(&s, &m, &k, 10u, 1000u);
+    als_stream_get_stats(&s, &st);
+
+    uint32_t produced = (uint32_t)(m.scan_no / BLOCK_SCANS);
+    snprintf(line, sizeof(line), "long hold: %lu delivered + %lu overruns = %lu produced",
+             (unsigned long)st.blocks, (unsigned long)st.overruns, (unsigned long)produced);
+    check((st.overruns >= 3u * st.blocks) && (st.blocks + st.overruns + 1u >= produced) &&
+          (st.blocks + st.overruns <= produced), line);
+    check(k.contiguous && k.seq_rising && (k.seq_gaps == 0u) && (m.lost == 0u), "long hold: blocks intact, backend never starved");
+}
+
+static void rate_change(void)
+{
+    als_adc_mock_t m;
+    als_adc_backend_t be;
+    als_stream_t s;
+    als_stream_stats_t st;
+    sink_t k;
+
+    sink_reset(&k);
+    setup(&s, &m, &be, 1000u);
+    run(&s, &m, &k, 2u, 1000u);
+    uint32_t before = k.blocks;
+    check(als_stream_set_rate(&s, 10000u) == CY_RSLT_SUCCESS, "rate change while running");
+    run(&s, &m, &k, 2u, poll_us(10000u));
+    als_stream_get_stats(&s, &st);
+    check((m.rate_hz == 10000u) && (k.blocks - before == 20000u / BLOCK_SCANS) && (k.seq_gaps == 0u) &&
+          (st.overruns == 0u), "restarted at the new rate, sequence continues");
+    als_stream_stop(&s);
+    als_adc_mock_advance(&m, 1000000u);
+    check(!als_stream_process(&s, sink, &k), "nothing delivered after stop");
+}
+
+static void throughput(void)
+{
+    als_adc_mock_t m;
+    als_adc_backend_t be;
+    als_stream_t s;
+    als_stream_stats_t st;
+    sink_t k;
+    struct timespec t0, t1;
+    const uint32_t seconds = 200u;
+
+    sink_reset(&k);
+    setup(&s, &m, &be, ALS_STREAM_RATE_MAX_HZ);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    run(&s, &m, &k, seconds, poll_us(ALS_STREAM_RATE_MAX_HZ));
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    als_stream_get_stats(&s, &st);
+
+    double dt = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    printf("throughput: %lu samples in %.3f s host time, %.1f Msamples/s (checksum %llx)\n",
+           (unsigned long)st.samples, dt, (double)st.samples / dt * 1e-6, (unsigned long long)k.sum);
+}
+
+int main(void)
+{
+    bad_args();
+    delivery();
+    late_poll();
+    long_hold();
+    rate_change();
+    throughput();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
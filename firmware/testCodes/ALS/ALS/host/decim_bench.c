@@ -0,0 +1,159 @@
+/******************************************************************************
+* File Name:   decim_bench.c
+*
+* Description: Host check and benchmark for als_decim: exact DC gain of the
+*              boxcar and CIC2 paths at every factor, no overflow at full
+*              scale, the measured resolution of the Q output for a DC input
+*              with one LSB of noise against als_decim_enob_q8(), and the
+*              cost per input sample. Exits non-zero on a failed check.
+*
+*                cc -O2 -I.. -Iemu -o decim_bench decim_bench.c ../als_decim.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "als_decim.h"
+
+#define ADC_BITS            (12u)
+#define ADC_MAX             ((1 << ADC_BITS) - 1)
+#define NOISE_LSB           (1.0)
+#define OUTPUTS             (4000u)
+#define BENCH_SAMPLES       (1u << 24)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double gauss(void)
+{
+    /* Box-Muller */
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double v = (double)rand() / ((double)RAND_MAX + 1.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static const char *mode_name(als_decim_mode_t mode)
+{
+    return (mode == ALS_DECIM_CIC2) ? "CIC2" : "boxcar";
+}
+
+static void dc_gain(als_decim_mode_t mode)
+{
+    static int32_t in[ALS_DECIM_MAX_FACTOR * 4u];
+    int32_t out[8];
+    bool exact = true;
+
+    for (uint32_t r = 1u; r <= ALS_DECIM_MAX_FACTOR; ++r)
+    {
+        static const int32_t levels[] = { 0, 1, 2047, ADC_MAX };
+        for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); ++l)
+        {
+            als_decim_t d;
+            (void)als_decim_init(&d, mode, r);
+            for (uint32_t i = 0; i < 4u * r; ++i)
+            {
+                in[i] = levels[l];
+            }
+            size_t n = als_decim_process(&d, in, 4u * r, 1u, out);
+            exact &= (n == 4u - ((uint32_t)mode - 1u));
+            for (size_t k = 0; k < n; ++k)
+            {
+                exact &= (out[k] == (levels[l] << ALS_DECIM_FRAC_BITS));
+            }
+        }
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "%s: exact DC gain, R = 1..%u, up to full scale", mode_name(mode),
+             ALS_DECIM_MAX_FACTOR);
+    check(exact, line);
+}
+
+/* Output noise of a DC input with NOISE_LSB of white noise, as bits */
+static double measured_bits(als_decim_mode_t mode, uint32_t r)
+{
+    als_decim_t d;
+    const double dc = 2000.37;
+    double sum2 = 0.0;
+    uint32_t got = 0u;
+    int32_t in[ALS_DECIM_MAX_FACTOR], out[2];
+
+    srand(7);
+    (void)als_decim_init(&d, mode, r);
+    while (got < OUTPUTS)
+    {
+        for (uint32_t i = 0; i < r; ++i)
+        {
+            in[i] = (int32_t)lrint(dc + NOISE_LSB * gauss());
+        }
+        size_t n = als_decim_process(&d, in, r, 1u, out);
+        for (size_t k = 0; k < n; ++k, ++got)
+        {
+            double e = (double)out[k] / (double)(1u << ALS_DECIM_FRAC_BITS) - dc;
+            sum2 += e * e;
+        }
+    }
+    /* Relative to a plain conversion with the same noise and quantisation */
+    double in_rms = sqrt(NOISE_LSB * NOISE_LSB + 1.0 / 12.0);
+    return ADC_BITS + log2(in_rms / sqrt(sum2 / got));
+}
+
+static void resolution(als_decim_mode_t mode)
+{
+    static const uint32_t factors[] = { 1u, 4u, 16u, 64u, 256u };
+    char line[96];
+
+    for (size_t i = 0; i < sizeof(factors) / sizeof(factors[0]); ++i)
+    {
+        double reported = als_decim_enob_q8(ADC_BITS, factors[i]) / 256.0;
+        double meas = measured_bits(mode, factors[i]);
+
+        /* The report is an upper bound: allowed to be a quarter bit high */
+        snprintf(line, sizeof(line), "%s R=%3lu: reported %5.2f bits, measured %5.2f", mode_name(mode),
+                 (unsigned long)factors[i], reported, meas);
+        check(reported <= meas + 0.25, line);
+    }
+    check(als_decim_enob_q8(ADC_BITS, 1u << 16) == ((ADC_BITS + ALS_DECIM_FRAC_BITS) << 8),
+          "reported bits capped at what the Q output carries");
+}
+
+static void bench(als_decim_mode_t mode, uint32_t r)
+{
+    static int32_t in[BENCH_SAMPLES];
+    static int32_t out[BENCH_SAMPLES];
+    als_decim_t d;
+    struct timespec t0, t1;
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; ++i)
+    {
+        in[i] = (int32_t)((i * 2654435761u) >> 20);
+    }
+    (void)als_decim_init(&d, mode, r);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    size_t n = als_decim_process(&d, in, BENCH_SAMPLES, 1u, out);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double dt = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    printf("%-6s R=%3lu: %5.2f ns per input, %7.1f ns per output (%zu outputs)\n", mode_name(mode),
+           (unsigned long)r, dt / BENCH_SAMPLES * 1e9, dt / (double)n * 1e9, n);
+}
+
+int main(void)
+{
+    dc_gain(ALS_DECIM_BOXCAR);
+    dc_gain(ALS_DECIM_CIC2);
+    resolution(ALS_DECIM_BOXCAR);
+    resolution(ALS_DECIM_CIC2);
+    bench(ALS_DECIM_BOXCAR, 16u);
+    bench(ALS_DECIM_CIC2, 64u);
+    bench(ALS_DECIM_CIC2, 256u);
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+/******************************************************************************
+* File Name:   cy_result.h
+*
+* Description: Host stand-in for the core-lib result header, only the parts
+*              the ALS modules use, with the same bit layout.
+*
+*******************************************************************************/
+
+#ifndef CY_RESULT_H_
+#define CY_RESULT_H_
+
+#include <stdint.h>
+
+typedef uint32_t cy_rslt_t;
+
+#define CY_RSLT_SUCCESS                     ((cy_rslt_t)0x00000000U)
+
+#define CY_RSLT_TYPE_POSITION               (16U)
+#define CY_RSLT_TYPE_MASK                   (0x3U)
+#define CY_RSLT_MODULE_POSITION             (18U)
+#define CY_RSLT_MODULE_MASK                 (0x3FFFU)
+#define CY_RSLT_CODE_POSITION               (0U)
+#define CY_RSLT_CODE_MASK                   (0xFFFFU)
+
+#define CY_RSLT_TYPE_ERROR                  (2U)
+#define CY_RSLT_MODULE_MIDDLEWARE_BASE      (0x0A0U)
+
+#define CY_RSLT_CREATE(type, module, code) \
+    ((((module) & CY_RSLT_MODULE_MASK) << CY_RSLT_MODULE_POSITION) | \
+     (((code) & CY_RSLT_CODE_MASK) << CY_RSLT_CODE_POSITION) | \
+     (((type) & CY_RSLT_TYPE_MASK) << CY_RSLT_TYPE_POSITION))
+
+#endif /* CY_RESULT_H_ */
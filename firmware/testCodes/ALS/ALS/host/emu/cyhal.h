@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name:   cyhal.h
+*
+* Description: Host stand-in for the HAL header, only the SAR ADC part that
+*              als_adc_hal.c uses, with the same names and signatures. The
+*              functions are implemented by the SAR model in sar_sim.c; the
+*              objects carry the model's state instead of the HAL's.
+*
+*******************************************************************************/
+
+#ifndef CYHAL_H_
+#define CYHAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define NC                                  ((cyhal_gpio_t)-1)
+#define CYHAL_ADC_VNEG                      NC
+
+#define CYHAL_DMA_PRIORITY_DEFAULT          (3u)
+#define CYHAL_ISR_PRIORITY_DEFAULT          (7u)
+
+#define CYHAL_ADC_MAX_CHANNELS              (16u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef int32_t cyhal_gpio_t;
+
+typedef enum
+{
+    CYHAL_ADC_EOS                   = 1u,
+    CYHAL_ADC_ASYNC_READ_COMPLETE   = 2u
+} cyhal_adc_event_t;
+
+typedef enum
+{
+    CYHAL_ADC_VNEG_VSSA,
+    CYHAL_ADC_VNEG_VREF
+} cyhal_adc_vneg_t;
+
+typedef enum
+{
+    CYHAL_ADC_REF_INTERNAL,
+    CYHAL_ADC_REF_EXTERNAL,
+    CYHAL_ADC_REF_VDDA,
+    CYHAL_ADC_REF_VDDA_DIV_2
+} cyhal_adc_vref_t;
+
+typedef enum
+{
+    CYHAL_ASYNC_SW,
+    CYHAL_ASYNC_DMA
+} cyhal_async_mode_t;
+
+typedef void (*cyhal_adc_event_callback_t)(void *arg, cyhal_adc_event_t event);
+
+typedef struct
+{
+    bool                continuous_scanning;
+    uint16_t            average_count;
+    cyhal_adc_vneg_t    vneg;
+    cyhal_adc_vref_t    vref;
+    cyhal_gpio_t        ext_vref;
+    uint32_t            ext_vref_mv;
+    bool                is_bypassed;
+    cyhal_gpio_t        bypass_pin;
+    uint8_t             resolution;
+} cyhal_adc_config_t;
+
+typedef struct
+{
+    bool                enabled;
+    bool                enable_averaging;
+    uint32_t            min_acquisition_ns;
+} cyhal_adc_channel_config_t;
+
+typedef struct cyhal_adc_channel cyhal_adc_channel_t;
+
+typedef struct
+{
+    cyhal_adc_config_t          cfg;
+    cyhal_adc_channel_t        *chan[CYHAL_ADC_MAX_CHANNELS];
+    size_t                      num_channels;
+    uint32_t                    rate_hz;
+    cyhal_adc_event_callback_t  cb;
+    void                       *cb_arg;
+    uint32_t                    events;
+    uint64_t                    now_ns;         /* model time */
+    uint32_t                    triggers;       /* software-started passes */
+    uint32_t                    configures;
+    uint64_t                    conversions;
+} cyhal_adc_t;
+
+struct cyhal_adc_channel
+{
+    cyhal_adc_t                *adc;
+    cyhal_gpio_t                pin;
+    cyhal_adc_channel_config_t  cfg;
+};
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t cyhal_adc_init(cyhal_adc_t *obj, cyhal_gpio_t pin, const void *clk);
+void cyhal_adc_free(cyhal_adc_t *obj);
+cy_rslt_t cyhal_adc_configure(cyhal_adc_t *obj, const cyhal_adc_config_t *config);
+cy_rslt_t cyhal_adc_set_sample_rate(cyhal_adc_t *obj, uint32_t desired_sample_rate_hz);
+cy_rslt_t cyhal_adc_channel_init_diff(cyhal_adc_channel_t *obj, cyhal_adc_t *adc, cyhal_gpio_t vplus,
+                                      cyhal_gpio_t vminus, const cyhal_adc_channel_config_t *cfg);
+void cyhal_adc_channel_free(cyhal_adc_channel_t *obj);
+int32_t cyhal_adc_read(const cyhal_adc_channel_t *obj);
+cy_rslt_t cyhal_adc_read_async(cyhal_adc_t *obj, size_t num_scan, int32_t *result_list);
+cy_rslt_t cyhal_adc_read_async_abort(cyhal_adc_t *obj);
+cy_rslt_t cyhal_adc_set_async_mode(cyhal_adc_t *obj, cyhal_async_mode_t mode, uint8_t dma_priority);
+void cyhal_adc_register_callback(cyhal_adc_t *obj, cyhal_adc_event_callback_t callback, void *callback_arg);
+void cyhal_adc_enable_event(cyhal_adc_t *obj, cyhal_adc_event_t event, uint8_t intr_priority, bool enable);
+
+#endif /* CYHAL_H_ */
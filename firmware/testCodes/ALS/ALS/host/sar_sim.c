@@ -0,0 +1,152 @@
+/******************************************************************************
+* File Name:   sar_sim.c
+*
+* Description: Host model of the PSoC 6 SAR, see sar_sim.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "sar_sim.h"
+
+#define COUNTS_MAX              (4095)
+
+static int32_t flat_input(cyhal_gpio_t pin, uint64_t now_ns)
+{
+    (void)now_ns;
+    return 1000 + 100 * pin;
+}
+
+int32_t (*sar_sim_input)(cyhal_gpio_t pin, uint64_t now_ns) = flat_input;
+
+uint64_t sar_sim_conv_ns(const cyhal_adc_channel_t *ch)
+{
+    const uint64_t clk_ps = 1000000000000u / SAR_SIM_CLK_HZ;
+    uint64_t acq_clks = ((uint64_t)ch->cfg.min_acquisition_ns * 1000u + clk_ps - 1u) / clk_ps;
+    uint64_t one = (acq_clks + SAR_SIM_CONV_CLKS) * clk_ps / 1000u;
+    return ch->cfg.enable_averaging ? one * ch->adc->cfg.average_count : one;
+}
+
+static int32_t convert(cyhal_adc_channel_t *ch)
+{
+    cyhal_adc_t *adc = ch->adc;
+    adc->now_ns += sar_sim_conv_ns(ch);
+    adc->conversions += ch->cfg.enable_averaging ? adc->cfg.average_count : 1u;
+
+    int32_t v = sar_sim_input(ch->pin, adc->now_ns);
+    return (v < 0) ? 0 : ((v > COUNTS_MAX) ? COUNTS_MAX : v);
+}
+
+cy_rslt_t cyhal_adc_init(cyhal_adc_t *obj, cyhal_gpio_t pin, const void *clk)
+{
+    (void)pin;
+    (void)clk;
+    memset(obj, 0, sizeof(*obj));
+    obj->cfg.average_count = 1u;
+    obj->cfg.resolution = 12u;
+    return CY_RSLT_SUCCESS;
+}
+
+void cyhal_adc_free(cyhal_adc_t *obj)
+{
+    obj->num_channels = 0u;
+}
+
+cy_rslt_t cyhal_adc_configure(cyhal_adc_t *obj, const cyhal_adc_config_t *config)
+{
+    obj->cfg = *config;
+    obj->now_ns += SAR_SIM_CONFIG_NS;
+    obj->configures++;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_adc_set_sample_rate(cyhal_adc_t *obj, uint32_t desired_sample_rate_hz)
+{
+    obj->rate_hz = desired_sample_rate_hz;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_adc_channel_init_diff(cyhal_adc_channel_t *obj, cyhal_adc_t *adc, cyhal_gpio_t vplus,
+                                      cyhal_gpio_t vminus, const cyhal_adc_channel_config_t *cfg)
+{
+    (void)vminus;
+    if (adc->num_channels == CYHAL_ADC_MAX_CHANNELS)
+    {
+        return CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0xFF);
+    }
+    obj->adc = adc;
+    obj->pin = vplus;
+    obj->cfg = *cfg;
+    adc->chan[adc->num_channels++] = obj;
+    return CY_RSLT_SUCCESS;
+}
+
+void cyhal_adc_channel_free(cyhal_adc_channel_t *obj)
+{
+    obj->cfg.enabled = false;
+}
+
+/* Modelled as a pass with only this channel in the sequencer, the best case
+ * for single reads. */
+int32_t cyhal_adc_read(const cyhal_adc_channel_t *obj)
+{
+    obj->adc->now_ns += SAR_SIM_TRIGGER_NS;
+    obj->adc->triggers++;
+    return convert((cyhal_adc_channel_t *)obj);
+}
+
+cy_rslt_t cyhal_adc_read_async(cyhal_adc_t *obj, size_t num_scan, int32_t *result_list)
+{
+    uint64_t start = obj->now_ns;
+
+    if (!obj->cfg.continuous_scanning)
+    {
+        obj->now_ns += SAR_SIM_TRIGGER_NS;
+        obj->triggers++;
+    }
+    for (size_t n = 0; n < num_scan; ++n)
+    {
+        for (size_t i = 0; i < obj->num_channels; ++i)
+        {
+            if (obj->chan[i]->cfg.enabled)
+            {
+                *result_list++ = convert(obj->chan[i]);
+            }
+        }
+    }
+    if (obj->cfg.continuous_scanning && (obj->rate_hz > 0u))
+    {
+        /* Paced by the scan timer, not by the conversions */
+        obj->now_ns = start + (uint64_t)num_scan * 1000000000u / obj->rate_hz;
+    }
+    if ((obj->cb != NULL) && ((obj->events & CYHAL_ADC_ASYNC_READ_COMPLETE) != 0u))
+    {
+        obj->cb(obj->cb_arg, CYHAL_ADC_ASYNC_READ_COMPLETE);
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_adc_read_async_abort(cyhal_adc_t *obj)
+{
+    (void)obj;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_adc_set_async_mode(cyhal_adc_t *obj, cyhal_async_mode_t mode, uint8_t dma_priority)
+{
+    (void)obj;
+    (void)mode;
+    (void)dma_priority;
+    return CY_RSLT_SUCCESS;
+}
+
+void cyhal_adc_register_callback(cyhal_adc_t *obj, cyhal_adc_event_callback_t callback, void *callback_arg)
+{
+    obj->cb = callback;
+    obj->cb_arg = callback_arg;
+}
+
+void cyhal_adc_enable_event(cyhal_adc_t *obj, cyhal_adc_event_t event, uint8_t intr_priority, bool enable)
+{
+    (void)intr_priority;
+    obj->events = enable ? (obj->events | (uint32_t)event) : (obj->events & ~(uint32_t)event);
+}
@@ -0,0 +1,43 @@
+/******************************************************************************
+* File Name:   sar_sim.h
+*
+* Description: Host model of the PSoC 6 SAR behind the cyhal.h stand-in in
+*              emu/. Conversions take their acquisition time plus the SAR
+*              clocks of a 12-bit conversion, repeated for averaged rows; a
+*              software-started pass adds a fixed trigger cost (HAL call,
+*              start, end-of-scan interrupt, result copy) and a configure the
+*              cost of reprogramming the SAR. All time is model time in
+*              adc->now_ns, so the cost of a read pattern can be compared
+*              without the board. Not part of the firmware build.
+*
+*              The figures below are assumptions, not measurements; change
+*              them to what a scope shows on the board.
+*
+*******************************************************************************/
+
+#ifndef SAR_SIM_H_
+#define SAR_SIM_H_
+
+#include "cyhal.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define SAR_SIM_CLK_HZ                    (18000000u)
+#define SAR_SIM_CONV_CLKS                 (14u)     /* 12 bits + 2 */
+#define SAR_SIM_TRIGGER_NS                (2500u)
+#define SAR_SIM_CONFIG_NS                 (6000u)
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+/* Input voltage of pin at model time now_ns, in counts. */
+extern int32_t (*sar_sim_input)(cyhal_gpio_t pin, uint64_t now_ns);
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Model time of one conversion of ch, averaging included. */
+uint64_t sar_sim_conv_ns(const cyhal_adc_channel_t *ch);
+
+#endif /* SAR_SIM_H_ */
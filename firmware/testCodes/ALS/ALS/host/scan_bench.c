@@ -0,0 +1,104 @@
+/******************************************************************************
+* File Name:   scan_bench.c
+*
+* Description: Host benchmark on the SAR model: one channel vector read as
+*              a blocking read per channel (one conversion setup each) and
+*              as one sequencer pass with als_adc_hal_read_scan(), for 1 to
+*              16 channels, with and without hardware averaging on the ALS
+*              row. Checks that both give the same vector and that the SAR
+*              is configured only once for repeated scans, then prints the
+*              model time per vector and the speed-up.
+*
+*                cc -O2 -I.. -Iemu -o scan_bench scan_bench.c sar_sim.c \
+*                   ../als_adc_hal.c
+*
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "als_adc_hal.h"
+#include "sar_sim.h"
+
+#define VECTORS             (10000u)
+#define ACQ_NS              (1000u)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static void bench(size_t nch, uint16_t average)
+{
+    als_adc_chan_t table[ALS_ADC_MAX_CHANNELS];
+    als_adc_backend_t be;
+    static als_adc_hal_t hal;
+    int32_t scan[ALS_ADC_MAX_CHANNELS], single[ALS_ADC_MAX_CHANNELS];
+    bool same = true;
+
+    for (size_t i = 0; i < nch; ++i)
+    {
+        table[i].pin = (cyhal_gpio_t)i;
+        table[i].averaging = (i == 0u);     /* only the ALS row, as in main.c */
+        table[i].min_acquisition_ns = ACQ_NS;
+    }
+    if ((als_adc_hal_init(&hal, table, nch, &be) != CY_RSLT_SUCCESS) ||
+        (als_adc_hal_set_averaging(&hal, average) != CY_RSLT_SUCCESS))
+    {
+        check(false, "init");
+        return;
+    }
+
+    /* First scan configures the SAR, with the average count for both */
+    same &= (als_adc_hal_read_scan(&hal, scan) == CY_RSLT_SUCCESS);
+    uint32_t cfg0 = hal.adc.configures;
+
+    uint64_t t0 = hal.adc.now_ns;
+    for (uint32_t n = 0; n < VECTORS; ++n)
+    {
+        for (size_t i = 0; i < nch; ++i)
+        {
+            single[i] = cyhal_adc_read(&hal.chan[i]);
+        }
+    }
+    uint64_t t_single = hal.adc.now_ns - t0;
+
+    t0 = hal.adc.now_ns;
+    for (uint32_t n = 0; n < VECTORS; ++n)
+    {
+        if (als_adc_hal_read_scan(&hal, scan) != CY_RSLT_SUCCESS)
+        {
+            same = false;
+        }
+    }
+    uint64_t t_scan = hal.adc.now_ns - t0;
+    same &= (memcmp(scan, single, nch * sizeof(scan[0])) == 0);
+
+    char line[96];
+    snprintf(line, sizeof(line), "%2zu ch, avg %3u: same vector, SAR configured once",
+             nch, (unsigned)average);
+    check(same && (cfg0 == 1u) && (hal.adc.configures == cfg0), line);
+    printf("    per channel %8.2f us   scan %8.2f us   x%.2f\n",
+           (double)t_single / VECTORS * 1e-3, (double)t_scan / VECTORS * 1e-3,
+           (double)t_single / (double)t_scan);
+    als_adc_hal_free(&hal);
+}
+
+int main(void)
+{
+    static const size_t counts[] = { 1u, 2u, 3u, 4u, 8u, 16u };
+
+    printf("SAR model: %u Hz clock, %u ns acquisition, %u ns per trigger, %u ns per configure\n",
+           SAR_SIM_CLK_HZ, ACQ_NS, SAR_SIM_TRIGGER_NS, SAR_SIM_CONFIG_NS);
+    for (size_t a = 0; a < 2u; ++a)
+    {
+        for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+        {
+            bench(counts[i], (a == 0u) ? 1u : 16u);
+        }
+    }
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
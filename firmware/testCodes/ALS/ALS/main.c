@@ -1,33 +1,219 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include <stdio.h>
+#include "als_stream.h"
+#include "als_adc_hal.h"
+#include "als_convert.h"
+#include "als_decim.h"
+#include "als_event.h"
 
 #define ALS_PIN P10_0  // Check in Device Configurator voor jouw board
 
+#define ALS_BLOCK_SCANS       (50u)
+#define ALS_PRINT_EVERY       (20u)     // blocks tussen twee prints
+#define ADC_ACQ_NS            (1000u)
+
+// Event mode: alleen veranderingen buiten de deadband verlaten de acquisitie
+#define ALS_DEADBAND_MLUX     (2000u)   // 2 lux
+#define ALS_DEADBAND_PERMILLE (20u)     // of 2 %, de grootste telt
+#define ALS_MAX_SILENCE_MS    (60000u)  // heartbeat
+
+_Static_assert(ALS_COUNTS_BITS == ALS_ADC_RESOLUTION_BITS, "als_convert expects the SAR resolution");
+
+// Kanaaltabel: index 0 is de ALS, daarna de externe analoge sensoren.
+// Eén sequencer-pass converteert alle kanalen.
+static const als_adc_chan_t adc_channels[] = {
+    { .pin = ALS_PIN, .averaging = true,  .min_acquisition_ns = ADC_ACQ_NS },
+    { .pin = P10_1,   .averaging = false, .min_acquisition_ns = ADC_ACQ_NS },
+    { .pin = P10_2,   .averaging = false, .min_acquisition_ns = ADC_ACQ_NS },
+};
+#define ADC_NUM_CHANNELS      (sizeof(adc_channels) / sizeof(adc_channels[0]))
+
+// Oversampling per deployment: hardware averaging x software decimatie.
+// De scan rate is out_rate_hz * factor. Wisselen met de user button.
+typedef struct
+{
+    uint16_t         hw_average;
+    als_decim_mode_t mode;
+    uint32_t         factor;
+    uint32_t         out_rate_hz;
+} oversample_cfg_t;
+
+static const oversample_cfg_t oversample_presets[] = {
+    {   1, ALS_DECIM_BOXCAR,  1, 1000 },   // geen oversampling
+    {   4, ALS_DECIM_BOXCAR, 16,  100 },
+    {  16, ALS_DECIM_CIC2,   64,   10 },
+    { 256, ALS_DECIM_CIC2,   32,    1 },
+};
+#define NUM_PRESETS           (sizeof(oversample_presets) / sizeof(oversample_presets[0]))
+
+static als_adc_hal_t als_hal;
+static als_adc_backend_t als_backend;
+static als_stream_t als_stream;
+static als_decim_t als_decim;
+static als_event_t als_event;
+static size_t preset_idx;
+static uint32_t als_out_ms_q8;           // tijd per decimator-uitgang, Q8 ms
+static uint64_t als_time_ms_q8;
+
+// CPU-kost van de decimator, in cycles (DWT)
+static uint32_t decim_cycles;
+static uint32_t decim_outputs;
+
+static void cycles_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static cy_rslt_t apply_oversampling(const oversample_cfg_t *os)
+{
+    cy_rslt_t rslt = als_adc_hal_set_averaging(&als_hal, os->hw_average);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+    rslt = als_decim_init(&als_decim, os->mode, os->factor);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+    decim_cycles = 0u;
+    decim_outputs = 0u;
+    als_out_ms_q8 = (1000u << 8) / os->out_rate_hz;
+
+    // set_rate herstart een lopende stream, dan geldt ook de nieuwe averaging
+    rslt = als_stream_set_rate(&als_stream, os->out_rate_hz * os->factor);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        uint32_t enob = als_decim_enob_q8(ALS_ADC_RESOLUTION_BITS, os->factor);
+        printf("Oversampling: hw %u x sw %lu (%s) -> %lu Hz, ~%lu.%02lu bits\r\n",
+               (unsigned)os->hw_average, (unsigned long)os->factor,
+               (os->mode == ALS_DECIM_CIC2) ? "CIC2" : "boxcar",
+               (unsigned long)os->out_rate_hz,
+               (unsigned long)(enob >> 8), (unsigned long)(((enob & 0xFFu) * 100u) >> 8));
+    }
+    return rslt;
+}
+
+static void on_block(const int32_t *samples, size_t num_scans, size_t num_channels,
+                     uint32_t seq, void *arg)
+{
+    (void)arg;
+    int32_t out[ALS_STREAM_BLOCK_SAMPLES_MAX];
+
+    // ALS (kanaal 0) door de decimator
+    uint32_t t0 = DWT->CYCCNT;
+    size_t n_out = als_decim_process(&als_decim, samples, num_scans, num_channels, out);
+    decim_cycles += DWT->CYCCNT - t0;
+    decim_outputs += (uint32_t)n_out;
+
+    // Ongewijzigde waarden worden hier al gedropt: geen formattering,
+    // geen flash-write, geen radio.
+    for (size_t i = 0; i < n_out; ++i)
+    {
+        als_time_ms_q8 += als_out_ms_q8;
+        uint32_t now_ms = (uint32_t)(als_time_ms_q8 >> 8);
+
+        // Decimator-uitgang in Q-counts: de fractiebits gaan mee naar uV/lux
+        uint32_t uv = als_counts_q_to_uv(out[i], ALS_DECIM_FRAC_BITS);
+        uint32_t mlux = als_uv_to_mlux(uv);
+        als_event_kind_t kind = als_event_offer(&als_event, mlux, now_ms);
+        if (kind != ALS_EVENT_NONE)
+        {
+            printf("ALS %s t=%lu ms: %lu.%03lu lux (suppressed %lu.%lu %%)\r\n",
+                   (kind == ALS_EVENT_HEARTBEAT) ? "heartbeat" : "change",
+                   (unsigned long)now_ms, (unsigned long)(mlux / 1000u), (unsigned long)(mlux % 1000u),
+                   (unsigned long)(als_event_suppressed_permille(&als_event) / 10u),
+                   (unsigned long)(als_event_suppressed_permille(&als_event) % 10u));
+        }
+    }
+
+    if ((seq % ALS_PRINT_EVERY) != 0u)
+    {
+        return;
+    }
+
+    printf("ADC block %lu:", (unsigned long)seq);
+    for (size_t ch = 1; ch < num_channels; ++ch)
+    {
+        int32_t raw = samples[(num_scans - 1u) * num_channels + ch];
+        printf(" ch%u raw: %ld (%lu mV)", (unsigned)ch, (long)raw,
+               (unsigned long)als_counts_to_mv(raw));
+    }
+    if (decim_outputs > 0u)
+    {
+        printf(" %lu cyc/out", (unsigned long)(decim_cycles / decim_outputs));
+    }
+
+    als_stream_stats_t st;
+    als_stream_get_stats(&als_stream, &st);
+    printf(" overruns %lu\r\n", (unsigned long)st.overruns);
+}
+
+static bool button_pressed(void)
+{
+    static bool prev = false;
+    bool now = (cyhal_gpio_read(CYBSP_USER_BTN) == CYBSP_BTN_PRESSED);
+    bool edge = now && !prev;
+    prev = now;
+    return edge;
+}
+
 int main(void)
 {
     cybsp_init();
     __enable_irq();
+    cycles_init();
+
+    cy_rslt_t rslt = cyhal_gpio_init(CYBSP_USER_BTN, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_PULLUP, CYBSP_BTN_OFF);
+    CY_ASSERT(rslt == CY_RSLT_SUCCESS);
 
-    cyhal_adc_t adc;
-    cyhal_adc_channel_t adc_chan;
+    rslt = als_adc_hal_init(&als_hal, adc_channels, ADC_NUM_CHANNELS, &als_backend);
+    CY_ASSERT(rslt == CY_RSLT_SUCCESS);
 
-    // Init ADC
-    cyhal_adc_init(&adc, ALS_PIN, NULL);
+    const oversample_cfg_t *os = &oversample_presets[preset_idx];
+    const als_stream_cfg_t cfg = {
+        .rate_hz      = os->out_rate_hz * os->factor,
+        .block_scans  = ALS_BLOCK_SCANS,
+        .num_channels = ADC_NUM_CHANNELS
+    };
+    rslt = als_stream_init(&als_stream, &als_backend, &cfg);
+    CY_ASSERT(rslt == CY_RSLT_SUCCESS);
+
+    rslt = apply_oversampling(os);
+    CY_ASSERT(rslt == CY_RSLT_SUCCESS);
 
-    // Init ALS channel
-    cyhal_adc_channel_config_t chan_config = {
-        .enable_averaging = false,
-        .min_acquisition_ns = 1000,
-        .enabled = true
+    const als_event_cfg_t ev_cfg = {
+        .deadband_mlux     = ALS_DEADBAND_MLUX,
+        .deadband_permille = ALS_DEADBAND_PERMILLE,
+        .max_silence_ms    = ALS_MAX_SILENCE_MS
     };
-    cyhal_adc_channel_init_diff(&adc_chan, &adc, ALS_PIN, CYHAL_ADC_VNEG, &chan_config);
+    als_event_init(&als_event, &ev_cfg);
+
+    rslt = als_stream_start(&als_stream);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        printf("ALS stream start failed: 0x%08lx\r\n", (unsigned long)rslt);
+        CY_ASSERT(0);
+    }
 
     for (;;)
     {
-        int32_t raw = cyhal_adc_read_u16(&adc_chan);
-        float voltage = (raw / 65535.0f) * 3.3f;
-        printf("ALS raw: %ld, Voltage: %.3f V\r\n", raw, voltage);
-        cyhal_system_delay_ms(500);
+        if (button_pressed())
+        {
+            preset_idx = (preset_idx + 1u) % NUM_PRESETS;
+            rslt = apply_oversampling(&oversample_presets[preset_idx]);
+            if (rslt != CY_RSLT_SUCCESS)
+            {
+                printf("Oversampling preset %u failed: 0x%08lx\r\n", (unsigned)preset_idx, (unsigned long)rslt);
+            }
+        }
+
+        if (!als_stream_process(&als_stream, on_block, NULL))
+        {
+            cyhal_syspm_sleep();
+        }
     }
 }
@@ -0,0 +1,120 @@
+/******************************************************************************
+* File Name:   adpcm.c
+*
+* Description: IMA-ADPCM codec, see adpcm.h.
+*
+*******************************************************************************/
+
+#include "adpcm.h"
+
+#define STEP_INDEX_MAX      (88)
+
+static const int16_t step_table[STEP_INDEX_MAX + 1] = {
+        7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+       19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+       50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+      130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+      337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+      876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+     2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+     5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t index_table[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static inline int32_t clamp16(int32_t v)
+{
+    return (v > INT16_MAX) ? INT16_MAX : ((v < INT16_MIN) ? INT16_MIN : v);
+}
+
+static inline int32_t next_index(int32_t index, uint8_t code)
+{
+    index += index_table[code & 7u];
+    return (index < 0) ? 0 : ((index > STEP_INDEX_MAX) ? STEP_INDEX_MAX : index);
+}
+
+/* Shared by encoder and decoder so both track the same predictor. */
+static inline int32_t reconstruct(int32_t pred, int32_t step, uint8_t code)
+{
+    int32_t diff = step >> 3;
+    if (code & 4u) { diff += step; }
+    if (code & 2u) { diff += step >> 1; }
+    if (code & 1u) { diff += step >> 2; }
+    return clamp16((code & 8u) ? (pred - diff) : (pred + diff));
+}
+
+void adpcm_init(adpcm_state_t *st)
+{
+    st->predictor = 0;
+    st->index = 0u;
+}
+
+size_t adpcm_encode_block(adpcm_state_t *st, const int16_t *pcm, size_t n, uint8_t *out)
+{
+    int32_t pred = (n > 0u) ? pcm[0] : st->predictor;
+    int32_t index = st->index;
+
+    out[0] = (uint8_t)((uint16_t)pred & 0xFFu);
+    out[1] = (uint8_t)((uint16_t)pred >> 8);
+    out[2] = (uint8_t)index;
+    out[3] = 0u;
+    uint8_t *dst = &out[ADPCM_BLOCK_HEADER_BYTES];
+
+    /* The first sample is in the header, nibble j codes sample j + 1. */
+    for (size_t i = 1; i < n; ++i)
+    {
+        int32_t step = step_table[index];
+        int32_t diff = (int32_t)pcm[i] - pred;
+        uint8_t code = 0u;
+        if (diff < 0)
+        {
+            code = 8u;
+            diff = -diff;
+        }
+        /* Three-bit magnitude, diff / step quantised by successive halving. */
+        if (diff >= step)        { code |= 4u; diff -= step; }
+        if (diff >= (step >> 1)) { code |= 2u; diff -= step >> 1; }
+        if (diff >= (step >> 2)) { code |= 1u; }
+
+        pred = reconstruct(pred, step, code);
+        index = next_index(index, code);
+
+        if ((i & 1u) != 0u)
+        {
+            *dst = code;
+        }
+        else
+        {
+            *dst++ |= (uint8_t)(code << 4);
+        }
+    }
+
+    st->predictor = (int16_t)pred;
+    st->index = (uint8_t)index;
+    return ADPCM_BLOCK_BYTES(n);
+}
+
+size_t adpcm_decode_block(const uint8_t *in, size_t n, int16_t *pcm)
+{
+    int32_t pred = (int16_t)((uint16_t)in[0] | ((uint16_t)in[1] << 8));
+    int32_t index = in[2];
+    if (index > STEP_INDEX_MAX)
+    {
+        return 0u;
+    }
+    const uint8_t *src = &in[ADPCM_BLOCK_HEADER_BYTES];
+
+    if (n > 0u)
+    {
+        pcm[0] = (int16_t)pred;
+    }
+    for (size_t i = 1; i < n; ++i)
+    {
+        uint8_t code = ((i & 1u) != 0u) ? (uint8_t)(*src & 0x0Fu) : (uint8_t)(*src++ >> 4);
+        pred = reconstruct(pred, step_table[index], code);
+        index = next_index(index, code);
+        pcm[i] = (int16_t)pred;
+    }
+    return ADPCM_BLOCK_BYTES(n);
+}
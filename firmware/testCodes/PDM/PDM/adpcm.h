@@ -0,0 +1,53 @@
+/******************************************************************************
+* File Name:   adpcm.h
+*
+* Description: IMA-ADPCM codec for PCM clips, 4 bits per sample. Audio is
+*              coded in blocks that each decode on their own. Block layout
+*              (little endian, as a mono WAV IMA-ADPCM block):
+*                int16 first sample, uint8 step index, uint8 reserved (0),
+*                then the other n - 1 samples, two per byte, low nibble
+*                first.
+*              A block of an odd number of samples is byte for byte a WAV
+*              block with nSamplesPerBlock = n; for even n the last nibble
+*              is padding.
+*              Plain C, no HAL: the decoder builds as-is on the host.
+*
+*******************************************************************************/
+
+#ifndef ADPCM_H_
+#define ADPCM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define ADPCM_BLOCK_HEADER_BYTES          (4u)
+#define ADPCM_BLOCK_BYTES(samples)        (ADPCM_BLOCK_HEADER_BYTES + ((samples) / 2u))
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+/* Encoder state, carried from block to block. Only the step index
+ * carries over: each block restarts from its first sample. */
+typedef struct
+{
+    int16_t predictor;
+    uint8_t index;
+} adpcm_state_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void adpcm_init(adpcm_state_t *st);
+
+/* Encodes n samples into out (ADPCM_BLOCK_BYTES(n) bytes). Returns the
+ * number of bytes written. */
+size_t adpcm_encode_block(adpcm_state_t *st, const int16_t *pcm, size_t n, uint8_t *out);
+
+/* Decodes one block of n samples. Returns the number of bytes consumed,
+ * or 0 if the header is invalid. */
+size_t adpcm_decode_block(const uint8_t *in, size_t n, int16_t *pcm);
+
+#endif /* ADPCM_H_ */
@@ -0,0 +1,293 @@
+/******************************************************************************
+* File Name:   adpcm_check.c
+*
+* Description: Host check and benchmark for the ADPCM codec: round-trip SNR
+*              of tones, speech-like and noise signals coded in 256-sample
+*              blocks as main.c does, that blocks decode on their own and
+*              start on their exact first sample, bad headers, then encoder
+*              and decoder throughput in samples/s. Exits non-zero on a
+*              failed check.
+*
+*                cc -O2 -I.. -o adpcm_check adpcm_check.c ../adpcm.c -lm
+*                ./adpcm_check [-w clip.wav]
+*
+*              -w writes the speech-like signal as a mono IMA-ADPCM WAV
+*              (505-sample blocks) to check with any player or decoder.
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "adpcm.h"
+
+#define FS                  (16000u)
+#define BLOCK               (256u)              /* one PCM frame, as main.c */
+#define SIGNAL_SAMPLES      (FS * 4u)
+#define BLOCKS              (SIGNAL_SAMPLES / BLOCK)
+#define WAV_BLOCK           (505u)              /* 256-byte WAV blocks */
+#define BENCH_ROUNDS        (100u)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double gauss(void)
+{
+    /* Box-Muller */
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double v = (double)rand() / ((double)RAND_MAX + 1.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static int16_t clip16(double v)
+{
+    long r = lrint(v);
+    return (int16_t)((r > 32767) ? 32767 : ((r < -32768) ? -32768 : r));
+}
+
+static int16_t pcm[SIGNAL_SAMPLES];
+static int16_t dec[SIGNAL_SAMPLES];
+static uint8_t coded[BLOCKS][ADPCM_BLOCK_BYTES(BLOCK)];
+
+static void encode_all(const int16_t *x)
+{
+    adpcm_state_t st;
+    adpcm_init(&st);
+    for (uint32_t b = 0; b < BLOCKS; ++b)
+    {
+        (void)adpcm_encode_block(&st, &x[b * BLOCK], BLOCK, coded[b]);
+    }
+}
+
+static double snr_db(const int16_t *x, const int16_t *y, size_t n)
+{
+    double s = 0.0, e = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        s += (double)x[i] * x[i];
+        e += ((double)x[i] - y[i]) * ((double)x[i] - y[i]);
+    }
+    return (e == 0.0) ? 200.0 : 10.0 * log10(s / e);
+}
+
+typedef void (*signal_fn)(int16_t *x);
+
+static void tone_1k(int16_t *x)
+{
+    for (size_t i = 0; i < SIGNAL_SAMPLES; ++i)
+    {
+        x[i] = clip16(16000.0 * sin(2.0 * M_PI * 1000.0 * i / FS));
+    }
+}
+
+static void tone_quiet(int16_t *x)
+{
+    for (size_t i = 0; i < SIGNAL_SAMPLES; ++i)
+    {
+        x[i] = clip16(300.0 * sin(2.0 * M_PI * 440.0 * i / FS));
+    }
+}
+
+static void speech_like(int16_t *x)
+{
+    static const double formants[] = { 250.0, 700.0, 1500.0, 2500.0, 3500.0 };
+    for (size_t i = 0; i < SIGNAL_SAMPLES; ++i)
+    {
+        double env = 0.55 + 0.45 * sin(2.0 * M_PI * 3.0 * i / FS);
+        double v = 0.0;
+        for (size_t k = 0; k < 5u; ++k)
+        {
+            v += sin(2.0 * M_PI * formants[k] * i / FS + 0.7 * k) / (k + 1.0);
+        }
+        x[i] = clip16(8000.0 * env * v + 20.0 * gauss());
+    }
+}
+
+static void noise(int16_t *x)
+{
+    for (size_t i = 0; i < SIGNAL_SAMPLES; ++i)
+    {
+        x[i] = clip16(3000.0 * gauss());
+    }
+}
+
+static void sweep_loud(int16_t *x)
+{
+    /* 50 Hz .. 7 kHz at -1 dBFS: steps hit the clamp and the top index */
+    double ph = 0.0;
+    for (size_t i = 0; i < SIGNAL_SAMPLES; ++i)
+    {
+        ph += 2.0 * M_PI * (50.0 * pow(140.0, (double)i / SIGNAL_SAMPLES)) / FS;
+        x[i] = clip16(29000.0 * sin(ph));
+    }
+}
+
+static void round_trip(const char *name, signal_fn fn, double min_snr)
+{
+    char line[96];
+
+    srand(31);
+    fn(pcm);
+    encode_all(pcm);
+    for (uint32_t b = 0; b < BLOCKS; ++b)
+    {
+        (void)adpcm_decode_block(coded[b], BLOCK, &dec[b * BLOCK]);
+    }
+    double snr = snr_db(pcm, dec, SIGNAL_SAMPLES);
+    snprintf(line, sizeof(line), "%-16s SNR %5.1f dB (at least %.0f)", name, snr, min_snr);
+    check(snr >= min_snr, line);
+}
+
+static void blocks(void)
+{
+    int16_t one[BLOCK];
+    bool alone = true, first = true;
+
+    srand(32);
+    speech_like(pcm);
+    encode_all(pcm);
+    for (uint32_t b = 0; b < BLOCKS; ++b)
+    {
+        (void)adpcm_decode_block(coded[b], BLOCK, &dec[b * BLOCK]);
+    }
+    /* Backwards, each block on its own */
+    for (uint32_t b = BLOCKS; b-- > 0u;)
+    {
+        size_t used = adpcm_decode_block(coded[b], BLOCK, one);
+        alone &= (used == ADPCM_BLOCK_BYTES(BLOCK)) && (memcmp(one, &dec[b * BLOCK], sizeof(one)) == 0);
+        first &= (one[0] == pcm[b * BLOCK]);
+    }
+    check(alone, "every block decodes on its own, in any order");
+    check(first, "every block starts on its exact first sample");
+    check(ADPCM_BLOCK_BYTES(BLOCK) == 4u + BLOCK / 2u, "256-sample block is 132 bytes, ~3.9:1");
+
+    uint8_t bad[ADPCM_BLOCK_BYTES(BLOCK)];
+    memcpy(bad, coded[0], sizeof(bad));
+    bad[2] = 89u;
+    check(adpcm_decode_block(bad, BLOCK, one) == 0u, "step index out of range rejected");
+
+    /* Odd lengths have no pad nibble, even lengths one */
+    adpcm_state_t st;
+    adpcm_init(&st);
+    bool sizes = (adpcm_encode_block(&st, pcm, 1u, bad) == 4u) &&
+                 (adpcm_encode_block(&st, pcm, 4u, bad) == 6u) &&
+                 (adpcm_encode_block(&st, pcm, WAV_BLOCK, coded[0]) == 256u);
+    check(sizes, "block sizes as WAV: 1 -> 4, 4 -> 6, 505 -> 256 bytes");
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void bench(void)
+{
+    volatile int16_t sink = 0;
+
+    srand(33);
+    speech_like(pcm);
+
+    double t0 = now_s();
+    for (uint32_t r = 0; r < BENCH_ROUNDS; ++r)
+    {
+        encode_all(pcm);
+        sink = (int16_t)coded[r % BLOCKS][5];
+    }
+    double t_enc = now_s() - t0;
+
+    t0 = now_s();
+    for (uint32_t r = 0; r < BENCH_ROUNDS; ++r)
+    {
+        for (uint32_t b = 0; b < BLOCKS; ++b)
+        {
+            (void)adpcm_decode_block(coded[b], BLOCK, &dec[b * BLOCK]);
+        }
+        sink = dec[r];
+    }
+    double t_dec = now_s() - t0;
+
+    double n = (double)BENCH_ROUNDS * SIGNAL_SAMPLES;
+    printf("encoder: %6.1f Msamples/s (%5.0fx real time at 16 kHz)\n", n / t_enc * 1e-6, n / t_enc / FS);
+    printf("decoder: %6.1f Msamples/s\n", n / t_dec * 1e-6);
+    (void)sink;
+}
+
+static void put_le(FILE *f, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        fputc((int)((v >> (8 * i)) & 0xFFu), f);
+    }
+}
+
+static void write_wav(const char *path)
+{
+    const uint32_t nblocks = SIGNAL_SAMPLES / WAV_BLOCK;
+    const uint32_t align = ADPCM_BLOCK_BYTES(WAV_BLOCK);
+    uint8_t blk[ADPCM_BLOCK_BYTES(WAV_BLOCK)];
+    adpcm_state_t st;
+    FILE *f = fopen(path, "wb");
+
+    if (f == NULL)
+    {
+        perror(path);
+        failures++;
+        return;
+    }
+    srand(34);
+    speech_like(pcm);
+
+    fwrite("RIFF", 1, 4, f);
+    put_le(f, 4u + 28u + 12u + 8u + nblocks * align, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put_le(f, 20u, 4);
+    put_le(f, 0x11u, 2);                /* IMA ADPCM */
+    put_le(f, 1u, 2);
+    put_le(f, FS, 4);
+    put_le(f, FS * align / WAV_BLOCK, 4);
+    put_le(f, align, 2);
+    put_le(f, 4u, 2);
+    put_le(f, 2u, 2);
+    put_le(f, WAV_BLOCK, 2);
+    fwrite("fact", 1, 4, f);
+    put_le(f, 4u, 4);
+    put_le(f, nblocks * WAV_BLOCK, 4);
+    fwrite("data", 1, 4, f);
+    put_le(f, nblocks * align, 4);
+
+    adpcm_init(&st);
+    for (uint32_t b = 0; b < nblocks; ++b)
+    {
+        fwrite(blk, 1, adpcm_encode_block(&st, &pcm[b * WAV_BLOCK], WAV_BLOCK, blk), f);
+    }
+    fclose(f);
+    printf("wrote %s: %lu samples in %lu blocks of %lu bytes\n", path, (unsigned long)(nblocks * WAV_BLOCK),
+           (unsigned long)nblocks, (unsigned long)align);
+}
+
+int main(int argc, char **argv)
+{
+    round_trip("1 kHz -6 dBFS", tone_1k, 27.0);
+    round_trip("440 Hz -40 dBFS", tone_quiet, 33.0);
+    round_trip("speech-like", speech_like, 22.0);
+    round_trip("white noise", noise, 12.0);
+    round_trip("loud sweep", sweep_loud, 22.0);
+    blocks();
+    bench();
+    if ((argc > 2) && (strcmp(argv[1], "-w") == 0))
+    {
+        write_wav(argv[2]);
+    }
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+/******************************************************************************
+* File Name:   cmsis_compiler.h
+*
+* Description: Host stand-in for the CMSIS header, only the intrinsics that
+*              sound_level.c and pcm_stereo.c use, in plain C with the
+*              Cortex-M4 semantics. Lets the DSP paths run on the host with
+*              -D__ARM_FEATURE_DSP.
+*
+*******************************************************************************/
+
+#ifndef CMSIS_COMPILER_H_
+#define CMSIS_COMPILER_H_
+
+#include <stdint.h>
+
+/* Dual signed 16x16 multiply, both products added to a 64-bit accumulator */
+static inline uint64_t __SMLALD(uint32_t op1, uint32_t op2, uint64_t acc)
+{
+    int64_t lo = (int64_t)(int16_t)op1 * (int16_t)op2;
+    int64_t hi = (int64_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16);
+    return acc + (uint64_t)(lo + hi);
+}
+
+/* Pack halfwords: bottom of op1 with op2 shifted left */
+static inline uint32_t __PKHBT(uint32_t op1, uint32_t op2, uint32_t sh)
+{
+    return (op1 & 0x0000FFFFu) | ((op2 << sh) & 0xFFFF0000u);
+}
+
+/* Pack halfwords: top of op1 with op2 shifted right */
+static inline uint32_t __PKHTB(uint32_t op1, uint32_t op2, uint32_t sh)
+{
+    return (op1 & 0xFFFF0000u) | ((op2 >> sh) & 0x0000FFFFu);
+}
+
+#endif /* CMSIS_COMPILER_H_ */
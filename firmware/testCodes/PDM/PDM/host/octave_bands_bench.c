@@ -0,0 +1,260 @@
+/******************************************************************************
+* File Name:   octave_bands_bench.c
+*
+* Description: Host check and benchmark for octave_bands: single frames of
+*              tones, noise and full-scale signals against a double DFT of
+*              the same Hann-windowed frame, band by band, tones at each
+*              band centre landing in their band, the bands of a window of
+*              noise adding up to the broadband level of sound_level, and
+*              the cost of ob_push() per 256-sample frame. Exits non-zero on
+*              a failed check.
+*
+*                cc -O2 -I.. -o octave_bands_bench octave_bands_bench.c \
+*                   ../octave_bands.c ../sound_level.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "octave_bands.h"
+#include "sound_level.h"
+
+#define N                   (OB_FFT_SIZE)
+#define FS                  ((double)OB_SAMPLE_RATE_HZ)
+#define RANDOM_FRAMES       (500u)
+#define WINDOW_FRAMES       (625u)
+#define ROUNDS              (100000u)
+#define FRAME_PERIOD_US     (1e6 * N / FS)
+
+/* Band edges as in octave_bands.c: first bin of each band, plus the end */
+static const uint32_t band_first_bin[OB_NUM_BANDS + 1u] = {
+    1, 2, 3, 6, 12, 23, 46, 91, 129
+};
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double gauss(void)
+{
+    /* Box-Muller */
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double v = (double)rand() / ((double)RAND_MAX + 1.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static int16_t clip16(double v)
+{
+    long r = lrint(v);
+    return (int16_t)((r > 32767) ? 32767 : ((r < -32768) ? -32768 : r));
+}
+
+/* Band levels of one frame in dBFS, DFT in double with the same scaling */
+static void reference(const int16_t *x, double db[OB_NUM_BANDS])
+{
+    double mean = 0.0;
+    for (uint32_t n = 0; n < N; ++n)
+    {
+        mean += x[n];
+    }
+    mean = trunc(mean / N);
+
+    for (uint32_t b = 0; b < OB_NUM_BANDS; ++b)
+    {
+        double ms = 0.0;
+        for (uint32_t k = band_first_bin[b]; k < band_first_bin[b + 1u]; ++k)
+        {
+            double re = 0.0, im = 0.0;
+            for (uint32_t n = 0; n < N; ++n)
+            {
+                double w = 0.5 * (1.0 - cos(2.0 * M_PI * n / N));
+                re += (x[n] - mean) * w * cos(2.0 * M_PI * k * n / N);
+                im -= (x[n] - mean) * w * sin(2.0 * M_PI * k * n / N);
+            }
+            ms += ((k == N / 2u) ? 1.0 : 2.0) * (re * re + im * im) / ((double)N * N * 3.0 / 8.0);
+        }
+        db[b] = (ms > 0.0) ? 10.0 * log10(ms / (32768.0 * 32768.0)) : -120.0;
+    }
+}
+
+/* Worst band error in dB of one frame. Bands below floor_db are left out:
+ * there the 8 extra input bits no longer hide the FFT rounding. */
+static double frame_error(const int16_t *x, double floor_db)
+{
+    ob_analyzer_t a;
+    ob_vector_t v;
+    double ref[OB_NUM_BANDS];
+    double worst = 0.0;
+
+    ob_init(&a, 1u);
+    (void)ob_push(&a, x, &v);
+    reference(x, ref);
+    for (uint32_t b = 0; b < OB_NUM_BANDS; ++b)
+    {
+        if (ref[b] >= floor_db)
+        {
+            worst = fmax(worst, fabs(v.band_cdb[b] / 100.0 - ref[b]));
+        }
+    }
+    return worst;
+}
+
+static void single_frames(void)
+{
+    int16_t x[N];
+    double worst = 0.0;
+    char line[96];
+
+    /* Tones across the spectrum at several levels */
+    for (double f = 40.0; f < 7900.0; f *= 1.07)
+    {
+        for (double amp = 30.0; amp <= 32000.0; amp *= 10.0)
+        {
+            for (uint32_t n = 0; n < N; ++n)
+            {
+                x[n] = clip16(amp * sin(2.0 * M_PI * f * n / FS + 0.4));
+            }
+            worst = fmax(worst, frame_error(x, -60.0));
+        }
+    }
+    snprintf(line, sizeof(line), "tones 40 Hz..7.9 kHz: bands vs double DFT, worst %.3f dB", worst);
+    check(worst <= 0.05, line);
+
+    srand(11);
+    worst = 0.0;
+    for (uint32_t r = 0; r < RANDOM_FRAMES; ++r)
+    {
+        double amp = 10.0 * pow(10.0, (r % 4u) + 0.3);
+        for (uint32_t n = 0; n < N; ++n)
+        {
+            x[n] = clip16(amp * gauss() + 300.0);
+        }
+        worst = fmax(worst, frame_error(x, -60.0));
+    }
+    snprintf(line, sizeof(line), "noise frames with DC offset: worst %.3f dB", worst);
+    check(worst <= 0.05, line);
+
+    /* Full scale: square wave and alternating extremes must not wrap */
+    for (uint32_t n = 0; n < N; ++n)
+    {
+        x[n] = ((n / 8u) & 1u) ? 32767 : -32768;
+    }
+    worst = frame_error(x, -60.0);
+    for (uint32_t n = 0; n < N; ++n)
+    {
+        x[n] = (n & 1u) ? 32767 : -32768;
+    }
+    worst = fmax(worst, frame_error(x, -60.0));
+    snprintf(line, sizeof(line), "full-scale square waves: worst %.3f dB", worst);
+    check(worst <= 0.05, line);
+}
+
+static void tones_in_band(void)
+{
+    int16_t x[N];
+    bool right = true;
+
+    for (uint32_t b = 0; b < OB_NUM_BANDS; ++b)
+    {
+        /* The 8 kHz centre is Nyquist: use the middle of its bins */
+        double f = (b == OB_NUM_BANDS - 1u) ? 7000.0 : ob_band_centre_hz[b];
+        ob_analyzer_t a;
+        ob_vector_t v;
+
+        for (uint32_t n = 0; n < N; ++n)
+        {
+            x[n] = clip16(10000.0 * sin(2.0 * M_PI * f * n / FS));
+        }
+        ob_init(&a, 1u);
+        (void)ob_push(&a, x, &v);
+        for (uint32_t o = 0; o < OB_NUM_BANDS; ++o)
+        {
+            right &= (o == b) || (v.band_cdb[o] < v.band_cdb[b]);
+        }
+    }
+    check(right, "tone at each band centre is loudest in its band");
+}
+
+static void window_sum(void)
+{
+    static int16_t x[N];
+    ob_analyzer_t a;
+    ob_vector_t v;
+    uint64_t ms_sum = 0u;
+    uint32_t emitted = 0u;
+    char line[96];
+
+    srand(13);
+    ob_init(&a, WINDOW_FRAMES);
+    for (uint32_t f = 0; f < WINDOW_FRAMES; ++f)
+    {
+        sl_frame_level_t lv;
+        for (uint32_t n = 0; n < N; ++n)
+        {
+            x[n] = clip16(2000.0 * gauss());
+        }
+        sl_frame_level(x, N, &lv);
+        ms_sum += lv.ms;
+        emitted += ob_push(&a, x, &v) ? 1u : 0u;
+    }
+
+    double bands = 0.0;
+    for (uint32_t b = 0; b < OB_NUM_BANDS; ++b)
+    {
+        bands += pow(10.0, v.band_cdb[b] / 1000.0);
+    }
+    double broadband = sl_ms_to_dbfs_cdb(ms_sum / WINDOW_FRAMES) / 100.0;
+    double diff = 10.0 * log10(bands) - broadband;
+    snprintf(line, sizeof(line), "noise window: bands sum to broadband within %.2f dB", fabs(diff));
+    /* DC bin and Hann estimate variance over 625 frames */
+    check((emitted == 1u) && (v.frames == WINDOW_FRAMES) && (fabs(diff) <= 0.2), line);
+}
+
+static void bench(void)
+{
+    static int16_t x[N];
+    ob_analyzer_t a;
+    ob_vector_t v;
+    struct timespec t0, t1;
+    volatile int32_t sink = 0;
+    int32_t acc = 0;
+
+    for (uint32_t n = 0; n < N; ++n)
+    {
+        x[n] = (int16_t)((n * 2654435761u) >> 16);
+    }
+    ob_init(&a, WINDOW_FRAMES);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t r = 0; r < ROUNDS; ++r)
+    {
+        if (ob_push(&a, x, &v))
+        {
+            acc += v.band_cdb[3];
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sink = acc;
+
+    double dt = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    double us = dt / ROUNDS * 1e6;
+    printf("ob_push: %.2f us per %u-sample frame, %.3f %% of the %.0f us frame period\n", us, N,
+           100.0 * us / FRAME_PERIOD_US, FRAME_PERIOD_US);
+    printf("state: %zu bytes per analyzer, no allocation\n", sizeof(ob_analyzer_t));
+    (void)sink;
+}
+
+int main(void)
+{
+    single_frames();
+    tones_in_band();
+    window_sum();
+    bench();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
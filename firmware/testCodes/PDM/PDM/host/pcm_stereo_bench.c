@@ -0,0 +1,200 @@
+/******************************************************************************
+* File Name:   pcm_stereo_bench.c
+*
+* Description: Host tool for pcm_stereo: puts every int16 value through the
+*              left and the right position of every de-interleave path built
+*              in, all lengths and start alignments of a frame, compares
+*              bit for bit with the scalar path and checks nothing beyond
+*              the output is written; checks the stereo metrics on known
+*              signals, then times each path per 256-pair frame. Exits
+*              non-zero on any difference.
+*
+*                cc -O2 -I.. -o pcm_stereo_bench pcm_stereo_bench.c \
+*                   ../pcm_stereo.c ../sound_level.c -lm
+*
+*              With the Cortex-M4 path emulated (checks only; the timing of
+*              the emulation says nothing about the target):
+*
+*                cc -O2 -I.. -Iemu -D__ARM_FEATURE_DSP -o pcm_stereo_bench \
+*                   pcm_stereo_bench.c ../pcm_stereo.c ../sound_level.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pcm_stereo.h"
+#include "sound_level.h"
+
+#define ALL_VALUES          (65536u)
+#define FRAME               (256u)
+#define GUARD               (8u)
+#define ROUNDS              (200000u)
+
+typedef void (*deint_fn)(const int16_t *, size_t, int16_t *, int16_t *);
+
+typedef struct
+{
+    const char *name;
+    deint_fn    fn;
+} path_t;
+
+static path_t paths[3];
+static size_t num_paths;
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static void add_paths(void)
+{
+    paths[num_paths++] = (path_t){ "scalar", pcm_deinterleave_scalar };
+#if defined(__ARM_FEATURE_DSP)
+    paths[num_paths++] = (path_t){ "dsp (emulated)", pcm_deinterleave_dsp };
+#endif
+#if defined(__SSE2__)
+    paths[num_paths++] = (path_t){ "sse2", pcm_deinterleave_sse2 };
+#endif
+}
+
+static void every_value(void)
+{
+    static int16_t lr[2u * ALL_VALUES];
+    static int16_t left[ALL_VALUES], right[ALL_VALUES];
+    bool exact = true;
+
+    /* Left counts up through every value, right down, so each value is
+     * seen in both positions and next to a different neighbour */
+    for (uint32_t i = 0; i < ALL_VALUES; ++i)
+    {
+        lr[2u * i] = (int16_t)(uint16_t)i;
+        lr[2u * i + 1u] = (int16_t)(uint16_t)(0xFFFFu - i * 3u);
+    }
+    for (size_t p = 0; p < num_paths; ++p)
+    {
+        memset(left, 0x55, sizeof(left));
+        memset(right, 0x55, sizeof(right));
+        paths[p].fn(lr, ALL_VALUES, left, right);
+        for (uint32_t i = 0; i < ALL_VALUES; ++i)
+        {
+            exact &= (left[i] == lr[2u * i]) && (right[i] == lr[2u * i + 1u]);
+        }
+    }
+    check(exact, "every int16 value, left and right, all paths exact");
+}
+
+static void lengths(void)
+{
+    static int16_t lr[2u * (FRAME + GUARD)];
+    int16_t ref_l[FRAME + 2u * GUARD], ref_r[FRAME + 2u * GUARD];
+    int16_t l[FRAME + 2u * GUARD], r[FRAME + 2u * GUARD];
+    bool same = true, bounded = true;
+
+    srand(41);
+    for (size_t i = 0; i < sizeof(lr) / sizeof(lr[0]); ++i)
+    {
+        lr[i] = (int16_t)(rand() & 0xFFFF);
+    }
+    /* Misaligned input and output, every length up to a frame */
+    for (size_t off = 0; off < 4u; ++off)
+    {
+        for (size_t pairs = 0; pairs <= FRAME; ++pairs)
+        {
+            memset(ref_l, 0x11, sizeof(ref_l));
+            memset(ref_r, 0x22, sizeof(ref_r));
+            pcm_deinterleave_scalar(&lr[off], pairs, &ref_l[GUARD + off], &ref_r[GUARD + off]);
+            for (size_t p = 1; p < num_paths; ++p)
+            {
+                memset(l, 0x11, sizeof(l));
+                memset(r, 0x22, sizeof(r));
+                paths[p].fn(&lr[off], pairs, &l[GUARD + off], &r[GUARD + off]);
+                same &= (memcmp(l, ref_l, sizeof(l)) == 0) && (memcmp(r, ref_r, sizeof(r)) == 0);
+            }
+            /* Guards around the scalar output untouched too */
+            bounded &= (ref_l[GUARD + off - 1u] == 0x1111) && (ref_l[GUARD + off + pairs] == 0x1111);
+            bounded &= (ref_r[GUARD + off - 1u] == 0x2222) && (ref_r[GUARD + off + pairs] == 0x2222);
+        }
+    }
+    check(same, "lengths 0..256 at 4 alignments, all paths bit-exact");
+    check(bounded, "nothing written outside the outputs");
+}
+
+static void metrics(void)
+{
+    int16_t l[FRAME], r[FRAME];
+    pcm_stereo_metrics_t m;
+    char line[96];
+
+    /* Centred source: both channels the same */
+    for (size_t i = 0; i < FRAME; ++i)
+    {
+        l[i] = r[i] = (int16_t)lrint(8000.0 * sin(2.0 * M_PI * 1000.0 * i / 16000.0));
+    }
+    pcm_stereo_metrics(l, r, FRAME, &m);
+    check((m.ild_cdb == 0) && (m.side_dbfs_cdb == SL_DB_FLOOR_CDB), "centred source: ILD 0, no side signal");
+
+    /* Right at half the amplitude: ILD +6.02 dB, side at -6.02 re. left */
+    for (size_t i = 0; i < FRAME; ++i)
+    {
+        r[i] = (int16_t)(l[i] / 2);
+    }
+    pcm_stereo_metrics(l, r, FRAME, &m);
+    snprintf(line, sizeof(line), "right at half amplitude: ILD %.2f dB", m.ild_cdb / 100.0);
+    check(abs(m.ild_cdb - 602) <= 2, line);
+    snprintf(line, sizeof(line), "side level %.2f dB below left", (m.left_dbfs_cdb - m.side_dbfs_cdb) / 100.0);
+    /* (L - R) / 2 is L / 4 here: 12 dB below left */
+    check(abs(m.left_dbfs_cdb - m.side_dbfs_cdb - 1204) <= 5, line);
+
+    /* Opposite polarity: side carries the whole signal */
+    for (size_t i = 0; i < FRAME; ++i)
+    {
+        r[i] = (int16_t)-l[i];
+    }
+    pcm_stereo_metrics(l, r, FRAME, &m);
+    check((m.ild_cdb == 0) && (abs(m.side_dbfs_cdb - m.left_dbfs_cdb) <= 1), "opposite polarity: side at the full level");
+}
+
+static void bench(void)
+{
+    static int16_t lr[2u * FRAME];
+    static int16_t l[FRAME], r[FRAME];
+    struct timespec t0, t1;
+    volatile int16_t sink = 0;
+
+    for (size_t i = 0; i < 2u * FRAME; ++i)
+    {
+        lr[i] = (int16_t)((i * 2654435761u) >> 16);
+    }
+    for (size_t p = 0; p < num_paths; ++p)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (uint32_t k = 0; k < ROUNDS; ++k)
+        {
+            paths[p].fn(lr, FRAME, l, r);
+            sink = (int16_t)(l[k & (FRAME - 1u)] + r[3]);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        double dt = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+        printf("%-16s %7.1f ns per %u-pair frame, %5.3f ns/pair\n", paths[p].name, dt / ROUNDS * 1e9, FRAME,
+               dt / ROUNDS / FRAME * 1e9);
+    }
+    (void)sink;
+}
+
+int main(void)
+{
+    add_paths();
+    every_value();
+    lengths();
+    metrics();
+    bench();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,401 @@
+/******************************************************************************
+* File Name:   sound_event_check.c
+*
+* Description: Host check of sound_event on WAV input (16-bit PCM, 16 kHz,
+*              first channel used). Built-in fixtures are synthesised, written
+*              as WAV and read back through the same reader as recorded
+*              files: a door slam in a quiet room, speech-like bursts, a
+*              machine that switches on and stays on, and mains hum. Each
+*              is run with the settings of main.c and checked for the number
+*              of clips, clip contents (every clip is the input frames
+*              around the trigger, in order, at the fixed length) and where
+*              the noise floor ends up. Exits non-zero on a failed check.
+*
+*                cc -O2 -I.. -o sound_event_check sound_event_check.c \
+*                   ../sound_event.c ../sound_level.c -lm
+*                ./sound_event_check [-w dir] [rec.wav[:clips] ...]
+*
+*              -w saves the fixtures as WAV files. Recorded files are
+*              checked for clip contents, and for the clip count if given.
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sound_event.h"
+
+#define FS                  (16000u)
+#define FRAME               (256u)
+#define POST_FRAMES         (46u)       /* as main.c */
+#define MAX_SAMPLES         (FS * 600u)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double gauss(void)
+{
+    /* Box-Muller */
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double v = (double)rand() / ((double)RAND_MAX + 1.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static int16_t clip16(double v)
+{
+    long r = lrint(v);
+    return (int16_t)((r > 32767) ? 32767 : ((r < -32768) ? -32768 : r));
+}
+
+static double dbfs_amp(double db)
+{
+    return 32768.0 * pow(10.0, db / 20.0);
+}
+
+/*******************************************************************************
+* WAV
+********************************************************************************/
+static void put_le(FILE *f, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        fputc((int)((v >> (8 * i)) & 0xFFu), f);
+    }
+}
+
+static void wav_write(FILE *f, const int16_t *x, size_t n)
+{
+    fwrite("RIFF", 1, 4, f);
+    put_le(f, 36u + 2u * (uint32_t)n, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put_le(f, 16u, 4);
+    put_le(f, 1u, 2);               /* PCM */
+    put_le(f, 1u, 2);               /* mono */
+    put_le(f, FS, 4);
+    put_le(f, FS * 2u, 4);
+    put_le(f, 2u, 2);
+    put_le(f, 16u, 2);
+    fwrite("data", 1, 4, f);
+    put_le(f, 2u * (uint32_t)n, 4);
+    for (size_t i = 0; i < n; ++i)
+    {
+        put_le(f, (uint16_t)x[i], 2);
+    }
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes)
+{
+    uint32_t v = 0u;
+    for (int i = bytes - 1; i >= 0; --i)
+    {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+/* Reads the first channel of a 16-bit PCM WAV at FS. Returns the number of
+ * samples, 0 on an unsupported file. */
+static size_t wav_read(FILE *f, int16_t *x, size_t max)
+{
+    uint8_t hdr[12], ck[8], fmt[16];
+    uint32_t channels = 0u;
+
+    if ((fread(hdr, 1, 12, f) != 12u) || (memcmp(hdr, "RIFF", 4) != 0) || (memcmp(&hdr[8], "WAVE", 4) != 0))
+    {
+        return 0u;
+    }
+    while (fread(ck, 1, 8, f) == 8u)
+    {
+        uint32_t size = get_le(&ck[4], 4);
+        if (memcmp(ck, "fmt ", 4) == 0)
+        {
+            if ((size < 16u) || (fread(fmt, 1, 16, f) != 16u))
+            {
+                return 0u;
+            }
+            channels = get_le(&fmt[2], 2);
+            if ((get_le(fmt, 2) != 1u) || (channels == 0u) || (get_le(&fmt[4], 4) != FS) ||
+                (get_le(&fmt[14], 2) != 16u))
+            {
+                return 0u;
+            }
+            fseek(f, (long)(size - 16u + (size & 1u)), SEEK_CUR);
+        }
+        else if ((memcmp(ck, "data", 4) == 0) && (channels != 0u))
+        {
+            size_t n = 0u;
+            uint8_t s[2];
+            for (uint32_t i = 0; (i < size / (2u * channels)) && (n < max); ++i)
+            {
+                if (fread(s, 1, 2, f) != 2u)
+                {
+                    break;
+                }
+                x[n++] = (int16_t)get_le(s, 2);
+                fseek(f, (long)(2u * (channels - 1u)), SEEK_CUR);
+            }
+            return n;
+        }
+        else
+        {
+            fseek(f, (long)(size + (size & 1u)), SEEK_CUR);
+        }
+    }
+    return 0u;
+}
+
+/*******************************************************************************
+* Run
+********************************************************************************/
+typedef struct
+{
+    const int16_t *input;
+    uint32_t       frame_no;        /* frame being pushed */
+    uint32_t       start_frame;     /* input frame of clip index 0 */
+    uint32_t       total;
+    uint32_t       next_index;
+    bool           ordered;         /* indices 0..total-1 in turn */
+    bool           same;            /* clip frames are the input frames */
+} clip_check_t;
+
+static void sink(const int16_t *frame, size_t n, uint32_t index, uint32_t total, void *arg)
+{
+    clip_check_t *c = (clip_check_t *)arg;
+
+    if (index == 0u)
+    {
+        /* The pre-trigger frames end with the trigger frame */
+        c->start_frame = c->frame_no + 1u - (total - POST_FRAMES);
+        c->total = total;
+        c->next_index = 0u;
+    }
+    c->ordered &= (index == c->next_index++) && (total == c->total) && (total <= SE_PRE_FRAMES + POST_FRAMES);
+    c->same &= (n == FRAME) && (memcmp(frame, &c->input[(size_t)(c->start_frame + index) * FRAME],
+                                       FRAME * sizeof(int16_t)) == 0);
+}
+
+typedef struct
+{
+    uint32_t clips;
+    uint32_t ends;
+    uint32_t last_start_frame;
+    int32_t  floor_cdb;
+} run_result_t;
+
+static run_result_t run(const char *name, const int16_t *x, size_t n)
+{
+    static se_detector_t d;
+    se_cfg_t cfg;
+    clip_check_t c = { x, 0u, 0u, 0u, 0u, true, true };
+    run_result_t r = { 0u, 0u, 0u, 0 };
+    char line[96];
+
+    se_default_cfg(&cfg);
+    cfg.post_frames = POST_FRAMES;
+    (void)se_init(&d, &cfg, FRAME, sink, &c);
+    for (c.frame_no = 0u; (size_t)(c.frame_no + 1u) * FRAME <= n; ++c.frame_no)
+    {
+        se_event_t ev = se_push(&d, &x[(size_t)c.frame_no * FRAME]);
+        r.clips += (ev == SE_EVENT_START) ? 1u : 0u;
+        r.ends += (ev == SE_EVENT_END) ? 1u : 0u;
+        r.last_start_frame = (ev == SE_EVENT_START) ? c.frame_no : r.last_start_frame;
+    }
+    r.floor_cdb = se_floor_cdb(&d);
+
+    printf("%-24s %6.1f s: %3lu clips, floor %6.1f dBFS\n", name, (double)n / FS, (unsigned long)r.clips,
+           r.floor_cdb / 100.0);
+    snprintf(line, sizeof(line), "%s: clips are the input frames, in order", name);
+    /* A clip still open at the end of the input has not ended */
+    check(c.ordered && c.same && (r.clips == d.clips) && (r.ends + (d.capturing ? 1u : 0u) == r.clips), line);
+    return r;
+}
+
+/*******************************************************************************
+* Fixtures
+********************************************************************************/
+static int16_t pcm[MAX_SAMPLES];
+static const char *fixture_dir;
+
+/* Writes the fixture as WAV and reads it back, as a recorded file would be */
+static size_t through_wav(const char *file, const int16_t *x, size_t n)
+{
+    FILE *f = NULL;
+    char path[256];
+
+    if (fixture_dir != NULL)
+    {
+        snprintf(path, sizeof(path), "%s/%s", fixture_dir, file);
+        f = fopen(path, "w+b");
+    }
+    f = (f != NULL) ? f : tmpfile();
+    if (f == NULL)
+    {
+        perror(file);
+        exit(2);
+    }
+    wav_write(f, x, n);
+    rewind(f);
+    n = wav_read(f, pcm, MAX_SAMPLES);
+    fclose(f);
+    return n;
+}
+
+static void background(int16_t *x, size_t n, double db)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        x[i] = clip16(dbfs_amp(db) * gauss());
+    }
+}
+
+static void add(int16_t *x, size_t i, double v)
+{
+    x[i] = clip16(x[i] + v);
+}
+
+static void door_slam(void)
+{
+    static int16_t x[FS * 12u];
+    const size_t n = sizeof(x) / sizeof(x[0]);
+
+    srand(21);
+    background(x, n, -60.0);
+    for (size_t i = 0; i < FS / 2u; ++i)
+    {
+        add(x, 5u * FS + i, dbfs_amp(-12.0) * gauss() * exp(-(double)i / (0.08 * FS)));
+    }
+    run_result_t r = run("door slam", pcm, through_wav("door_slam.wav", x, n));
+    check(r.clips == 1u, "door slam: one clip");
+    check(fabs(r.floor_cdb / 100.0 + 60.0) <= 3.0, "door slam: floor back at the room level");
+}
+
+static void speech(void)
+{
+    static int16_t x[FS * 30u];
+    const size_t n = sizeof(x) / sizeof(x[0]);
+    static const double formants[] = { 300.0, 800.0, 1700.0, 2600.0 };
+
+    srand(22);
+    background(x, n, -55.0);
+    for (uint32_t b = 0; b < 8u; ++b)
+    {
+        size_t at = (2u + 3u * b) * FS + (size_t)b * 997u;
+        for (size_t i = 0; i < FS * 6u / 10u; ++i)
+        {
+            double env = sin(M_PI * i / (FS * 0.6)) * (0.6 + 0.4 * sin(2.0 * M_PI * 4.0 * i / FS));
+            double v = 0.0;
+            for (size_t k = 0; k < 4u; ++k)
+            {
+                v += sin(2.0 * M_PI * formants[k] * (1.0 + 0.05 * b) * i / FS + k) / (k + 1.0);
+            }
+            add(x, at + i, dbfs_amp(-25.0) * env * v);
+        }
+    }
+    run_result_t r = run("speech bursts", pcm, through_wav("speech.wav", x, n));
+    check(r.clips == 8u, "speech: one clip per burst");
+    check(fabs(r.floor_cdb / 100.0 + 55.0) <= 3.0, "speech: bursts leave the floor in place");
+}
+
+static void machine(void)
+{
+    static int16_t x[FS * 80u];
+    const size_t n = sizeof(x) / sizeof(x[0]);
+    const size_t on = 5u * FS;
+    se_cfg_t cfg;
+
+    srand(23);
+    se_default_cfg(&cfg);
+    background(x, n, -60.0);
+    for (size_t i = on; i < n; ++i)
+    {
+        add(x, i, dbfs_amp(-35.0) * (gauss() + 0.8 * sin(2.0 * M_PI * 180.0 * i / FS)));
+    }
+    run_result_t r = run("machine stays on", pcm, through_wav("machine.wav", x, n));
+    /* A frozen floor would trigger clip after clip for the whole minute */
+    check((r.clips >= 1u) && (r.clips <= 10u), "machine: clips stop once the floor follows");
+    check((size_t)r.last_start_frame * FRAME < on + 10u * FS, "machine: no clip after the first 10 s");
+    check(r.floor_cdb / 100.0 > -35.0 - cfg.threshold_cdb / 100.0, "machine: floor rose to the machine level");
+}
+
+static void hum(void)
+{
+    static int16_t x[FS * 20u];
+    const size_t n = sizeof(x) / sizeof(x[0]);
+
+    srand(24);
+    background(x, n, -70.0);
+    for (size_t i = 5u * FS; i < n; ++i)
+    {
+        add(x, i, dbfs_amp(-20.0) * (sin(2.0 * M_PI * 50.0 * i / FS) + 0.3 * sin(2.0 * M_PI * 100.0 * i / FS)));
+    }
+    run_result_t r = run("mains hum", pcm, through_wav("hum.wav", x, n));
+    check(r.clips == 0u, "hum: below the zero-crossing range, no clip");
+}
+
+static void recorded(const char *arg)
+{
+    char path[256];
+    char line[320];
+    unsigned long expect = 0u;
+    bool have_expect = false;
+
+    snprintf(path, sizeof(path), "%s", arg);
+    char *colon = strrchr(path, ':');
+    if ((colon != NULL) && (sscanf(colon + 1, "%lu", &expect) == 1))
+    {
+        *colon = '\0';
+        have_expect = true;
+    }
+
+    FILE *f = fopen(path, "rb");
+    size_t n = (f != NULL) ? wav_read(f, pcm, MAX_SAMPLES) : 0u;
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+    if (n == 0u)
+    {
+        fprintf(stderr, "%s: not a 16-bit %u Hz PCM WAV\n", path, FS);
+        failures++;
+        return;
+    }
+    run_result_t r = run(path, pcm, n);
+    if (have_expect)
+    {
+        snprintf(line, sizeof(line), "%s: %lu clips expected", path, expect);
+        check(r.clips == expect, line);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int i = 1;
+
+    if ((argc > 2) && (strcmp(argv[1], "-w") == 0))
+    {
+        fixture_dir = argv[2];
+        i = 3;
+    }
+    if (i < argc)
+    {
+        for (; i < argc; ++i)
+        {
+            recorded(argv[i]);
+        }
+    }
+    else
+    {
+        door_slam();
+        speech();
+        machine();
+        hum();
+    }
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
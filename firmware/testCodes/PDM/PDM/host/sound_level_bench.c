@@ -0,0 +1,207 @@
+/******************************************************************************
+* File Name:   sound_level_bench.c
+*
+* Description: Host tool for sound_level: runs the moments kernels built in
+*              on random frames, full-scale extremes and every tail length
+*              and compares them bit for bit with the scalar path, checks
+*              the frame level against a double reference, then times each
+*              kernel and the sl_moments() dispatch per 256-sample frame.
+*              Exits non-zero on any difference.
+*
+*                cc -O2 -I.. -o sound_level_bench sound_level_bench.c \
+*                   ../sound_level.c -lm
+*
+*              With the Cortex-M4 path emulated (checks only; the timing of
+*              the emulation says nothing about the target):
+*
+*                cc -O2 -I.. -Iemu -D__ARM_FEATURE_DSP -o sound_level_bench \
+*                   sound_level_bench.c ../sound_level.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sound_level.h"
+
+#define FRAME               (256u)
+#define MAX_LEN             (1024u)
+#define RANDOM_FRAMES       (2000u)
+#define ROUNDS              (200000u)
+
+typedef void (*moments_fn)(const int16_t *, size_t, sl_moments_t *);
+
+typedef struct
+{
+    const char *name;
+    moments_fn  fn;
+} path_t;
+
+static path_t paths[5];
+static size_t num_paths;
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static void add_paths(void)
+{
+    paths[num_paths++] = (path_t){ "scalar", sl_moments_scalar };
+#if defined(__ARM_FEATURE_DSP)
+    paths[num_paths++] = (path_t){ "dsp (emulated)", sl_moments_dsp };
+#endif
+#if defined(__SSE2__)
+    paths[num_paths++] = (path_t){ "sse2", sl_moments_sse2 };
+#endif
+#if defined(SL_HAVE_AVX2)
+    if (sl_avx2_ok())
+    {
+        paths[num_paths++] = (path_t){ "avx2", sl_moments_avx2 };
+    }
+#endif
+    /* What the firmware calls, whichever kernel it picks */
+    paths[num_paths++] = (path_t){ "sl_moments", sl_moments };
+}
+
+/* Every path against scalar on x[0..len) for every len up to max */
+static bool same_all_lengths(const int16_t *x, size_t max)
+{
+    bool same = true;
+    for (size_t len = 0; len <= max; ++len)
+    {
+        sl_moments_t ref;
+        sl_moments_scalar(x, len, &ref);
+        for (size_t p = 1; p < num_paths; ++p)
+        {
+            sl_moments_t m;
+            memset(&m, 0x5A, sizeof(m));
+            paths[p].fn(x, len, &m);
+            same &= (m.sum == ref.sum) && (m.sum_sq == ref.sum_sq);
+        }
+    }
+    return same;
+}
+
+static void exactness(void)
+{
+    static int16_t x[MAX_LEN + 1u];
+    bool same = true;
+
+    srand(5);
+    for (uint32_t f = 0; f < RANDOM_FRAMES; ++f)
+    {
+        for (size_t i = 0; i < FRAME + 1u; ++i)
+        {
+            x[i] = (int16_t)(rand() & 0xFFFF);
+        }
+        /* Misaligned start as well */
+        same &= same_all_lengths(&x[f & 1u], FRAME);
+    }
+    check(same, "random frames, every length 0..256, bit-exact");
+
+    /* Largest magnitudes: (-32768)^2 pairs are 2^31 in each 32-bit lane */
+    for (size_t i = 0; i <= MAX_LEN; ++i)
+    {
+        x[i] = -32768;
+    }
+    same = same_all_lengths(x, MAX_LEN);
+    for (size_t i = 0; i <= MAX_LEN; ++i)
+    {
+        x[i] = 32767;
+    }
+    same &= same_all_lengths(x, MAX_LEN);
+    for (size_t i = 0; i <= MAX_LEN; ++i)
+    {
+        x[i] = (i & 1u) ? 32767 : -32768;
+    }
+    same &= same_all_lengths(x, MAX_LEN);
+    check(same, "full-scale extremes, every length 0..1024, bit-exact");
+}
+
+static void level(void)
+{
+    static int16_t x[FRAME];
+    double worst_db = 0.0;
+    uint32_t worst_rms = 0u;
+    sl_frame_level_t lv;
+    char line[96];
+
+    srand(9);
+    for (int a = 1; a <= 32767; a = a * 3 / 2 + 1)
+    {
+        double sum = 0.0, sum2 = 0.0;
+        for (size_t i = 0; i < FRAME; ++i)
+        {
+            double s = a * sin(2.0 * M_PI * 1000.0 * i / 16000.0 + 0.3) + 40.0;
+            s = fmin(fmax(s + (rand() % 3 - 1), -32768.0), 32767.0);
+            x[i] = (int16_t)lrint(s);
+            sum += x[i];
+            sum2 += (double)x[i] * x[i];
+        }
+        double ms = sum2 / FRAME - (sum / FRAME) * (sum / FRAME);
+        sl_frame_level(x, FRAME, &lv);
+
+        uint32_t rms_ref = (uint32_t)sqrt(floor(ms));
+        uint32_t d = (lv.rms > rms_ref) ? lv.rms - rms_ref : rms_ref - lv.rms;
+        worst_rms = (d > worst_rms) ? d : worst_rms;
+        if (ms >= 1.0)
+        {
+            double db = 10.0 * log10(floor(ms) / (32768.0 * 32768.0));
+            worst_db = fmax(worst_db, fabs(lv.dbfs_cdb / 100.0 - db));
+        }
+    }
+    snprintf(line, sizeof(line), "frame RMS against double, worst %lu LSB", (unsigned long)worst_rms);
+    check(worst_rms == 0u, line);
+    snprintf(line, sizeof(line), "frame dBFS against double, worst %.3f dB", worst_db);
+    check(worst_db <= 0.015, line);
+
+    memset(x, 0, sizeof(x));
+    sl_frame_level(x, FRAME, &lv);
+    check((lv.rms == 0u) && (lv.dbfs_cdb == SL_DB_FLOOR_CDB), "digital silence at the floor");
+}
+
+static void bench(void)
+{
+    static int16_t x[FRAME];
+    struct timespec t0, t1;
+    volatile int64_t sink = 0;
+
+    for (size_t i = 0; i < FRAME; ++i)
+    {
+        x[i] = (int16_t)((i * 2654435761u) >> 16);
+    }
+    for (size_t p = 0; p < num_paths; ++p)
+    {
+        sl_moments_t m;
+        int64_t acc = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (uint32_t r = 0; r < ROUNDS; ++r)
+        {
+            paths[p].fn(x, FRAME, &m);
+            acc += m.sum + (int64_t)m.sum_sq;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        sink = acc;
+
+        double dt = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+        printf("%-16s %7.1f ns per %u-sample frame, %5.2f ns/sample\n", paths[p].name,
+               dt / ROUNDS * 1e9, FRAME, dt / ROUNDS / FRAME * 1e9);
+    }
+    (void)sink;
+}
+
+int main(void)
+{
+    add_paths();
+    exactness();
+    level();
+    bench();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,437 @@
+/******************************************************************************
+* File Name:   tlm_loopback.c
+*
+* Description: End-to-end check of the binary telemetry: records of every
+*              type are framed by telemetry.c and written to a pseudo
+*              terminal, with line noise before the first delimiter, a
+*              stalled UART that makes the ring drop records and one frame
+*              with a bad CRC. firmware/tools/tlm_decode.py reads the other
+*              side of the pty like a serial port (pyserial) and writes one
+*              CSV per record type; every decoded row is compared with what
+*              was sent, and its counts of bad frames and sequence gaps with
+*              the injected faults. The captured stream is then decoded again
+*              from stdin to check the single-header mixed output. Exits
+*              non-zero on a failed check.
+*
+*                cc -O2 -I.. -o tlm_loopback tlm_loopback.c ../telemetry.c
+*                ./tlm_loopback ../../../../tools/tlm_decode.py [python3]
+*
+*******************************************************************************/
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "telemetry.h"
+
+#define RECORDS             (600u)
+#define BURST_AT            (300u)      /* UART stalls for this many records */
+#define BURST_RECORDS       (150u)
+#define SENSOR_ID           (7u)
+#define MAX_LINE            (256u)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+/*******************************************************************************
+* UART stand-in: writes are completed by uart_service(), not at once
+********************************************************************************/
+typedef struct
+{
+    int            fd;
+    FILE          *capture;
+    const uint8_t *buf;
+    size_t         len;
+    bool           pending;
+} uart_t;
+
+static bool uart_start(const uint8_t *buf, size_t len, void *ctx)
+{
+    uart_t *u = (uart_t *)ctx;
+    u->buf = buf;
+    u->len = len;
+    u->pending = true;
+    return true;
+}
+
+static void uart_write(uart_t *u, const uint8_t *p, size_t n)
+{
+    fwrite(p, 1, n, u->capture);
+    while (n > 0u)
+    {
+        ssize_t w = write(u->fd, p, n);
+        if (w <= 0)
+        {
+            usleep(1000);       /* pty buffer full, the decoder catches up */
+            continue;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+}
+
+static void uart_service(tlm_t *t, uart_t *u)
+{
+    while (u->pending)
+    {
+        u->pending = false;
+        uart_write(u, u->buf, u->len);
+        tlm_tx_done(t);         /* may start the next chunk */
+    }
+}
+
+/*******************************************************************************
+* Records: values derived from the index, so the reader can recompute them
+********************************************************************************/
+static uint8_t type_of(uint32_t i)
+{
+    return (uint8_t)(i % 6u);
+}
+
+static uint32_t ts_of(uint32_t i)
+{
+    return 4294960000u + i * 16u;       /* wraps past 2^32 on the way */
+}
+
+static size_t payload_of(uint32_t i, uint8_t *p)
+{
+    switch (type_of(i))
+    {
+        case TLM_REC_TEXT:
+            return (size_t)snprintf((char *)p, TLM_PAYLOAD_MAX, "boot %lu: ok", (unsigned long)i);
+        case TLM_REC_LEVEL:
+        {
+            /* Overruns past 8 and 16 bits */
+            tlm_level_t r = { (int16_t)(-3000 + (int)i), (int16_t)(6500 - (int)i), (uint16_t)(i * 97u), 1u, 0u,
+                              i * 70001u, i * 12345u };
+            memcpy(p, &r, sizeof(r));
+            return sizeof(r);
+        }
+        case TLM_REC_BANDS:
+        {
+            tlm_bands_t r;
+            for (int b = 0; b < 8; ++b)
+            {
+                r.band_cdb[b] = (int16_t)(-9000 + (int)(i * 10u) + b * 100);
+            }
+            r.frames = 625u;
+            memcpy(p, &r, sizeof(r));
+            return sizeof(r);
+        }
+        case TLM_REC_EVENT:
+        {
+            tlm_event_t r = { (int16_t)(1500 + (int)i), (int16_t)(-6000 - (int)i), (uint16_t)(i & 0xFFu) };
+            memcpy(p, &r, sizeof(r));
+            return sizeof(r);
+        }
+        case TLM_REC_CLIP:
+        {
+            /* Zero bytes in the payload exercise COBS */
+            tlm_clip_t r = { i, 62u, 0u, i << 16 };
+            memcpy(p, &r, sizeof(r));
+            return sizeof(r);
+        }
+        default:
+        {
+            tlm_stereo_t r = { (int16_t)-(int)i, (int16_t)i, 0, -12000 };
+            memcpy(p, &r, sizeof(r));
+            return sizeof(r);
+        }
+    }
+}
+
+/* The CSV fields after ts_ms,seq,sensor,record as the decoder prints them */
+static void fields_of(uint32_t i, char *out, size_t size)
+{
+    uint8_t p[TLM_PAYLOAD_MAX + 1u];
+    size_t n = payload_of(i, p);
+
+    switch (type_of(i))
+    {
+        case TLM_REC_TEXT:
+            p[n] = 0u;
+            snprintf(out, size, "%s", (char *)p);
+            break;
+        case TLM_REC_LEVEL:
+        {
+            tlm_level_t r;
+            memcpy(&r, p, sizeof(r));
+            snprintf(out, size, "%d,%d,%u,%u,%lu,%lu", r.level_cdb, r.leq_cdb, r.rms, r.weighting,
+                     (unsigned long)r.overruns, (unsigned long)r.cycles);
+            break;
+        }
+        case TLM_REC_BANDS:
+        {
+            tlm_bands_t r;
+            memcpy(&r, p, sizeof(r));
+            int k = 0;
+            for (int b = 0; b < 8; ++b)
+            {
+                k += snprintf(out + k, size - (size_t)k, "%d,", r.band_cdb[b]);
+            }
+            snprintf(out + k, size - (size_t)k, "%u", r.frames);
+            break;
+        }
+        case TLM_REC_EVENT:
+        {
+            tlm_event_t r;
+            memcpy(&r, p, sizeof(r));
+            snprintf(out, size, "%d,%d,%u", r.above_floor_cdb, r.floor_cdb, r.zcr);
+            break;
+        }
+        case TLM_REC_CLIP:
+        {
+            tlm_clip_t r;
+            memcpy(&r, p, sizeof(r));
+            snprintf(out, size, "%lu,%u,%u,%lu", (unsigned long)r.clip, r.frames, r.peak, (unsigned long)r.bytes);
+            break;
+        }
+        default:
+        {
+            tlm_stereo_t r;
+            memcpy(&r, p, sizeof(r));
+            snprintf(out, size, "%d,%d,%d,%d", r.left_cdb, r.right_cdb, r.ild_cdb, r.side_cdb);
+            break;
+        }
+    }
+}
+
+static const char *const type_names[6] = { "text", "level", "bands", "event", "clip", "stereo" };
+
+/*******************************************************************************
+* Run
+********************************************************************************/
+static pid_t spawn(const char *python, const char *script, const char *source, const char *out_prefix,
+                   const char *stdin_path, const char *stdout_path, const char *stderr_path)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (stdin_path != NULL)
+        {
+            (void)freopen(stdin_path, "rb", stdin);
+        }
+        if (stdout_path != NULL)
+        {
+            (void)freopen(stdout_path, "w", stdout);
+        }
+        (void)freopen(stderr_path, "w", stderr);
+        if (out_prefix != NULL)
+        {
+            execlp(python, python, script, source, "--out", out_prefix, (char *)NULL);
+        }
+        else
+        {
+            execlp(python, python, script, source, (char *)NULL);
+        }
+        _exit(127);
+    }
+    return pid;
+}
+
+static bool read_stats(const char *path, unsigned *records, unsigned *bad, unsigned *lost)
+{
+    char line[MAX_LINE];
+    FILE *f = fopen(path, "r");
+    bool ok = false;
+
+    while ((f != NULL) && (fgets(line, sizeof(line), f) != NULL))
+    {
+        ok |= (sscanf(line, "records %u, bad %u, lost (seq gaps) %u", records, bad, lost) == 3);
+    }
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+    return ok;
+}
+
+/* Compares one per-type CSV with the records of that type that were sent */
+static bool compare_type(const char *prefix, uint8_t type, const bool *sent, uint32_t *rows)
+{
+    char path[256], line[MAX_LINE], want[2u * MAX_LINE], fields[MAX_LINE];
+    bool same = true;
+    uint32_t i = 0u;
+
+    snprintf(path, sizeof(path), "%s_%s.csv", prefix, type_names[type]);
+    FILE *f = fopen(path, "r");
+    if ((f == NULL) || (fgets(line, sizeof(line), f) == NULL) || (strncmp(line, "ts_ms,seq,sensor,record,", 24) != 0))
+    {
+        if (f != NULL)
+        {
+            fclose(f);
+        }
+        return false;
+    }
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        while ((i < RECORDS) && (!sent[i] || (type_of(i) != type)))
+        {
+            i++;
+        }
+        if (i == RECORDS)
+        {
+            same = false;
+            break;
+        }
+        fields_of(i, fields, sizeof(fields));
+        snprintf(want, sizeof(want), "%lu,%lu,%u,%s,%s", (unsigned long)ts_of(i), (unsigned long)(i & 0xFFu),
+                 SENSOR_ID, type_names[type], fields);
+        same &= (strcmp(line, want) == 0);
+        (*rows)++;
+        i++;
+    }
+    fclose(f);
+    return same;
+}
+
+int main(int argc, char **argv)
+{
+    static tlm_t tlm;
+    static bool sent[RECORDS];
+    uart_t uart;
+    char dir[] = "/tmp/tlm_loopbackXXXXXX";
+    char prefix[64], stats[64], capture[64], mixed[64], mixed_stats[64];
+    const char *python = (argc > 2) ? argv[2] : "python3";
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s path/to/tlm_decode.py [python]\n", argv[0]);
+        return 2;
+    }
+    if (mkdtemp(dir) == NULL)
+    {
+        perror("mkdtemp");
+        return 2;
+    }
+    snprintf(prefix, sizeof(prefix), "%s/run", dir);
+    snprintf(stats, sizeof(stats), "%s/stats.txt", dir);
+    snprintf(capture, sizeof(capture), "%s/capture.bin", dir);
+    snprintf(mixed, sizeof(mixed), "%s/mixed.csv", dir);
+    snprintf(mixed_stats, sizeof(mixed_stats), "%s/mixed_stats.txt", dir);
+
+    /* The slave end stays open in raw mode, so nothing written before the
+     * decoder opens it is echoed or edited by the line discipline */
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0))
+    {
+        perror("pty");
+        return 2;
+    }
+    const char *slave_name = ptsname(master);
+    int slave = open(slave_name, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    pid_t dec = spawn(python, argv[1], slave_name, prefix, NULL, NULL, stats);
+    sleep(1);
+
+    uart.fd = master;
+    uart.capture = fopen(capture, "wb");
+    uart.pending = false;
+
+    /* Noise on the line before the first delimiter */
+    static const uint8_t noise[] = { 0x13, 0x37, 0xFF, 0x42, 0x11, 0x03, 0x0D, 0x0A };
+    uart_write(&uart, noise, sizeof(noise));
+
+    tlm_init(&tlm, uart_start, &uart);
+    for (uint32_t i = 0; i < RECORDS; ++i)
+    {
+        uint8_t p[TLM_PAYLOAD_MAX];
+        size_t n = payload_of(i, p);
+        sent[i] = tlm_send(&tlm, type_of(i), SENSOR_ID, ts_of(i), p, n);
+        /* The UART stalls for a burst, the ring fills and drops */
+        if ((i < BURST_AT) || (i >= BURST_AT + BURST_RECORDS))
+        {
+            uart_service(&tlm, &uart);
+        }
+    }
+    uart_service(&tlm, &uart);
+
+    /* One frame with a bad CRC to finish */
+    uint8_t raw[TLM_RAW_MAX], frame[TLM_FRAME_MAX];
+    memset(raw, 0x5A, TLM_HEADER_BYTES + 4u);
+    size_t flen = tlm_cobs_encode(raw, TLM_HEADER_BYTES + 4u, frame);
+    frame[flen++] = 0u;
+    uart_write(&uart, frame, flen);
+    fclose(uart.capture);
+
+    sleep(2);
+    kill(dec, SIGINT);
+    waitpid(dec, NULL, 0);
+    close(slave);
+    close(master);
+
+    uint32_t expect_bad = 1u, dropped = 0u, rows = 0u;
+    for (uint32_t i = 0; i < RECORDS; ++i)
+    {
+        dropped += sent[i] ? 0u : 1u;
+    }
+    unsigned got_records = 0u, got_bad = 0u, got_lost = 0u;
+    bool have = read_stats(stats, &got_records, &got_bad, &got_lost);
+    char line[128];
+
+    printf("sent %lu records, ring dropped %lu (%lu), decoder: %u records, %u bad, %u lost\n",
+           (unsigned long)(RECORDS - dropped), (unsigned long)dropped, (unsigned long)tlm.drops,
+           got_records, got_bad, got_lost);
+    check(dropped == tlm.drops && (dropped > 0u), "stalled UART: ring drops counted");
+    check(have && (got_records == RECORDS - dropped), "pty: every record sent was decoded");
+    snprintf(line, sizeof(line), "pty: bad CRC counted, line noise ignored (%u bad)", got_bad);
+    check(have && (got_bad == expect_bad), line);
+    check(have && (got_lost == dropped), "pty: sequence gaps = ring drops");
+
+    bool same = true;
+    for (uint8_t type = 0; type < 6u; ++type)
+    {
+        same &= compare_type(prefix, type, sent, &rows);
+    }
+    check(same && (rows == RECORDS - dropped), "pty: every CSV row equals the record sent");
+
+    /* Same stream from stdin, all types to stdout: one header */
+    pid_t dec2 = spawn(python, argv[1], "-", NULL, capture, mixed, mixed_stats);
+    waitpid(dec2, NULL, 0);
+    FILE *f = fopen(mixed, "r");
+    uint32_t headers = 0u, lines = 0u;
+    bool named = true;
+    char buf[MAX_LINE];
+    while ((f != NULL) && (fgets(buf, sizeof(buf), f) != NULL))
+    {
+        headers += (strncmp(buf, "ts_ms,", 6) == 0) ? 1u : 0u;
+        named &= (lines == 0u) || (strstr(buf, "=") != NULL);
+        lines++;
+    }
+    if (f != NULL)
+    {
+        fclose(f);
+    }
+    check((headers == 1u) && named && (lines == RECORDS - dropped + 1u), "stdin, mixed types: one header, name=value rows");
+
+    if (failures == 0)
+    {
+        char cmd[96];
+        snprintf(cmd, sizeof(cmd), "rm -r %s", dir);
+        (void)system(cmd);
+    }
+    else
+    {
+        printf("decoder output kept in %s\n", dir);
+    }
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
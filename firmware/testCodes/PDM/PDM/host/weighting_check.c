@@ -0,0 +1,146 @@
+/******************************************************************************
+* File Name:   weighting_check.c
+*
+* Description: Host check of the A and C weighting cascades against the
+*              IEC 61672-1 table: a sine at every third-octave frequency from
+*              10 Hz to 6.3 kHz is run through wt_process() in 256-sample
+*              frames, and its gain relative to 1 kHz is taken from the output
+*              with a single-bin DFT. Each point must lie within the class 2
+*              tolerance, and from 20 Hz up within the design error of the
+*              cascade. 8 kHz is Nyquist at 16 kHz and is not measured.
+*              Exits non-zero on a failed check.
+*
+*                cc -O2 -I.. -o weighting_check weighting_check.c \
+*                   ../weighting.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "weighting.h"
+
+#define FRAME               (256u)
+#define SETTLE_S            (2.0)
+#define MEASURE_S           (4.0)
+#define AMPLITUDE           (16000.0)
+#define DESIGN_TOL_DB       (0.3)       /* fitted design error plus Q15 rounding */
+#define NO_LIMIT            (99.0)
+
+typedef struct
+{
+    double f_hz;
+    double a_db;
+    double c_db;
+    double tol_plus;        /* class 2 */
+    double tol_minus;
+} iec_point_t;
+
+/* IEC 61672-1:2013 Table 3, nominal weightings and class 2 limits */
+static const iec_point_t iec[] = {
+    {   10.0, -70.4, -14.3, 5.5, NO_LIMIT },
+    {   12.5, -63.4, -11.2, 5.5, NO_LIMIT },
+    {   16.0, -56.7,  -8.5, 5.5, NO_LIMIT },
+    {   20.0, -50.5,  -6.2, 3.5, 3.5 },
+    {   25.0, -44.7,  -4.4, 3.5, 3.5 },
+    {   31.5, -39.4,  -3.0, 3.5, 3.5 },
+    {   40.0, -34.6,  -2.0, 2.5, 2.5 },
+    {   50.0, -30.2,  -1.3, 2.5, 2.5 },
+    {   63.0, -26.2,  -0.8, 2.5, 2.5 },
+    {   80.0, -22.5,  -0.5, 2.5, 2.5 },
+    {  100.0, -19.1,  -0.3, 2.0, 2.0 },
+    {  125.0, -16.1,  -0.2, 2.0, 2.0 },
+    {  160.0, -13.4,  -0.1, 2.0, 2.0 },
+    {  200.0, -10.9,   0.0, 2.0, 2.0 },
+    {  250.0,  -8.6,   0.0, 1.9, 1.9 },
+    {  315.0,  -6.6,   0.0, 1.9, 1.9 },
+    {  400.0,  -4.8,   0.0, 1.9, 1.9 },
+    {  500.0,  -3.2,   0.0, 1.9, 1.9 },
+    {  630.0,  -1.9,   0.0, 1.9, 1.9 },
+    {  800.0,  -0.8,   0.0, 1.9, 1.9 },
+    { 1000.0,   0.0,   0.0, 1.4, 1.4 },
+    { 1250.0,   0.6,   0.0, 1.9, 1.9 },
+    { 1600.0,   1.0,  -0.1, 2.6, 2.6 },
+    { 2000.0,   1.2,  -0.2, 2.6, 2.6 },
+    { 2500.0,   1.3,  -0.3, 3.1, 3.1 },
+    { 3150.0,   1.2,  -0.5, 3.1, 3.1 },
+    { 4000.0,   1.0,  -0.8, 3.6, 3.6 },
+    { 5000.0,   0.5,  -1.3, 4.1, 4.1 },
+    { 6300.0,  -0.1,  -2.0, 5.1, 5.1 },
+};
+#define NUM_POINTS          (sizeof(iec) / sizeof(iec[0]))
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+/* Output amplitude of the cascade for a sine at f_hz, in dB re. the input */
+static double gain_db(wt_curve_t curve, double f_hz)
+{
+    wt_filter_t f;
+    int16_t frame[FRAME];
+    const double w = 2.0 * M_PI * f_hz / WT_SAMPLE_RATE_HZ;
+    const uint32_t settle = (uint32_t)(SETTLE_S * WT_SAMPLE_RATE_HZ / FRAME);
+    const uint32_t frames = settle + (uint32_t)(MEASURE_S * WT_SAMPLE_RATE_HZ / FRAME);
+    double re = 0.0, im = 0.0;
+    uint32_t n = 0u, t = 0u;
+
+    wt_init(&f, curve);
+    for (uint32_t k = 0; k < frames; ++k)
+    {
+        for (uint32_t i = 0; i < FRAME; ++i)
+        {
+            frame[i] = (int16_t)lrint(AMPLITUDE * sin(w * (t + i)));
+        }
+        wt_process(&f, frame, FRAME);
+        for (uint32_t i = 0; (k >= settle) && (i < FRAME); ++i, ++n)
+        {
+            re += frame[i] * cos(w * (t + i));
+            im += frame[i] * sin(w * (t + i));
+        }
+        t += FRAME;
+    }
+    return 20.0 * log10(2.0 * sqrt(re * re + im * im) / n / AMPLITUDE);
+}
+
+static void curve_check(wt_curve_t curve)
+{
+    const double ref = gain_db(curve, 1000.0);
+    double worst_dev = 0.0, worst_design = 0.0;
+    bool class2 = true;
+    char line[96];
+
+    printf("%s     f/Hz   measured   IEC     dev\n", wt_curve_name(curve));
+    for (size_t i = 0; i < NUM_POINTS; ++i)
+    {
+        const iec_point_t *p = &iec[i];
+        double nominal = (curve == WT_CURVE_A) ? p->a_db : p->c_db;
+        double dev = gain_db(curve, p->f_hz) - ref - nominal;
+
+        printf("      %7.1f  %8.2f  %6.1f  %+6.2f\n", p->f_hz, dev + nominal, nominal, dev);
+        class2 &= (dev <= p->tol_plus) && (dev >= -p->tol_minus);
+        worst_dev = (fabs(dev) > fabs(worst_dev)) ? dev : worst_dev;
+        /* The table is rounded to 0.1 dB */
+        if (p->f_hz >= 20.0)
+        {
+            worst_design = fmax(worst_design, fabs(dev) - 0.05);
+        }
+    }
+    snprintf(line, sizeof(line), "%s: within IEC 61672 class 2, worst %+.2f dB", wt_curve_name(curve), worst_dev);
+    check(class2, line);
+    snprintf(line, sizeof(line), "%s: 20 Hz..6.3 kHz within %.1f dB of nominal", wt_curve_name(curve),
+             DESIGN_TOL_DB);
+    check(worst_design <= DESIGN_TOL_DB, line);
+}
+
+int main(void)
+{
+    curve_check(WT_CURVE_A);
+    curve_check(WT_CURVE_C);
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
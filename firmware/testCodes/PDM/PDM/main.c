@@ -2,6 +2,16 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include "cy_retarget_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include "pcm_ring.h"
+#include "sound_level.h"
+#include "weighting.h"
+#include "octave_bands.h"
+#include "sound_event.h"
+#include "adpcm.h"
+#include "pcm_stereo.h"
+#include "telemetry.h"
 
 #define UART_BAUD             (115200)
 #define PCM_SAMPLE_RATE_HZ    (16000)
@@ -14,8 +24,221 @@
 #define PDM_DATA_PIN          (P10_5)   // DATA van mic (shield)
 #define PDM_CLK_PIN           (P10_4)   // CLK naar mic  (shield)
 
+// 1: beide mics (stereo, L/R interleaved in de ring), 0: alleen de RIGHT mic
+#ifndef PDM_STEREO
+#define PDM_STEREO            (0)
+#endif
+#if PDM_STEREO
+#define PDM_MODE              (CYHAL_PDM_PCM_MODE_STEREO)
+#define PDM_CHANNELS          (2u)
+#else
+#define PDM_MODE              (CYHAL_PDM_PCM_MODE_RIGHT)  // mic gedraagt zich als RIGHT
+#define PDM_CHANNELS          (1u)
+#endif
+#define FRAME_WORDS           (FRAME_SAMPLES * PDM_CHANNELS)   // int16 per ring slot
+
+#define PDM_IRQ_PRIORITY      (3u)
+#define PRINT_EVERY_FRAMES    (62u)     // ~1 s bij 256 samples/16 kHz
+#define FRAME_MS              ((FRAME_SAMPLES * 1000u) / PCM_SAMPLE_RATE_HZ)   // 16 ms
+
+// 1: binaire telemetrie (COBS + CRC) i.p.v. printf, zie tools/tlm_decode.py
+#ifndef TELEMETRY_BINARY
+#define TELEMETRY_BINARY      (1)
+#endif
+#define TLM_IRQ_PRIORITY      (6u)
+#define TLM_SENSOR_MIC        (0u)
+#define TLM_SENSOR_MIC_PAIR   (1u)
+#if TELEMETRY_BINARY
+#define LEVEL_EVERY_FRAMES    (1u)      // binair is goedkoop genoeg voor elke frame
+#else
+#define LEVEL_EVERY_FRAMES    (PRINT_EVERY_FRAMES)
+#endif
+#define LEVEL_WEIGHTING       (WT_CURVE_A)
+#define CLIP_POST_FRAMES      (46u)     // + SE_PRE_FRAMES = 62 frames, ~1 s clip
+#define CLIP_MAX_FRAMES       (SE_PRE_FRAMES + CLIP_POST_FRAMES)
+#define CLIP_BLOCK_BYTES      (ADPCM_BLOCK_BYTES(FRAME_SAMPLES))
+
+_Static_assert(PCM_SAMPLE_RATE_HZ == WT_SAMPLE_RATE_HZ, "weighting coefficients are for 16 kHz");
+_Static_assert((FRAME_SAMPLES == OB_FFT_SIZE) && (PCM_SAMPLE_RATE_HZ == OB_SAMPLE_RATE_HZ),
+               "octave bands expect 256-sample frames at 16 kHz");
+
 static cyhal_pdm_pcm_t pdm;
-static int16_t pcm_buf[FRAME_SAMPLES];
+static pcm_ring_t pcm_ring;
+static int16_t *pdm_dst;                // frame dat de DMA nu vult
+#if PDM_STEREO
+static int16_t ch_left[FRAME_SAMPLES];  // planar kopie per kanaal
+static int16_t ch_right[FRAME_SAMPLES];
+#endif
+static sl_leq_t leq;
+static wt_filter_t weighting;
+static ob_analyzer_t bands;
+static se_detector_t events;
+static int32_t clip_peak;               // grootste |sample| van de lopende clip
+static adpcm_state_t clip_codec;
+static uint8_t clip_store[CLIP_MAX_FRAMES][CLIP_BLOCK_BYTES];   // ADPCM clip, 1 blok per frame
+static uint32_t clip_cycles;            // encoder cycles voor de hele clip
+#if TELEMETRY_BINARY
+static tlm_t tlm;
+#endif
+
+/* ISR: frame klaar -> commit in de ring en meteen de volgende read starten,
+ * zodat de PDM FIFO nooit stilvalt, ook niet als de verwerking achterloopt. */
+static void pdm_event_cb(void *arg, cyhal_pdm_pcm_event_t event)
+{
+    (void)arg;
+    if ((event & CYHAL_PDM_PCM_ASYNC_COMPLETE) == 0u) {
+        return;
+    }
+    pcm_ring_commit(&pcm_ring, pdm_dst);
+    pdm_dst = pcm_ring_write_slot(&pcm_ring);
+    (void)cyhal_pdm_pcm_read_async(&pdm, pdm_dst, FRAME_WORDS);
+}
+
+/* Clip sink van de event detector: elke frame wordt meteen een ADPCM blok
+ * (4:1) in clip_store, klaar voor opslag/upload. */
+static void clip_sink(const int16_t *frame, size_t n, uint32_t index, uint32_t total, void *arg)
+{
+    (void)arg;
+    (void)total;
+    if (index == 0u) {
+        clip_peak = 0;
+        clip_cycles = 0;
+        adpcm_init(&clip_codec);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (abs(frame[i]) > clip_peak) {
+            clip_peak = abs(frame[i]);
+        }
+    }
+    if (index < CLIP_MAX_FRAMES) {
+        uint32_t t0 = DWT->CYCCNT;
+        (void)adpcm_encode_block(&clip_codec, frame, n, clip_store[index]);
+        clip_cycles += DWT->CYCCNT - t0;
+    }
+}
+
+#if TELEMETRY_BINARY
+/* Telemetrie TX via de retarget-io UART: async write, TX_DONE start de volgende. */
+static bool tlm_uart_start(const uint8_t *buf, size_t len, void *ctx)
+{
+    return cyhal_uart_write_async((cyhal_uart_t *)ctx, (void *)buf, len) == CY_RSLT_SUCCESS;
+}
+
+static void tlm_uart_event_cb(void *arg, cyhal_uart_event_t event)
+{
+    if ((event & CYHAL_UART_IRQ_TX_DONE) != 0u) {
+        tlm_tx_done((tlm_t *)arg);
+    }
+}
+
+static void telemetry_init(void)
+{
+    static const char banner[] = "PDM telemetry start";
+    tlm_init(&tlm, tlm_uart_start, &cy_retarget_io_uart_obj);
+    cyhal_uart_register_callback(&cy_retarget_io_uart_obj, tlm_uart_event_cb, &tlm);
+    cyhal_uart_enable_event(&cy_retarget_io_uart_obj, CYHAL_UART_IRQ_TX_DONE, TLM_IRQ_PRIORITY, true);
+    (void)tlm_send(&tlm, TLM_REC_TEXT, TLM_SENSOR_MIC, 0u, banner, sizeof(banner) - 1u);
+}
+#endif
+
+/* Rapportage: binaire records of de oude printf regels, zelfde inhoud. */
+static void report_event(uint32_t ts_ms, se_event_t ev)
+{
+#if TELEMETRY_BINARY
+    if (ev == SE_EVENT_START) {
+        tlm_event_t rec = {
+            .above_floor_cdb = (int16_t)(events.last_dbfs_cdb - se_floor_cdb(&events)),
+            .floor_cdb       = (int16_t)se_floor_cdb(&events),
+            .zcr             = events.last_zcr
+        };
+        (void)tlm_send(&tlm, TLM_REC_EVENT, TLM_SENSOR_MIC, ts_ms, &rec, sizeof(rec));
+    } else if (ev == SE_EVENT_END) {
+        tlm_clip_t rec = {
+            .clip   = events.clips,
+            .frames = (uint16_t)events.clip_total,
+            .peak   = (uint16_t)clip_peak,
+            .bytes  = events.clip_total * CLIP_BLOCK_BYTES
+        };
+        (void)tlm_send(&tlm, TLM_REC_CLIP, TLM_SENSOR_MIC, ts_ms, &rec, sizeof(rec));
+    }
+#else
+    (void)ts_ms;
+    if (ev == SE_EVENT_START) {
+        printf("event: %ld cdB boven floor %ld cdBFS, zcr %u\r\n",
+               (long)(events.last_dbfs_cdb - se_floor_cdb(&events)),
+               (long)se_floor_cdb(&events), events.last_zcr);
+    } else if (ev == SE_EVENT_END) {
+        printf("clip %lu: %lu frames, piek %ld, %lu bytes ADPCM (%lu cyc/frame)\r\n",
+               (unsigned long)events.clips, (unsigned long)events.clip_total, (long)clip_peak,
+               (unsigned long)(events.clip_total * CLIP_BLOCK_BYTES),
+               (unsigned long)(clip_cycles / events.clip_total));
+    }
+#endif
+}
+
+static void report_level(uint32_t ts_ms, const sl_frame_level_t *lvl, uint32_t cycles)
+{
+    int32_t spl = lvl->dbfs_cdb + SL_SPL_OFFSET_CDB;
+    int32_t leq_spl = sl_leq_dbfs_cdb(&leq) + SL_SPL_OFFSET_CDB;
+#if TELEMETRY_BINARY
+    tlm_level_t rec = {
+        .level_cdb = (int16_t)spl,
+        .leq_cdb   = (int16_t)leq_spl,
+        .rms       = (uint16_t)lvl->rms,
+        .weighting = (uint8_t)weighting.curve,
+        .overruns  = atomic_load(&pcm_ring.overruns),
+        .cycles    = cycles
+    };
+    (void)tlm_send(&tlm, TLM_REC_LEVEL, TLM_SENSOR_MIC, ts_ms, &rec, sizeof(rec));
+#else
+    (void)ts_ms;
+    const char *unit = wt_curve_name(weighting.curve);
+    printf("rms %lu, sound: %ld.%02ld %s, Leq %ld.%02ld %s (%lu cyc/frame, ovr %u, idle %u)\r\n",
+           (unsigned long)lvl->rms, (long)(spl / 100), (long)(abs(spl) % 100), unit,
+           (long)(leq_spl / 100), (long)(abs(leq_spl) % 100), unit, (unsigned long)cycles,
+           atomic_load(&pcm_ring.overruns), atomic_load(&pcm_ring.empty_polls));
+#endif
+}
+
+#if PDM_STEREO
+static void report_stereo(uint32_t ts_ms, const pcm_stereo_metrics_t *sm, uint32_t cycles)
+{
+#if TELEMETRY_BINARY
+    (void)cycles;
+    tlm_stereo_t rec = {
+        .left_cdb  = (int16_t)sm->left_dbfs_cdb,
+        .right_cdb = (int16_t)sm->right_dbfs_cdb,
+        .ild_cdb   = (int16_t)sm->ild_cdb,
+        .side_cdb  = (int16_t)sm->side_dbfs_cdb
+    };
+    (void)tlm_send(&tlm, TLM_REC_STEREO, TLM_SENSOR_MIC_PAIR, ts_ms, &rec, sizeof(rec));
+#else
+    (void)ts_ms;
+    printf("stereo: L %ld R %ld cdBFS, ILD %ld cdB, side %ld cdBFS (split %lu cyc)\r\n",
+           (long)sm->left_dbfs_cdb, (long)sm->right_dbfs_cdb, (long)sm->ild_cdb,
+           (long)sm->side_dbfs_cdb, (unsigned long)cycles);
+#endif
+}
+#endif
+
+static void report_bands(uint32_t ts_ms, const ob_vector_t *bv, uint32_t cycles)
+{
+#if TELEMETRY_BINARY
+    (void)cycles;
+    tlm_bands_t rec;
+    _Static_assert(OB_NUM_BANDS == (sizeof(rec.band_cdb) / sizeof(rec.band_cdb[0])), "band count");
+    memcpy(rec.band_cdb, bv->band_cdb, sizeof(rec.band_cdb));
+    rec.frames = bv->frames;
+    (void)tlm_send(&tlm, TLM_REC_BANDS, TLM_SENSOR_MIC, ts_ms, &rec, sizeof(rec));
+#else
+    (void)ts_ms;
+    printf("bands dBFS (%u frames, %lu cyc/frame):", bv->frames, (unsigned long)cycles);
+    for (uint32_t b = 0; b < OB_NUM_BANDS; ++b) {
+        printf(" %u:%d.%02d", ob_band_centre_hz[b], bv->band_cdb[b] / 100, abs(bv->band_cdb[b]) % 100);
+    }
+    printf("\r\n");
+#endif
+}
 
 static void pdm_init(void)
 {
@@ -23,7 +246,7 @@ static void pdm_init(void)
     const cyhal_pdm_pcm_cfg_t cfg = {
         .sample_rate     = PCM_SAMPLE_RATE_HZ,
         .decimation_rate = DECIMATION_RATE,
-        .mode            = CYHAL_PDM_PCM_MODE_RIGHT, // mic gedraagt zich als RIGHT
+        .mode            = PDM_MODE,
         .word_length     = PCM_WORD_LEN_BITS,
         .left_gain       = PDM_LEFT_GAIN_DB,
         .right_gain      = PDM_RIGHT_GAIN_DB
@@ -34,26 +257,27 @@ static void pdm_init(void)
         printf("PDM init failed: 0x%08lx\r\n", (unsigned long)rslt);
         CY_ASSERT(0);
     }
+
+    rslt = cyhal_pdm_pcm_set_async_mode(&pdm, CYHAL_ASYNC_DMA, CYHAL_DMA_PRIORITY_DEFAULT);
+    if (rslt != CY_RSLT_SUCCESS) {
+        printf("PDM async mode failed: 0x%08lx\r\n", (unsigned long)rslt);
+        CY_ASSERT(0);
+    }
+    cyhal_pdm_pcm_register_callback(&pdm, pdm_event_cb, NULL);
+    cyhal_pdm_pcm_enable_event(&pdm, CYHAL_PDM_PCM_ASYNC_COMPLETE, PDM_IRQ_PRIORITY, true);
+
     rslt = cyhal_pdm_pcm_start(&pdm);
     if (rslt != CY_RSLT_SUCCESS) {
         printf("PDM start failed: 0x%08lx\r\n", (unsigned long)rslt);
         CY_ASSERT(0);
     }
-}
 
-static size_t pdm_read_blocking(int16_t *dst, size_t want)
-{
-    size_t filled = 0;
-    while (filled < want) {
-        size_t n = want - filled;
-        cy_rslt_t r = cyhal_pdm_pcm_read(&pdm, &dst[filled], &n);
-        if (r != CY_RSLT_SUCCESS) {
-            printf("read err: 0x%08lx\r\n", (unsigned long)r);
-            break;
-        }
-        filled += n;
+    pdm_dst = pcm_ring_write_slot(&pcm_ring);
+    rslt = cyhal_pdm_pcm_read_async(&pdm, pdm_dst, FRAME_WORDS);
+    if (rslt != CY_RSLT_SUCCESS) {
+        printf("PDM read start failed: 0x%08lx\r\n", (unsigned long)rslt);
+        CY_ASSERT(0);
     }
-    return filled;
 }
 
 int main(void)
@@ -65,15 +289,84 @@ int main(void)
     rslt = cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX, UART_BAUD);
     if (rslt != CY_RSLT_SUCCESS) { CY_ASSERT(0); }
 
-    printf("\r\nPDM->PCM demo start (mono RIGHT, 16kHz)\r\n");
+    printf("\r\nPDM->PCM demo start (%s, 16kHz)\r\n", PDM_STEREO ? "stereo L/R" : "mono RIGHT");
+#if TELEMETRY_BINARY
+    telemetry_init();       // vanaf hier geen printf meer op deze UART
+#endif
+    pcm_ring_init(&pcm_ring, FRAME_WORDS);
+    sl_leq_init(&leq);
+    wt_init(&weighting, LEVEL_WEIGHTING);
+    ob_init(&bands, SL_LEQ_WINDOW_FRAMES);     // een band-vector per upload-venster
+    se_cfg_t se_cfg;
+    se_default_cfg(&se_cfg);
+    se_cfg.post_frames = CLIP_POST_FRAMES;
+    if (!se_init(&events, &se_cfg, FRAME_SAMPLES, clip_sink, NULL)) {
+        CY_ASSERT(0);
+    }
     pdm_init();
 
+    // DWT cycle counter om de kost per frame te meten
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    uint32_t frames = 0;
+    uint32_t level_cycles = 0;
+    uint32_t band_cycles = 0;
+#if PDM_STEREO
+    uint32_t split_cycles = 0;
+    pcm_stereo_metrics_t sm = { 0 };
+#endif
     for (;;) {
-        size_t filled = pdm_read_blocking(pcm_buf, FRAME_SAMPLES);
-        printf("PCM[%u]: ", (unsigned)filled);
-        size_t show = filled < 12 ? filled : 12;
-        for (size_t i = 0; i < show; ++i) printf("%d ", (int)pcm_buf[i]);
-        printf("...\r\n");
-        cyhal_system_delay_ms(2);
+        int16_t *slot = pcm_ring_peek(&pcm_ring);
+        if (slot == NULL) {
+            cyhal_syspm_sleep();    // wakker bij de volgende PDM interrupt
+            continue;
+        }
+
+#if PDM_STEREO
+        // L/R splitsen; de stages hieronder zien per kanaal een gewone mono frame
+        uint32_t ts = DWT->CYCCNT;
+        pcm_deinterleave(slot, FRAME_SAMPLES, ch_left, ch_right);
+        split_cycles = DWT->CYCCNT - ts;
+        pcm_stereo_metrics(ch_left, ch_right, FRAME_SAMPLES, &sm);
+        int16_t *frame = ch_right;  // zelfde mic als in mono
+#else
+        int16_t *frame = slot;
+#endif
+        uint32_t ts_ms = frames * FRAME_MS;     // audioklok: frames sinds start
+
+        // spectrum op het ongewogen signaal, voor de weging in place
+        uint32_t t0 = DWT->CYCCNT;
+        ob_vector_t bv;
+        bool bands_ready = ob_push(&bands, frame, &bv);
+        band_cycles = DWT->CYCCNT - t0;
+
+        // event detector + pre-trigger buffer, ook op het ruwe signaal
+        se_event_t ev = se_push(&events, frame);
+        if (ev != SE_EVENT_NONE) {
+            report_event(ts_ms, ev);
+        }
+
+        t0 = DWT->CYCCNT;
+        wt_process(&weighting, frame, FRAME_SAMPLES);   // in place, slot is van ons tot release
+        sl_frame_level_t lvl;
+        sl_frame_level(frame, FRAME_SAMPLES, &lvl);
+        sl_leq_push(&leq, lvl.ms);
+        level_cycles = DWT->CYCCNT - t0;
+
+        if ((frames % LEVEL_EVERY_FRAMES) == 0u) {
+            report_level(ts_ms, &lvl, level_cycles);
+        }
+#if PDM_STEREO
+        if ((frames % PRINT_EVERY_FRAMES) == 0u) {
+            report_stereo(ts_ms, &sm, split_cycles);
+        }
+#endif
+        if (bands_ready) {
+            report_bands(ts_ms, &bv, band_cycles);
+        }
+        frames++;
+        pcm_ring_release(&pcm_ring);
     }
 }
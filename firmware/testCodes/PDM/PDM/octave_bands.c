@@ -0,0 +1,206 @@
+/******************************************************************************
+* File Name:   octave_bands.c
+*
+* Description: Octave band analyzer, see octave_bands.h.
+*
+*              The 256-point real FFT is done as a 128-point complex radix-2
+*              FFT over the even/odd sample pairs followed by the usual split
+*              step. Data is int32 with twiddles in Q15; every butterfly
+*              stage halves, so the input can use 24 bits without overflow.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "octave_bands.h"
+#include "sound_level.h"
+
+#define HALF_SIZE           (OB_FFT_SIZE / 2u)      /* complex FFT length */
+#define HALF_LOG2           (7u)
+
+/* Windowed samples are Q15 x Q15 >> 7, i.e. 8 extra bits of resolution. */
+#define INPUT_SHIFT         (7u)
+
+/* sum |X|^2 -> mean square in LSB^2: the split step leaves X = 2 * DFT(x*w),
+ * one-sided bins count twice, and Hann has a mean power of 3/8:
+ * 2 / 4 / (256^2 * 3/8) = 1 / 49152. */
+#define BIN_POWER_DIV       (49152u)
+
+_Static_assert(OB_FFT_SIZE == (2u << HALF_LOG2), "FFT size and log2 disagree");
+
+/* sin(2 pi k / 256) in Q15 for k = 0 .. 64; the rest follows by symmetry. */
+static const int16_t sin_quarter_q15[65] = {
+        0,   804,  1608,  2411,  3212,  4011,  4808,  5602,
+     6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793,
+    12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531,
+    18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+    23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791,
+    27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+    30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972,
+    32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+    32767,
+};
+
+/* First FFT bin of each band, plus the end. A bin belongs to the band whose
+ * edges (fc / sqrt 2, fc * sqrt 2) contain its centre frequency. */
+static const uint8_t band_first_bin[OB_NUM_BANDS + 1u] = {
+    1, 2, 3, 6, 12, 23, 46, 91, 129
+};
+
+const uint16_t ob_band_centre_hz[OB_NUM_BANDS] = {
+    63, 125, 250, 500, 1000, 2000, 4000, 8000
+};
+
+static inline int32_t sin_q15(uint32_t k)
+{
+    uint32_t r = k & 63u;
+    switch ((k >> 6) & 3u)
+    {
+        case 0:  return sin_quarter_q15[r];
+        case 1:  return sin_quarter_q15[64u - r];
+        case 2:  return -sin_quarter_q15[r];
+        default: return -sin_quarter_q15[64u - r];
+    }
+}
+
+static inline int32_t cos_q15(uint32_t k)
+{
+    return sin_q15(k + 64u);
+}
+
+static inline uint32_t bit_reverse7(uint32_t v)
+{
+    uint32_t r = 0u;
+    for (uint32_t i = 0u; i < HALF_LOG2; ++i)
+    {
+        r = (r << 1) | (v & 1u);
+        v >>= 1;
+    }
+    return r;
+}
+
+/* In-place 128-point complex FFT on interleaved re/im, scaled by 1/128. */
+static void fft128_scaled(int32_t *z)
+{
+    for (uint32_t i = 0u; i < HALF_SIZE; ++i)
+    {
+        uint32_t j = bit_reverse7(i);
+        if (j > i)
+        {
+            int32_t tr = z[2u * i];
+            int32_t ti = z[2u * i + 1u];
+            z[2u * i] = z[2u * j];
+            z[2u * i + 1u] = z[2u * j + 1u];
+            z[2u * j] = tr;
+            z[2u * j + 1u] = ti;
+        }
+    }
+
+    for (uint32_t len = 2u; len <= HALF_SIZE; len <<= 1)
+    {
+        uint32_t half = len / 2u;
+        uint32_t step = OB_FFT_SIZE / len;     /* twiddle index in 1/256 turns */
+
+        for (uint32_t m = 0u; m < half; ++m)
+        {
+            int32_t c = cos_q15(m * step);
+            int32_t s = sin_q15(m * step);
+
+            for (uint32_t i = m; i < HALF_SIZE; i += len)
+            {
+                int32_t *a = &z[2u * i];
+                int32_t *b = &z[2u * (i + half)];
+
+                /* t = b * (c - j s) */
+                int32_t tr = (int32_t)(((int64_t)b[0] * c + (int64_t)b[1] * s) >> 15);
+                int32_t ti = (int32_t)(((int64_t)b[1] * c - (int64_t)b[0] * s) >> 15);
+
+                b[0] = (a[0] - tr) >> 1;
+                b[1] = (a[1] - ti) >> 1;
+                a[0] = (a[0] + tr) >> 1;
+                a[1] = (a[1] + ti) >> 1;
+            }
+        }
+    }
+}
+
+static void frame_band_ms(ob_analyzer_t *a, const int16_t *x, uint64_t ms[OB_NUM_BANDS])
+{
+    int32_t *z = a->fft;
+
+    int32_t sum = 0;
+    for (uint32_t n = 0u; n < OB_FFT_SIZE; ++n)
+    {
+        sum += x[n];
+    }
+    int32_t mean = sum / (int32_t)OB_FFT_SIZE;
+
+    /* Hann window, w[n] = (1 - cos(2 pi n / N)) / 2 in Q15. Even samples go
+     * to the real part, odd samples to the imaginary part. */
+    for (uint32_t n = 0u; n < OB_FFT_SIZE; ++n)
+    {
+        int32_t w = (32767 - cos_q15(n)) >> 1;
+        z[n] = (int32_t)(((int64_t)(x[n] - mean) * w) >> INPUT_SHIFT);
+    }
+
+    fft128_scaled(z);
+
+    /* Split step: X[k] = E[k] + W^k O[k], bins 1 .. N/2. */
+    uint32_t band = 0u;
+    uint64_t acc = 0u;
+    for (uint32_t k = 1u; k <= HALF_SIZE; ++k)
+    {
+        uint32_t p = k & (HALF_SIZE - 1u);
+        uint32_t q = (HALF_SIZE - k) & (HALF_SIZE - 1u);
+        int32_t pr = z[2u * p], pi = z[2u * p + 1u];
+        int32_t qr = z[2u * q], qi = z[2u * q + 1u];
+
+        int32_t er = (pr + qr) / 2;
+        int32_t ei = (pi - qi) / 2;
+        int32_t or_ = (pi + qi) / 2;
+        int32_t oi = (qr - pr) / 2;
+        int32_t c = cos_q15(k);
+        int32_t s = sin_q15(k);
+
+        int64_t xr = er + (((int64_t)or_ * c + (int64_t)oi * s) >> 15);
+        int64_t xi = ei + (((int64_t)oi * c - (int64_t)or_ * s) >> 15);
+
+        if (k == band_first_bin[band + 1u])
+        {
+            ms[band++] = acc / BIN_POWER_DIV;
+            acc = 0u;
+        }
+        uint64_t pwr = (uint64_t)(xr * xr) + (uint64_t)(xi * xi);
+        acc += (k == HALF_SIZE) ? (pwr / 2u) : pwr;     /* Nyquist bin is not mirrored */
+    }
+    ms[band] = acc / BIN_POWER_DIV;
+}
+
+void ob_init(ob_analyzer_t *a, uint32_t window_frames)
+{
+    memset(a, 0, sizeof(*a));
+    a->window_frames = (window_frames == 0u) ? 1u : window_frames;
+}
+
+bool ob_push(ob_analyzer_t *a, const int16_t *frame, ob_vector_t *out)
+{
+    uint64_t ms[OB_NUM_BANDS];
+    frame_band_ms(a, frame, ms);
+
+    for (uint32_t b = 0u; b < OB_NUM_BANDS; ++b)
+    {
+        a->ms_sum[b] += ms[b];
+    }
+    if (++a->frames < a->window_frames)
+    {
+        return false;
+    }
+
+    for (uint32_t b = 0u; b < OB_NUM_BANDS; ++b)
+    {
+        out->band_cdb[b] = (int16_t)sl_ms_to_dbfs_cdb(a->ms_sum[b] / a->frames);
+        a->ms_sum[b] = 0u;
+    }
+    out->frames = (uint16_t)a->frames;
+    a->frames = 0u;
+    return true;
+}
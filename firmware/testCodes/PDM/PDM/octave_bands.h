@@ -0,0 +1,58 @@
+/******************************************************************************
+* File Name:   octave_bands.h
+*
+* Description: Octave band analyzer for 256-sample PCM frames at 16 kHz.
+*              Each frame is DC-removed, Hann-windowed and run through a
+*              fixed-point real FFT; bin powers are summed per octave band
+*              (63 Hz .. 8 kHz) and accumulated over an upload window. When
+*              the window is complete a fixed-size vector of band levels is
+*              emitted. All state is in the analyzer struct, no allocation.
+*
+*******************************************************************************/
+
+#ifndef OCTAVE_BANDS_H_
+#define OCTAVE_BANDS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define OB_FFT_SIZE                       (256u)
+#define OB_SAMPLE_RATE_HZ                 (16000u)
+/* Octave bands with nominal centres 63, 125, ... 8000 Hz. The 31.5 Hz band
+ * is below the 62.5 Hz bin spacing and is not reported. */
+#define OB_NUM_BANDS                      (8u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+/* Emitted once per window: band levels in centi-dBFS, scaled like
+ * sl_frame_level() so the bands add up to the broadband AC level. */
+typedef struct
+{
+    int16_t  band_cdb[OB_NUM_BANDS];
+    uint16_t frames;
+} ob_vector_t;
+
+typedef struct
+{
+    uint64_t ms_sum[OB_NUM_BANDS];      /* per-band mean square, summed over frames */
+    uint32_t frames;
+    uint32_t window_frames;
+    int32_t  fft[OB_FFT_SIZE];          /* work buffer, 128 complex bins re/im */
+} ob_analyzer_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void ob_init(ob_analyzer_t *a, uint32_t window_frames);
+
+/* Adds one frame of OB_FFT_SIZE samples. Returns true and fills out when
+ * this frame completes the window; the accumulators then start over. */
+bool ob_push(ob_analyzer_t *a, const int16_t *frame, ob_vector_t *out);
+
+extern const uint16_t ob_band_centre_hz[OB_NUM_BANDS];
+
+#endif /* OCTAVE_BANDS_H_ */
@@ -0,0 +1,78 @@
+/******************************************************************************
+* File Name:   pcm_ring.c
+*
+* Description: SPSC ring of PCM frames, see pcm_ring.h.
+*
+*******************************************************************************/
+
+#include "pcm_ring.h"
+
+#define SLOT_MASK   (PCM_RING_SLOTS - 1u)
+
+_Static_assert((PCM_RING_SLOTS & SLOT_MASK) == 0u, "PCM_RING_SLOTS must be a power of two");
+
+bool pcm_ring_init(pcm_ring_t *r, size_t frame_samples)
+{
+    if ((frame_samples == 0u) || (frame_samples > PCM_RING_SLOT_MAX))
+    {
+        return false;
+    }
+    r->frame_samples = frame_samples;
+    atomic_init(&r->head, 0u);
+    atomic_init(&r->tail, 0u);
+    atomic_init(&r->overruns, 0u);
+    atomic_init(&r->empty_polls, 0u);
+    return true;
+}
+
+int16_t *pcm_ring_write_slot(pcm_ring_t *r)
+{
+    unsigned head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+
+    if ((head - tail) >= PCM_RING_SLOTS)
+    {
+        return r->scratch;
+    }
+    return r->data[head & SLOT_MASK];
+}
+
+void pcm_ring_commit(pcm_ring_t *r, const int16_t *slot)
+{
+    if (slot == r->scratch)
+    {
+        atomic_fetch_add_explicit(&r->overruns, 1u, memory_order_relaxed);
+        return;
+    }
+
+    /* Release: the frame contents become visible before the new head. */
+    unsigned head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + 1u, memory_order_release);
+}
+
+int16_t *pcm_ring_peek(pcm_ring_t *r)
+{
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    if (head == tail)
+    {
+        atomic_fetch_add_explicit(&r->empty_polls, 1u, memory_order_relaxed);
+        return NULL;
+    }
+    return r->data[tail & SLOT_MASK];
+}
+
+void pcm_ring_release(pcm_ring_t *r)
+{
+    /* Release: we are done reading before the producer may reuse the slot. */
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + 1u, memory_order_release);
+}
+
+unsigned pcm_ring_count(pcm_ring_t *r)
+{
+    unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return head - tail;
+}
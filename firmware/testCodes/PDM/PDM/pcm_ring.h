@@ -0,0 +1,66 @@
+/******************************************************************************
+* File Name:   pcm_ring.h
+*
+* Description: Lock-free single-producer / single-consumer ring of PCM frames.
+*              The producer is the PDM completion ISR, the consumer is the
+*              processing loop. Each side only writes its own index, so no
+*              critical sections are needed.
+*
+*******************************************************************************/
+
+#ifndef PCM_RING_H_
+#define PCM_RING_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Number of frames in the ring, a power of two. Head and tail run freely
+ * and are masked on access, so all slots are usable. */
+#ifndef PCM_RING_SLOTS
+#define PCM_RING_SLOTS                    (8u)
+#endif
+
+/* Largest frame in int16 samples: 256 interleaved L/R pairs in stereo. */
+#ifndef PCM_RING_SLOT_MAX
+#define PCM_RING_SLOT_MAX                 (512u)
+#endif
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int16_t          data[PCM_RING_SLOTS][PCM_RING_SLOT_MAX];
+    int16_t          scratch[PCM_RING_SLOT_MAX];  /* sink while the ring is full */
+    size_t           frame_samples;
+    atomic_uint      head;                        /* written by producer only */
+    atomic_uint      tail;                        /* written by consumer only */
+    atomic_uint      overruns;                    /* frames lost, ring full */
+    atomic_uint      empty_polls;                 /* peeks that found nothing */
+} pcm_ring_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+bool pcm_ring_init(pcm_ring_t *r, size_t frame_samples);
+
+/* Producer: slot to fill next. When the ring is full this is the scratch
+ * buffer and the frame written into it is counted as an overrun on commit. */
+int16_t *pcm_ring_write_slot(pcm_ring_t *r);
+void pcm_ring_commit(pcm_ring_t *r, const int16_t *slot);
+
+/* Consumer: oldest frame or NULL, then release it. The consumer owns the
+ * slot until release and may modify it in place. A NULL is counted as an
+ * empty poll: the consumer was ahead, which loses nothing (lost frames are
+ * the producer's overruns). */
+int16_t *pcm_ring_peek(pcm_ring_t *r);
+void pcm_ring_release(pcm_ring_t *r);
+
+unsigned pcm_ring_count(pcm_ring_t *r);
+
+#endif /* PCM_RING_H_ */
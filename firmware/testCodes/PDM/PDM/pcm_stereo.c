@@ -0,0 +1,100 @@
+/******************************************************************************
+* File Name:   pcm_stereo.c
+*
+* Description: Stereo de-interleave and metrics, see pcm_stereo.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "pcm_stereo.h"
+#include "sound_level.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+void pcm_deinterleave_scalar(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right)
+{
+    for (size_t i = 0; i < pairs; ++i)
+    {
+        left[i] = lr[2u * i];
+        right[i] = lr[2u * i + 1u];
+    }
+}
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+void pcm_deinterleave_dsp(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right)
+{
+    size_t i = 0;
+
+    /* w0 = R0:L0, w1 = R1:L1 -> PKHBT gives L1:L0, PKHTB gives R1:R0. */
+    for (; (i + 2u) <= pairs; i += 2u)
+    {
+        uint32_t w0, w1;
+        memcpy(&w0, &lr[2u * i], sizeof(w0));
+        memcpy(&w1, &lr[2u * i + 2u], sizeof(w1));
+        uint32_t l = __PKHBT(w0, w1, 16);
+        uint32_t r = __PKHTB(w1, w0, 16);
+        memcpy(&left[i], &l, sizeof(l));
+        memcpy(&right[i], &r, sizeof(r));
+    }
+    pcm_deinterleave_scalar(&lr[2u * i], pairs - i, &left[i], &right[i]);
+}
+#endif
+
+#if defined(__SSE2__)
+void pcm_deinterleave_sse2(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right)
+{
+    size_t i = 0;
+
+    /* Eight pairs per step: the low halves of each 32-bit lane are left,
+     * the high halves right; sign-extend both and pack back to 16 bit. */
+    for (; (i + 8u) <= pairs; i += 8u)
+    {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)&lr[2u * i]);
+        __m128i v1 = _mm_loadu_si128((const __m128i *)&lr[2u * i + 8u]);
+        __m128i l = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(v0, 16), 16),
+                                    _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16));
+        __m128i r = _mm_packs_epi32(_mm_srai_epi32(v0, 16), _mm_srai_epi32(v1, 16));
+        _mm_storeu_si128((__m128i *)&left[i], l);
+        _mm_storeu_si128((__m128i *)&right[i], r);
+    }
+    pcm_deinterleave_scalar(&lr[2u * i], pairs - i, &left[i], &right[i]);
+}
+#endif
+
+void pcm_deinterleave(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    pcm_deinterleave_dsp(lr, pairs, left, right);
+#elif defined(__SSE2__)
+    pcm_deinterleave_sse2(lr, pairs, left, right);
+#else
+    pcm_deinterleave_scalar(lr, pairs, left, right);
+#endif
+}
+
+void pcm_stereo_metrics(const int16_t *left, const int16_t *right, size_t n,
+                        pcm_stereo_metrics_t *out)
+{
+    sl_frame_level_t lvl;
+
+    sl_frame_level(left, n, &lvl);
+    out->left_dbfs_cdb = lvl.dbfs_cdb;
+    sl_frame_level(right, n, &lvl);
+    out->right_dbfs_cdb = lvl.dbfs_cdb;
+    out->ild_cdb = out->left_dbfs_cdb - out->right_dbfs_cdb;
+
+    sl_moments_t m = { 0, 0u };
+    for (size_t i = 0; i < n; ++i)
+    {
+        int32_t s = ((int32_t)left[i] - right[i]) / 2;
+        m.sum += s;
+        m.sum_sq += (uint32_t)(s * s);
+    }
+    sl_level_from_moments(&m, n, &lvl);
+    out->side_dbfs_cdb = lvl.dbfs_cdb;
+}
@@ -0,0 +1,45 @@
+/******************************************************************************
+* File Name:   pcm_stereo.h
+*
+* Description: Stereo helpers for the dual-mic PDM mode: split interleaved
+*              L/R frames into planar per-channel buffers, and an optional
+*              inter-channel level metric. The de-interleave kernel has a
+*              Cortex-M4 path (PKHBT/PKHTB, two pairs per step), an SSE2
+*              path for host builds and a portable scalar reference.
+*
+*******************************************************************************/
+
+#ifndef PCM_STEREO_H_
+#define PCM_STEREO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int32_t left_dbfs_cdb;
+    int32_t right_dbfs_cdb;
+    int32_t ild_cdb;            /* left minus right, centi-dB */
+    int32_t side_dbfs_cdb;      /* level of (L - R) / 2, low for a centred source */
+} pcm_stereo_metrics_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* lr holds pairs L0 R0 L1 R1 ...; left and right receive pairs samples each. */
+void pcm_deinterleave_scalar(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right);
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+void pcm_deinterleave_dsp(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right);
+#endif
+#if defined(__SSE2__)
+void pcm_deinterleave_sse2(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right);
+#endif
+void pcm_deinterleave(const int16_t *lr, size_t pairs, int16_t *left, int16_t *right);
+
+void pcm_stereo_metrics(const int16_t *left, const int16_t *right, size_t n,
+                        pcm_stereo_metrics_t *out);
+
+#endif /* PCM_STEREO_H_ */
@@ -0,0 +1,135 @@
+/******************************************************************************
+* File Name:   sound_event.c
+*
+* Description: Sound event detector, see sound_event.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "sound_event.h"
+#include "sound_level.h"
+
+void se_default_cfg(se_cfg_t *cfg)
+{
+    cfg->threshold_cdb    = 1500;   /* 15 dB above the floor */
+    cfg->zcr_min          = 4;      /* ~125 Hz: ignore hum and wind thumps */
+    cfg->zcr_max          = 192;    /* ~6 kHz: ignore hiss and clicks */
+    cfg->attack_frames    = 2;
+    cfg->floor_rise_shift = 7;      /* ~2 s at 16 ms frames */
+    cfg->floor_fall_shift = 3;
+    cfg->floor_loud_shift = 9;      /* ~8 s: a burst barely moves it */
+    cfg->post_frames      = 46;     /* with 16 pre frames: 62 frames, ~1 s */
+}
+
+bool se_init(se_detector_t *d, const se_cfg_t *cfg, size_t frame_samples,
+             se_clip_cb_t sink, void *sink_arg)
+{
+    if ((frame_samples == 0u) || (frame_samples > SE_FRAME_MAX) ||
+        (cfg->post_frames == 0u) || (cfg->attack_frames == 0u) || (sink == NULL))
+    {
+        return false;
+    }
+    memset(d, 0, sizeof(*d));
+    d->cfg = *cfg;
+    d->frame_samples = frame_samples;
+    d->sink = sink;
+    d->sink_arg = sink_arg;
+    return true;
+}
+
+static uint16_t zero_crossings(const int16_t *x, size_t n, int32_t mean)
+{
+    uint32_t zc = 0u;
+    bool pos = (x[0] >= mean);
+    for (size_t i = 1; i < n; ++i)
+    {
+        bool p = (x[i] >= mean);
+        zc += (p != pos) ? 1u : 0u;
+        pos = p;
+    }
+    return (uint16_t)zc;
+}
+
+static void track_floor(se_detector_t *d, int32_t dbfs_cdb, bool loud)
+{
+    int32_t target = dbfs_cdb * 16;
+    if (!d->floor_valid)
+    {
+        d->floor_cdb_q4 = target;
+        d->floor_valid = true;
+        return;
+    }
+    int32_t diff = target - d->floor_cdb_q4;
+    uint8_t shift = (diff <= 0) ? d->cfg.floor_fall_shift :
+                    (loud ? d->cfg.floor_loud_shift : d->cfg.floor_rise_shift);
+    d->floor_cdb_q4 += diff / (1 << shift);
+}
+
+static void deliver(se_detector_t *d, const int16_t *frame)
+{
+    d->sink(frame, d->frame_samples, d->clip_index++, d->clip_total, d->sink_arg);
+}
+
+se_event_t se_push(se_detector_t *d, const int16_t *frame)
+{
+    const size_t n = d->frame_samples;
+
+    sl_moments_t m;
+    sl_frame_level_t lvl;
+    sl_moments(frame, n, &m);
+    sl_level_from_moments(&m, n, &lvl);
+    d->last_dbfs_cdb = lvl.dbfs_cdb;
+    d->last_zcr = zero_crossings(frame, n, (int32_t)(m.sum / (int64_t)n));
+
+    /* During a clip frames go straight to the sink and count as loud for
+     * the floor. */
+    if (d->capturing)
+    {
+        track_floor(d, lvl.dbfs_cdb, true);
+        deliver(d, frame);
+        if (d->clip_index < d->clip_total)
+        {
+            return SE_EVENT_NONE;
+        }
+        d->capturing = false;
+        d->pre_count = 0u;
+        d->loud_run = 0u;
+        return SE_EVENT_END;
+    }
+
+    memcpy(d->pre[d->pre_head], frame, n * sizeof(int16_t));
+    d->pre_head = (d->pre_head + 1u) % SE_PRE_FRAMES;
+    if (d->pre_count < SE_PRE_FRAMES)
+    {
+        d->pre_count++;
+    }
+
+    bool loud = d->floor_valid &&
+                (lvl.dbfs_cdb > se_floor_cdb(d) + d->cfg.threshold_cdb) &&
+                (d->last_zcr >= d->cfg.zcr_min) && (d->last_zcr <= d->cfg.zcr_max);
+    track_floor(d, lvl.dbfs_cdb, loud);
+    if (!loud)
+    {
+        d->loud_run = 0u;
+        return SE_EVENT_NONE;
+    }
+    if (++d->loud_run < d->cfg.attack_frames)
+    {
+        return SE_EVENT_NONE;
+    }
+
+    /* Trigger: flush the history oldest first (it ends with this frame),
+     * then keep forwarding until post_frames more have gone out. */
+    d->capturing = true;
+    d->clips++;
+    d->clip_index = 0u;
+    d->clip_total = d->pre_count + d->cfg.post_frames;
+
+    uint32_t slot = (d->pre_head + SE_PRE_FRAMES - d->pre_count) % SE_PRE_FRAMES;
+    for (uint32_t i = 0u; i < d->pre_count; ++i)
+    {
+        deliver(d, d->pre[slot]);
+        slot = (slot + 1u) % SE_PRE_FRAMES;
+    }
+    return SE_EVENT_START;
+}
@@ -0,0 +1,101 @@
+/******************************************************************************
+* File Name:   sound_event.h
+*
+* Description: Sound event detector with a pre-trigger buffer. Every frame
+*              is measured (AC level and zero crossings) against an adaptive
+*              noise floor and copied into a circular buffer of the last
+*              SE_PRE_FRAMES frames. When the level stays above the floor
+*              for a few frames and the crossing rate is in range, the
+*              buffered frames and the next post_frames frames are handed to
+*              a sink callback in order, as one fixed-length clip. Loud
+*              frames still pull the floor up, only much slower, so a sound
+*              that stays on becomes the new floor instead of triggering
+*              clip after clip.
+*
+*******************************************************************************/
+
+#ifndef SOUND_EVENT_H_
+#define SOUND_EVENT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Pre-trigger history: 16 x 256 samples is 256 ms at 16 kHz, 8 KB. */
+#ifndef SE_PRE_FRAMES
+#define SE_PRE_FRAMES                     (16u)
+#endif
+#define SE_FRAME_MAX                      (256u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int32_t  threshold_cdb;     /* trigger level above the noise floor */
+    uint16_t zcr_min;           /* accepted zero crossings per frame */
+    uint16_t zcr_max;
+    uint8_t  attack_frames;     /* consecutive loud frames to trigger */
+    uint8_t  floor_rise_shift;  /* floor tracks up by 1/2^n per frame */
+    uint8_t  floor_fall_shift;  /* and down by 1/2^n */
+    uint8_t  floor_loud_shift;  /* and up by 1/2^n on loud frames */
+    uint16_t post_frames;       /* frames forwarded after the trigger frame */
+} se_cfg_t;
+
+typedef enum
+{
+    SE_EVENT_NONE = 0,
+    SE_EVENT_START,             /* clip started, pre-trigger frames delivered */
+    SE_EVENT_END                /* last frame of the clip delivered */
+} se_event_t;
+
+/* Clip sink: called with the frames of a clip in order, index 0 .. total-1.
+ * Runs in the caller's context of se_push(), up to SE_PRE_FRAMES + 1 times
+ * for the trigger frame. */
+typedef void (*se_clip_cb_t)(const int16_t *frame, size_t n, uint32_t index,
+                             uint32_t total, void *arg);
+
+typedef struct
+{
+    se_cfg_t      cfg;
+    size_t        frame_samples;
+    se_clip_cb_t  sink;
+    void         *sink_arg;
+
+    int16_t       pre[SE_PRE_FRAMES][SE_FRAME_MAX];
+    uint32_t      pre_head;         /* next slot to write */
+    uint32_t      pre_count;
+
+    int32_t       floor_cdb_q4;     /* noise floor, centi-dBFS in Q4 */
+    bool          floor_valid;
+    uint32_t      loud_run;
+
+    bool          capturing;
+    uint32_t      clip_index;
+    uint32_t      clip_total;
+    uint32_t      clips;
+
+    int32_t       last_dbfs_cdb;    /* last frame, for reporting */
+    uint16_t      last_zcr;
+} se_detector_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void se_default_cfg(se_cfg_t *cfg);
+
+bool se_init(se_detector_t *d, const se_cfg_t *cfg, size_t frame_samples,
+             se_clip_cb_t sink, void *sink_arg);
+
+/* Feed one frame; the frame is copied, the caller keeps ownership. */
+se_event_t se_push(se_detector_t *d, const int16_t *frame);
+
+static inline int32_t se_floor_cdb(const se_detector_t *d)
+{
+    return d->floor_cdb_q4 / 16;
+}
+
+#endif /* SOUND_EVENT_H_ */
@@ -0,0 +1,284 @@
+/******************************************************************************
+* File Name:   sound_level.c
+*
+* Description: Sound level engine, see sound_level.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "sound_level.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#endif
+#if defined(__SSE2__) || defined(SL_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+
+/* 10*log10(2) in centi-dB, scaled by 100. */
+#define CDB_PER_OCTAVE_X100     (30103)
+
+/* Adds samples i..n-1 to m. Also inlined into the vector paths for their
+ * tails, so the tail is built for the same instruction set as the loop. */
+static inline __attribute__((always_inline)) void moments_loop(const int16_t *x, size_t i, size_t n,
+                                                               sl_moments_t *m)
+{
+    int64_t sum = 0;
+    uint64_t sum_sq = 0;
+    for (; i < n; ++i)
+    {
+        int32_t v = x[i];
+        sum += v;
+        sum_sq += (uint32_t)(v * v);
+    }
+    m->sum += sum;
+    m->sum_sq += sum_sq;
+}
+
+void sl_moments_scalar(const int16_t *x, size_t n, sl_moments_t *m)
+{
+    m->sum = 0;
+    m->sum_sq = 0u;
+    moments_loop(x, 0u, n, m);
+}
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+void sl_moments_dsp(const int16_t *x, size_t n, sl_moments_t *m)
+{
+    uint64_t sum = 0;
+    uint64_t sum_sq = 0;
+    size_t i = 0;
+
+    /* Two samples per word: SMLALD does lo*lo + hi*hi into a 64-bit
+     * accumulator, and against 0x00010001 it sums the pair. */
+    for (; (i + 2u) <= n; i += 2u)
+    {
+        uint32_t w;
+        memcpy(&w, &x[i], sizeof(w));
+        sum_sq = __SMLALD(w, w, sum_sq);
+        sum = __SMLALD(w, 0x00010001u, sum);
+    }
+
+    m->sum = (int64_t)sum;
+    m->sum_sq = sum_sq;
+    if (i < n)
+    {
+        int32_t v = x[i];
+        m->sum += v;
+        m->sum_sq += (uint32_t)(v * v);
+    }
+}
+#endif
+
+#if defined(__SSE2__)
+void sl_moments_sse2(const int16_t *x, size_t n, sl_moments_t *m)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc_sum = zero;
+    __m128i acc_sq = zero;
+    size_t i = 0;
+
+    for (; (i + 8u) <= n; i += 8u)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)&x[i]);
+
+        /* Pairwise x0^2 + x1^2 is at most 2^31, so it fits unsigned 32 bit;
+         * widen with zeros into 64-bit lanes. */
+        __m128i sq = _mm_madd_epi16(v, v);
+        acc_sq = _mm_add_epi64(acc_sq, _mm_unpacklo_epi32(sq, zero));
+        acc_sq = _mm_add_epi64(acc_sq, _mm_unpackhi_epi32(sq, zero));
+
+        /* Pairwise sums are signed, sign-extend into 64-bit lanes. */
+        __m128i s = _mm_madd_epi16(v, ones);
+        __m128i sign = _mm_srai_epi32(s, 31);
+        acc_sum = _mm_add_epi64(acc_sum, _mm_unpacklo_epi32(s, sign));
+        acc_sum = _mm_add_epi64(acc_sum, _mm_unpackhi_epi32(s, sign));
+    }
+
+    uint64_t lanes_sq[2];
+    int64_t lanes_sum[2];
+    _mm_storeu_si128((__m128i *)lanes_sq, acc_sq);
+    _mm_storeu_si128((__m128i *)lanes_sum, acc_sum);
+
+    m->sum = lanes_sum[0] + lanes_sum[1];
+    m->sum_sq = lanes_sq[0] + lanes_sq[1];
+    moments_loop(x, i, n, m);
+}
+#endif
+
+#if defined(SL_HAVE_AVX2)
+#define AVX2 __attribute__((target("avx2")))
+
+bool sl_avx2_ok(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+/* As the SSE2 path on 16 samples per step */
+AVX2 void sl_moments_avx2(const int16_t *x, size_t n, sl_moments_t *m)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc_sum = zero;
+    __m256i acc_sq = zero;
+    size_t i = 0;
+
+    for (; (i + 16u) <= n; i += 16u)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)&x[i]);
+
+        __m256i sq = _mm256_madd_epi16(v, v);
+        acc_sq = _mm256_add_epi64(acc_sq, _mm256_unpacklo_epi32(sq, zero));
+        acc_sq = _mm256_add_epi64(acc_sq, _mm256_unpackhi_epi32(sq, zero));
+
+        __m256i s = _mm256_madd_epi16(v, ones);
+        __m256i sign = _mm256_srai_epi32(s, 31);
+        acc_sum = _mm256_add_epi64(acc_sum, _mm256_unpacklo_epi32(s, sign));
+        acc_sum = _mm256_add_epi64(acc_sum, _mm256_unpackhi_epi32(s, sign));
+    }
+
+    uint64_t lanes_sq[4];
+    int64_t lanes_sum[4];
+    _mm256_storeu_si256((__m256i *)lanes_sq, acc_sq);
+    _mm256_storeu_si256((__m256i *)lanes_sum, acc_sum);
+
+    m->sum = lanes_sum[0] + lanes_sum[1] + lanes_sum[2] + lanes_sum[3];
+    m->sum_sq = lanes_sq[0] + lanes_sq[1] + lanes_sq[2] + lanes_sq[3];
+    moments_loop(x, i, n, m);
+}
+#endif
+
+void sl_moments(const int16_t *x, size_t n, sl_moments_t *m)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    sl_moments_dsp(x, n, m);
+#else
+#if defined(SL_HAVE_AVX2)
+    if (sl_avx2_ok())
+    {
+        sl_moments_avx2(x, n, m);
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    sl_moments_sse2(x, n, m);
+#else
+    sl_moments_scalar(x, n, m);
+#endif
+#endif
+}
+
+uint32_t sl_isqrt64(uint64_t v)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ull << 62;
+
+    while (bit > v)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0u)
+    {
+        if (v >= res + bit)
+        {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else
+        {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+/* log2(v) in Q16, v >= 1. */
+static uint32_t log2_q16(uint64_t v)
+{
+    uint32_t ip = 63u;
+    while ((v >> ip) == 0u)
+    {
+        ip--;
+    }
+
+    /* Mantissa in Q31, [1, 2); square once per fraction bit. */
+    uint64_t mant = (ip >= 31u) ? (v >> (ip - 31u)) : (v << (31u - ip));
+    uint32_t fp = 0u;
+    for (uint32_t bit = 1u << 15; bit != 0u; bit >>= 1)
+    {
+        mant = mant * mant;
+        if (mant >= (1ull << 63))
+        {
+            mant >>= 32;
+            fp |= bit;
+        }
+        else
+        {
+            mant >>= 31;
+        }
+    }
+    return (ip << 16) | fp;
+}
+
+int32_t sl_ms_to_dbfs_cdb(uint64_t ms)
+{
+    if (ms == 0u)
+    {
+        return SL_DB_FLOOR_CDB;
+    }
+
+    /* Full scale is 32768^2 = 2^30. */
+    int64_t l = (int64_t)log2_q16(ms) - ((int64_t)30 << 16);
+    int32_t cdb = (int32_t)((l * CDB_PER_OCTAVE_X100) / (100 * 65536));
+    return (cdb < SL_DB_FLOOR_CDB) ? SL_DB_FLOOR_CDB : cdb;
+}
+
+void sl_frame_level(const int16_t *x, size_t n, sl_frame_level_t *out)
+{
+    sl_moments_t m;
+    sl_moments(x, n, &m);
+    sl_level_from_moments(&m, n, out);
+}
+
+void sl_level_from_moments(const sl_moments_t *m, size_t n, sl_frame_level_t *out)
+{
+    /* AC mean square: (n * sum_sq - sum^2) / n^2. */
+    uint64_t nn = (uint64_t)n * n;
+    uint64_t num = (uint64_t)n * m->sum_sq - (uint64_t)(m->sum * m->sum);
+    uint32_t ms = (uint32_t)(num / nn);
+
+    out->ms = ms;
+    out->rms = sl_isqrt64(ms);
+    out->dbfs_cdb = sl_ms_to_dbfs_cdb(ms);
+}
+
+void sl_leq_init(sl_leq_t *leq)
+{
+    memset(leq, 0, sizeof(*leq));
+}
+
+void sl_leq_push(sl_leq_t *leq, uint32_t frame_ms)
+{
+    if (leq->count == SL_LEQ_WINDOW_FRAMES)
+    {
+        leq->ms_sum -= leq->ms[leq->idx];
+    }
+    else
+    {
+        leq->count++;
+    }
+    leq->ms[leq->idx] = frame_ms;
+    leq->ms_sum += frame_ms;
+    leq->idx = (leq->idx + 1u) % SL_LEQ_WINDOW_FRAMES;
+}
+
+int32_t sl_leq_dbfs_cdb(const sl_leq_t *leq)
+{
+    if (leq->count == 0u)
+    {
+        return SL_DB_FLOOR_CDB;
+    }
+    return sl_ms_to_dbfs_cdb(leq->ms_sum / leq->count);
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name:   sound_level.h
+*
+* Description: Sound level engine for 16-bit PCM frames: per-frame RMS and
+*              dBFS, and a rolling Leq over a fixed number of frames.
+*              The inner kernel is a sum and sum of squares, implemented with
+*              dual 16-bit MACs (SMLALD) on Cortex-M4, SSE2 and AVX2 (runtime
+*              choice) on host builds and a portable scalar reference. All
+*              are integer and bit-exact.
+*
+*******************************************************************************/
+
+#ifndef SOUND_LEVEL_H_
+#define SOUND_LEVEL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Leq window in frames: 625 x 256 samples at 16 kHz is the 10 s upload period. */
+#ifndef SL_LEQ_WINDOW_FRAMES
+#define SL_LEQ_WINDOW_FRAMES              (625u)
+#endif
+
+/* dBFS -> dB SPL offset in centi-dB: 94 dB SPL minus the mic sensitivity in
+ * dBFS (IM69D130: -36 dBFS) minus the PDM gain (12 dB). */
+#ifndef SL_SPL_OFFSET_CDB
+#define SL_SPL_OFFSET_CDB                 (9400 + 3600 - 1200)
+#endif
+
+/* Level reported for digital silence. */
+#define SL_DB_FLOOR_CDB                   (-12000)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SL_HAVE_AVX2                      (1)
+#endif
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int64_t  sum;           /* sum of samples */
+    uint64_t sum_sq;        /* sum of squared samples */
+} sl_moments_t;
+
+typedef struct
+{
+    uint32_t rms;           /* AC RMS in LSB */
+    int32_t  dbfs_cdb;      /* AC level in centi-dBFS */
+    uint32_t ms;            /* AC mean square, LSB^2 */
+} sl_frame_level_t;
+
+typedef struct
+{
+    uint32_t ms[SL_LEQ_WINDOW_FRAMES];
+    uint64_t ms_sum;
+    uint32_t idx;
+    uint32_t count;
+} sl_leq_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Kernels. sl_moments() dispatches to the fastest one built in. */
+void sl_moments_scalar(const int16_t *x, size_t n, sl_moments_t *m);
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+void sl_moments_dsp(const int16_t *x, size_t n, sl_moments_t *m);
+#endif
+#if defined(__SSE2__)
+void sl_moments_sse2(const int16_t *x, size_t n, sl_moments_t *m);
+#endif
+#if defined(SL_HAVE_AVX2)
+/* Only call this if sl_avx2_ok() */
+bool sl_avx2_ok(void);
+void sl_moments_avx2(const int16_t *x, size_t n, sl_moments_t *m);
+#endif
+void sl_moments(const int16_t *x, size_t n, sl_moments_t *m);
+
+/* RMS and dBFS of one frame, DC removed. */
+void sl_frame_level(const int16_t *x, size_t n, sl_frame_level_t *out);
+/* Same, for callers that already have the moments of the frame. */
+void sl_level_from_moments(const sl_moments_t *m, size_t n, sl_frame_level_t *out);
+
+/* 10*log10(ms / 32768^2) in centi-dB. */
+int32_t sl_ms_to_dbfs_cdb(uint64_t ms);
+
+uint32_t sl_isqrt64(uint64_t v);
+
+void sl_leq_init(sl_leq_t *leq);
+void sl_leq_push(sl_leq_t *leq, uint32_t frame_ms);
+/* Equivalent continuous level over the frames in the window, centi-dBFS. */
+int32_t sl_leq_dbfs_cdb(const sl_leq_t *leq);
+
+#endif /* SOUND_LEVEL_H_ */
@@ -0,0 +1,186 @@
+/******************************************************************************
+* File Name:   telemetry.c
+*
+* Description: Binary telemetry framing and TX ring, see telemetry.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "telemetry.h"
+
+#if defined(CY_USING_HAL)
+#include "cyhal_system.h"
+#define TLM_CRITICAL_ENTER(st)  ((st) = cyhal_system_critical_section_enter())
+#define TLM_CRITICAL_EXIT(st)   cyhal_system_critical_section_exit(st)
+#else
+/* Host ports complete writes from the caller's thread. */
+#define TLM_CRITICAL_ENTER(st)  ((st) = 0u)
+#define TLM_CRITICAL_EXIT(st)   ((void)(st))
+#endif
+
+#define RING_MASK   (TLM_RING_BYTES - 1u)
+
+_Static_assert((TLM_RING_BYTES & RING_MASK) == 0u, "TLM_RING_BYTES must be a power of two");
+_Static_assert(sizeof(tlm_level_t) == 16u, "tlm_level_t layout");
+_Static_assert(sizeof(tlm_bands_t) == 18u, "tlm_bands_t layout");
+_Static_assert(sizeof(tlm_event_t) == 6u, "tlm_event_t layout");
+_Static_assert(sizeof(tlm_clip_t) == 12u, "tlm_clip_t layout");
+_Static_assert(sizeof(tlm_stereo_t) == 8u, "tlm_stereo_t layout");
+
+/* CRC-16/CCITT-FALSE (poly 0x1021), a nibble at a time. */
+static const uint16_t crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t tlm_crc16(const uint8_t *p, size_t n, uint16_t crc)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (p[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (p[i] & 0x0Fu)]);
+    }
+    return crc;
+}
+
+size_t tlm_cobs_encode(const uint8_t *src, size_t n, uint8_t *dst)
+{
+    size_t code_pos = 0u;
+    size_t out = 1u;
+    uint8_t code = 1u;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (src[i] != 0u)
+        {
+            dst[out++] = src[i];
+            code++;
+        }
+        if ((src[i] == 0u) || (code == 0xFFu))
+        {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1u;
+        }
+    }
+    dst[code_pos] = code;
+    return out;
+}
+
+/* Starts the next contiguous chunk if there is one. Caller holds off the
+ * TX interrupt (or is it) and busy is false. */
+static void start_chunk(tlm_t *t)
+{
+    unsigned tail = atomic_load_explicit(&t->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&t->head, memory_order_acquire);
+    if (head == tail)
+    {
+        return;
+    }
+
+    size_t off = tail & RING_MASK;
+    size_t len = head - tail;
+    if (len > (TLM_RING_BYTES - off))
+    {
+        len = TLM_RING_BYTES - off;
+    }
+
+    t->inflight = len;
+    t->busy = true;
+    if (!t->start(&t->ring[off], len, t->ctx))
+    {
+        /* Drop the chunk rather than wedge the ring. */
+        t->errors++;
+        t->busy = false;
+        atomic_store_explicit(&t->tail, tail + (unsigned)len, memory_order_release);
+    }
+}
+
+void tlm_init(tlm_t *t, tlm_tx_start_t start, void *ctx)
+{
+    t->start = start;
+    t->ctx = ctx;
+    t->busy = false;
+    t->inflight = 0u;
+    t->seq = 0u;
+    t->records = 0u;
+    t->drops = 0u;
+    t->errors = 0u;
+    /* Leading delimiter, so the reader can sync on the very first record. */
+    t->ring[0] = 0u;
+    atomic_init(&t->head, 1u);
+    atomic_init(&t->tail, 0u);
+}
+
+bool tlm_send(tlm_t *t, uint8_t type, uint8_t sensor_id, uint32_t ts_ms,
+              const void *payload, size_t len)
+{
+    uint8_t raw[TLM_RAW_MAX];
+    uint8_t frame[TLM_FRAME_MAX];
+
+    if (len > TLM_PAYLOAD_MAX)
+    {
+        t->drops++;
+        return false;
+    }
+
+    raw[0] = type;
+    raw[1] = sensor_id;
+    raw[2] = t->seq++;
+    raw[3] = (uint8_t)ts_ms;
+    raw[4] = (uint8_t)(ts_ms >> 8);
+    raw[5] = (uint8_t)(ts_ms >> 16);
+    raw[6] = (uint8_t)(ts_ms >> 24);
+    if (len > 0u)
+    {
+        memcpy(&raw[TLM_HEADER_BYTES], payload, len);
+    }
+    size_t n = TLM_HEADER_BYTES + len;
+    uint16_t crc = tlm_crc16(raw, n, 0xFFFFu);
+    raw[n++] = (uint8_t)crc;
+    raw[n++] = (uint8_t)(crc >> 8);
+
+    size_t flen = tlm_cobs_encode(raw, n, frame);
+    frame[flen++] = 0u;
+
+    /* All or nothing: a partial frame would corrupt the next one too. */
+    unsigned head = atomic_load_explicit(&t->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&t->tail, memory_order_acquire);
+    if ((TLM_RING_BYTES - (head - tail)) < flen)
+    {
+        t->drops++;
+        return false;
+    }
+
+    size_t off = head & RING_MASK;
+    size_t first = TLM_RING_BYTES - off;
+    if (first >= flen)
+    {
+        memcpy(&t->ring[off], frame, flen);
+    }
+    else
+    {
+        memcpy(&t->ring[off], frame, first);
+        memcpy(t->ring, &frame[first], flen - first);
+    }
+    atomic_store_explicit(&t->head, head + (unsigned)flen, memory_order_release);
+    t->records++;
+
+    uint32_t irq;
+    TLM_CRITICAL_ENTER(irq);
+    if (!t->busy)
+    {
+        start_chunk(t);
+    }
+    TLM_CRITICAL_EXIT(irq);
+    return true;
+}
+
+void tlm_tx_done(tlm_t *t)
+{
+    unsigned tail = atomic_load_explicit(&t->tail, memory_order_relaxed);
+    atomic_store_explicit(&t->tail, tail + (unsigned)t->inflight, memory_order_release);
+    t->inflight = 0u;
+    t->busy = false;
+    start_chunk(t);
+}
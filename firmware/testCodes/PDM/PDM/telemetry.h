@@ -0,0 +1,131 @@
+/******************************************************************************
+* File Name:   telemetry.h
+*
+* Description: Binary telemetry over the debug UART. Each record is
+*                type (u8), sensor id (u8), sequence (u8), timestamp ms (u32),
+*                payload (0..TLM_PAYLOAD_MAX bytes), CRC-16/CCITT (u16)
+*              all little endian, COBS-encoded and terminated by a 0x00 byte,
+*              so a reader can resync on any zero. Records are queued in a
+*              byte ring and sent with async UART writes from the TX-done
+*              interrupt; tlm_send() never blocks and drops the record when
+*              the ring is full.
+*
+*              Record types and payload layouts below are mirrored in
+*              firmware/tools/tlm_decode.py; keep the two in sync.
+*
+*******************************************************************************/
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* TX ring size, a power of two. About 180 ms of line time at 115200 baud. */
+#ifndef TLM_RING_BYTES
+#define TLM_RING_BYTES                    (2048u)
+#endif
+
+#define TLM_PAYLOAD_MAX                   (64u)
+#define TLM_HEADER_BYTES                  (7u)
+#define TLM_CRC_BYTES                     (2u)
+#define TLM_RAW_MAX                       (TLM_HEADER_BYTES + TLM_PAYLOAD_MAX + TLM_CRC_BYTES)
+/* COBS adds one byte per 254 plus one, then the 0x00 delimiter. */
+#define TLM_FRAME_MAX                     (TLM_RAW_MAX + (TLM_RAW_MAX / 254u) + 2u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef enum
+{
+    TLM_REC_TEXT   = 0,     /* free text, payload is ASCII without terminator */
+    TLM_REC_LEVEL  = 1,     /* tlm_level_t */
+    TLM_REC_BANDS  = 2,     /* tlm_bands_t */
+    TLM_REC_EVENT  = 3,     /* tlm_event_t */
+    TLM_REC_CLIP   = 4,     /* tlm_clip_t */
+    TLM_REC_STEREO = 5      /* tlm_stereo_t */
+} tlm_record_t;
+
+/* Payloads: fixed layouts without padding, sent as-is (both the M4 and the
+ * host are little endian). Levels are in centi-dB. */
+typedef struct
+{
+    int16_t  level_cdb;     /* frame level, dB SPL (weighted) */
+    int16_t  leq_cdb;       /* rolling Leq, dB SPL (weighted) */
+    uint16_t rms;
+    uint8_t  weighting;     /* wt_curve_t */
+    uint8_t  reserved;      /* 0 */
+    uint32_t overruns;      /* ring overruns since boot */
+    uint32_t cycles;        /* processing cycles for this frame */
+} tlm_level_t;
+
+typedef struct
+{
+    int16_t  band_cdb[8];   /* dBFS, 63 Hz .. 8 kHz octaves */
+    uint16_t frames;
+} tlm_bands_t;
+
+typedef struct
+{
+    int16_t  above_floor_cdb;
+    int16_t  floor_cdb;     /* dBFS */
+    uint16_t zcr;
+} tlm_event_t;
+
+typedef struct
+{
+    uint32_t clip;
+    uint16_t frames;
+    uint16_t peak;
+    uint32_t bytes;         /* ADPCM size */
+} tlm_clip_t;
+
+typedef struct
+{
+    int16_t  left_cdb;      /* dBFS */
+    int16_t  right_cdb;
+    int16_t  ild_cdb;
+    int16_t  side_cdb;
+} tlm_stereo_t;
+
+/* Starts an async write of len bytes. Completion must be reported with
+ * tlm_tx_done(), possibly from inside this call. */
+typedef bool (*tlm_tx_start_t)(const uint8_t *buf, size_t len, void *ctx);
+
+typedef struct
+{
+    uint8_t          ring[TLM_RING_BYTES];
+    atomic_uint      head;          /* bytes queued, written by tlm_send() */
+    atomic_uint      tail;          /* bytes sent, written on TX done */
+    volatile bool    busy;          /* a write is in flight */
+    size_t           inflight;
+    tlm_tx_start_t   start;
+    void            *ctx;
+    uint8_t          seq;
+    uint32_t         records;
+    uint32_t         drops;         /* ring full */
+    uint32_t         errors;        /* write could not be started */
+} tlm_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void tlm_init(tlm_t *t, tlm_tx_start_t start, void *ctx);
+
+/* Frames and queues one record; false if it was dropped. Main loop only. */
+bool tlm_send(tlm_t *t, uint8_t type, uint8_t sensor_id, uint32_t ts_ms,
+              const void *payload, size_t len);
+
+/* Called from the TX-done interrupt: frees the sent bytes, starts the next. */
+void tlm_tx_done(tlm_t *t);
+
+/* Building blocks, also used by host tools. */
+uint16_t tlm_crc16(const uint8_t *p, size_t n, uint16_t crc);
+size_t tlm_cobs_encode(const uint8_t *src, size_t n, uint8_t *dst);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,116 @@
+/******************************************************************************
+* File Name:   weighting.c
+*
+* Description: A/C weighting biquad cascade, see weighting.h.
+*
+*              Coefficients: the IEC 61672 analog poles at 20.6 Hz (x2) and
+*              107.7 + 737.9 Hz, each pair with its zeros at DC, mapped with
+*              the bilinear transform at 16 kHz. The 12194 Hz pole pair lies
+*              above Nyquist and the bilinear transform would fold it onto
+*              zeros at 8 kHz, rolling off from ~4 kHz (A: -5.8 dB at 6.3 kHz
+*              instead of -0.1 dB). It is replaced by one biquad without
+*              Nyquist zeros, least-squares fitted in dB to the remaining
+*              error of the analog curve from 100 Hz to 7.6 kHz. Each section
+*              is normalised to 0 dB at 1 kHz. Designed response: A within
+*              0.11 dB and C within 0.02 dB of the analog curves up to 7.6 kHz;
+*              host/weighting_check.c measures it against IEC 61672.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "weighting.h"
+
+static const wt_biquad_coef_t a_weighting[] = {
+    /*        b0           b1           b2           a1           a2 */
+    {  532774258, -1065548516,   532774258, -1065090673,   528254612 },  /* 20.6 Hz x2 */
+    {  571326567, -1142653134,   571326567,  -915622864,   384379928 },  /* 107.7 + 737.9 Hz */
+    {  475518286,    51638224,   -42837492,   -21142803,   -35964634 },  /* high end, fitted */
+};
+
+static const wt_biquad_coef_t c_weighting[] = {
+    {  532774258, -1065548516,   532774258, -1065090673,   528254612 },  /* 20.6 Hz x2 */
+    {  475770068,   361691109,    43553215,   327955753,    10418237 },  /* high end, fitted */
+};
+
+#define NUM_SECTIONS(t)     (sizeof(t) / sizeof((t)[0]))
+
+static inline int32_t sat32(int64_t v)
+{
+    if (v > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (v < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return (int32_t)v;
+}
+
+void wt_init(wt_filter_t *f, wt_curve_t curve)
+{
+    memset(f, 0, sizeof(*f));
+    f->curve = curve;
+    switch (curve)
+    {
+        case WT_CURVE_A:
+            f->coef = a_weighting;
+            f->num_sections = NUM_SECTIONS(a_weighting);
+            break;
+        case WT_CURVE_C:
+            f->coef = c_weighting;
+            f->num_sections = NUM_SECTIONS(c_weighting);
+            break;
+        default:
+            f->coef = NULL;
+            f->num_sections = 0u;
+            break;
+    }
+}
+
+void wt_process(wt_filter_t *f, int16_t *pcm, size_t n)
+{
+    const size_t ns = f->num_sections;
+    if (ns == 0u)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        int32_t x = (int32_t)pcm[i] << 15;     /* Q15 -> Q30 */
+
+        for (size_t s = 0; s < ns; ++s)
+        {
+            const wt_biquad_coef_t *c = &f->coef[s];
+            wt_biquad_state_t *st = &f->state[s];
+
+            /* Direct form I, Q29 x Q30 products summed in 64 bit. */
+            int64_t acc = (int64_t)c->b0 * x
+                        + (int64_t)c->b1 * st->x1
+                        + (int64_t)c->b2 * st->x2
+                        - (int64_t)c->a1 * st->y1
+                        - (int64_t)c->a2 * st->y2;
+            int32_t y = sat32((acc + (1ll << (WT_COEF_FRAC_BITS - 1u))) >> WT_COEF_FRAC_BITS);
+
+            st->x2 = st->x1;
+            st->x1 = x;
+            st->y2 = st->y1;
+            st->y1 = y;
+            x = y;
+        }
+
+        int32_t out = (x + (1 << 14)) >> 15;  /* Q30 -> Q15 */
+        pcm[i] = (int16_t)((out > INT16_MAX) ? INT16_MAX : ((out < INT16_MIN) ? INT16_MIN : out));
+    }
+}
+
+const char *wt_curve_name(wt_curve_t curve)
+{
+    switch (curve)
+    {
+        case WT_CURVE_A: return "dB(A)";
+        case WT_CURVE_C: return "dB(C)";
+        default:         return "dB(Z)";
+    }
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+* File Name:   weighting.h
+*
+* Description: A- and C-frequency weighting for the 16 kHz PCM stream, as a
+*              fixed-point biquad cascade. Samples are Q15 on the outside and
+*              Q30 between sections (one bit of headroom), coefficients are
+*              Q29, accumulation is 64 bit. Frames are filtered in place.
+*
+*******************************************************************************/
+
+#ifndef WEIGHTING_H_
+#define WEIGHTING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* The coefficient tables are designed for this rate only. */
+#define WT_SAMPLE_RATE_HZ                 (16000u)
+#define WT_MAX_SECTIONS                   (3u)
+#define WT_COEF_FRAC_BITS                 (29u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef enum
+{
+    WT_CURVE_Z = 0,     /* no weighting, pass-through */
+    WT_CURVE_A,
+    WT_CURVE_C
+} wt_curve_t;
+
+typedef struct
+{
+    int32_t b0, b1, b2, a1, a2;     /* Q29, a0 = 1 */
+} wt_biquad_coef_t;
+
+typedef struct
+{
+    int32_t x1, x2, y1, y2;         /* Q30 */
+} wt_biquad_state_t;
+
+typedef struct
+{
+    wt_curve_t               curve;
+    const wt_biquad_coef_t  *coef;
+    size_t                   num_sections;
+    wt_biquad_state_t        state[WT_MAX_SECTIONS];
+} wt_filter_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void wt_init(wt_filter_t *f, wt_curve_t curve);
+
+/* Filters n samples of pcm in place, saturating to int16. */
+void wt_process(wt_filter_t *f, int16_t *pcm, size_t n);
+
+const char *wt_curve_name(wt_curve_t curve);
+
+#endif /* WEIGHTING_H_ */
@@ -0,0 +1,164 @@
+/******************************************************************************
+* File Name:   drift.c
+*
+* Description: RTC drift tracker, see drift.h. The fit runs in double: it is
+*              only done per reference point, and the terms stay small
+*              because offsets are taken against the oldest fitted point.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "drift.h"
+
+#define PPB                 (1000000000ll)
+
+static const dr_point_t *point(const dr_tracker_t *d, uint32_t i)
+{
+    return &d->log[i % DR_LOG_LEN];
+}
+
+static uint32_t oldest(const dr_tracker_t *d)
+{
+    return (d->count > DR_LOG_LEN) ? (d->count - DR_LOG_LEN) : 0u;
+}
+
+/* dt * (1 + ppb) without overflowing for weeks of dt. */
+static int64_t scaled(int64_t dt, int32_t ppb)
+{
+    return dt + (dt / PPB) * ppb + ((dt % PPB) * ppb) / PPB;
+}
+
+/* Least-squares slope of (ref - local) over local, in ppb. False if the
+ * points span too little time or the result is implausible. */
+static bool fit_drift(const dr_tracker_t *d, int32_t *ppb)
+{
+    uint32_t avail = d->count - d->fit_first;
+    uint32_t n = (avail < DR_FIT_POINTS) ? avail : DR_FIT_POINTS;
+    uint32_t first = d->count - n;
+    const dr_point_t *p0 = point(d, first);
+
+    if ((n < 2u) || ((point(d, d->count - 1u)->local_us - p0->local_us) < DR_MIN_SPAN_US))
+    {
+        return false;
+    }
+
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    for (uint32_t i = first; i < d->count; ++i)
+    {
+        const dr_point_t *p = point(d, i);
+        double x = (double)(p->local_us - p0->local_us);
+        double y = (double)((p->ref_us - p->local_us) - (p0->ref_us - p0->local_us));
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double den = (double)n * sxx - sx * sx;
+    if (den <= 0.0)
+    {
+        return false;
+    }
+    double slope = ((double)n * sxy - sx * sy) / den * (double)PPB;
+    if ((slope > (double)DR_MAX_PPB) || (slope < -(double)DR_MAX_PPB))
+    {
+        return false;
+    }
+    *ppb = (int32_t)((slope >= 0.0) ? (slope + 0.5) : (slope - 0.5));
+    return true;
+}
+
+void dr_init(dr_tracker_t *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+int64_t dr_now(const dr_tracker_t *d, int64_t local_us)
+{
+    int64_t dt = local_us - d->base_local_us;
+    int64_t ds = (dt < d->slew_us) ? dt : d->slew_us;
+    if (ds < 0)
+    {
+        ds = 0;
+    }
+    return d->base_us + scaled(dt, d->drift_ppb) + (ds * d->slew_ppb) / PPB;
+}
+
+void dr_reference(dr_tracker_t *d, int64_t local_us, int64_t ref_us)
+{
+    bool first = (d->count == 0u);
+    int64_t corrected = dr_now(d, local_us);
+    int64_t err = ref_us - corrected;
+    bool step = !first && ((err > DR_STEP_LIMIT_US) || (err < -DR_STEP_LIMIT_US));
+
+    dr_point_t *p = &d->log[d->count % DR_LOG_LEN];
+    p->local_us = local_us;
+    p->ref_us = ref_us;
+    if (step)
+    {
+        d->fit_first = d->count;
+    }
+    d->count++;
+
+    int32_t ppb;
+    if (fit_drift(d, &ppb))
+    {
+        d->drift_ppb = ppb;
+    }
+
+    /* Restart the segment here, continuous with what was handed out. */
+    d->base_local_us = local_us;
+    d->slew_us = 0;
+    d->slew_ppb = 0;
+    if (first || step)
+    {
+        d->last_error_us = 0;
+        d->steps += step ? 1u : 0u;
+        d->base_us = ref_us;
+        return;
+    }
+
+    d->last_error_us = (int32_t)err;
+    d->base_us = corrected;
+    if (err != 0)
+    {
+        d->slew_ppb = (err > 0) ? DR_SLEW_PPB : -DR_SLEW_PPB;
+        d->slew_us = ((err > 0) ? err : -err) * PPB / DR_SLEW_PPB;
+    }
+}
+
+int64_t dr_restamp(const dr_tracker_t *d, int64_t local_us)
+{
+    if (d->count == 0u)
+    {
+        return local_us;
+    }
+
+    uint32_t lo = oldest(d);
+    uint32_t last = d->count - 1u;
+    const dr_point_t *a = point(d, lo);
+    if (local_us <= a->local_us)
+    {
+        return a->ref_us + scaled(local_us - a->local_us, d->drift_ppb);
+    }
+
+    for (uint32_t i = lo; i < last; ++i)
+    {
+        a = point(d, i);
+        const dr_point_t *b = point(d, i + 1u);
+        if (local_us <= b->local_us)
+        {
+            /* Only the small offset change is interpolated in double. */
+            int64_t span = b->local_us - a->local_us;
+            int64_t dt = local_us - a->local_us;
+            int64_t doff = (b->ref_us - b->local_us) - (a->ref_us - a->local_us);
+            if (span <= 0)
+            {
+                return b->ref_us;
+            }
+            return a->ref_us + dt + (int64_t)((double)dt * (double)doff / (double)span);
+        }
+    }
+
+    a = point(d, last);
+    return a->ref_us + scaled(local_us - a->local_us, d->drift_ppb);
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+* File Name:   drift.h
+*
+* Description: RTC drift tracker on top of the timestamp service. Reference
+*              points (local ts_now_us() against a server or host clock)
+*              give the crystal error in ppb, fitted by least squares over
+*              the last DR_FIT_POINTS points. The corrected clock runs at
+*              (1 + drift) times the local rate; a phase error found at a
+*              reference is slewed out at DR_SLEW_PPB instead of stepped,
+*              so corrected time stays monotonic. Only errors beyond
+*              DR_STEP_LIMIT_US step; the fit then restarts at the point
+*              that stepped, as earlier points would read the step as rate.
+*
+*              Reference points are kept as a correction log. Records
+*              stored with the raw local stamp are re-stamped on replay by
+*              interpolating between the points around them, which is more
+*              accurate than the live correction was at the time.
+*
+*              No HAL calls; feed it from any context, one at a time.
+*
+*******************************************************************************/
+
+#ifndef DRIFT_H_
+#define DRIFT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define DR_LOG_LEN                        (32u)
+#define DR_FIT_POINTS                     (8u)
+
+/* Points closer together than this carry too little rate information. */
+#define DR_MIN_SPAN_US                    (60ll * 1000000ll)
+
+/* Larger estimates are rejected as bad references, not crystal error. */
+#define DR_MAX_PPB                        (500000)
+
+#define DR_SLEW_PPB                       (500000)
+#define DR_STEP_LIMIT_US                  (2000000)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int64_t local_us;           /* ts_now_us() when the reference arrived */
+    int64_t ref_us;             /* reference epoch us */
+} dr_point_t;
+
+typedef struct
+{
+    dr_point_t log[DR_LOG_LEN]; /* ring, oldest at count - DR_LOG_LEN */
+    uint32_t   count;           /* references seen */
+    uint32_t   fit_first;       /* first point on the current local base */
+
+    /* Live segment: corrected = base_us + dt * (1 + rate) + min(dt, slew_us) * slew */
+    int64_t    base_local_us;
+    int64_t    base_us;
+    int64_t    slew_us;         /* local us until the slew is done */
+    int32_t    slew_ppb;
+    int32_t    drift_ppb;       /* reference minus local rate */
+
+    int32_t    last_error_us;   /* reference minus corrected, at the last point */
+    uint32_t   steps;
+} dr_tracker_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Also after the local clock was stepped (RTC written): old points no longer
+ * apply. */
+void dr_init(dr_tracker_t *d);
+
+/* Adds a reference point and updates drift, phase slew and the log. */
+void dr_reference(dr_tracker_t *d, int64_t local_us, int64_t ref_us);
+
+/* Corrected time for a local stamp taken now (live, monotonic). The local
+ * clock is passed through until the first reference. */
+int64_t dr_now(const dr_tracker_t *d, int64_t local_us);
+
+/* Corrected time for a stored local stamp, from the correction log. */
+int64_t dr_restamp(const dr_tracker_t *d, int64_t local_us);
+
+#endif /* DRIFT_H_ */
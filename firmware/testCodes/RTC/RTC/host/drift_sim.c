@@ -0,0 +1,209 @@
+/******************************************************************************
+* File Name:   drift_sim.c
+*
+* Description: Drifting-clock simulation for drift: a local clock that runs
+*              off the true time by a crystal error (constant, or swinging
+*              with temperature through the day) gets reference points
+*              with network jitter, as main.c takes them from "@<ms>"
+*              input. For every scenario it checks that
+*
+*              - the drift estimate settles near the true crystal error;
+*              - live corrected time (dr_now) is monotonic and stays within
+*                a bound of the true time, far inside the free-running error;
+*              - records re-stamped from the log (dr_restamp) are at least as
+*                accurate as the live correction was;
+*              - a glitch in the local clock beyond DR_STEP_LIMIT_US steps
+*                once and is recovered from;
+*              - a month of hourly references runs without overflow.
+*
+*              Exits non-zero on a failed check.
+*
+*                cc -O2 -I.. -o drift_sim drift_sim.c ../drift.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "drift.h"
+
+#define EPOCH_US            (1792195200ll * 1000000ll)     /* 2026-10-17 */
+#define BOOT_ERROR_US       (1300000ll)     /* RTC set by hand at boot */
+#define SETTLE_REFS         (DR_FIT_POINTS) /* errors counted from here on */
+#define RECORD_EVERY_S      (60u)
+#define MAX_RECORDS         (1u << 16)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static double gauss(void)
+{
+    /* Box-Muller */
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double v = (double)rand() / ((double)RAND_MAX + 1.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+typedef struct
+{
+    const char *name;
+    double      ppm;            /* crystal error */
+    double      temp_ppm;       /* daily swing amplitude */
+    uint32_t    ref_every_s;
+    double      jitter_us;      /* reference error, RMS */
+    double      hours;
+    double      glitch_at_h;    /* local clock loses glitch_us here, 0 = none */
+    double      glitch_us;
+    double      live_bound_us;  /* allowed worst live error after settling */
+} scenario_t;
+
+typedef struct
+{
+    int64_t local_us;
+    int64_t true_us;
+    int64_t live_us;
+    uint32_t refs;              /* references in when it was recorded */
+} record_t;
+
+static double crystal_ppm(const scenario_t *sc, double t_s)
+{
+    return sc->ppm + sc->temp_ppm * sin(2.0 * M_PI * t_s / 86400.0);
+}
+
+static void run(const scenario_t *sc)
+{
+    static record_t rec[MAX_RECORDS];
+    static dr_tracker_t d;
+    uint32_t n_rec = 0u;
+    char line[112];
+
+    srand(17);
+    dr_init(&d);
+
+    /* One-second steps; the local clock integrates the crystal rate */
+    double local = (double)(EPOCH_US + BOOT_ERROR_US);
+    int64_t prev_live = INT64_MIN;
+    bool mono = true, glitched = false;
+    double worst_live = 0.0, worst_free = 0.0, worst_drift = 0.0;
+    uint32_t steps_before = 0u;
+    double recovered_after_h = -1.0;
+    uint32_t n_s = (uint32_t)(sc->hours * 3600.0);
+
+    for (uint32_t s = 0; s <= n_s; ++s)
+    {
+        int64_t true_us = EPOCH_US + (int64_t)s * 1000000;
+        if (!glitched && (sc->glitch_at_h > 0.0) && (s >= (uint32_t)(sc->glitch_at_h * 3600.0)))
+        {
+            local -= sc->glitch_us;
+            glitched = true;
+            steps_before = d.steps;
+        }
+        int64_t local_us = (int64_t)llround(local);
+
+        if ((s % sc->ref_every_s) == 0u)
+        {
+            dr_reference(&d, local_us, true_us + (int64_t)llround(sc->jitter_us * gauss()));
+            if (d.count > SETTLE_REFS)
+            {
+                /* drift_ppb is reference minus local: a fast crystal reads negative */
+                worst_drift = fmax(worst_drift, fabs(d.drift_ppb / 1000.0 + crystal_ppm(sc, s)));
+            }
+        }
+
+        int64_t live = dr_now(&d, local_us);
+        mono &= (prev_live == INT64_MIN) || (live >= prev_live) || (glitched && (d.steps > steps_before) &&
+                                                                  (live >= prev_live - (int64_t)sc->glitch_us));
+        prev_live = live;
+
+        double err = fabs((double)(live - true_us));
+        if (glitched && (recovered_after_h < 0.0) && (d.steps > steps_before) &&
+            (err <= sc->live_bound_us))
+        {
+            recovered_after_h = s / 3600.0 - sc->glitch_at_h;
+        }
+        /* After a glitch, from the reference that stepped */
+        if ((d.count > SETTLE_REFS) && (!glitched || (d.steps > steps_before)))
+        {
+            worst_live = fmax(worst_live, err);
+        }
+        worst_free = fmax(worst_free, fabs(local - (double)true_us));
+
+        if (((s % RECORD_EVERY_S) == RECORD_EVERY_S / 2u) && (n_rec < MAX_RECORDS))
+        {
+            rec[n_rec].local_us = local_us;
+            rec[n_rec].true_us = true_us;
+            rec[n_rec].live_us = live;
+            rec[n_rec].refs = d.count;
+            n_rec++;
+        }
+
+        local += 1e6 * (1.0 + crystal_ppm(sc, s + 0.5) * 1e-6);
+    }
+
+    /* Re-stamp what the log still covers, after settling and the glitch */
+    double live2 = 0.0, re2 = 0.0;
+    uint32_t n_cmp = 0u;
+    uint32_t log_first = (d.count > DR_LOG_LEN) ? (d.count - DR_LOG_LEN) : 0u;
+    for (uint32_t i = 0; i < n_rec; ++i)
+    {
+        if ((rec[i].refs <= log_first + 1u) || (rec[i].refs <= SETTLE_REFS) || (rec[i].refs >= d.count))
+        {
+            continue;
+        }
+        double el = (double)(rec[i].live_us - rec[i].true_us);
+        double er = (double)(dr_restamp(&d, rec[i].local_us) - rec[i].true_us);
+        live2 += el * el;
+        re2 += er * er;
+        n_cmp++;
+    }
+    double live_rms = sqrt(live2 / fmax(n_cmp, 1.0));
+    double re_rms = sqrt(re2 / fmax(n_cmp, 1.0));
+
+    printf("%s: %lu refs, drift %ld ppb, free-running worst %.0f ms\n", sc->name, (unsigned long)d.count,
+           (long)d.drift_ppb, worst_free / 1000.0);
+    snprintf(line, sizeof(line), "  drift estimate within %.2f ppm of the crystal", worst_drift);
+    check(worst_drift <= 3.0 * sc->jitter_us / (sc->ref_every_s * 1e6) * 1e6 / sqrt(DR_FIT_POINTS) * 2.0 +
+                         2.0 * M_PI * sc->temp_ppm * DR_FIT_POINTS * sc->ref_every_s / 86400.0 + 0.05,
+          line);
+    check(mono, "  live time monotonic");
+    snprintf(line, sizeof(line), "  live error after settling %.1f ms (bound %.0f ms)", worst_live / 1000.0,
+             sc->live_bound_us / 1000.0);
+    check(worst_live <= sc->live_bound_us, line);
+    snprintf(line, sizeof(line), "  re-stamped RMS %.2f ms vs live %.2f ms (%lu records)", re_rms / 1000.0,
+             live_rms / 1000.0, (unsigned long)n_cmp);
+    check((n_cmp > 0u) && (re_rms <= live_rms), line);
+    if (sc->glitch_at_h > 0.0)
+    {
+        snprintf(line, sizeof(line), "  %.1f s glitch: %lu step, back in bound after %.2f h", sc->glitch_us / 1e6,
+                 (unsigned long)(d.steps - steps_before), recovered_after_h);
+        check((d.steps - steps_before == 1u) && (recovered_after_h >= 0.0) &&
+              (recovered_after_h <= 2.0 * sc->ref_every_s / 3600.0), line);
+    }
+    else
+    {
+        check(d.steps == 0u, "  no steps");
+    }
+}
+
+int main(void)
+{
+    static const scenario_t scenarios[] = {
+        { "32 kHz crystal +35 ppm, 10 min refs, 2 ms jitter", 35.0, 0.0, 600u, 2000.0, 24.0, 0.0, 0.0, 10000.0 },
+        { "-80 ppm, 5 ppm daily swing, 30 min refs, 5 ms", -80.0, 5.0, 1800u, 5000.0, 72.0, 0.0, 0.0, 60000.0 },
+        { "+20 ppm, hourly refs, 20 ms jitter, 30 days", 20.0, 1.0, 3600u, 20000.0, 720.0, 0.0, 0.0, 120000.0 },
+        { "+35 ppm, local clock loses 3 s at 6 h", 35.0, 0.0, 600u, 2000.0, 24.0, 6.0, 3000000.0, 10000.0 },
+    };
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); ++i)
+    {
+        run(&scenarios[i]);
+    }
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
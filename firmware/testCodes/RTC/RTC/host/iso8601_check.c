@@ -0,0 +1,202 @@
+/******************************************************************************
+* File Name:   iso8601_check.c
+*
+* Description: Host check and benchmark for iso8601: iso_format_s() and
+*              iso_format_ms() against gmtime_r() + strftime() + snprintf()
+*              for every day of years 0001..9999, every second of the days
+*              around leap days and year ends, times before 1970 and with
+*              the cache driven both in order and at random; then both
+*              formatters timed on a 100 Hz record stream and on random
+*              times (a cache miss every call). Exits non-zero on a
+*              difference.
+*
+*                cc -O2 -I.. -o iso8601_check iso8601_check.c ../iso8601.c
+*
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "iso8601.h"
+
+#define SECONDS_PER_DAY     (86400)
+#define EPOCH_0001          (-62135596800ll)    /* 0001-01-01T00:00:00 */
+#define EPOCH_10000         (253402300800ll)    /* 10000-01-01T00:00:00 */
+#define RANDOM_TIMES        (2000000u)
+#define BENCH_CALLS         (5000000u)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+/* The same string the slow way */
+static void reference(int64_t epoch_ms, bool with_ms, char *buf, size_t size)
+{
+    int64_t s = epoch_ms / 1000;
+    int64_t ms = epoch_ms % 1000;
+    if (ms < 0)
+    {
+        ms += 1000;
+        s--;
+    }
+    time_t tt = (time_t)s;
+    struct tm t;
+    gmtime_r(&tt, &t);
+    /* %Y does not pad years below 1000 */
+    size_t n = (size_t)snprintf(buf, size, "%04d", t.tm_year + 1900);
+    n += strftime(buf + n, size - n, "-%m-%dT%H:%M:%S", &t);
+    if (with_ms)
+    {
+        snprintf(buf + n, size - n, ".%03d", (int)ms);
+    }
+}
+
+static bool one(iso_cache_t *c, int64_t epoch_ms, bool with_ms, bool *reported)
+{
+    char got[ISO_BUF_SIZE + 8u], want[64];
+    size_t n;
+
+    memset(got, '#', sizeof(got));
+    if (with_ms)
+    {
+        n = iso_format_ms(c, epoch_ms, got);
+    }
+    else
+    {
+        /* Whole seconds: floor, as the reference does */
+        int64_t s = (epoch_ms >= 0) ? (epoch_ms / 1000) : -((-epoch_ms + 999) / 1000);
+        n = iso_format_s(c, s, got);
+        epoch_ms = s * 1000;
+    }
+    reference(epoch_ms, with_ms, want, sizeof(want));
+    bool ok = (strcmp(got, want) == 0) && (n == strlen(want)) && (got[n + 1u] == '#');
+    if (!ok && !*reported)
+    {
+        printf("  first difference at %lld ms: \"%s\", reference \"%s\"\n", (long long)epoch_ms, got, want);
+        *reported = true;
+    }
+    return ok;
+}
+
+static void correctness(void)
+{
+    iso_cache_t c;
+    bool ok = true, reported = false;
+    char line[96];
+
+    /* Every day, at a time that changes with the day */
+    iso_cache_init(&c);
+    uint32_t days = 0u;
+    for (int64_t s = EPOCH_0001; s < EPOCH_10000; s += SECONDS_PER_DAY, ++days)
+    {
+        int64_t sod = (int64_t)((days * 2654435761u) % SECONDS_PER_DAY);
+        ok &= one(&c, (s + sod) * 1000 + (days % 1000u), (days & 1u) != 0u, &reported);
+    }
+    snprintf(line, sizeof(line), "every day 0001..9999 (%lu days), s and ms", (unsigned long)days);
+    check(ok, line);
+
+    /* Every second of the days around leap days and year ends */
+    static const int64_t around[] = {
+        951782400,      /* 2000-02-29 */
+        4107456000,     /* 2100-02-28 */
+        1709164800,     /* 2024-02-29 */
+        946684800,      /* 2000-01-01 */
+        4102444800,     /* 2100-01-01 */
+        0,              /* 1970-01-01 */
+        -2208988800,    /* 1900-01-01 */
+        2147483648,     /* 2038-01-19, past int32 */
+    };
+    ok = true;
+    iso_cache_init(&c);
+    for (size_t i = 0; i < sizeof(around) / sizeof(around[0]); ++i)
+    {
+        for (int64_t s = around[i] - SECONDS_PER_DAY; s < around[i] + SECONDS_PER_DAY; ++s)
+        {
+            ok &= one(&c, s * 1000 + 999, true, &reported);
+            ok &= one(&c, s * 1000, false, &reported);
+        }
+    }
+    check(ok, "every second of 2 days around 8 boundaries");
+
+    /* Milliseconds across second and day edges, before and after 1970 */
+    ok = true;
+    for (int64_t ms = -3 * SECONDS_PER_DAY * 1000ll; ms < 3 * SECONDS_PER_DAY * 1000ll; ms += 997)
+    {
+        ok &= one(&c, ms, true, &reported);
+    }
+    for (int64_t ms = -2500; ms <= 2500; ++ms)
+    {
+        ok &= one(&c, ms, true, &reported);
+    }
+    check(ok, "milliseconds around 1970, negative epochs floor");
+
+    /* Random order: every call may land on another day */
+    ok = true;
+    srand(51);
+    for (uint32_t i = 0; i < RANDOM_TIMES; ++i)
+    {
+        int64_t r = ((int64_t)rand() << 31) ^ rand();
+        int64_t ms = EPOCH_0001 * 1000 + (r % ((EPOCH_10000 - EPOCH_0001) * 1000));
+        ok &= one(&c, ms, (i & 1u) != 0u, &reported);
+    }
+    check(ok, "2M random times 0001..9999, cache out of order");
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void bench(const char *name, int64_t start_ms, int64_t step_ms, bool random)
+{
+    static int64_t times[1u << 16];
+    iso_cache_t c;
+    char buf[64];
+    volatile char sink = 0;
+
+    srand(52);
+    for (uint32_t i = 0; i < (1u << 16); ++i)
+    {
+        times[i] = random ? (start_ms + (((int64_t)rand() << 20) % (400ll * 365 * SECONDS_PER_DAY * 1000)))
+                          : (start_ms + (int64_t)i * step_ms);
+    }
+
+    iso_cache_init(&c);
+    double t0 = now_s();
+    for (uint32_t i = 0; i < BENCH_CALLS; ++i)
+    {
+        (void)iso_format_ms(&c, times[i & 0xFFFFu] + (i >> 16) * step_ms, buf);
+        sink = buf[22];
+    }
+    double t_iso = now_s() - t0;
+
+    t0 = now_s();
+    for (uint32_t i = 0; i < BENCH_CALLS; ++i)
+    {
+        reference(times[i & 0xFFFFu] + (i >> 16) * step_ms, true, buf, sizeof(buf));
+        sink = buf[22];
+    }
+    double t_ref = now_s() - t0;
+
+    printf("%-22s iso_format_ms %6.1f ns, gmtime+strftime+snprintf %6.1f ns (x%.1f)\n", name,
+           t_iso / BENCH_CALLS * 1e9, t_ref / BENCH_CALLS * 1e9, t_ref / t_iso);
+    (void)sink;
+}
+
+int main(void)
+{
+    correctness();
+    bench("100 Hz record stream", 1760000000000ll, 10, false);
+    bench("random times", 946684800000ll, 0, true);
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
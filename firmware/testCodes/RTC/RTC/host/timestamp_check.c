@@ -0,0 +1,122 @@
+/******************************************************************************
+* File Name:   timestamp_check.c
+*
+* Description: Host check of ts_epoch_from_tm() against the C library's
+*              timegm(): every day from 1600 to 2400 (all month ends, leap
+*              days and the 1700/1800/1900/2100 non-leap centuries), every
+*              second around midnight of the month and year boundaries, and
+*              the years the RTC can hold. Exits non-zero on a difference.
+*
+*                cc -O2 -I.. -o timestamp_check timestamp_check.c ../timestamp.c
+*
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "timestamp.h"
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static struct tm civil(int year, int mon, int mday, int hh, int mm, int ss)
+{
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    t.tm_year = year - 1900;
+    t.tm_mon = mon;
+    t.tm_mday = mday;
+    t.tm_hour = hh;
+    t.tm_min = mm;
+    t.tm_sec = ss;
+    return t;
+}
+
+static bool same(struct tm t, int64_t *got, int64_t *want)
+{
+    struct tm copy = t;             /* timegm normalises its argument */
+    *got = ts_epoch_from_tm(&t);
+    *want = (int64_t)timegm(&copy);
+    return *got == *want;
+}
+
+static void report_first(bool *reported, const struct tm *t, int64_t got, int64_t want)
+{
+    if (!*reported)
+    {
+        printf("  first difference: %04d-%02d-%02d %02d:%02d:%02d -> %lld, timegm %lld\n", t->tm_year + 1900,
+               t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec, (long long)got, (long long)want);
+        *reported = true;
+    }
+}
+
+int main(void)
+{
+    static const int mdays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool ok = true, reported = false;
+    int64_t got, want;
+    uint32_t days = 0u;
+
+    for (int y = 1600; y <= 2400; ++y)
+    {
+        bool leap = ((y % 4) == 0) && (((y % 100) != 0) || ((y % 400) == 0));
+        for (int m = 0; m < 12; ++m)
+        {
+            int last = mdays[m] + (((m == 1) && leap) ? 1 : 0);
+            for (int d = 1; d <= last; ++d, ++days)
+            {
+                struct tm t = civil(y, m, d, 12, 0, 0);
+                if (!same(t, &got, &want))
+                {
+                    ok = false;
+                    report_first(&reported, &t, got, want);
+                }
+            }
+        }
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "every day 1600..2400 (%lu days)", (unsigned long)days);
+    check(ok, line);
+
+    /* Seconds across midnight at each month end, leap and not */
+    static const int years[] = { 1900, 1970, 1999, 2000, 2024, 2038, 2099, 2100 };
+    ok = true;
+    for (size_t i = 0; i < sizeof(years) / sizeof(years[0]); ++i)
+    {
+        for (int m = 0; m < 12; ++m)
+        {
+            struct tm first = civil(years[i], m, 1, 0, 0, 0);
+            int64_t midnight = ts_epoch_from_tm(&first);
+            for (int s = -3600; s < 3600; ++s)
+            {
+                /* Build the broken-down time with gmtime, then back */
+                time_t tt = (time_t)(midnight + s);
+                struct tm t;
+                gmtime_r(&tt, &t);
+                if (!same(t, &got, &want) || (got != midnight + s))
+                {
+                    ok = false;
+                    report_first(&reported, &t, got, want);
+                }
+            }
+        }
+    }
+    check(ok, "every second around each month start, 8 years");
+
+    /* Known values */
+    struct tm t0 = civil(1970, 0, 1, 0, 0, 0);
+    struct tm t1 = civil(2000, 2, 1, 0, 0, 0);
+    struct tm t2 = civil(2024, 1, 29, 23, 59, 59);
+    check((ts_epoch_from_tm(&t0) == 0) && (ts_epoch_from_tm(&t1) == 951868800) &&
+          (ts_epoch_from_tm(&t2) == 1709251199), "1970-01-01, 2000-03-01, 2024-02-29 23:59:59");
+
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,287 @@
+/******************************************************************************
+* File Name:   timestamp_clock_check.c
+*
+* Description: Host check of the timestamp service across RTC second edges.
+*
+*              Simulated: a 32-bit counter and an RTC, each with its own
+*              rate error, drive ts_clock_set() / ts_clock_edge() with a
+*              random handler latency, and ts_clock_now() is read every
+*              millisecond or so, also between capture and publish. The
+*              counter starts just below its wrap and runs past it; rate
+*              errors go both ways. Checks that the time never decreases
+*              and stays within a few microseconds of the RTC once the
+*              first edges are in, and that the step paths recover: edges
+*              handled seconds late, a disturbed counter, and an RTC write
+*              followed by a re-anchor.
+*
+*              Live: the clock_gettime() port (timestamp_host.c) for a few
+*              seconds, ts_now_us() against CLOCK_REALTIME.
+*
+*              Exits non-zero on a failed check.
+*
+*                cc -O2 -I.. -o timestamp_clock_check timestamp_clock_check.c \
+*                   timestamp_host.c ../timestamp.c
+*
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "timestamp_host.h"
+
+#define EPOCH_S             (1792195200ll)  /* 2026-10-17 */
+#define READ_EVERY_NS       (997003ll)
+#define SETTLE_EDGES        (3u)
+#define TRACK_BOUND_US      (5)             /* after settling, against the RTC */
+#define LIVE_SECONDS        (3)
+#define LIVE_BOUND_US       (2000)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+/*******************************************************************************
+* Simulation
+********************************************************************************/
+typedef struct
+{
+    const char *name;
+    double      counter_ppm;
+    double      rtc_ppm;
+    double      seconds;
+    double      late_at_s;      /* one edge handled late_s late, 0 = none */
+    double      late_s;
+    double      jump_at_s;      /* counter jumps jump_us ahead, 0 = none */
+    double      jump_us;
+    double      rewrite_at_s;   /* RTC written rewrite_s ahead and re-anchored */
+    double      rewrite_s;
+} scenario_t;
+
+static const scenario_t *sc;
+static int64_t t_ns;                /* true time */
+static double rtc_offset_us;        /* RTC writes */
+static double counter_offset;       /* counter disturbances, ticks */
+static const uint32_t COUNTER_START = 0xFFFFFFFFu - 5000000u;
+
+static uint32_t sim_counter(void)
+{
+    double ticks = (double)t_ns * 1e-3 * (1.0 + sc->counter_ppm * 1e-6) + counter_offset;
+    return COUNTER_START + (uint32_t)(uint64_t)floor(ticks);
+}
+
+static double rtc_us(void)
+{
+    return (double)EPOCH_S * 1e6 + (double)t_ns * 1e-3 * (1.0 + sc->rtc_ppm * 1e-6) + rtc_offset_us;
+}
+
+/* True time at which the RTC reaches epoch second s */
+static int64_t rtc_edge_ns(int64_t s)
+{
+    return (int64_t)ceil(((double)(s - EPOCH_S) * 1e6 - rtc_offset_us) / (1.0 + sc->rtc_ppm * 1e-6) * 1e3);
+}
+
+static void simulate(const scenario_t *scenario)
+{
+    static ts_clock_t clk;
+    char line[112];
+
+    sc = scenario;
+    srand(14);
+    t_ns = 0;
+    rtc_offset_us = 0.0;
+    counter_offset = 0.0;
+
+    /* Anchored on the first edge, as the ports do */
+    ts_clock_init(&clk, TS_COUNTER_HZ);
+    int64_t sec = EPOCH_S;
+    ts_clock_set(&clk, sec, sim_counter());
+
+    int64_t end_ns = (int64_t)(sc->seconds * 1e9);
+    int64_t next_read = 0;
+    int64_t next_edge = rtc_edge_ns(sec + 1);
+    int64_t lat_ns = 2000 + (rand() % 38000);
+    bool late_done = (sc->late_at_s <= 0.0), jump_done = (sc->jump_at_s <= 0.0);
+    bool rewrite_done = (sc->rewrite_at_s <= 0.0), reanchor = false;
+    int64_t prev = INT64_MIN;
+    uint32_t decreases = 0u, stray = 0u, wraps = 0u, edges_after = 0u;
+    bool stepped = false;           /* since the last read */
+    uint32_t prev_count = sim_counter();
+    double worst = 0.0, worst_first = 0.0;
+
+    while (t_ns < end_ns)
+    {
+        /* Edge handler: captures, then publishes after its latency */
+        if (!late_done && (next_edge >= (int64_t)(sc->late_at_s * 1e9)))
+        {
+            lat_ns += (int64_t)(sc->late_s * 1e9);
+            late_done = true;
+        }
+
+        if (next_read < next_edge + lat_ns)
+        {
+            t_ns = next_read;
+            next_read += READ_EVERY_NS + (rand() % 2000);
+
+            if (!jump_done && (t_ns >= (int64_t)(sc->jump_at_s * 1e9)))
+            {
+                counter_offset += sc->jump_us;
+                jump_done = true;
+                edges_after = 0u;       /* off until the next edge steps */
+            }
+            if (!rewrite_done && (t_ns >= (int64_t)(sc->rewrite_at_s * 1e9)))
+            {
+                rtc_offset_us += sc->rewrite_s * 1e6;
+                rewrite_done = reanchor = true;
+                edges_after = 0u;
+                next_edge = rtc_edge_ns((int64_t)floor(rtc_us() / 1e6) + 1);
+            }
+
+            uint32_t count = sim_counter();
+            wraps += (count < prev_count) ? 1u : 0u;
+            prev_count = count;
+
+            int64_t now = ts_clock_now(&clk, sim_counter);
+            if ((prev != INT64_MIN) && (now < prev))
+            {
+                decreases++;
+                stray += stepped ? 0u : 1u;
+            }
+            prev = now;
+            stepped = false;
+
+            double err = fabs((double)now - rtc_us());
+            if (edges_after >= SETTLE_EDGES)
+            {
+                worst = fmax(worst, err);
+            }
+            else
+            {
+                worst_first = fmax(worst_first, err);
+            }
+            continue;
+        }
+
+        /* The edge: RTC second s starts at next_edge */
+        t_ns = next_edge;
+        sec = (int64_t)llround((rtc_us()) / 1e6);
+        uint32_t captured = sim_counter();
+        int64_t handled = next_edge + lat_ns;
+        uint32_t steps = clk.steps;
+
+        if (reanchor)
+        {
+            /* The port spins to the next edge after writing the RTC */
+            ts_clock_set(&clk, sec, captured);
+            reanchor = false;
+            stepped = true;
+            edges_after = 0u;
+        }
+        else
+        {
+            t_ns = handled;
+            uint32_t published = sim_counter();
+            if (lat_ns > 1000000000ll)
+            {
+                /* Held off: the capture is taken when the handler runs */
+                captured = published;
+            }
+            ts_clock_edge(&clk, captured, published);
+            if (clk.steps != steps)
+            {
+                stepped = true;
+                edges_after = 0u;
+            }
+            else
+            {
+                edges_after++;
+            }
+        }
+        t_ns = (t_ns > next_edge) ? t_ns : next_edge;
+        /* The alarm is re-armed from here, also after a late handler */
+        next_edge = rtc_edge_ns((int64_t)floor(rtc_us() / 1e6) + 1);
+        lat_ns = 2000 + (rand() % 38000);
+    }
+
+    printf("%s: %lu edges, %lu steps, %lu counter wraps\n", sc->name, (unsigned long)clk.edges,
+           (unsigned long)clk.steps, (unsigned long)wraps);
+    bool plain = (sc->late_at_s <= 0.0) && (sc->jump_at_s <= 0.0) && (sc->rewrite_at_s <= 0.0);
+    if (plain)
+    {
+        check((decreases == 0u) && (clk.steps == 0u), "  never decreases, never steps");
+        snprintf(line, sizeof(line), "  first seconds within %.0f us (rate error)", worst_first);
+        check(worst_first <= fabs(sc->counter_ppm - sc->rtc_ppm) * 2.0 + TRACK_BOUND_US, line);
+    }
+    else
+    {
+        snprintf(line, sizeof(line), "  decreases only at steps / re-anchor (%lu)", (unsigned long)decreases);
+        check(stray == 0u, line);
+    }
+    snprintf(line, sizeof(line), "  within %.1f us of the RTC once settled", worst);
+    check(worst <= TRACK_BOUND_US, line);
+}
+
+/*******************************************************************************
+* Live, on clock_gettime()
+********************************************************************************/
+static int64_t realtime_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void live(void)
+{
+    char line[112];
+
+    check(ts_host_init(), "host port anchors on a CLOCK_REALTIME second");
+    int64_t prev = ts_now_us();
+    int64_t start = prev;
+    int64_t worst = 0;
+    uint32_t reads = 0u, decreases = 0u;
+    while (prev - start < LIVE_SECONDS * 1000000ll)
+    {
+        ts_host_poll();
+        /* Bracketed, so a preemption between the reads does not count */
+        int64_t r0 = realtime_us();
+        int64_t now = ts_now_us();
+        int64_t r1 = realtime_us();
+        int64_t err = (now < r0) ? (r0 - now) : ((now > r1) ? (now - r1) : 0);
+        decreases += (now < prev) ? 1u : 0u;
+        worst = (err > worst) ? err : worst;
+        prev = now;
+        reads++;
+    }
+    const ts_clock_t *clk = ts_host_clock();
+    printf("live: %lu reads over %lu edges, %lu steps\n", (unsigned long)reads, (unsigned long)clk->edges,
+           (unsigned long)clk->steps);
+    check((decreases == 0u) && (clk->edges >= LIVE_SECONDS - 1), "  ts_now_us() never decreases across edges");
+    snprintf(line, sizeof(line), "  within %lld us of CLOCK_REALTIME", (long long)worst);
+    check(worst <= LIVE_BOUND_US, line);
+}
+
+int main(void)
+{
+    static const scenario_t scenarios[] = {
+        { "counter +150 ppm, RTC -20 ppm, past the wrap", 150.0, -20.0, 4400.0, 0, 0, 0, 0, 0, 0 },
+        { "counter -150 ppm, RTC +35 ppm, past the wrap", -150.0, 35.0, 4400.0, 0, 0, 0, 0, 0, 0 },
+        { "counter exact, RTC -35 ppm", 0.0, -35.0, 600.0, 0, 0, 0, 0, 0, 0 },
+        { "edge handled 2.3 s late", 80.0, 10.0, 120.0, 30.0, 2.3, 0, 0, 0, 0 },
+        { "counter jumps 250 ms ahead", -80.0, 10.0, 120.0, 0, 0, 40.4, 250000.0, 0, 0 },
+        { "RTC written 3 s back, re-anchored", 80.0, -10.0, 120.0, 0, 0, 0, 0, 50.6, -3.0 },
+    };
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); ++i)
+    {
+        simulate(&scenarios[i]);
+    }
+    live();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
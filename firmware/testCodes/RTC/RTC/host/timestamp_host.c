@@ -0,0 +1,64 @@
+/******************************************************************************
+* File Name:   timestamp_host.c
+*
+* Description: Host port of the timestamp service, see timestamp_host.h.
+*
+*******************************************************************************/
+
+#include <time.h>
+#include "timestamp_host.h"
+
+static ts_clock_t clk;
+static int64_t last_sec;
+
+static uint32_t read_counter(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * TS_COUNTER_HZ + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+static int64_t realtime_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec;
+}
+
+bool ts_host_init(void)
+{
+    ts_clock_init(&clk, TS_COUNTER_HZ);
+
+    int64_t start = realtime_sec();
+    int64_t now = start;
+    uint32_t edge = 0u;
+    while (now == start)
+    {
+        edge = read_counter();
+        now = realtime_sec();
+    }
+    ts_clock_set(&clk, now, edge);
+    last_sec = now;
+    return true;
+}
+
+void ts_host_poll(void)
+{
+    uint32_t count = read_counter();
+    int64_t sec = realtime_sec();
+    if (sec != last_sec)
+    {
+        last_sec = sec;
+        ts_clock_edge(&clk, count, read_counter());
+    }
+}
+
+const ts_clock_t *ts_host_clock(void)
+{
+    return &clk;
+}
+
+int64_t ts_now_us(void)
+{
+    return ts_clock_now(&clk, read_counter);
+}
@@ -0,0 +1,29 @@
+/******************************************************************************
+* File Name:   timestamp_host.h
+*
+* Description: Host port of the timestamp service on clock_gettime():
+*              CLOCK_MONOTONIC in microseconds stands in for the free-running
+*              counter and CLOCK_REALTIME seconds for the RTC. Edges are
+*              found by polling, so call ts_host_poll() often (or from a
+*              thread). Not part of the firmware build.
+*
+*******************************************************************************/
+
+#ifndef TIMESTAMP_HOST_H_
+#define TIMESTAMP_HOST_H_
+
+#include <stdbool.h>
+#include "timestamp.h"
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Anchors on the next CLOCK_REALTIME second (blocks at most 1 s). */
+bool ts_host_init(void);
+
+/* Feeds an edge when the realtime second has changed since the last call. */
+void ts_host_poll(void);
+
+const ts_clock_t *ts_host_clock(void);
+
+#endif /* TIMESTAMP_HOST_H_ */
@@ -0,0 +1,109 @@
+/******************************************************************************
+* File Name:   iso8601.c
+*
+* Description: ISO-8601 timestamp formatter, see iso8601.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "iso8601.h"
+
+#define SECONDS_PER_DAY     (86400)
+
+/* "00" .. "99" */
+static const char digits2[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+static inline void put2(char *p, uint32_t v)
+{
+    memcpy(p, &digits2[2u * v], 2u);
+}
+
+/* Civil date from days since 1970-01-01 (H. Hinnant), into the cache. */
+static void update_date(iso_cache_t *c, int64_t day)
+{
+    int64_t z = day + 719468;
+    int64_t era = ((z >= 0) ? z : (z - 146096)) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    uint32_t d = (uint32_t)(doy - (153 * mp + 2) / 5 + 1);
+    uint32_t m = (uint32_t)((mp < 10) ? (mp + 3) : (mp - 9));
+    int64_t y = yoe + era * 400 + ((m <= 2u) ? 1 : 0);
+
+    /* Four-digit years only; outside 0000..9999 clamp rather than overflow. */
+    uint32_t yy = (y < 0) ? 0u : ((y > 9999) ? 9999u : (uint32_t)y);
+    put2(&c->date[0], yy / 100u);
+    put2(&c->date[2], yy % 100u);
+    c->date[4] = '-';
+    put2(&c->date[5], m);
+    c->date[7] = '-';
+    put2(&c->date[8], d);
+    c->day = day;
+}
+
+void iso_cache_init(iso_cache_t *c)
+{
+    update_date(c, 0);
+}
+
+static void format_day_time(iso_cache_t *c, int64_t epoch_s, char *buf)
+{
+    int64_t day = epoch_s / SECONDS_PER_DAY;
+    int64_t sod = epoch_s % SECONDS_PER_DAY;
+    if (sod < 0)
+    {
+        sod += SECONDS_PER_DAY;
+        day--;
+    }
+    if (day != c->day)
+    {
+        update_date(c, day);
+    }
+
+    uint32_t s = (uint32_t)sod;
+    memcpy(buf, c->date, ISO_DATE_LEN);
+    buf[10] = 'T';
+    put2(&buf[11], s / 3600u);
+    buf[13] = ':';
+    put2(&buf[14], (s / 60u) % 60u);
+    buf[16] = ':';
+    put2(&buf[17], s % 60u);
+}
+
+size_t iso_format_s(iso_cache_t *c, int64_t epoch_s, char *buf)
+{
+    format_day_time(c, epoch_s, buf);
+    buf[ISO_LEN_S] = '\0';
+    return ISO_LEN_S;
+}
+
+size_t iso_format_ms(iso_cache_t *c, int64_t epoch_ms, char *buf)
+{
+    int64_t s = epoch_ms / 1000;
+    int64_t ms = epoch_ms % 1000;
+    if (ms < 0)
+    {
+        ms += 1000;
+        s--;
+    }
+    format_day_time(c, s, buf);
+
+    uint32_t m = (uint32_t)ms;
+    buf[19] = '.';
+    buf[20] = (char)('0' + (m / 100u));
+    put2(&buf[21], m % 100u);
+    buf[ISO_LEN_MS] = '\0';
+    return ISO_LEN_MS;
+}
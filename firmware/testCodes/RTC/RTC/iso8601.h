@@ -0,0 +1,50 @@
+/******************************************************************************
+* File Name:   iso8601.h
+*
+* Description: ISO-8601 timestamp formatter for record serialization,
+*              "YYYY-MM-DDTHH:MM:SS" (the JSON upload format) with optional
+*              ".mmm". The date part is cached and only recomputed when the
+*              day changes; the time of day comes from integer division by
+*              constants and a two-digit lookup table. Writes straight into
+*              the caller's buffer, no locale, no struct tm.
+*
+*******************************************************************************/
+
+#ifndef ISO8601_H_
+#define ISO8601_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define ISO_DATE_LEN                      (10u)   /* YYYY-MM-DD */
+#define ISO_LEN_S                         (19u)   /* YYYY-MM-DDTHH:MM:SS */
+#define ISO_LEN_MS                        (23u)   /* ... .mmm */
+/* Buffer size for either form, including the terminator. */
+#define ISO_BUF_SIZE                      (ISO_LEN_MS + 1u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int64_t day;                    /* days since 1970-01-01 of date[] */
+    char    date[ISO_DATE_LEN];
+} iso_cache_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void iso_cache_init(iso_cache_t *c);
+
+/* UTC epoch seconds -> "YYYY-MM-DDTHH:MM:SS", NUL-terminated. buf must hold
+ * ISO_LEN_S + 1 bytes. Returns ISO_LEN_S. */
+size_t iso_format_s(iso_cache_t *c, int64_t epoch_s, char *buf);
+
+/* UTC epoch milliseconds -> "YYYY-MM-DDTHH:MM:SS.mmm", NUL-terminated. buf
+ * must hold ISO_BUF_SIZE bytes. Returns ISO_LEN_MS. */
+size_t iso_format_ms(iso_cache_t *c, int64_t epoch_ms, char *buf);
+
+#endif /* ISO8601_H_ */
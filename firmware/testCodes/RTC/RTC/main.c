@@ -3,73 +3,110 @@
 #include "cybsp.h"
 #include "cy_retarget_io.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <stdbool.h>
+#include "timestamp_hal.h"
+#include "iso8601.h"
+#include "drift.h"
 
 #define UART_TIMEOUT_MS   (50u)
-#define INPUT_TIMEOUT_MS  (60000u)   /* 1 minuut om tijd in te voeren */
+#define LOG_PERIOD_MS     (1000u)    /* UART wordt tussen de logregels gepold */
 #define STRING_BUFFER_SIZE (80)
 #define TM_YEAR_BASE      (1900u)
 
 /* RTC object */
 static cyhal_rtc_t rtc_obj;
 
+/* Tijd is voorlopig (build-tijd) tot iemand de echte tijd invoert */
+static bool time_provisional;
+
+/* Drift van het RTC kristal t.o.v. referentietijden van de server/PC */
+static dr_tracker_t drift;
+
+/* Invoerregel, wordt over meerdere polls opgebouwd */
+static char input_buf[STRING_BUFFER_SIZE];
+static uint32_t input_idx;
+
 /* -------------------- Helpers -------------------- */
-static cy_rslt_t fetch_time_data(char *buffer, uint32_t timeout_ms)
+/* Leest tekens tot een regel compleet is of window_ms verstreken is; blokkeert
+ * nooit langer dan window_ms. True als input_buf een volledige regel bevat. */
+static bool poll_time_input(uint32_t window_ms)
 {
-    uint32_t idx = 0;
     uint8_t ch;
-    memset(buffer, 0, STRING_BUFFER_SIZE);
 
-    while (idx < STRING_BUFFER_SIZE-1)
+    for (uint32_t waited = 0; waited < window_ms; )
     {
         cy_rslt_t rslt = cyhal_uart_getc(&cy_retarget_io_uart_obj, &ch, UART_TIMEOUT_MS);
         if (rslt == CY_RSLT_ERR_CSP_UART_GETC_TIMEOUT)
         {
-            timeout_ms -= UART_TIMEOUT_MS;
-            if (timeout_ms == 0) return CY_RSLT_ERR_CSP_UART_GETC_TIMEOUT;
+            waited += UART_TIMEOUT_MS;
             continue;
         }
+        if (rslt != CY_RSLT_SUCCESS)
+        {
+            return false;
+        }
 
-        if (ch == '\r' || ch == '\n') break;
-        buffer[idx++] = (char)ch;
+        if (ch == '\r' || ch == '\n')
+        {
+            if (input_idx == 0) continue;   /* lege regel of \r\n */
+            input_buf[input_idx] = '\0';
+            input_idx = 0;
+            return true;
+        }
+        if (input_idx < STRING_BUFFER_SIZE-1) input_buf[input_idx++] = (char)ch;
     }
-    return CY_RSLT_SUCCESS;
+    return false;
 }
 
-/* Vraag gebruiker om tijd in HH MM SS dd mm yyyy */
-static void ask_and_set_time(void)
+/* Tijd in HH MM SS dd mm yyyy naar de RTC */
+static bool set_time_from_input(const char *buf)
 {
-    char buf[STRING_BUFFER_SIZE];
-    printf("RTC not initialized. Enter time as \"HH MM SS dd mm yyyy\":\r\n");
-
-    if (fetch_time_data(buf, INPUT_TIMEOUT_MS) == CY_RSLT_SUCCESS)
+    int hh, mm, ss, dd, mo, yy;
+    if (6 != sscanf(buf, "%d %d %d %d %d %d",
+                    &hh,&mm,&ss,&dd,&mo,&yy))
     {
-        int hh, mm, ss, dd, mo, yy;
-        if (6 == sscanf(buf, "%d %d %d %d %d %d",
-                        &hh,&mm,&ss,&dd,&mo,&yy))
-        {
-            struct tm t = {0};
-            t.tm_hour = hh; t.tm_min = mm; t.tm_sec = ss;
-            t.tm_mday = dd; t.tm_mon = mo - 1;
-            t.tm_year = yy - TM_YEAR_BASE;
-            cyhal_rtc_write(&rtc_obj, &t);
-            printf("RTC set to: %04d-%02d-%02d %02d:%02d:%02d\r\n",
-                   yy, mo, dd, hh, mm, ss);
-        }
-        else
-        {
-            printf("Invalid format, try reset and enter again.\r\n");
-        }
+        printf("Invalid format, use \"HH MM SS dd mm yyyy\".\r\n");
+        return false;
     }
-    else
+
+    struct tm t = {0};
+    t.tm_hour = hh; t.tm_min = mm; t.tm_sec = ss;
+    t.tm_mday = dd; t.tm_mon = mo - 1;
+    t.tm_year = yy - TM_YEAR_BASE;
+    if (CY_RSLT_SUCCESS != cyhal_rtc_write(&rtc_obj, &t))
     {
-        printf("Timeout waiting for time input. Using default 2000-01-01 00:00:00\r\n");
-        struct tm t = {0};
-        t.tm_year = 2000 - TM_YEAR_BASE;
-        t.tm_mon  = 0; t.tm_mday = 1;
-        cyhal_rtc_write(&rtc_obj, &t);
+        printf("RTC write failed.\r\n");
+        return false;
     }
+    printf("RTC set to: %04d-%02d-%02d %02d:%02d:%02d\r\n",
+           yy, mo, dd, hh, mm, ss);
+    return true;
+}
+
+/* RTC liep niet: start meteen op de build-tijd in plaats van op invoer te
+ * wachten, zodat het loggen niet vertraagd wordt */
+static void set_provisional_time(void)
+{
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char mon[4] = {0};
+    int dd = 1, yy = 2000, hh = 0, mm = 0, ss = 0;
+    struct tm t = {0};
+
+    (void)sscanf(__DATE__, "%3s %d %d", mon, &dd, &yy);
+    (void)sscanf(__TIME__, "%d:%d:%d", &hh, &mm, &ss);
+    const char *m = strstr(months, mon);
+    t.tm_mon  = (m != NULL) ? (int)(m - months) / 3 : 0;
+    t.tm_mday = dd;
+    t.tm_year = yy - TM_YEAR_BASE;
+    t.tm_hour = hh; t.tm_min = mm; t.tm_sec = ss;
+    cyhal_rtc_write(&rtc_obj, &t);
+    time_provisional = true;
+
+    printf("RTC not initialized. Running on build time %s %s (provisional).\r\n", __DATE__, __TIME__);
+    printf("Enter time as \"HH MM SS dd mm yyyy\" at any time to correct it.\r\n");
 }
 
 /* -------------------- Main -------------------- */
@@ -87,20 +124,66 @@ int main(void)
         CY_ASSERT(0);
     }
 
-    /* Check of RTC al loopt, anders tijd vragen */
+    /* Check of RTC al loopt, anders voorlopige tijd; invoer kan later */
     if (!cyhal_rtc_is_enabled(&rtc_obj))
     {
-        ask_and_set_time();
+        set_provisional_time();
+    }
+
+    /* Sub-seconde timestamps: vrijlopende 1 MHz timer, elke seconde op de RTC gezet */
+    if (CY_RSLT_SUCCESS != ts_hal_init(&rtc_obj))
+    {
+        printf("Timestamp service init failed!\r\n");
+        CY_ASSERT(0);
     }
 
-    /* Elke seconde de tijd loggen op nieuwe regel */
-    struct tm now;
-    char line[64];
+    /* DWT cycle counter om de kost van een timestamp te meten */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* Elke seconde de tijd loggen op nieuwe regel, in het JSON formaat
+     * (ISO-8601); de datum komt uit de cache, geen struct tm/strftime meer */
+    iso_cache_t iso;
+    iso_cache_init(&iso);
+    dr_init(&drift);
+    char line[ISO_BUF_SIZE];
     for(;;)
     {
-        cyhal_rtc_read(&rtc_obj, &now);
-        strftime(line, sizeof(line), "%Y-%m-%d %H:%M:%S", &now);
-        printf("%s\r\n", line);
-        cyhal_system_delay_ms(1000);
+        uint32_t t0 = DWT->CYCCNT;
+        int64_t us = ts_now_us();
+        uint32_t t1 = DWT->CYCCNT;
+        us = dr_now(&drift, us);
+        iso_format_ms(&iso, us / 1000, line);
+        uint32_t t2 = DWT->CYCCNT;
+
+        const ts_clock_t *clk = ts_hal_clock();
+        printf("%s%s  (ts %lu cyc, drift+iso %lu cyc, edge err %ld us, steps %lu, drift %ld ppb, ref err %ld us)\r\n",
+               line, time_provisional ? " (provisional)" : "",
+               (unsigned long)(t1 - t0), (unsigned long)(t2 - t1),
+               (long)clk->last_error_us, (unsigned long)clk->steps,
+               (long)drift.drift_ppb, (long)drift.last_error_us);
+
+        /* Wachten = UART pollen. "@<epoch ms>" is een referentiepunt voor de
+         * drift; een ingevoerde tijd zet de RTC en begint de drift opnieuw */
+        if (!poll_time_input(LOG_PERIOD_MS))
+        {
+            continue;
+        }
+        if (input_buf[0] == '@')
+        {
+            int64_t local_us = ts_now_us();
+            int64_t ref_ms = strtoll(&input_buf[1], NULL, 10);
+            dr_reference(&drift, local_us, ref_ms * 1000);
+        }
+        else if (set_time_from_input(input_buf))
+        {
+            time_provisional = false;
+            dr_init(&drift);
+            if (CY_RSLT_SUCCESS != ts_hal_resync())
+            {
+                printf("Timestamp resync failed!\r\n");
+            }
+        }
     }
 }
@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name:   timestamp.c
+*
+* Description: Timestamp service core, see timestamp.h. No HAL calls here;
+*              the ports read the counter and deliver the edges.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "timestamp.h"
+
+static uint32_t nominal_scale(const ts_clock_t *c)
+{
+    return (uint32_t)(((uint64_t)TS_US_PER_S << TS_SCALE_FRAC_BITS) / c->counter_hz);
+}
+
+/* Writes the inactive slot and flips the index; readers that raced the
+ * flip see a changed index and retry. */
+static void publish(ts_clock_t *c, int64_t base_us, uint32_t base_count, uint32_t scale_q30)
+{
+    unsigned next = atomic_load_explicit(&c->active, memory_order_relaxed) ^ 1u;
+    c->seg[next].base_us = base_us;
+    c->seg[next].base_count = base_count;
+    c->seg[next].scale_q30 = scale_q30;
+    atomic_store_explicit(&c->active, next, memory_order_release);
+}
+
+void ts_clock_init(ts_clock_t *c, uint32_t counter_hz)
+{
+    memset(c, 0, sizeof(*c));
+    c->counter_hz = counter_hz;
+    c->seg[0].scale_q30 = nominal_scale(c);
+    atomic_init(&c->active, 0u);
+}
+
+void ts_clock_set(ts_clock_t *c, int64_t epoch_s, uint32_t count)
+{
+    int64_t edge_us = epoch_s * TS_US_PER_S;
+    c->next_edge_us = edge_us + TS_US_PER_S;
+    c->edge_count = count;
+    c->valid = true;
+    publish(c, edge_us, count, nominal_scale(c));
+}
+
+void ts_clock_edge(ts_clock_t *c, uint32_t count, uint32_t now)
+{
+    if (!c->valid)
+    {
+        return;
+    }
+
+    const ts_segment_t *cur = &c->seg[atomic_load_explicit(&c->active, memory_order_relaxed)];
+    int64_t target = c->next_edge_us;
+    uint32_t ticks = count - c->edge_count;     /* counter ticks per RTC second */
+
+    /* Edges missed (handler held off past the next second): the counter
+     * tells how many seconds went by, so the target stays the RTC's. */
+    uint32_t secs = (ticks + c->counter_hz / 32u) / c->counter_hz;
+    if (secs > 1u)
+    {
+        target += (int64_t)(secs - 1u) * TS_US_PER_S;
+        ticks /= secs;
+    }
+    int64_t err = target - ts_segment_us(cur, count);
+
+    c->edges++;
+    c->last_error_us = (int32_t)err;
+    c->edge_count = count;
+    c->next_edge_us = target + TS_US_PER_S;
+
+    if ((err > TS_STEP_LIMIT_US) || (err < -TS_STEP_LIMIT_US))
+    {
+        /* Too far off to slew (counter disturbed, handler late): jump onto it. */
+        c->steps++;
+        publish(c, target, count, nominal_scale(c));
+        return;
+    }
+
+    /* Keep the mapping continuous at the moment of publishing, then aim the
+     * new segment at the next edge, expected one measured second from now. */
+    int64_t base_us = ts_segment_us(cur, now);
+    int64_t corr = (err > TS_SLEW_MAX_US) ? TS_SLEW_MAX_US : ((err < -TS_SLEW_MAX_US) ? -TS_SLEW_MAX_US : err);
+    int64_t goal = target + TS_US_PER_S - (err - corr);
+    uint32_t span = (count + ticks) - now;
+
+    uint32_t scale = nominal_scale(c);
+    if ((span > 0u) && (span <= ticks) && (goal > base_us))
+    {
+        scale = (uint32_t)((((uint64_t)(goal - base_us)) << TS_SCALE_FRAC_BITS) / span);
+    }
+    publish(c, base_us, now, scale);
+}
+
+int64_t ts_epoch_from_tm(const struct tm *t)
+{
+    /* Days from civil (H. Hinnant), valid for the proleptic Gregorian calendar.
+     * The year starts in March: mp is 0 for March, 11 for February. */
+    int64_t m = (int64_t)t->tm_mon + 1;
+    int64_t y = (int64_t)t->tm_year + 1900 - ((m <= 2) ? 1 : 0);
+    int64_t era = ((y >= 0) ? y : (y - 399)) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t mp = (m + 9) % 12;
+    int64_t doy = (153 * mp + 2) / 5 + t->tm_mday - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+
+    return days * 86400 + t->tm_hour * 3600 + t->tm_min * 60 + t->tm_sec;
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+* File Name:   timestamp.h
+*
+* Description: Sub-second timestamp service. A free-running 32-bit counter
+*              (nominally 1 MHz) is anchored to the RTC at every RTC second
+*              edge. Between edges the counter is mapped to epoch
+*              microseconds with a per-second linear segment; each new
+*              segment starts where the previous one ends and is sloped to
+*              hit the next RTC second, so timestamps are monotonic and
+*              track the RTC crystal instead of the counter's clock.
+*
+*              The active segment is published through two slots and an
+*              index, so ts_now_us() is lock-free and safe from any task or
+*              ISR, including one that preempts the anchor update.
+*
+*              Ports provide ts_now_us() and feed the edges:
+*                timestamp_hal.c        TCPWM timer + RTC alarm interrupt
+*                host/timestamp_host.c  clock_gettime(), for host tools/tests
+*
+*******************************************************************************/
+
+#ifndef TIMESTAMP_H_
+#define TIMESTAMP_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TS_COUNTER_HZ                     (1000000u)
+#define TS_US_PER_S                       (1000000ll)
+#define TS_SCALE_FRAC_BITS                (30u)
+
+/* Largest error corrected by slewing within one second; beyond this (counter
+ * disturbed, edge handled late) the clock steps. Whole missed seconds are
+ * counted from the counter; after writing the RTC, re-anchor with
+ * ts_clock_set(). */
+#define TS_SLEW_MAX_US                    (5000)
+#define TS_STEP_LIMIT_US                  (100000)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+/* One linear segment: us = base_us + ((count - base_count) * scale) >> 30. */
+typedef struct
+{
+    int64_t  base_us;
+    uint32_t base_count;
+    uint32_t scale_q30;         /* microseconds per count, Q30 */
+} ts_segment_t;
+
+typedef struct
+{
+    ts_segment_t seg[2];
+    atomic_uint  active;        /* index of the published segment */
+    int64_t      next_edge_us;  /* epoch us of the next RTC second edge */
+    uint32_t     edge_count;    /* counter value at the last edge */
+    uint32_t     counter_hz;    /* nominal counter rate */
+    bool         valid;         /* set by ts_clock_set() */
+    uint32_t     edges;
+    uint32_t     steps;         /* hard steps, not slewed */
+    int32_t      last_error_us; /* RTC minus timestamp at the last edge */
+} ts_clock_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void ts_clock_init(ts_clock_t *c, uint32_t counter_hz);
+
+/* Hard anchor: epoch second epoch_s started at counter value count. */
+void ts_clock_set(ts_clock_t *c, int64_t epoch_s, uint32_t count);
+
+/* An RTC second edge was seen at counter value count (captured first thing
+ * in the edge handler); now is the counter value when the new segment is
+ * published. Call from one context only. */
+void ts_clock_edge(ts_clock_t *c, uint32_t count, uint32_t now);
+
+/* Maps a counter value to epoch microseconds (time since start before
+ * ts_clock_set()). */
+static inline int64_t ts_segment_us(const ts_segment_t *s, uint32_t count)
+{
+    return s->base_us + (int64_t)(((uint64_t)(count - s->base_count) * s->scale_q30) >> TS_SCALE_FRAC_BITS);
+}
+
+/* Lock-free read for the ports: the counter is sampled after the segment is
+ * picked, and the read is retried if an edge was published in between. */
+static inline int64_t ts_clock_now(ts_clock_t *c, uint32_t (*read_counter)(void))
+{
+    for (;;)
+    {
+        unsigned i = atomic_load_explicit(&c->active, memory_order_acquire);
+        ts_segment_t s = c->seg[i];
+        uint32_t count = read_counter();
+        if (atomic_load_explicit(&c->active, memory_order_acquire) == i)
+        {
+            return ts_segment_us(&s, count);
+        }
+    }
+}
+
+/* Seconds since 1970-01-01 for a broken-down UTC time (no time zones). */
+int64_t ts_epoch_from_tm(const struct tm *t);
+
+/* Implemented by the port: current time in epoch microseconds. */
+int64_t ts_now_us(void);
+
+#endif /* TIMESTAMP_H_ */
@@ -0,0 +1,127 @@
+/******************************************************************************
+* File Name:   timestamp_hal.c
+*
+* Description: Target port of the timestamp service, see timestamp_hal.h.
+*
+*******************************************************************************/
+
+#include "timestamp_hal.h"
+
+/* The counter must be one of the 32-bit TCPWM blocks; configuring a 16-bit
+ * block with this period fails and is reported by ts_hal_init(). */
+#define COUNTER_PERIOD      (0xFFFFFFFFu)
+
+static cyhal_timer_t counter;
+static cyhal_rtc_t *ts_rtc;
+static ts_clock_t clk;
+
+static uint32_t read_counter(void)
+{
+    return cyhal_timer_read(&counter);
+}
+
+static void rtc_alarm_cb(void *arg, cyhal_rtc_event_t event)
+{
+    (void)arg;
+    /* Capture before anything else so the latency is short and constant. */
+    uint32_t edge = read_counter();
+    if ((event & CYHAL_RTC_ALARM) == 0u)
+    {
+        return;
+    }
+    (void)cyhal_rtc_set_alarm_by_seconds(ts_rtc, 1u);
+    ts_clock_edge(&clk, edge, read_counter());
+}
+
+/* Spins until the RTC second changes and anchors on that edge. */
+static cy_rslt_t anchor_on_edge(void)
+{
+    struct tm t;
+    cy_rslt_t rslt = cyhal_rtc_read(ts_rtc, &t);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+    int64_t start = ts_epoch_from_tm(&t);
+    int64_t now = start;
+    uint32_t edge = 0u;
+
+    while (now == start)
+    {
+        edge = read_counter();
+        rslt = cyhal_rtc_read(ts_rtc, &t);
+        if (rslt != CY_RSLT_SUCCESS)
+        {
+            return rslt;
+        }
+        now = ts_epoch_from_tm(&t);
+    }
+    ts_clock_set(&clk, now, edge);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t ts_hal_init(cyhal_rtc_t *rtc)
+{
+    const cyhal_timer_cfg_t cfg = {
+        .is_continuous = true,
+        .direction     = CYHAL_TIMER_DIR_UP,
+        .is_compare    = false,
+        .period        = COUNTER_PERIOD,
+        .compare_value = 0u,
+        .value         = 0u
+    };
+    cy_rslt_t rslt;
+
+    ts_rtc = rtc;
+    ts_clock_init(&clk, TS_COUNTER_HZ);
+
+    rslt = cyhal_timer_init(&counter, NC, NULL);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+    rslt = cyhal_timer_configure(&counter, &cfg);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = cyhal_timer_set_frequency(&counter, TS_COUNTER_HZ);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = cyhal_timer_start(&counter);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = anchor_on_edge();
+    }
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        cyhal_timer_free(&counter);
+        return rslt;
+    }
+
+    cyhal_rtc_register_callback(ts_rtc, rtc_alarm_cb, NULL);
+    cyhal_rtc_enable_event(ts_rtc, CYHAL_RTC_ALARM, TS_HAL_RTC_IRQ_PRIORITY, true);
+    return cyhal_rtc_set_alarm_by_seconds(ts_rtc, 1u);
+}
+
+cy_rslt_t ts_hal_resync(void)
+{
+    cyhal_rtc_enable_event(ts_rtc, CYHAL_RTC_ALARM, TS_HAL_RTC_IRQ_PRIORITY, false);
+    cy_rslt_t rslt = anchor_on_edge();
+    cyhal_rtc_enable_event(ts_rtc, CYHAL_RTC_ALARM, TS_HAL_RTC_IRQ_PRIORITY, true);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = cyhal_rtc_set_alarm_by_seconds(ts_rtc, 1u);
+    }
+    return rslt;
+}
+
+const ts_clock_t *ts_hal_clock(void)
+{
+    return &clk;
+}
+
+int64_t ts_now_us(void)
+{
+    return ts_clock_now(&clk, read_counter);
+}
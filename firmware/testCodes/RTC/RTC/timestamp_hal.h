@@ -0,0 +1,35 @@
+/******************************************************************************
+* File Name:   timestamp_hal.h
+*
+* Description: Target port of the timestamp service: a free-running 32-bit
+*              TCPWM counter at 1 MHz, anchored by the RTC alarm interrupt
+*              that is re-armed for every next second.
+*
+*******************************************************************************/
+
+#ifndef TIMESTAMP_HAL_H_
+#define TIMESTAMP_HAL_H_
+
+#include "cyhal.h"
+#include "timestamp.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define TS_HAL_RTC_IRQ_PRIORITY           (2u)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Starts the counter, waits for the next RTC second edge (at most 1 s) to
+ * anchor on it, then keeps anchoring from the RTC alarm. The RTC must be
+ * running. */
+cy_rslt_t ts_hal_init(cyhal_rtc_t *rtc);
+
+/* Re-anchors after the RTC was written. Blocks until the next edge. */
+cy_rslt_t ts_hal_resync(void);
+
+/* Edge statistics, for diagnostics. */
+const ts_clock_t *ts_hal_clock(void);
+
+#endif /* TIMESTAMP_HAL_H_ */
@@ -0,0 +1,128 @@
+/******************************************************************************
+* File Name:   bmi160_fifo.c
+*
+* Description: BMI160 FIFO frame parser, see bmi160_fifo.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "bmi160_fifo.h"
+
+#define FH_MODE_MASK        0xC0
+#define FH_MODE_REGULAR     0x80
+#define FH_MODE_CONTROL     0x40
+#define FH_MAG              0x10
+#define FH_GYR              0x08
+#define FH_ACC              0x04
+
+#define FH_SKIP             0x40
+#define FH_SENSORTIME       0x44
+#define FH_CONFIG           0x48
+#define FH_OVER_READ        0x80
+
+#define MAG_BYTES           (8u)
+#define AXES_BYTES          (6u)
+
+static void get_axes(const uint8_t *p, int16_t v[3])
+{
+    v[0] = (int16_t)((p[1] << 8) | p[0]);
+    v[1] = (int16_t)((p[3] << 8) | p[2]);
+    v[2] = (int16_t)((p[5] << 8) | p[4]);
+}
+
+size_t imu_fifo_parse(const uint8_t *buf, size_t len, imu_block_t *blk)
+{
+    size_t i = 0;
+
+    blk->count = 0;
+    blk->skipped = 0;
+    blk->has_sensortime = false;
+    blk->sensortime = 0;
+
+    while (i < len)
+    {
+        uint8_t h = buf[i];
+
+        if (h == FH_OVER_READ)
+        {
+            break;
+        }
+
+        if ((h & FH_MODE_MASK) == FH_MODE_REGULAR)
+        {
+            size_t n = 1u + ((h & FH_MAG) ? MAG_BYTES : 0u) + ((h & FH_GYR) ? AXES_BYTES : 0u) +
+                       ((h & FH_ACC) ? AXES_BYTES : 0u);
+            if ((i + n) > len)
+            {
+                break;
+            }
+            if ((h & (FH_GYR | FH_ACC)) && (blk->count < IMU_BLOCK_MAX))
+            {
+                imu_sample_t *s = &blk->s[blk->count];
+                if (blk->count > 0u)
+                {
+                    *s = blk->s[blk->count - 1u];
+                }
+                else
+                {
+                    memset(s, 0, sizeof(*s));
+                }
+
+                const uint8_t *p = &buf[i + 1u + ((h & FH_MAG) ? MAG_BYTES : 0u)];
+                if (h & FH_GYR)
+                {
+                    get_axes(p, s->gyr);
+                    p += AXES_BYTES;
+                }
+                if (h & FH_ACC)
+                {
+                    get_axes(p, s->acc);
+                }
+                blk->count++;
+            }
+            i += n;
+            continue;
+        }
+
+        /* Control frames; anything unknown means we lost frame sync. */
+        if (h == FH_SKIP)
+        {
+            if ((i + 2u) > len)
+            {
+                break;
+            }
+            blk->skipped = (uint16_t)(blk->skipped + buf[i + 1u]);
+            i += 2u;
+        }
+        else if (h == FH_SENSORTIME)
+        {
+            if ((i + 4u) > len)
+            {
+                break;
+            }
+            blk->sensortime = (uint32_t)buf[i + 1u] | ((uint32_t)buf[i + 2u] << 8) |
+                              ((uint32_t)buf[i + 3u] << 16);
+            blk->has_sensortime = true;
+            i += 4u;
+        }
+        else if (h == FH_CONFIG)
+        {
+            if ((i + 2u) > len)
+            {
+                break;
+            }
+            i += 2u;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+void imu_fifo_stamp(imu_block_t *blk, int64_t t_last_us, uint32_t period_us)
+{
+    blk->period_us = period_us;
+    blk->t_first_us = (blk->count > 0u) ? (t_last_us - (int64_t)(blk->count - 1u) * period_us) : t_last_us;
+}
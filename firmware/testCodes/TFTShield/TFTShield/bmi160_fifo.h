@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name:   bmi160_fifo.h
+*
+* Description: BMI160 FIFO in header mode: register map for the FIFO and its
+*              interrupts, and a parser that turns one burst read of
+*              FIFO_DATA into a block of timestamped accel+gyro samples.
+*
+*              Frames (datasheet 2.11.2), first byte is the header:
+*                10 m g a xx   regular frame: mag(8) gyr(6) acc(6), as enabled
+*                0100 0000     skip frame, 1 byte: frames lost to overflow
+*                0100 0100     sensortime, 3 bytes (appended on over-read)
+*                0100 1000     FIFO config changed, 1 byte
+*                1000 0000     over-read: no more data
+*
+*              The parser has no HAL calls, so captured dumps can be fed to
+*              it on a host.
+*
+*******************************************************************************/
+
+#ifndef BMI160_FIFO_H_
+#define BMI160_FIFO_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define REG_SENSORTIME          0x18     // 3 bytes, 39.0625 us/LSB
+#define REG_FIFO_LENGTH         0x22     // 2 bytes, 11 bits fill level
+#define REG_FIFO_DATA           0x24
+#define REG_ACC_CONF            0x40
+#define REG_GYR_CONF            0x42
+#define REG_FIFO_CONFIG_0       0x46     // watermark, units of 4 bytes
+#define REG_FIFO_CONFIG_1       0x47
+#define REG_INT_EN_1            0x51
+#define REG_INT_OUT_CTRL        0x53
+#define REG_INT_LATCH           0x54
+#define REG_INT_MAP_1           0x56
+
+#define CMD_FIFO_FLUSH          0xB0
+
+#define FIFO_CFG1_GYR_EN        0x80
+#define FIFO_CFG1_ACC_EN        0x40
+#define FIFO_CFG1_HEADER_EN     0x10
+#define FIFO_CFG1_TIME_EN       0x02
+
+#define INT_EN_1_FWM            0x40
+#define INT_EN_1_DRDY           0x10
+#define INT_MAP_1_INT1_FWM      0x40
+#define INT_MAP_1_INT1_DRDY     0x80
+#define INT_OUT_CTRL_INT1_PP_HI 0x0A     // output enabled, push-pull, active high
+
+/* ACC_CONF/GYR_CONF: normal filter mode, ODR code in the low nibble. */
+#define CONF_BWP_NORMAL         0x20
+#define ODR_100HZ               0x08
+#define ODR_200HZ               0x09
+#define ODR_400HZ               0x0A
+#define ODR_800HZ               0x0B
+
+#define IMU_FIFO_BYTES          (1024u)
+#define IMU_FRAME_BYTES         (13u)    // header + gyr + acc
+#define IMU_BLOCK_MAX           (IMU_FIFO_BYTES / IMU_FRAME_BYTES + 1u)
+
+/* Sensortime LSB is 39.0625 us = 625/16 us. */
+#define IMU_SENSORTIME_US(t)    (((uint64_t)(t) * 625u) >> 4)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int16_t gyr[3];
+    int16_t acc[3];
+} imu_sample_t;
+
+typedef struct
+{
+    imu_sample_t s[IMU_BLOCK_MAX];
+    uint16_t     count;
+    uint16_t     skipped;       /* frames lost to FIFO overflow */
+    bool         has_sensortime;
+    uint32_t     sensortime;    /* 24 bits, of the last frame */
+    int64_t      t_first_us;    /* time of s[0], see imu_fifo_stamp() */
+    uint32_t     period_us;
+} imu_block_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Parses a burst read of FIFO_DATA. Frames with only gyro or only accel data
+ * (different ODRs) repeat the last value of the other sensor. Stops at the
+ * over-read marker or a truncated frame; returns the bytes consumed. */
+size_t imu_fifo_parse(const uint8_t *buf, size_t len, imu_block_t *blk);
+
+/* Timestamps the block: t_last_us is the time of the last sample, samples
+ * are period_us apart. Stamping backwards from the newest sample keeps
+ * frames lost to an overflow (at the old end) from shifting the rest. */
+void imu_fifo_stamp(imu_block_t *blk, int64_t t_last_us, uint32_t period_us);
+
+#endif /* BMI160_FIFO_H_ */
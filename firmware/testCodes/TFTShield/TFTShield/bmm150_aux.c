@@ -0,0 +1,149 @@
+/******************************************************************************
+* File Name:   bmm150_aux.c
+*
+* Description: BMM150 via the BMI160 auxiliary interface, see bmm150_aux.h.
+*
+*******************************************************************************/
+
+#include "bmm150_aux.h"
+#include "i2c_bus_hal.h"
+
+#define BMI160_REG_CMD          0x7E
+#define BMM150_AUX_RSLT_NO_DEV  CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_I2C, 0x81u)
+#define MAN_OP_POLLS            (10u)   /* 1 ms each; an aux access takes ~0.1 ms */
+
+#define X_OVERFLOW              (-4096)
+#define Z_OVERFLOW              (-16384)
+
+static cy_rslt_t write_u8(i2c_bus_t *bus, uint8_t dev, uint8_t reg, uint8_t val)
+{
+    uint8_t b[2] = { reg, val };
+    i2c_txn_t t;
+    i2c_txn_setup(&t, dev, b, 2, NULL, 0, NULL, NULL);
+    return i2c_bus_hal_transfer(bus, &t);
+}
+
+static cy_rslt_t read_u8(i2c_bus_t *bus, uint8_t dev, uint8_t reg, uint8_t *val)
+{
+    i2c_txn_t t;
+    i2c_txn_setup(&t, dev, &reg, 1, val, 1, NULL, NULL);
+    return i2c_bus_hal_transfer(bus, &t);
+}
+
+/* Waits until the BMI160 finished a manual aux access. */
+static cy_rslt_t wait_man_op(i2c_bus_t *bus, uint8_t imu)
+{
+    for (uint32_t i = 0; i < MAN_OP_POLLS; ++i)
+    {
+        uint8_t st = 0;
+        cy_rslt_t rslt = read_u8(bus, imu, REG_STATUS, &st);
+        if ((rslt != CY_RSLT_SUCCESS) || ((st & STATUS_MAG_MAN_OP) == 0u))
+        {
+            return rslt;
+        }
+        cyhal_system_delay_ms(1);
+    }
+    return BMM150_AUX_RSLT_NO_DEV;
+}
+
+static cy_rslt_t aux_write(i2c_bus_t *bus, uint8_t imu, uint8_t reg, uint8_t val)
+{
+    cy_rslt_t rslt = write_u8(bus, imu, REG_MAG_IF_4, val);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = write_u8(bus, imu, REG_MAG_IF_3, reg);
+    }
+    return (rslt == CY_RSLT_SUCCESS) ? wait_man_op(bus, imu) : rslt;
+}
+
+static cy_rslt_t aux_read(i2c_bus_t *bus, uint8_t imu, uint8_t reg, uint8_t *val)
+{
+    cy_rslt_t rslt = write_u8(bus, imu, REG_MAG_IF_2, reg);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = wait_man_op(bus, imu);
+    }
+    return (rslt == CY_RSLT_SUCCESS) ? read_u8(bus, imu, REG_DATA_MAG, val) : rslt;
+}
+
+cy_rslt_t bmm150_aux_init(i2c_bus_t *bus, uint8_t imu_addr)
+{
+    uint8_t id = 0;
+
+    cy_rslt_t rslt = write_u8(bus, imu_addr, BMI160_REG_CMD, CMD_MAG_IF_NORMAL);
+    cyhal_system_delay_ms(2);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = write_u8(bus, imu_addr, REG_IF_CONF, IF_CONF_AUX_MAG);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = write_u8(bus, imu_addr, REG_MAG_IF_0, (uint8_t)(BMM150_ADDR << 1));
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = write_u8(bus, imu_addr, REG_MAG_IF_1, MAG_IF_1_MANUAL | MAG_IF_1_BURST_1);
+    }
+
+    /* Out of suspend, then check that something answers */
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = aux_write(bus, imu_addr, BMM150_POWER, 0x01);
+        cyhal_system_delay_ms(3);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = aux_read(bus, imu_addr, BMM150_CHIP_ID, &id);
+    }
+    if ((rslt == CY_RSLT_SUCCESS) && (id != BMM150_CHIP_ID_VAL))
+    {
+        rslt = BMM150_AUX_RSLT_NO_DEV;
+    }
+
+    /* Regular preset. The last write (forced mode) stays in MAG_IF_3/4 and
+     * is repeated by the BMI160 after every read in data mode. */
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = aux_write(bus, imu_addr, BMM150_REP_XY, BMM150_REP_XY_REGULAR);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = aux_write(bus, imu_addr, BMM150_REP_Z, BMM150_REP_Z_REGULAR);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = aux_write(bus, imu_addr, BMM150_OP_MODE, BMM150_OP_FORCED);
+    }
+
+    /* Data mode: 8 bytes from DATA_X at the MAG_CONF rate */
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = write_u8(bus, imu_addr, REG_MAG_IF_2, BMM150_DATA);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = write_u8(bus, imu_addr, REG_MAG_CONF, MAG_ODR_25HZ);
+    }
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        rslt = write_u8(bus, imu_addr, REG_MAG_IF_1, MAG_IF_1_BURST_8);
+    }
+    return rslt;
+}
+
+bool bmm150_aux_parse(const uint8_t raw[8], int16_t mag[3])
+{
+    /* x and y are 13 bits in bits 15..3, z is 15 bits in bits 15..1 */
+    int16_t x = (int16_t)((raw[1] << 8) | raw[0]);
+    int16_t y = (int16_t)((raw[3] << 8) | raw[2]);
+    int16_t z = (int16_t)((raw[5] << 8) | raw[4]);
+
+    mag[0] = (int16_t)(x >> 3);
+    mag[1] = (int16_t)(y >> 3);
+    mag[2] = (int16_t)(z >> 1);
+    if ((mag[0] == X_OVERFLOW) || (mag[1] == X_OVERFLOW) || (mag[2] == Z_OVERFLOW))
+    {
+        return false;
+    }
+    return (mag[0] != 0) || (mag[1] != 0) || (mag[2] != 0);
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+* File Name:   bmm150_aux.h
+*
+* Description: BMM150 magnetometer behind the BMI160 auxiliary interface
+*              (BMX160, or a BMM150 on the BMI160 secondary I2C pins).
+*              Setup goes through the manual mode of MAG_IF; afterwards the
+*              BMI160 polls the BMM150 by itself (data mode, forced
+*              measurements at the MAG_CONF rate) and the latest reading is
+*              in DATA_MAG, next to the accel and gyro registers.
+*
+*              Raw counts are returned without the trim compensation of the
+*              Bosch API: the fusion only uses the field direction, and the
+*              trim mainly corrects the gain per part (about 0.3 uT/LSB on
+*              all axes).
+*
+*******************************************************************************/
+
+#ifndef BMM150_AUX_H_
+#define BMM150_AUX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cy_result.h"
+#include "i2c_bus.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* BMI160 side */
+#define REG_DATA_MAG            0x04     // 8 bytes: x, y, z, rhall of the BMM150
+#define REG_STATUS              0x1B
+#define REG_MAG_CONF            0x44     // ODR code in the low nibble
+#define REG_MAG_IF_0            0x4B     // slave address << 1
+#define REG_MAG_IF_1            0x4C     // manual mode, read burst length
+#define REG_MAG_IF_2            0x4D     // read address (manual: starts the read)
+#define REG_MAG_IF_3            0x4E     // write address (starts the write)
+#define REG_MAG_IF_4            0x4F     // write data
+#define REG_IF_CONF             0x6B
+
+#define CMD_MAG_IF_NORMAL       0x19
+#define STATUS_MAG_MAN_OP       0x04
+#define IF_CONF_AUX_MAG         0x20
+#define MAG_IF_1_MANUAL         0x80
+#define MAG_IF_1_BURST_1        0x00
+#define MAG_IF_1_BURST_8        0x03
+#define MAG_ODR_25HZ            0x06
+
+/* BMM150 side */
+#define BMM150_ADDR             0x10
+#define BMM150_CHIP_ID          0x40     // 0x32
+#define BMM150_CHIP_ID_VAL      0x32
+#define BMM150_DATA             0x42
+#define BMM150_POWER            0x4B
+#define BMM150_OP_MODE          0x4C     // 0x02 = forced
+#define BMM150_REP_XY           0x51
+#define BMM150_REP_Z            0x52
+
+#define BMM150_OP_FORCED        0x02
+#define BMM150_REP_XY_REGULAR   0x04     // 9 repetitions
+#define BMM150_REP_Z_REGULAR    0x0E     // 15 repetitions
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Finds the BMM150 behind the BMI160 at imu_addr and starts data mode at
+ * 25 Hz. Blocking, for init code. Fails if no BMM150 answers. */
+cy_rslt_t bmm150_aux_init(i2c_bus_t *bus, uint8_t imu_addr);
+
+/* Raw x, y, z from the 8 bytes at DATA_MAG. Returns false on an overflow
+ * reading (or when no measurement was made yet). */
+bool bmm150_aux_parse(const uint8_t raw[8], int16_t mag[3]);
+
+#endif /* BMM150_AUX_H_ */
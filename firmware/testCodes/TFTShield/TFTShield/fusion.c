@@ -0,0 +1,164 @@
+/******************************************************************************
+* File Name:   fusion.c
+*
+* Description: Fixed-point Mahony filter, see fusion.h.
+*
+*******************************************************************************/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "fusion.h"
+#include "motion.h"
+
+#define FU_HALF             (FU_ONE / 2)
+
+static inline int32_t mul30(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> 30);
+}
+
+/* v / |v| in Q30. The square is shifted up by an even amount first so the
+ * root keeps 16 bits whatever the scale of v. */
+static bool unit(const int16_t *v, int32_t out[3])
+{
+    uint32_t sq = 0u;
+    for (int a = 0; a < 3; ++a)
+    {
+        sq += (uint32_t)((int32_t)v[a] * v[a]);     /* <= 3 * 2^30 */
+    }
+    if (sq == 0u)
+    {
+        return false;
+    }
+    uint32_t k = (uint32_t)__builtin_clz(sq) & ~1u;
+    uint32_t n = me_isqrt(sq << k);                 /* |v| << k/2, >= 2^15 */
+    uint32_t recip = 0xFFFFFFFFu / n;               /* 2^32 / n */
+    for (int a = 0; a < 3; ++a)
+    {
+        int32_t x = (int32_t)v[a] * (int32_t)(1u << (k / 2u));
+        out[a] = (int32_t)(((int64_t)x * recip) >> 2);
+    }
+    return true;
+}
+
+/* sqrt(x^2 + y^2) of Q30 values below 1, to 16 bits. */
+static int32_t planar(int32_t x, int32_t y)
+{
+    uint32_t s = (uint32_t)mul30(x, x) + (uint32_t)mul30(y, y);
+    if (s > 0x3FFFFFFFu)
+    {
+        s = 0x3FFFFFFFu;
+    }
+    return (int32_t)(me_isqrt(s << 2) << 14);
+}
+
+fu_cfg_t fu_default_cfg(uint32_t period_us)
+{
+    fu_cfg_t c = {
+        .gyr_rad_q40 = FU_GYR_2000DPS_Q40,
+        .dt_q32      = (uint32_t)(((uint64_t)period_us << 32) / 1000000u),
+        .two_kp_q16  = FU_TWO_KP_Q16,
+        .two_ki_q16  = FU_TWO_KI_Q16
+    };
+    return c;
+}
+
+void fu_init(fu_filter_t *f, const fu_cfg_t *cfg)
+{
+    memset(f, 0, sizeof(*f));
+    f->cfg = *cfg;
+    f->q.w = FU_ONE;
+}
+
+void fu_update(fu_filter_t *f, const imu_sample_t *s, const int16_t *mag)
+{
+    const fu_cfg_t *c = &f->cfg;
+    int32_t q0 = f->q.w, q1 = f->q.x, q2 = f->q.y, q3 = f->q.z;
+    int32_t g[3], a[3], m[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        g[i] = (int32_t)(((int64_t)s->gyr[i] * c->gyr_rad_q40) >> 16);
+    }
+
+    if (unit(s->acc, a))
+    {
+        int32_t q0q0 = mul30(q0, q0), q0q1 = mul30(q0, q1), q0q2 = mul30(q0, q2), q0q3 = mul30(q0, q3);
+        int32_t q1q1 = mul30(q1, q1), q1q2 = mul30(q1, q2), q1q3 = mul30(q1, q3);
+        int32_t q2q2 = mul30(q2, q2), q2q3 = mul30(q2, q3), q3q3 = mul30(q3, q3);
+
+        /* Half of the predicted gravity direction, error = a x v */
+        int32_t vx = q1q3 - q0q2;
+        int32_t vy = q0q1 + q2q3;
+        int32_t vz = q0q0 - FU_HALF + q3q3;
+        int32_t e[3] = {
+            mul30(a[1], vz) - mul30(a[2], vy),
+            mul30(a[2], vx) - mul30(a[0], vz),
+            mul30(a[0], vy) - mul30(a[1], vx)
+        };
+
+        if ((mag != NULL) && unit(mag, m))
+        {
+            /* Field in the earth frame, flattened onto north and down */
+            int32_t hx = 2 * (mul30(m[0], FU_HALF - q2q2 - q3q3) + mul30(m[1], q1q2 - q0q3) + mul30(m[2], q1q3 + q0q2));
+            int32_t hy = 2 * (mul30(m[0], q1q2 + q0q3) + mul30(m[1], FU_HALF - q1q1 - q3q3) + mul30(m[2], q2q3 - q0q1));
+            int32_t bz = 2 * (mul30(m[0], q1q3 - q0q2) + mul30(m[1], q2q3 + q0q1) + mul30(m[2], FU_HALF - q1q1 - q2q2));
+            int32_t bx = planar(hx, hy);
+
+            /* Half of its predicted direction, error += m x w */
+            int32_t wx = mul30(bx, FU_HALF - q2q2 - q3q3) + mul30(bz, q1q3 - q0q2);
+            int32_t wy = mul30(bx, q1q2 - q0q3) + mul30(bz, q0q1 + q2q3);
+            int32_t wz = mul30(bx, q0q2 + q1q3) + mul30(bz, FU_HALF - q1q1 - q2q2);
+            e[0] += mul30(m[1], wz) - mul30(m[2], wy);
+            e[1] += mul30(m[2], wx) - mul30(m[0], wz);
+            e[2] += mul30(m[0], wy) - mul30(m[1], wx);
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            /* Q30 * Q16 >> 22 = Q24 rad/s. The integral steps are tiny,
+             * so it is kept in Q40. */
+            if (c->two_ki_q16 != 0)
+            {
+                int64_t ki = ((int64_t)e[i] * c->two_ki_q16) >> 16;
+                f->ei_q40[i] += (ki * (int64_t)c->dt_q32) >> 22;
+                g[i] += (int32_t)(f->ei_q40[i] >> 16);
+            }
+            g[i] += (int32_t)(((int64_t)e[i] * c->two_kp_q16) >> 22);
+        }
+    }
+
+    /* Half angle steps: Q24 * Q32 >> 26 is Q30, halved */
+    int32_t hx = (int32_t)(((int64_t)g[0] * (int64_t)c->dt_q32) >> 27);
+    int32_t hy = (int32_t)(((int64_t)g[1] * (int64_t)c->dt_q32) >> 27);
+    int32_t hz = (int32_t)(((int64_t)g[2] * (int64_t)c->dt_q32) >> 27);
+
+    int32_t n0 = q0 - mul30(q1, hx) - mul30(q2, hy) - mul30(q3, hz);
+    int32_t n1 = q1 + mul30(q0, hx) + mul30(q2, hz) - mul30(q3, hy);
+    int32_t n2 = q2 + mul30(q0, hy) - mul30(q1, hz) + mul30(q3, hx);
+    int32_t n3 = q3 + mul30(q0, hz) + mul30(q1, hy) - mul30(q2, hx);
+
+    /* |q| stays within a fraction of a percent of 1, so one Newton step
+     * (3 - |q|^2) / 2 from 1 is enough for 1/|q|. */
+    int64_t sq = ((int64_t)n0 * n0 + (int64_t)n1 * n1 + (int64_t)n2 * n2 + (int64_t)n3 * n3) >> 30;
+    int32_t inv = (int32_t)((3 * (int64_t)FU_ONE - sq) >> 1);
+    f->q.w = mul30(n0, inv);
+    f->q.x = mul30(n1, inv);
+    f->q.y = mul30(n2, inv);
+    f->q.z = mul30(n3, inv);
+    f->updates++;
+}
+
+void fu_update_block(fu_filter_t *f, const imu_sample_t *s, uint32_t n,
+                     const int16_t *mag, fu_quat_t *out)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        fu_update(f, &s[i], mag);
+        if (out != NULL)
+        {
+            out[i] = f->q;
+        }
+    }
+}
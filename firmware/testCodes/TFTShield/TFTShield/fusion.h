@@ -0,0 +1,81 @@
+/******************************************************************************
+* File Name:   fusion.h
+*
+* Description: Orientation fusion (Mahony complementary filter) in fixed
+*              point on raw BMI160 counts, with an optional BMM150
+*              magnetometer for heading. One update per IMU sample:
+*                - accel (and mag) give the reference directions, the cross
+*                  product with the directions predicted by the quaternion
+*                  is the error,
+*                - the error feeds back into the gyro rates (PI gains),
+*                - the rates are integrated into the quaternion, which is
+*                  renormalised with one Newton step.
+*
+*              Formats: quaternion and unit vectors Q30, rates Q24 rad/s.
+*              Products are 32x32->64 multiplies (SMULL on the CM4); no
+*              floating point and one 32-bit division per direction
+*              vector. No HAL calls.
+*
+*******************************************************************************/
+
+#ifndef FUSION_H_
+#define FUSION_H_
+
+#include <stdint.h>
+#include "bmi160_fifo.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define FU_ONE                  ((int32_t)1 << 30)  /* 1.0 in Q30 */
+
+/* pi/180/16.4 rad/s per LSB at +-2000 dps, Q40 */
+#define FU_GYR_2000DPS_Q40      ((int32_t)1170127931)
+
+/* Mahony gains 2*Kp, 2*Ki, Q16 */
+#define FU_TWO_KP_Q16           ((int32_t)65536)    /* 1.0 */
+#define FU_TWO_KI_Q16           ((int32_t)0)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int32_t w, x, y, z;         /* Q30, unit length */
+} fu_quat_t;
+
+typedef struct
+{
+    int32_t  gyr_rad_q40;       /* rad/s per gyro LSB */
+    uint32_t dt_q32;            /* sample period in s */
+    int32_t  two_kp_q16;
+    int32_t  two_ki_q16;        /* 0 disables the integral term */
+} fu_cfg_t;
+
+typedef struct
+{
+    fu_cfg_t  cfg;
+    fu_quat_t q;
+    int64_t   ei_q40[3];        /* integral of the error, rad/s */
+    uint32_t  updates;
+} fu_filter_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Defaults for +-2000 dps at the given sample period. */
+fu_cfg_t fu_default_cfg(uint32_t period_us);
+
+/* Starts at the identity orientation. */
+void fu_init(fu_filter_t *f, const fu_cfg_t *cfg);
+
+/* One sample. mag (x, y, z in the IMU frame, any scale) may be NULL or all
+ * zero for a 6-axis update; an all-zero accel skips the correction. */
+void fu_update(fu_filter_t *f, const imu_sample_t *s, const int16_t *mag);
+
+/* n samples with the same mag reading (the magnetometer runs slower).
+ * If out is not NULL it receives the orientation after every sample. */
+void fu_update_block(fu_filter_t *f, const imu_sample_t *s, uint32_t n,
+                     const int16_t *mag, fu_quat_t *out);
+
+#endif /* FUSION_H_ */
@@ -0,0 +1,186 @@
+/******************************************************************************
+* File Name:   convert_bench.c
+*
+* Description: Host tool for imu_convert: puts every int16 value through every
+*              path built in (float and fixed point, gyro and acc positions,
+*              all tail lengths) and compares bit for bit with the scalar
+*              path, then times each path on FIFO-sized blocks. Exits
+*              non-zero on any difference.
+*
+*                cc -O2 -I.. -o convert_bench convert_bench.c ../imu_convert.c
+*
+*              With the Cortex-M4 path emulated (checks only; the timing of
+*              the emulation says nothing about the target):
+*
+*                cc -O2 -I.. -Iemu -D__ARM_FEATURE_DSP -o convert_bench \
+*                   convert_bench.c ../imu_convert.c
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "imu_convert.h"
+
+#define NSAMP               (65536u / 6u * 6u + 6u)   /* every value, all 6 positions */
+#define BLOCK               (IMU_BLOCK_MAX)
+#define ROUNDS              (20000u)
+
+typedef void (*f32_fn)(const imu_sample_t *, uint32_t, const cv_scale_f32_t *, const cv_f32_t *);
+typedef void (*fx_fn)(const imu_sample_t *, uint32_t, const cv_scale_fx_t *, const cv_fx_t *);
+
+typedef struct
+{
+    const char *name;
+    f32_fn      f32;
+    fx_fn       fx;
+} path_t;
+
+static imu_sample_t samples[NSAMP];
+static float    ref_f[6][NSAMP], got_f[6][NSAMP];
+static int32_t  ref_x[6][NSAMP], got_x[6][NSAMP];
+
+static const cv_scale_f32_t kf = { CV_GYR_DPS_PER_LSB, CV_ACC_G_PER_LSB };
+static const cv_scale_fx_t  kx = { CV_GYR_DPS_Q16_K, CV_ACC_G_Q16_K, 16u };
+
+static cv_f32_t f32_out(float (*a)[NSAMP])
+{
+    cv_f32_t o = { { a[0], a[1], a[2] }, { a[3], a[4], a[5] } };
+    return o;
+}
+
+static cv_fx_t fx_out(int32_t (*a)[NSAMP])
+{
+    cv_fx_t o = { { a[0], a[1], a[2] }, { a[3], a[4], a[5] } };
+    return o;
+}
+
+static double now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+/* Full run, then every length 0..2*8+7 from odd offsets for the tails */
+static int check(const path_t *p)
+{
+    int bad = 0;
+    cv_f32_t of = f32_out(got_f);
+    cv_fx_t ox = fx_out(got_x);
+
+    memset(got_f, 0xA5, sizeof(got_f));
+    memset(got_x, 0xA5, sizeof(got_x));
+    p->f32(samples, NSAMP, &kf, &of);
+    p->fx(samples, NSAMP, &kx, &ox);
+    bad += memcmp(got_f, ref_f, sizeof(ref_f)) != 0;
+    bad += memcmp(got_x, ref_x, sizeof(ref_x)) != 0;
+
+    for (uint32_t n = 0; n < 24u; ++n)
+    {
+        uint32_t off = 1u + 3u * n;
+        cv_f32_t tf = f32_out(got_f);
+        cv_fx_t tx = fx_out(got_x);
+        for (int a = 0; a < 3; ++a)
+        {
+            tf.gyr[a] += off; tf.acc[a] += off;
+            tx.gyr[a] += off; tx.acc[a] += off;
+        }
+        memset(got_f, 0xA5, sizeof(got_f));
+        memset(got_x, 0xA5, sizeof(got_x));
+        p->f32(samples + off, n, &kf, &tf);
+        p->fx(samples + off, n, &kx, &tx);
+        for (int a = 0; a < 6; ++a)
+        {
+            /* in range equal, the word after untouched */
+            bad += memcmp(&got_f[a][off], &ref_f[a][off], n * sizeof(float)) != 0;
+            bad += memcmp(&got_x[a][off], &ref_x[a][off], n * sizeof(int32_t)) != 0;
+            bad += got_x[a][off + n] != (int32_t)0xA5A5A5A5;
+        }
+    }
+    return bad;
+}
+
+static void timing(const path_t *p)
+{
+    cv_f32_t of = f32_out(got_f);
+    cv_fx_t ox = fx_out(got_x);
+    double t0 = now_ns();
+    for (uint32_t r = 0; r < ROUNDS; ++r)
+    {
+        p->f32(samples + (r & 255u), BLOCK, &kf, &of);
+    }
+    double t1 = now_ns();
+    for (uint32_t r = 0; r < ROUNDS; ++r)
+    {
+        p->fx(samples + (r & 255u), BLOCK, &kx, &ox);
+    }
+    double t2 = now_ns();
+    printf("%-8s f32 %6.2f ns/sample   fx %6.2f ns/sample\n", p->name,
+           (t1 - t0) / (ROUNDS * (double)BLOCK), (t2 - t1) / (ROUNDS * (double)BLOCK));
+}
+
+int main(void)
+{
+    path_t paths[6];
+    int np = 0, fail = 0;
+
+    paths[np++] = (path_t){ "scalar", cv_f32_scalar, cv_fx_scalar };
+#if defined(__ARM_FEATURE_DSP)
+    paths[np++] = (path_t){ "dsp", cv_f32_dsp, cv_fx_dsp };
+#endif
+#if defined(__SSE2__)
+    paths[np++] = (path_t){ "sse2", cv_f32_sse2, cv_fx_sse2 };
+#endif
+#if defined(CV_HAVE_AVX2)
+    if (cv_avx2_ok())
+    {
+        paths[np++] = (path_t){ "avx2", cv_f32_avx2, cv_fx_avx2 };
+    }
+#endif
+    paths[np++] = (path_t){ "cv_*", cv_f32, cv_fx };
+
+    /* Value v at sample v/6 + ..., shifted per row so that each value
+     * appears in each of the six positions */
+    int16_t *raw = &samples[0].gyr[0];
+    for (uint32_t i = 0; i < NSAMP * 6u; ++i)
+    {
+        raw[i] = (int16_t)(uint16_t)(i + i / 65536u);
+    }
+
+    cv_f32_t rf = f32_out(ref_f);
+    cv_fx_t rx = fx_out(ref_x);
+    cv_f32_scalar(samples, NSAMP, &kf, &rf);
+    cv_fx_scalar(samples, NSAMP, &kx, &rx);
+
+    /* Scalar against the obvious formulas */
+    uint32_t div_ulp = 0;
+    for (uint32_t i = 0; i < NSAMP; ++i)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            int32_t g = samples[i].gyr[a], c = samples[i].acc[a];
+            fail += ref_x[a][i] != ((g * CV_GYR_DPS_Q16_K) >> 16);
+            fail += ref_x[3 + a][i] != ((c * CV_ACC_G_Q16_K) >> 16);
+            fail += ref_f[3 + a][i] != (float)c / 16384.0f;
+            div_ulp += ref_f[a][i] != (float)g / 16.4f;
+            fail += fabsf(ref_f[a][i] - (float)g / 16.4f) > fabsf((float)g / 16.4f) * 1.2e-7f;
+        }
+    }
+    printf("scalar   formulas %s; gyro float differs from raw/16.4 by 1 ulp in %u of %u\n",
+           fail ? "FAIL" : "OK", div_ulp, NSAMP * 3u);
+
+    for (int i = 1; i < np; ++i)
+    {
+        int bad = check(&paths[i]);
+        printf("%-8s bit-exact with scalar: %s\n", paths[i].name, bad ? "FAIL" : "OK");
+        fail += bad;
+    }
+    for (int i = 0; i < np; ++i)
+    {
+        timing(&paths[i]);
+    }
+    return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,23 @@
+/******************************************************************************
+* File Name:   cmsis_compiler.h
+*
+* Description: Host stand-in for the CMSIS header, only the intrinsics that
+*              imu_convert.c uses, in plain C with the Cortex-M4 semantics.
+*              Lets the DSP path run on the host with -D__ARM_FEATURE_DSP.
+*
+*******************************************************************************/
+
+#ifndef CMSIS_COMPILER_H_
+#define CMSIS_COMPILER_H_
+
+#include <stdint.h>
+
+/* Dual signed 16x16 multiply, products added (wraps like the instruction) */
+static inline uint32_t __SMUAD(uint32_t op1, uint32_t op2)
+{
+    int32_t lo = (int32_t)(int16_t)op1 * (int16_t)op2;
+    int32_t hi = (int32_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16);
+    return (uint32_t)lo + (uint32_t)hi;
+}
+
+#endif /* CMSIS_COMPILER_H_ */
@@ -0,0 +1,334 @@
+/******************************************************************************
+* File Name:   fifo_parse_check.c
+*
+* Description: Host checks for imu_fifo_parse() on BMI160 FIFO byte dumps
+*              built frame by frame as the datasheet lays them out (2.11.2):
+*              accel+gyro frames, skip, sensortime and config frames, the
+*              0x80 padding an over-read returns, frames with mag bytes,
+*              gyro-only and accel-only frames, a full 1024-byte FIFO and a
+*              burst that ends inside a frame. Then random dumps for bounds
+*              (build with -fsanitize=address,undefined as well). Prints one
+*              line per check and exits non-zero if any failed.
+*
+*                cc -I.. -o fifo_parse_check fifo_parse_check.c ../bmi160_fifo.c
+*
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bmi160_fifo.h"
+
+#define H_ACC               0x84
+#define H_GYR               0x88
+#define H_GYR_ACC           0x8C
+#define H_MAG               0x90
+#define H_MAG_GYR_ACC       0x9C
+#define H_SKIP              0x40
+#define H_SENSORTIME        0x44
+#define H_CONFIG            0x48
+#define H_OVER_READ         0x80
+
+#define DUMP_MAX            (2048u)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+typedef struct
+{
+    uint8_t b[DUMP_MAX];
+    size_t  len;
+} dump_t;
+
+static void put_axes(dump_t *d, const int16_t v[3])
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        d->b[d->len++] = (uint8_t)v[k];
+        d->b[d->len++] = (uint8_t)((uint16_t)v[k] >> 8);
+    }
+}
+
+/* Sample n, different on every axis and sign */
+static imu_sample_t sample(int n)
+{
+    imu_sample_t s;
+    for (int k = 0; k < 3; ++k)
+    {
+        s.gyr[k] = (int16_t)(n * 311 - k * 7919 - 16000);
+        s.acc[k] = (int16_t)(-n * 173 + k * 4099 + 8000);
+    }
+    return s;
+}
+
+static void frame(dump_t *d, uint8_t h, const imu_sample_t *s)
+{
+    d->b[d->len++] = h;
+    if (h & 0x10)
+    {
+        /* mag x/y/z and RHALL, values the parser must not pick up */
+        for (int k = 0; k < 8; ++k)
+        {
+            d->b[d->len++] = (uint8_t)(0xA5 ^ k);
+        }
+    }
+    if (h & 0x08)
+    {
+        put_axes(d, s->gyr);
+    }
+    if (h & 0x04)
+    {
+        put_axes(d, s->acc);
+    }
+}
+
+static void control(dump_t *d, uint8_t h, uint32_t v)
+{
+    d->b[d->len++] = h;
+    d->b[d->len++] = (uint8_t)v;
+    if (h == H_SENSORTIME)
+    {
+        d->b[d->len++] = (uint8_t)(v >> 8);
+        d->b[d->len++] = (uint8_t)(v >> 16);
+    }
+}
+
+static void over_read(dump_t *d, size_t n)
+{
+    memset(&d->b[d->len], H_OVER_READ, n);
+    d->len += n;
+}
+
+static bool same(const imu_sample_t *a, const imu_sample_t *b)
+{
+    return memcmp(a->gyr, b->gyr, sizeof(a->gyr)) == 0 && memcmp(a->acc, b->acc, sizeof(a->acc)) == 0;
+}
+
+static bool samples_are(const imu_block_t *blk, int first, int n)
+{
+    bool ok = (blk->count == n);
+    for (int i = 0; ok && (i < n); ++i)
+    {
+        imu_sample_t want = sample(first + i);
+        ok = same(&blk->s[i], &want);
+    }
+    return ok;
+}
+
+static void regular(void)
+{
+    static dump_t d;
+    static imu_block_t blk;
+
+    d.len = 0u;
+    for (int i = 0; i < 40; ++i)
+    {
+        imu_sample_t s = sample(i);
+        frame(&d, H_GYR_ACC, &s);
+    }
+    size_t used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 40) && (used == d.len) && (blk.skipped == 0u) && !blk.has_sensortime,
+          "40 accel+gyro frames, little-endian, signed");
+
+    /* A full FIFO: 78 whole frames and the first 10 bytes of the next */
+    d.len = 0u;
+    for (int i = 0; d.len + IMU_FRAME_BYTES <= IMU_FIFO_BYTES; ++i)
+    {
+        imu_sample_t s = sample(i);
+        frame(&d, H_GYR_ACC, &s);
+    }
+    size_t whole = d.len;
+    imu_sample_t s = sample(78);
+    frame(&d, H_GYR_ACC, &s);
+    d.len = IMU_FIFO_BYTES;
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 78) && (used == whole) && (blk.count <= IMU_BLOCK_MAX),
+          "full 1024-byte FIFO fits one block");
+}
+
+static void control_frames(void)
+{
+    static dump_t d;
+    static imu_block_t blk;
+    imu_sample_t s;
+
+    /* Overflow: the FIFO starts with a skip frame, here twice */
+    d.len = 0u;
+    control(&d, H_SKIP, 5u);
+    control(&d, H_SKIP, 250u);
+    for (int i = 0; i < 10; ++i)
+    {
+        s = sample(i);
+        frame(&d, H_GYR_ACC, &s);
+    }
+    size_t used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 10) && (blk.skipped == 255u) && (used == d.len), "skip frames summed, samples kept");
+    imu_fifo_stamp(&blk, 1000000, 5000u);
+    check(blk.t_first_us == 1000000 - 9 * 5000, "lost frames do not shift the stamps");
+
+    /* Config change in the middle, then the sensortime an over-read appends
+     * and the 0x80 padding up to the burst length */
+    d.len = 0u;
+    for (int i = 0; i < 6; ++i)
+    {
+        s = sample(i);
+        frame(&d, H_GYR_ACC, &s);
+        if (i == 2)
+        {
+            control(&d, H_CONFIG, 0x01u);
+        }
+    }
+    control(&d, H_SENSORTIME, 0xABCDEFu);
+    size_t end = d.len;
+    over_read(&d, 300u);
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 6), "config frame stepped over");
+    check(blk.has_sensortime && (blk.sensortime == 0xABCDEFu), "sensortime read, 24 bits little-endian");
+    check(used == end, "stops at the 0x80 over-read padding");
+
+    /* The same with the padding starting right after the data */
+    d.len = 0u;
+    s = sample(0);
+    frame(&d, H_GYR_ACC, &s);
+    end = d.len;
+    over_read(&d, 1u);
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 1) && (used == end) && !blk.has_sensortime, "single 0x80 byte after one frame");
+
+    /* An empty FIFO reads as padding only */
+    d.len = 0u;
+    over_read(&d, 64u);
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    check((blk.count == 0u) && (used == 0u), "empty FIFO: no samples, nothing consumed");
+
+    /* Lost frame sync: an unknown header ends the block */
+    d.len = 0u;
+    s = sample(0);
+    frame(&d, H_GYR_ACC, &s);
+    end = d.len;
+    d.b[d.len++] = 0x4C;
+    s = sample(1);
+    frame(&d, H_GYR_ACC, &s);
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 1) && (used == end), "unknown control header stops the parse");
+}
+
+static void truncated(void)
+{
+    static dump_t d, full;
+    static imu_block_t blk;
+    imu_sample_t s;
+
+    /* Every possible cut through the last frame of each kind */
+    static const uint8_t last[] = { H_GYR_ACC, H_MAG_GYR_ACC, H_ACC, H_SKIP, H_SENSORTIME, H_CONFIG };
+    bool ok = true;
+    for (size_t k = 0; k < sizeof(last); ++k)
+    {
+        full.len = 0u;
+        for (int i = 0; i < 3; ++i)
+        {
+            s = sample(i);
+            frame(&full, H_GYR_ACC, &s);
+        }
+        size_t start = full.len;
+        s = sample(3);
+        if (last[k] & 0x80)
+        {
+            frame(&full, last[k], &s);
+        }
+        else
+        {
+            control(&full, last[k], 0x123456u);
+        }
+        for (size_t cut = start; cut < full.len; ++cut)
+        {
+            memcpy(d.b, full.b, cut);
+            d.len = cut;
+            size_t used = imu_fifo_parse(d.b, d.len, &blk);
+            ok &= samples_are(&blk, 0, 3) && (used == start) && !blk.has_sensortime && (blk.skipped == 0u);
+        }
+    }
+    check(ok, "truncated trailing frame left unconsumed, any cut");
+}
+
+static void mag_and_mixed(void)
+{
+    static dump_t d;
+    static imu_block_t blk;
+    imu_sample_t s;
+
+    /* mag+gyr+acc frames: 21 bytes, the mag bytes skipped */
+    d.len = 0u;
+    for (int i = 0; i < 20; ++i)
+    {
+        s = sample(i);
+        frame(&d, H_MAG_GYR_ACC, &s);
+    }
+    size_t used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 20) && (used == d.len) && (d.len == 20u * 21u), "mag+gyr+acc frames: mag bytes skipped");
+
+    /* mag-only frames in between carry no accel/gyro sample */
+    d.len = 0u;
+    for (int i = 0; i < 5; ++i)
+    {
+        s = sample(i);
+        frame(&d, H_GYR_ACC, &s);
+        frame(&d, H_MAG, &s);
+    }
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    check(samples_are(&blk, 0, 5) && (used == d.len), "mag-only frames add no sample");
+
+    /* Accel at twice the gyro rate: gyro-less frames repeat the last gyro */
+    d.len = 0u;
+    imu_sample_t a = sample(0), b = sample(1);
+    frame(&d, H_GYR_ACC, &a);
+    frame(&d, H_ACC, &b);
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    bool ok = (blk.count == 2u) && same(&blk.s[0], &a) && (memcmp(blk.s[1].gyr, a.gyr, sizeof(a.gyr)) == 0) &&
+              (memcmp(blk.s[1].acc, b.acc, sizeof(b.acc)) == 0);
+    /* and a gyro-only first frame starts from zero accel */
+    d.len = 0u;
+    frame(&d, H_GYR, &a);
+    used = imu_fifo_parse(d.b, d.len, &blk);
+    ok &= (blk.count == 1u) && (memcmp(blk.s[0].gyr, a.gyr, sizeof(a.gyr)) == 0) &&
+          (blk.s[0].acc[0] == 0) && (blk.s[0].acc[1] == 0) && (blk.s[0].acc[2] == 0);
+    check(ok && (used == d.len), "single-sensor frames repeat the other sensor");
+}
+
+static void random_dumps(void)
+{
+    static uint8_t buf[IMU_FIFO_BYTES];
+    static imu_block_t blk;
+    bool ok = true;
+
+    /* Mostly valid headers, so the parser gets deep into the buffer */
+    static const uint8_t heads[] = { H_GYR_ACC, H_ACC, H_GYR, H_MAG_GYR_ACC, H_MAG, H_SKIP, H_SENSORTIME, H_CONFIG };
+    srand(18);
+    for (int r = 0; r < 20000; ++r)
+    {
+        size_t len = (size_t)(rand() % (int)IMU_FIFO_BYTES) + 1u;
+        for (size_t i = 0; i < len; ++i)
+        {
+            buf[i] = ((rand() & 3) == 0) ? heads[rand() % (int)sizeof(heads)] : (uint8_t)rand();
+        }
+        size_t used = imu_fifo_parse(buf, len, &blk);
+        ok &= (used <= len) && (blk.count <= IMU_BLOCK_MAX);
+    }
+    check(ok, "20000 random dumps: within the buffer and the block");
+}
+
+int main(void)
+{
+    regular();
+    control_frames();
+    truncated();
+    mag_and_mixed();
+    random_dumps();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
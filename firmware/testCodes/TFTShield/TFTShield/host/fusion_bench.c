@@ -0,0 +1,377 @@
+/******************************************************************************
+* File Name:   fusion_bench.c
+*
+* Description: Host check of the fixed-point fusion. Synthetic traces are
+*              made from a known orientation trajectory: quantised gyro with
+*              bias and noise, accel with noise and linear acceleration, and
+*              a magnetometer held at 25 Hz. Each trace goes through the
+*              fixed-point filter and the same filter in double; reported
+*              are the largest difference between the two (the cost of the
+*              fixed point), the error of both against the true orientation
+*              after convergence, and the time per update.
+*
+*              A recorded trace can be given instead: one sample per line,
+*              gx gy gz ax ay az [mx my mz] in raw counts at 200 Hz. It is
+*              only compared against the double filter.
+*
+*                cc -O2 -I.. -o fusion_bench fusion_bench.c ../fusion.c ../motion.c -lm
+*                ./fusion_bench [trace.txt]
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fusion.h"
+
+#define PERIOD_US           (5000u)
+#define DT                  (PERIOD_US * 1e-6)
+#define SECONDS             (120u)
+#define NMAX                (200u * 3600u)
+#define MAG_EVERY           (8u)            /* 25 Hz */
+#define WARMUP              (200u * 10u)    /* samples before errors count */
+#define ACC_LSB_PER_G       (16384.0)
+#define GYR_LSB_PER_DPS     (16.4)
+#define MAG_LSB_PER_UT      (1.0 / 0.3)
+#define DEG                 (M_PI / 180.0)
+
+typedef struct { double w, x, y, z; } dq_t;
+
+typedef struct
+{
+    imu_sample_t s[NMAX];
+    int16_t      mag[NMAX][3];
+    dq_t         truth[NMAX];
+    uint32_t     n;
+    bool         has_mag;
+    bool         has_truth;
+} trace_t;
+
+static trace_t tr;
+
+/*-------------------------------------------------------- quaternion helpers */
+static dq_t qmul(dq_t a, dq_t b)
+{
+    dq_t r = {
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w
+    };
+    return r;
+}
+
+static dq_t qnorm(dq_t q)
+{
+    double n = sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    dq_t r = { q.w / n, q.x / n, q.y / n, q.z / n };
+    return r;
+}
+
+/* Earth vector into the body frame: q* v q */
+static void to_body(dq_t q, const double v[3], double out[3])
+{
+    dq_t p = { 0.0, v[0], v[1], v[2] };
+    dq_t c = { q.w, -q.x, -q.y, -q.z };
+    dq_t r = qmul(qmul(c, p), q);
+    out[0] = r.x;
+    out[1] = r.y;
+    out[2] = r.z;
+}
+
+static double angle_deg(dq_t a, dq_t b)
+{
+    double d = fabs(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+    return 2.0 * acos((d > 1.0) ? 1.0 : d) / DEG;
+}
+
+static dq_t from_fixed(fu_quat_t q)
+{
+    dq_t r = { q.w / (double)FU_ONE, q.x / (double)FU_ONE, q.y / (double)FU_ONE, q.z / (double)FU_ONE };
+    return r;
+}
+
+/*----------------------------------------------------------- synthetic data */
+static double uniform(void)
+{
+    return (double)rand() / ((double)RAND_MAX + 1.0);
+}
+
+static double gauss(void)
+{
+    double u = uniform() + 1e-12;
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * uniform());
+}
+
+static int16_t q16(double v)
+{
+    v = floor(v + 0.5);
+    return (int16_t)((v > 32767.0) ? 32767.0 : ((v < -32768.0) ? -32768.0 : v));
+}
+
+typedef enum { SYN_STILL, SYN_SWING, SYN_SWING_MAG, SYN_CARRIED } syn_t;
+static const char *const syn_name[] = { "still", "swing 6-axis", "swing 9-axis", "carried 9-axis" };
+
+static void synthesize(syn_t kind)
+{
+    /* Netherlands: 49 uT, inclination 67 deg; x north, z up */
+    const double field[3] = { 49.0 * cos(67.0 * DEG), 0.0, -49.0 * sin(67.0 * DEG) };
+    const double up[3] = { 0.0, 0.0, 1.0 };
+    const double bias_dps[3] = { 0.4, -0.3, 0.2 };
+    dq_t q = qnorm((dq_t){ cos(10.0 * DEG), sin(10.0 * DEG), 0.0, 0.0 });   /* 20 deg roll */
+    int16_t m_held[3] = { 0, 0, 0 };
+
+    srand(3);
+    tr.n = 200u * SECONDS;
+    tr.has_mag = (kind == SYN_SWING_MAG) || (kind == SYN_CARRIED);
+    tr.has_truth = true;
+    for (uint32_t i = 0; i < tr.n; ++i)
+    {
+        double t = i * DT;
+        double w[3] = { 0.0, 0.0, 0.0 };    /* rad/s, body frame */
+        double lin[3] = { 0.0, 0.0, 0.0 };  /* g, body frame */
+
+        if (kind != SYN_STILL)
+        {
+            w[0] = 90.0 * DEG * sin(2.0 * M_PI * 0.31 * t);
+            w[1] = 60.0 * DEG * sin(2.0 * M_PI * 0.17 * t + 1.0);
+            w[2] = 120.0 * DEG * sin(2.0 * M_PI * 0.07 * t + 2.0);
+        }
+        if (kind == SYN_CARRIED)
+        {
+            /* steps: 0.3 g bounce at 1.8 Hz */
+            lin[2] = 0.3 * sin(2.0 * M_PI * 1.8 * t);
+            lin[0] = 0.1 * sin(2.0 * M_PI * 0.9 * t);
+        }
+
+        double g_b[3], m_b[3];
+        to_body(q, up, g_b);
+        to_body(q, field, m_b);
+        tr.truth[i] = q;
+        for (int a = 0; a < 3; ++a)
+        {
+            tr.s[i].gyr[a] = q16((w[a] / DEG + bias_dps[a]) * GYR_LSB_PER_DPS + gauss() * 1.5);
+            tr.s[i].acc[a] = q16((g_b[a] + lin[a]) * ACC_LSB_PER_G + gauss() * 30.0);
+        }
+        if ((i % MAG_EVERY) == 0u)
+        {
+            for (int a = 0; a < 3; ++a)
+            {
+                m_held[a] = q16(m_b[a] * MAG_LSB_PER_UT + gauss() * 2.0);
+            }
+        }
+        memcpy(tr.mag[i], m_held, sizeof(m_held));
+
+        /* Advance the truth over this period in fine steps */
+        for (int k = 0; k < 50; ++k)
+        {
+            double h = DT / 50.0 / 2.0;
+            dq_t dq = { 1.0, w[0] * h, w[1] * h, w[2] * h };
+            q = qnorm(qmul(q, dq));
+        }
+    }
+}
+
+static bool load(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char line[256];
+
+    if (fp == NULL)
+    {
+        return false;
+    }
+    tr.n = 0;
+    tr.has_mag = false;
+    tr.has_truth = false;
+    while ((tr.n < NMAX) && (fgets(line, sizeof(line), fp) != NULL))
+    {
+        int v[9];
+        int k = sscanf(line, "%d %d %d %d %d %d %d %d %d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8]);
+        if (k < 6)
+        {
+            continue;
+        }
+        for (int a = 0; a < 3; ++a)
+        {
+            tr.s[tr.n].gyr[a] = (int16_t)v[a];
+            tr.s[tr.n].acc[a] = (int16_t)v[3 + a];
+            tr.mag[tr.n][a] = (int16_t)((k == 9) ? v[6 + a] : 0);
+        }
+        tr.has_mag |= (k == 9);
+        tr.n++;
+    }
+    fclose(fp);
+    return tr.n > 0u;
+}
+
+/*------------------------------------------------- reference filter, double */
+typedef struct
+{
+    dq_t   q;
+    double ei[3];
+} ref_t;
+
+static void ref_update(ref_t *r, const imu_sample_t *s, const int16_t *mag, const fu_cfg_t *c)
+{
+    double two_kp = c->two_kp_q16 / 65536.0;
+    double two_ki = c->two_ki_q16 / 65536.0;
+    double gs = c->gyr_rad_q40 / 1099511627776.0;
+    double g[3] = { s->gyr[0] * gs, s->gyr[1] * gs, s->gyr[2] * gs };
+    double q0 = r->q.w, q1 = r->q.x, q2 = r->q.y, q3 = r->q.z;
+    double an = sqrt((double)s->acc[0] * s->acc[0] + (double)s->acc[1] * s->acc[1] + (double)s->acc[2] * s->acc[2]);
+
+    if (an > 0.0)
+    {
+        double a[3] = { s->acc[0] / an, s->acc[1] / an, s->acc[2] / an };
+        double vx = q1 * q3 - q0 * q2, vy = q0 * q1 + q2 * q3, vz = q0 * q0 - 0.5 + q3 * q3;
+        double e[3] = { a[1] * vz - a[2] * vy, a[2] * vx - a[0] * vz, a[0] * vy - a[1] * vx };
+        double mn = (mag != NULL) ? sqrt((double)mag[0] * mag[0] + (double)mag[1] * mag[1] + (double)mag[2] * mag[2]) : 0.0;
+
+        if (mn > 0.0)
+        {
+            double m[3] = { mag[0] / mn, mag[1] / mn, mag[2] / mn };
+            double hx = 2.0 * (m[0] * (0.5 - q2 * q2 - q3 * q3) + m[1] * (q1 * q2 - q0 * q3) + m[2] * (q1 * q3 + q0 * q2));
+            double hy = 2.0 * (m[0] * (q1 * q2 + q0 * q3) + m[1] * (0.5 - q1 * q1 - q3 * q3) + m[2] * (q2 * q3 - q0 * q1));
+            double bz = 2.0 * (m[0] * (q1 * q3 - q0 * q2) + m[1] * (q2 * q3 + q0 * q1) + m[2] * (0.5 - q1 * q1 - q2 * q2));
+            double bx = sqrt(hx * hx + hy * hy);
+            double wx = bx * (0.5 - q2 * q2 - q3 * q3) + bz * (q1 * q3 - q0 * q2);
+            double wy = bx * (q1 * q2 - q0 * q3) + bz * (q0 * q1 + q2 * q3);
+            double wz = bx * (q0 * q2 + q1 * q3) + bz * (0.5 - q1 * q1 - q2 * q2);
+            e[0] += m[1] * wz - m[2] * wy;
+            e[1] += m[2] * wx - m[0] * wz;
+            e[2] += m[0] * wy - m[1] * wx;
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            if (two_ki > 0.0)
+            {
+                r->ei[i] += two_ki * e[i] * DT;
+                g[i] += r->ei[i];
+            }
+            g[i] += two_kp * e[i];
+        }
+    }
+
+    double h = 0.5 * DT;
+    dq_t n = {
+        q0 + (-q1 * g[0] - q2 * g[1] - q3 * g[2]) * h,
+        q1 + (q0 * g[0] + q2 * g[2] - q3 * g[1]) * h,
+        q2 + (q0 * g[1] - q1 * g[2] + q3 * g[0]) * h,
+        q3 + (q0 * g[2] + q1 * g[1] - q2 * g[0]) * h
+    };
+    r->q = qnorm(n);
+}
+
+/*-------------------------------------------------------------------- main */
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int run(const char *name, const fu_cfg_t *cfg)
+{
+    fu_filter_t f;
+    ref_t r = { { 1.0, 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+    double max_diff = 0.0, err_fx = 0.0, err_ref = 0.0, max_fx = 0.0;
+    uint32_t counted = 0;
+
+    fu_init(&f, cfg);
+    for (uint32_t i = 0; i < tr.n; ++i)
+    {
+        const int16_t *m = tr.has_mag ? tr.mag[i] : NULL;
+        fu_update(&f, &tr.s[i], m);
+        ref_update(&r, &tr.s[i], m, cfg);
+
+        dq_t qf = from_fixed(f.q);
+        double d = angle_deg(qf, r.q);
+        max_diff = (d > max_diff) ? d : max_diff;
+        if (tr.has_truth && (i >= WARMUP))
+        {
+            double ef = angle_deg(qf, tr.truth[i]);
+            /* 6-axis cannot see heading: compare tilt only */
+            if (!tr.has_mag)
+            {
+                double zf[3], zt[3];
+                const double up[3] = { 0.0, 0.0, 1.0 };
+                to_body(qf, up, zf);
+                to_body(tr.truth[i], up, zt);
+                ef = acos(fmin(1.0, zf[0] * zt[0] + zf[1] * zt[1] + zf[2] * zt[2])) / DEG;
+                to_body(r.q, up, zf);
+                err_ref += pow(acos(fmin(1.0, zf[0] * zt[0] + zf[1] * zt[1] + zf[2] * zt[2])) / DEG, 2.0);
+            }
+            else
+            {
+                err_ref += pow(angle_deg(r.q, tr.truth[i]), 2.0);
+            }
+            err_fx += ef * ef;
+            max_fx = (ef > max_fx) ? ef : max_fx;
+            counted++;
+        }
+    }
+
+    /* Timing, whole trace repeated */
+    const int reps = 20;
+    double t0 = now_ns();
+    for (int k = 0; k < reps; ++k)
+    {
+        fu_init(&f, cfg);
+        fu_update_block(&f, tr.s, tr.n, tr.has_mag ? tr.mag[0] : NULL, NULL);
+    }
+    double ns_fx = (now_ns() - t0) / (reps * (double)tr.n);
+    t0 = now_ns();
+    for (int k = 0; k < reps; ++k)
+    {
+        r.q = (dq_t){ 1.0, 0.0, 0.0, 0.0 };
+        for (uint32_t i = 0; i < tr.n; ++i)
+        {
+            ref_update(&r, &tr.s[i], tr.has_mag ? tr.mag[0] : NULL, cfg);
+        }
+    }
+    double ns_ref = (now_ns() - t0) / (reps * (double)tr.n);
+
+    printf("%-16s fixed vs double max %.4f deg", name, max_diff);
+    if (counted > 0u)
+    {
+        printf("  %s error rms %.2f deg (double %.2f), max %.2f deg",
+               tr.has_mag ? "orientation" : "tilt",
+               sqrt(err_fx / counted), sqrt(err_ref / counted), max_fx);
+    }
+    printf("  %.1f ns/update (double %.1f)\n", ns_fx, ns_ref);
+    /* The fixed point may not cost accuracy: a hundredth of a degree */
+    return (max_diff > 0.01) ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    fu_cfg_t cfg = fu_default_cfg(PERIOD_US);
+    int fail = 0;
+
+    if (argc > 1)
+    {
+        if (!load(argv[1]))
+        {
+            printf("cannot read %s\n", argv[1]);
+            return 2;
+        }
+        fail |= run(argv[1], &cfg);
+    }
+    else
+    {
+        for (int k = SYN_STILL; k <= SYN_CARRIED; ++k)
+        {
+            synthesize((syn_t)k);
+            fail |= run(syn_name[k], &cfg);
+        }
+        /* With the integral term the gyro bias is learned */
+        cfg.two_ki_q16 = 6554;  /* 0.1 */
+        synthesize(SYN_SWING_MAG);
+        fail |= run("swing 9-axis, ki", &cfg);
+    }
+    printf(fail ? "FAIL\n" : "OK\n");
+    return fail;
+}
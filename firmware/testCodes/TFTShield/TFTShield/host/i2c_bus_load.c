@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name:   i2c_bus_load.c
+*
+* Description: Host tool: bus utilisation and IMU burst latency for the
+*              IMU FIFO, a pressure sensor and an OLED sharing one bus, at
+*              standard, fast and fast-mode-plus rates.
+*
+*                cc -I.. -o i2c_bus_load i2c_bus_load.c i2c_bus_sim.c ../i2c_bus.c
+*
+*******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "i2c_bus_sim.h"
+
+#define SIM_SECONDS         (2u)
+#define TURNAROUND_NS       (5000u)         /* ISR + restart on target */
+
+#define IMU_ADDR            0x68
+#define IMU_FIFO_DATA       0x24
+#define IMU_FRAME_BYTES     (13u)
+#define BARO_ADDR           0x76
+#define OLED_ADDR           0x3C
+#define OLED_CHUNK          (128u)          /* one page per transaction */
+
+typedef struct
+{
+    const char *name;
+    uint32_t    period_ns;
+    i2c_txn_t   txn;
+    uint8_t     tx[1 + OLED_CHUNK];
+    uint8_t     rx[1024];
+    uint64_t    submitted_ns;
+    uint64_t    worst_ns;
+    uint32_t    late;           /* previous one still pending at its next slot */
+} client_t;
+
+static i2c_sim_t sim;
+
+static void imu_stream(i2c_sim_dev_t *d, uint8_t *buf, size_t n)
+{
+    (void)d;
+    for (size_t i = 0; i < n; i += IMU_FRAME_BYTES)
+    {
+        buf[i] = 0x8C;
+    }
+}
+
+static void client_done(i2c_txn_t *t, void *arg)
+{
+    client_t *c = (client_t *)arg;
+    uint64_t lat = sim.now_ns - c->submitted_ns;
+    (void)t;
+    if (lat > c->worst_ns)
+    {
+        c->worst_ns = lat;
+    }
+}
+
+static void run(uint32_t hz, uint32_t imu_hz, uint32_t wm_frames)
+{
+    i2c_bus_t bus;
+    i2c_sim_dev_t imu, baro, oled;
+    client_t c[3];
+
+    i2c_sim_init(&sim, &bus, hz, TURNAROUND_NS);
+    i2c_sim_dev_init(&imu, IMU_ADDR);
+    imu.stream_reg = IMU_FIFO_DATA;
+    imu.stream = imu_stream;
+    i2c_sim_dev_init(&baro, BARO_ADDR);
+    i2c_sim_dev_init(&oled, OLED_ADDR);
+    i2c_sim_attach(&sim, &imu);
+    i2c_sim_attach(&sim, &baro);
+    i2c_sim_attach(&sim, &oled);
+
+    memset(c, 0, sizeof(c));
+    /* IMU: one FIFO burst per watermark, plus sensortime */
+    c[0].name = "imu";
+    c[0].period_ns = (uint32_t)(1000000000ull * wm_frames / imu_hz);
+    c[0].tx[0] = IMU_FIFO_DATA;
+    i2c_txn_setup(&c[0].txn, IMU_ADDR, c[0].tx, 1, c[0].rx,
+                  (uint16_t)(wm_frames * IMU_FRAME_BYTES + 4u), client_done, &c[0]);
+    /* Pressure + temperature burst at 25 Hz */
+    c[1].name = "baro";
+    c[1].period_ns = 40000000u;
+    c[1].tx[0] = 0xF7;
+    i2c_txn_setup(&c[1].txn, BARO_ADDR, c[1].tx, 1, c[1].rx, 8, client_done, &c[1]);
+    /* 128x64 OLED at 10 fps: 8 pages of 128 bytes, one page per slot */
+    c[2].name = "oled";
+    c[2].period_ns = 100000000u / 8u;
+    c[2].tx[0] = 0x40;
+    i2c_txn_setup(&c[2].txn, OLED_ADDR, c[2].tx, 1 + OLED_CHUNK, NULL, 0, client_done, &c[2]);
+
+    uint64_t next[3] = {0, 1000000u, 2000000u};
+    uint64_t end = (uint64_t)SIM_SECONDS * 1000000000u;
+    for (;;)
+    {
+        size_t k = 0;
+        for (size_t i = 1; i < 3; ++i)
+        {
+            if (next[i] < next[k])
+            {
+                k = i;
+            }
+        }
+        if (next[k] >= end)
+        {
+            break;
+        }
+        i2c_sim_run_until(&sim, next[k]);
+        if (i2c_bus_submit(&bus, &c[k].txn))
+        {
+            c[k].submitted_ns = sim.now_ns;
+        }
+        else
+        {
+            c[k].late++;
+        }
+        next[k] += c[k].period_ns;
+    }
+    i2c_sim_run_until(&sim, end);
+
+    printf("%7lu Hz  imu %4lu Hz wm %2lu  util %5.1f %%  worst latency us: imu %7.1f baro %7.1f oled %7.1f  late %lu/%lu/%lu  err %lu\n",
+           (unsigned long)hz, (unsigned long)imu_hz, (unsigned long)wm_frames,
+           100.0 * i2c_sim_utilisation(&sim),
+           c[0].worst_ns / 1e3, c[1].worst_ns / 1e3, c[2].worst_ns / 1e3,
+           (unsigned long)c[0].late, (unsigned long)c[1].late, (unsigned long)c[2].late,
+           (unsigned long)bus.errors);
+}
+
+int main(void)
+{
+    static const uint32_t rates[] = { I2C_BUS_HZ_STANDARD, I2C_BUS_HZ_FAST, I2C_BUS_HZ_FAST_PLUS };
+    static const uint32_t imu_hz[] = { 200u, 800u, 1600u };
+
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r)
+    {
+        for (size_t i = 0; i < sizeof(imu_hz) / sizeof(imu_hz[0]); ++i)
+        {
+            run(rates[r], imu_hz[i], 16u);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+* File Name:   i2c_bus_sim.c
+*
+* Description: Host port of the shared I2C bus, see i2c_bus_sim.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "i2c_bus_sim.h"
+
+static i2c_sim_dev_t *find(const i2c_sim_t *sim, uint8_t addr)
+{
+    for (size_t i = 0; i < sim->ndev; ++i)
+    {
+        if (sim->dev[i]->addr == addr)
+        {
+            return sim->dev[i];
+        }
+    }
+    return NULL;
+}
+
+/* The data moves at completion, like a DMA'd transfer seen by the CPU. */
+static bool execute(i2c_sim_t *sim, const i2c_txn_t *t)
+{
+    i2c_sim_dev_t *d = find(sim, t->addr);
+    if (d == NULL)
+    {
+        return false;           /* address NACK */
+    }
+
+    if (t->tx_len > 0u)
+    {
+        d->ptr = t->tx[0];
+        for (uint16_t i = 1u; i < t->tx_len; ++i)
+        {
+            d->regs[d->ptr++] = t->tx[i];
+        }
+    }
+    if (t->rx_len > 0u)
+    {
+        if ((d->stream_reg >= 0) && (d->ptr == (uint8_t)d->stream_reg) && (d->stream != NULL))
+        {
+            d->stream(d, t->rx, t->rx_len);
+        }
+        else
+        {
+            for (uint16_t i = 0u; i < t->rx_len; ++i)
+            {
+                t->rx[i] = d->regs[d->ptr++];
+            }
+        }
+    }
+    return true;
+}
+
+static bool sim_start(i2c_txn_t *t, void *ctx)
+{
+    i2c_sim_t *sim = (i2c_sim_t *)ctx;
+    uint64_t wire_ns = (uint64_t)i2c_txn_bits(t) * 1000000000u / sim->bus->hz + sim->turnaround_ns;
+
+    sim->active = t;
+    sim->done_at_ns = sim->now_ns + wire_ns;
+    sim->busy_ns += wire_ns;
+    return true;
+}
+
+void i2c_sim_init(i2c_sim_t *sim, i2c_bus_t *bus, uint32_t hz, uint32_t turnaround_ns)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->bus = bus;
+    sim->turnaround_ns = turnaround_ns;
+    i2c_bus_init(bus, sim_start, sim, hz);
+}
+
+void i2c_sim_dev_init(i2c_sim_dev_t *d, uint8_t addr)
+{
+    memset(d, 0, sizeof(*d));
+    d->addr = addr;
+    d->stream_reg = -1;
+}
+
+void i2c_sim_attach(i2c_sim_t *sim, i2c_sim_dev_t *d)
+{
+    if (sim->ndev < I2C_SIM_MAX_DEVICES)
+    {
+        sim->dev[sim->ndev++] = d;
+    }
+}
+
+void i2c_sim_run_until(i2c_sim_t *sim, uint64_t t_ns)
+{
+    while ((sim->active != NULL) && (sim->done_at_ns <= t_ns))
+    {
+        i2c_txn_t *t = sim->active;
+        sim->now_ns = sim->done_at_ns;
+        sim->active = NULL;
+        i2c_bus_complete(sim->bus, execute(sim, t));
+    }
+    if (t_ns > sim->now_ns)
+    {
+        sim->now_ns = t_ns;
+    }
+}
+
+double i2c_sim_utilisation(const i2c_sim_t *sim)
+{
+    /* A transfer still on the wire counts only up to now. */
+    uint64_t busy = sim->busy_ns;
+    if ((sim->active != NULL) && (sim->done_at_ns > sim->now_ns))
+    {
+        busy -= sim->done_at_ns - sim->now_ns;
+    }
+    return (sim->now_ns > 0u) ? ((double)busy / (double)sim->now_ns) : 0.0;
+}
@@ -0,0 +1,73 @@
+/******************************************************************************
+* File Name:   i2c_bus_sim.h
+*
+* Description: Host port of the shared I2C bus: simulated register-map
+*              devices on a virtual clock. A transaction occupies the bus for
+*              its wire bits at the bus rate plus a fixed turnaround (the
+*              interrupt and restart cost on target) and completes when the
+*              clock is advanced past that point, so queueing, callbacks and
+*              bus utilisation behave as on target. Not part of the firmware
+*              build.
+*
+*******************************************************************************/
+
+#ifndef I2C_BUS_SIM_H_
+#define I2C_BUS_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "i2c_bus.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define I2C_SIM_MAX_DEVICES               (8u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct i2c_sim_dev i2c_sim_dev_t;
+
+/* Produces n bytes for a read of the stream register (e.g. FIFO_DATA). */
+typedef void (*i2c_sim_stream_t)(i2c_sim_dev_t *d, uint8_t *buf, size_t n);
+
+struct i2c_sim_dev
+{
+    uint8_t          addr;
+    uint8_t          regs[256];
+    uint8_t          ptr;           /* register pointer, auto-increments */
+    int              stream_reg;    /* no auto-increment; -1 for none */
+    i2c_sim_stream_t stream;
+    void            *user;
+};
+
+typedef struct
+{
+    i2c_bus_t      *bus;
+    i2c_sim_dev_t  *dev[I2C_SIM_MAX_DEVICES];
+    size_t          ndev;
+    uint32_t        turnaround_ns;
+    uint64_t        now_ns;
+    uint64_t        busy_ns;        /* time the bus was occupied */
+    i2c_txn_t      *active;
+    uint64_t        done_at_ns;
+} i2c_sim_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Initialises bus with the simulated port at hz. */
+void i2c_sim_init(i2c_sim_t *sim, i2c_bus_t *bus, uint32_t hz, uint32_t turnaround_ns);
+
+/* Devices are not copied; stream_reg is -1 until set. */
+void i2c_sim_dev_init(i2c_sim_dev_t *d, uint8_t addr);
+void i2c_sim_attach(i2c_sim_t *sim, i2c_sim_dev_t *d);
+
+/* Runs the clock to t_ns, completing transactions (and running their
+ * callbacks, which may submit more) on the way. */
+void i2c_sim_run_until(i2c_sim_t *sim, uint64_t t_ns);
+
+/* Fraction of the elapsed time the bus was occupied. */
+double i2c_sim_utilisation(const i2c_sim_t *sim);
+
+#endif /* I2C_BUS_SIM_H_ */
@@ -0,0 +1,294 @@
+/******************************************************************************
+* File Name:   imu_cal_check.c
+*
+* Description: Host checks for imu_cal: the stored record format (CRC over
+*              every bit, erased flash, choice between the two rows,
+*              sequence wrap) and the estimator on synthetic 200 Hz data
+*              (still and flat, moving, tilted, slowly turning, and hours of
+*              gyro drift with temperature). Prints one line per check and
+*              exits non-zero if any failed.
+*
+*                cc -I.. -o imu_cal_check imu_cal_check.c ../imu_cal.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "imu_cal.h"
+
+#define RATE_HZ             (200u)
+#define LSB_PER_DPS         (16.4)
+#define LSB_PER_G           (16384.0)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+/*--------------------------------------------------------------- synthetic */
+static double gauss(void)
+{
+    double u = ((double)rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double v = (double)rand() / ((double)RAND_MAX + 1.0);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static int16_t q16(double v)
+{
+    v = floor(v + 0.5);
+    return (int16_t)((v > 32767.0) ? 32767.0 : ((v < -32768.0) ? -32768.0 : v));
+}
+
+typedef struct
+{
+    double gyr_bias[3];         /* counts */
+    double acc_bias[3];         /* counts */
+    double tilt_deg;            /* about x */
+    double turn_dps;            /* constant rotation about z */
+    bool   moving;              /* walking: swinging rates, bouncing accel */
+} scene_t;
+
+static void gen(const scene_t *sc, imu_sample_t *s, uint32_t n, uint32_t t0)
+{
+    double ct = cos(sc->tilt_deg * M_PI / 180.0), st = sin(sc->tilt_deg * M_PI / 180.0);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        double t = (t0 + i) / (double)RATE_HZ;
+        double w[3] = { 0.0, 0.0, sc->turn_dps };
+        double a[3] = { 0.0, st, ct };
+        if (sc->moving)
+        {
+            w[0] += 40.0 * sin(2.0 * M_PI * 0.9 * t);
+            w[1] += 25.0 * sin(2.0 * M_PI * 1.8 * t);
+            a[2] += 0.3 * sin(2.0 * M_PI * 1.8 * t);
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+            s[i].gyr[k] = q16(w[k] * LSB_PER_DPS + sc->gyr_bias[k] + gauss() * 1.5);
+            s[i].acc[k] = q16(a[k] * LSB_PER_G + sc->acc_bias[k] + gauss() * 20.0);
+        }
+    }
+}
+
+static void feed_seconds(ic_cal_t *c, const scene_t *sc, uint32_t seconds, uint32_t *t)
+{
+    imu_sample_t blk[8];
+    for (uint32_t i = 0; i < seconds * RATE_HZ; i += 8u)
+    {
+        gen(sc, blk, 8u, *t);
+        *t += 8u;
+        (void)ic_feed(c, blk, 8u);
+    }
+}
+
+static double gyr_err(const ic_cal_t *c, const scene_t *sc)
+{
+    double e = 0.0;
+    for (int k = 0; k < 3; ++k)
+    {
+        e = fmax(e, fabs(c->rec.gyr_q4[k] / 16.0 - sc->gyr_bias[k]));
+    }
+    return e;
+}
+
+static double acc_err(const ic_cal_t *c, const scene_t *sc)
+{
+    double e = 0.0;
+    for (int k = 0; k < 3; ++k)
+    {
+        e = fmax(e, fabs(c->rec.acc_q4[k] / 16.0 - sc->acc_bias[k]));
+    }
+    return e;
+}
+
+/*------------------------------------------------------------------ record */
+static void record_checks(void)
+{
+    ic_record_t a, b, erased;
+    bool all = true;
+
+    memset(&a, 0, sizeof(a));
+    a.temp_raw = -1234;
+    a.acc_q4[0] = 1920;
+    a.gyr_q4[2] = -656;
+    a.seq = 7;
+    a.windows = 42;
+    a.flags = IC_FLAG_GYR | IC_FLAG_ACC;
+    ic_record_seal(&a);
+    check(ic_record_check(&a), "record: sealed record checks");
+
+    for (size_t byte = 0; byte < sizeof(a); ++byte)
+    {
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            b = a;
+            ((uint8_t *)&b)[byte] ^= (uint8_t)(1u << bit);
+            all = all && !ic_record_check(&b);
+        }
+    }
+    check(all, "record: every single-bit error is caught");
+
+    b = a;
+    b.version = IC_VERSION + 1u;
+    b.crc = ic_crc16((const uint8_t *)&b, offsetof(ic_record_t, crc), 0xFFFFu);
+    check(!ic_record_check(&b), "record: other version rejected");
+
+    memset(&erased, 0xFF, sizeof(erased));
+    check(!ic_record_check(&erased), "record: erased flash rejected");
+    memset(&erased, 0x00, sizeof(erased));
+    check(!ic_record_check(&erased), "record: zeroed flash rejected");
+
+    check(ic_crc16((const uint8_t *)"123456789", 9, 0xFFFFu) == 0x29B1u, "record: CRC-16/CCITT-FALSE check value");
+    check((offsetof(ic_record_t, acc_q4) == 8u) && (offsetof(ic_record_t, gyr_q4) == 20u) &&
+          (offsetof(ic_record_t, seq) == 32u) && (offsetof(ic_record_t, crc) == 42u),
+          "record: field offsets");
+
+    /* Two rows */
+    b = a;
+    b.seq = 8;
+    ic_record_seal(&b);
+    memset(&erased, 0xFF, sizeof(erased));
+    check(ic_record_pick(&erased, &erased) == NULL, "pick: nothing stored");
+    check(ic_record_pick(&a, &erased) == &a, "pick: only row A");
+    check(ic_record_pick(&erased, &b) == &b, "pick: only row B");
+    check(ic_record_pick(&a, &b) == &b, "pick: B newer");
+    check(ic_record_pick(&b, &a) == &b, "pick: A newer");
+    ic_record_t torn = b;
+    torn.gyr_q4[0] ^= 0x100;
+    check(ic_record_pick(&a, &torn) == &a, "pick: newer row torn, older one used");
+    a.seq = 0xFFFFFFFFu;
+    ic_record_seal(&a);
+    b.seq = 0u;
+    ic_record_seal(&b);
+    check(ic_record_pick(&a, &b) == &b, "pick: sequence wrap");
+}
+
+/*--------------------------------------------------------------- estimator */
+static void estimator_checks(void)
+{
+    ic_cfg_t cfg = ic_default_cfg();
+    ic_cal_t c;
+    uint32_t t = 0;
+    char line[96];
+
+    srand(11);
+
+    /* Still and flat */
+    scene_t flat = { { 23.4, -41.2, 7.7 }, { 120.0, -300.0, 200.0 }, 0.0, 0.0, false };
+    ic_init(&c, &cfg, NULL);
+    feed_seconds(&c, &flat, 1, &t);
+    check(!ic_valid(&c), "estimate: not valid after one window");
+    feed_seconds(&c, &flat, 1, &t);
+    snprintf(line, sizeof(line), "estimate: flat, gyro %.2f acc %.2f counts off", gyr_err(&c, &flat), acc_err(&c, &flat));
+    check(ic_valid(&c) && (c.rec.flags & IC_FLAG_ACC) && (gyr_err(&c, &flat) < 0.25) && (acc_err(&c, &flat) < 3.0), line);
+
+    /* Moving all the time */
+    scene_t walk = flat;
+    walk.moving = true;
+    ic_init(&c, &cfg, NULL);
+    feed_seconds(&c, &walk, 60, &t);
+    check(!ic_valid(&c) && (c.still_windows == 0u), "estimate: never while walking");
+
+    /* Still but tilted: gyro yes, accel no until laid flat */
+    scene_t tilted = flat;
+    tilted.tilt_deg = 15.0;
+    ic_init(&c, &cfg, NULL);
+    feed_seconds(&c, &tilted, 3, &t);
+    check(ic_valid(&c) && !(c.rec.flags & IC_FLAG_ACC) && (gyr_err(&c, &tilted) < 0.25), "estimate: tilted, gyro only");
+    feed_seconds(&c, &walk, 1, &t);     /* turning it over */
+    feed_seconds(&c, &flat, 2, &t);
+    check((c.rec.flags & IC_FLAG_ACC) && (acc_err(&c, &flat) < 4.0), "estimate: accel offsets once laid flat");
+
+    /* Slow smooth turn on a valid estimate is not taken as offset */
+    scene_t turn = flat;
+    turn.turn_dps = 3.0;
+    int32_t before = c.rec.gyr_q4[2];
+    feed_seconds(&c, &turn, 30, &t);
+    check(c.rec.gyr_q4[2] == before, "track: 3 dps turn is not an offset");
+
+    /* Moving during the first windows restarts the count */
+    ic_init(&c, &cfg, NULL);
+    feed_seconds(&c, &flat, 1, &t);
+    feed_seconds(&c, &walk, 1, &t);
+    feed_seconds(&c, &flat, 1, &t);
+    check(!ic_valid(&c), "estimate: needs consecutive still windows");
+
+    /* A stored record is valid at once: no calibration at boot */
+    ic_record_t stored;
+    ic_init(&c, &cfg, NULL);
+    t = 0;
+    feed_seconds(&c, &flat, 2, &t);
+    check(ic_save_due(&c, &stored) && (stored.seq == 1u) && ic_record_check(&stored), "save: first estimate is saved at once");
+    ic_init(&c, &cfg, &stored);
+    check(ic_valid(&c) && (gyr_err(&c, &flat) < 0.25), "boot: stored record used without a still window");
+    check(!ic_save_due(&c, &stored), "save: nothing new, no write");
+
+    /* Apply */
+    imu_sample_t s[2] = { { { 100, -100, 0 }, { 16504, -300, 16584 } }, { { -32768, 32767, 0 }, { 0, 0, 0 } } };
+    int32_t gx = (c.rec.gyr_q4[0] + 8) >> 4, gy = (c.rec.gyr_q4[1] + 8) >> 4, ax = (c.rec.acc_q4[0] + 8) >> 4;
+    ic_apply(&c, s, 2);
+    check((abs(gx - 23) <= 1) && (abs(gy + 41) <= 1) &&
+          (s[0].gyr[0] == 100 - gx) && (s[0].gyr[1] == -100 - gy) && (s[0].acc[0] == 16504 - ax) &&
+          (s[1].gyr[0] == -32768) && (s[1].gyr[1] == 32767), "apply: offsets subtracted, saturating");
+}
+
+/*------------------------------------------------------------------- drift */
+static void drift_checks(void)
+{
+    ic_cfg_t cfg = ic_default_cfg();
+    ic_cal_t c;
+    ic_record_t rec;
+    uint32_t t = 0, saves = 0;
+    double worst = 0.0;
+    const uint32_t minutes = 180u;
+
+    srand(5);
+    scene_t sc = { { 10.0, -20.0, 5.0 }, { 0.0, 0.0, 0.0 }, 0.0, 0.0, false };
+    ic_init(&c, &cfg, NULL);
+    ic_set_temp(&c, 0);
+    feed_seconds(&c, &sc, 2, &t);
+    (void)ic_save_due(&c, &rec);
+    saves = 1;
+
+    /* 3 h: warming by 15 K over the first 90 min, gyro offsets following at
+     * 0.5 count/K (0.03 dps/K); alternating 2 min still, 3 min moving */
+    for (uint32_t m = 0; m < minutes; ++m)
+    {
+        double k = (m < 90u) ? (15.0 * m / 90.0) : 15.0;
+        sc.gyr_bias[0] = 10.0 + 0.5 * k;
+        sc.gyr_bias[1] = -20.0 - 0.4 * k;
+        sc.gyr_bias[2] = 5.0 + 0.2 * k;
+        sc.moving = (m % 5u) >= 2u;
+        ic_set_temp(&c, (int16_t)(k * IC_TEMP_LSB_PER_K));
+        feed_seconds(&c, &sc, 60, &t);
+        if (ic_save_due(&c, &rec))
+        {
+            saves++;
+        }
+        if (!sc.moving)
+        {
+            worst = fmax(worst, gyr_err(&c, &sc));
+        }
+    }
+
+    char line[96];
+    snprintf(line, sizeof(line), "drift: 7.5 count ramp followed, worst %.2f counts", worst);
+    check(worst < 1.0, line);
+    snprintf(line, sizeof(line), "drift: %u saves in %u min (at most one per 10)", saves, minutes);
+    check((saves >= 3u) && (saves <= minutes / 10u + 1u), line);
+    check(ic_record_check(&rec) && (rec.seq == saves), "drift: last saved record valid, sequence counts saves");
+}
+
+int main(void)
+{
+    record_checks();
+    estimator_checks();
+    drift_checks();
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
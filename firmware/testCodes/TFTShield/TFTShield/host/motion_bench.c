@@ -0,0 +1,190 @@
+/******************************************************************************
+* File Name:   motion_bench.c
+*
+* Description: Host tool for the motion engine: runs synthetic 200 Hz
+*              traces (rest, tilt, walking, shaking) through it in FIFO-sized
+*              blocks, compares every window with a double-precision
+*              reference of the same algorithm, and times the engine.
+*              Exits non-zero if a window is off by more than the integer
+*              resolution allows.
+*
+*                cc -O2 -I.. -o motion_bench motion_bench.c ../motion.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "motion.h"
+
+#define RATE_HZ             (200.0)
+#define SECONDS             (60u)
+#define NSAMP               (200u * SECONDS)
+#define BLOCK               (16u)
+
+typedef enum { TRACE_REST, TRACE_TILT, TRACE_WALK, TRACE_SHAKE } trace_t;
+static const char *const trace_name[] = { "rest", "tilt", "walk", "shake" };
+
+static imu_sample_t samples[NSAMP];
+
+static double noise(void)
+{
+    return ((double)rand() / RAND_MAX - 0.5) * 20.0;   /* +-10 counts */
+}
+
+static int16_t clamp16(double v)
+{
+    return (int16_t)((v > 32767.0) ? 32767.0 : ((v < -32768.0) ? -32768.0 : lrint(v)));
+}
+
+static void make_trace(trace_t tr)
+{
+    srand(7);
+    for (uint32_t i = 0; i < NSAMP; ++i)
+    {
+        double t = i / RATE_HZ;
+        double g = 16384.0, ax = 0.0, ay = 0.0, az = g;
+        switch (tr)
+        {
+            case TRACE_REST:
+                break;
+            case TRACE_TILT:    /* slow 30 degree tilt over 20 s: gravity only */
+            {
+                double th = (t < 20.0) ? (t / 20.0) * (M_PI / 6.0) : (M_PI / 6.0);
+                ax = g * sin(th);
+                az = g * cos(th);
+                break;
+            }
+            case TRACE_WALK:    /* 1.8 Hz steps, 0.3 g vertical, 0.1 g sway */
+                az += 0.3 * g * sin(2.0 * M_PI * 1.8 * t);
+                ay += 0.1 * g * sin(2.0 * M_PI * 0.9 * t);
+                break;
+            case TRACE_SHAKE:   /* 6 Hz, 1.5 g on x: clips at +-2 g */
+                ax += 1.5 * g * sin(2.0 * M_PI * 6.0 * t);
+                break;
+        }
+        samples[i].acc[0] = clamp16(ax + noise());
+        samples[i].acc[1] = clamp16(ay + noise());
+        samples[i].acc[2] = clamp16(az + noise());
+    }
+}
+
+/* Same algorithm in double, without the fixed-point shortcuts. */
+static void reference(const me_cfg_t *cfg, me_window_t *out, uint32_t nwin)
+{
+    double g[3];
+    double alpha = 1.0 / (double)(1u << cfg->gravity_shift);
+    double sum = 0.0, sum_sq = 0.0, peak = 0.0;
+    uint32_t n = 0, active = 0, w = 0;
+
+    for (int a = 0; a < 3; ++a)
+    {
+        g[a] = samples[0].acc[a];
+    }
+    for (uint32_t i = 0; (i < NSAMP) && (w < nwin); ++i)
+    {
+        double m2 = 0.0;
+        for (int a = 0; a < 3; ++a)
+        {
+            g[a] += (samples[i].acc[a] - g[a]) * alpha;
+            double d = samples[i].acc[a] - g[a];
+            m2 += d * d;
+        }
+        double m = sqrt(m2);
+        sum += m;
+        sum_sq += m2;
+        peak = (m > peak) ? m : peak;
+        active += (m * 1000.0 / cfg->lsb_per_g > cfg->active_mg) ? 1u : 0u;
+        if (++n == cfg->window_samples)
+        {
+            double rms = sqrt(sum_sq / n);
+            double mean = sum / n;
+            out[w].samples = n;
+            out[w].rms_mg = (uint16_t)(rms * 1000.0 / cfg->lsb_per_g);
+            out[w].peak_mg = (uint16_t)(peak * 1000.0 / cfg->lsb_per_g);
+            out[w].var_mg2 = (uint32_t)((sum_sq / n - mean * mean) * 1e6 / ((double)cfg->lsb_per_g * cfg->lsb_per_g));
+            out[w].active = active;
+            out[w].motion_cms2 = (uint16_t)(rms * 980.665 / cfg->lsb_per_g);
+            w++;
+            n = 0;
+            sum = sum_sq = peak = 0.0;
+            active = 0;
+        }
+    }
+}
+
+int main(void)
+{
+    me_cfg_t cfg = me_default_cfg();
+    uint32_t nwin = NSAMP / cfg.window_samples;
+    me_window_t got[NSAMP / 2000u + 1u], ref[NSAMP / 2000u + 1u];
+    int fail = 0;
+
+    /* The square root itself must be exact. */
+    for (uint64_t x = 0; x <= 0xFFFFFFFFull; x += (x < 1000000u) ? 1u : 65521u)
+    {
+        uint32_t r = me_isqrt((uint32_t)x);
+        if (((uint64_t)r * r > x) || ((uint64_t)(r + 1u) * (r + 1u) <= x))
+        {
+            printf("isqrt(%llu) = %u wrong\n", (unsigned long long)x, r);
+            fail = 1;
+            break;
+        }
+    }
+
+    for (int tr = TRACE_REST; tr <= TRACE_SHAKE; ++tr)
+    {
+        me_engine_t e;
+        uint32_t w = 0;
+
+        make_trace((trace_t)tr);
+        reference(&cfg, ref, nwin);
+
+        me_init(&e, &cfg);
+        for (uint32_t i = 0; i < NSAMP; i += BLOCK)
+        {
+            if (me_process(&e, &samples[i], BLOCK, &got[w]))
+            {
+                w++;
+            }
+        }
+
+        /* Timing over repeated runs of the whole trace. */
+        const int reps = 50;
+        struct timespec t0, t1;
+        me_window_t sink;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int r = 0; r < reps; ++r)
+        {
+            me_init(&e, &cfg);
+            for (uint32_t i = 0; i < NSAMP; i += BLOCK)
+            {
+                (void)me_process(&e, &samples[i], BLOCK, &sink);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)reps * NSAMP);
+
+        for (uint32_t i = 0; i < w; ++i)
+        {
+            /* 2-count magnitude steps and truncation: allow 1 mg, 1 cm/s^2 and 0.5 % of active. */
+            int bad = (abs((int)got[i].rms_mg - (int)ref[i].rms_mg) > 1) ||
+                      (abs((int)got[i].peak_mg - (int)ref[i].peak_mg) > 1) ||
+                      (abs((int)got[i].motion_cms2 - (int)ref[i].motion_cms2) > 1) ||
+                      (abs((int)got[i].active - (int)ref[i].active) > (int)(cfg.window_samples / 200u));
+            fail |= bad;
+            printf("%-5s win %u: motion %4u (ref %4u) cm/s2  rms %4u/%4u mg  peak %4u/%4u mg  var %7lu/%7lu mg2  active %4lu/%4lu%s\n",
+                   trace_name[tr], i, got[i].motion_cms2, ref[i].motion_cms2, got[i].rms_mg, ref[i].rms_mg,
+                   got[i].peak_mg, ref[i].peak_mg, (unsigned long)got[i].var_mg2, (unsigned long)ref[i].var_mg2,
+                   (unsigned long)got[i].active, (unsigned long)ref[i].active, bad ? "  MISMATCH" : "");
+        }
+        printf("%-5s %.1f ns/sample (%u windows)\n", trace_name[tr], ns, w);
+        if (w != nwin)
+        {
+            fail = 1;
+        }
+    }
+    printf(fail ? "FAIL\n" : "OK\n");
+    return fail;
+}
@@ -0,0 +1,386 @@
+/******************************************************************************
+* File Name:   sensor_check.c
+*
+* Description: Host tool for the sensor registry: a BME280 and a DPS310 as
+*              simulated register maps (calibration, ids, reset and ready
+*              timing) on the simulated bus. Checks that
+*                - init runs the tables (retries, copied bits, config),
+*                  and fails for a missing sensor or a wrong chip id,
+*                - conversions match the datasheets' double-precision
+*                  formulas over the sensors' range (BME280 also against
+*                  its worked example),
+*                - the scheduler reads each sensor with one burst per
+*                  period and no per-sensor code.
+*              Exits non-zero on failure.
+*
+*                cc -I.. -o sensor_check sensor_check.c i2c_bus_sim.c ../i2c_bus.c \
+*                   ../sensors.c ../sensor_bme280.c ../sensor_dps310.c -lm
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "i2c_bus_sim.h"
+#include "sensors.h"
+
+#define TURNAROUND_NS       (5000u)
+#define BME_RESET_NS        (3000000u)      /* NVM copy after reset */
+#define DPS_RESET_NS        (45000000u)     /* coefficients + sensor ready */
+
+static i2c_sim_t sim;
+static i2c_bus_t bus;
+static i2c_sim_dev_t bme, dps;
+static uint64_t bme_ready_ns, dps_ready_ns;
+static uint32_t xfers;
+static int fail;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s\n", what);
+        fail++;
+    }
+}
+
+/*------------------------------------------------------------ device models */
+/* BME280 datasheet example (T, P) and typical humidity trimming */
+static const bme280_cal_t bme_cal =
+{
+    27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+    75, 0, 362, 313, 50, 30
+};
+
+static const int32_t dps_c[9] = { 204, -261, 80469, -54769, -2259, 1461, -11183, 115, -1328 };
+
+static void put16le(uint8_t *r, int v)
+{
+    r[0] = (uint8_t)v;
+    r[1] = (uint8_t)(v >> 8);
+}
+
+static void bme_model_init(uint8_t id)
+{
+    uint8_t *r = bme.regs;
+    const bme280_cal_t *c = &bme_cal;
+    int tp[12] = { c->t1, c->t2, c->t3, c->p1, c->p2, c->p3, c->p4, c->p5, c->p6, c->p7, c->p8, c->p9 };
+
+    i2c_sim_dev_init(&bme, BME280_ADDR);
+    for (int i = 0; i < 12; ++i)
+    {
+        put16le(&r[0x88 + 2 * i], tp[i]);
+    }
+    r[0xA1] = c->h1;
+    put16le(&r[0xE1], c->h2);
+    r[0xE3] = c->h3;
+    r[0xE4] = (uint8_t)(c->h4 >> 4);
+    r[0xE5] = (uint8_t)((c->h4 & 0x0F) | ((c->h5 & 0x0F) << 4));
+    r[0xE6] = (uint8_t)(c->h5 >> 4);
+    r[0xE7] = (uint8_t)c->h6;
+    r[BME280_REG_ID] = id;
+    r[BME280_REG_STATUS] = BME280_STATUS_IM_UPDATE;
+    bme_ready_ns = 0u;
+}
+
+static void bme_set_raw(int32_t adc_p, int32_t adc_t, int32_t adc_h)
+{
+    uint8_t *d = &bme.regs[BME280_DATA_REG];
+    d[0] = (uint8_t)(adc_p >> 12); d[1] = (uint8_t)(adc_p >> 4); d[2] = (uint8_t)(adc_p << 4);
+    d[3] = (uint8_t)(adc_t >> 12); d[4] = (uint8_t)(adc_t >> 4); d[5] = (uint8_t)(adc_t << 4);
+    d[6] = (uint8_t)(adc_h >> 8);  d[7] = (uint8_t)adc_h;
+}
+
+static void dps_model_init(uint8_t coef_srce)
+{
+    uint8_t *r = dps.regs, *b = &dps.regs[DPS310_REG_COEF];
+    uint32_t c0 = (uint32_t)dps_c[0] & 0xFFFu, c1 = (uint32_t)dps_c[1] & 0xFFFu;
+    uint32_t c00 = (uint32_t)dps_c[2] & 0xFFFFFu, c10 = (uint32_t)dps_c[3] & 0xFFFFFu;
+
+    i2c_sim_dev_init(&dps, DPS310_ADDR);
+    b[0] = (uint8_t)(c0 >> 4);
+    b[1] = (uint8_t)(((c0 & 0x0F) << 4) | (c1 >> 8));
+    b[2] = (uint8_t)c1;
+    b[3] = (uint8_t)(c00 >> 12);
+    b[4] = (uint8_t)(c00 >> 4);
+    b[5] = (uint8_t)(((c00 & 0x0F) << 4) | (c10 >> 16));
+    b[6] = (uint8_t)(c10 >> 8);
+    b[7] = (uint8_t)c10;
+    for (int i = 0; i < 5; ++i)
+    {
+        b[8 + 2 * i] = (uint8_t)(dps_c[4 + i] >> 8);
+        b[9 + 2 * i] = (uint8_t)dps_c[4 + i];
+    }
+    r[DPS310_REG_ID] = 0x10;
+    r[DPS310_REG_COEF_SRCE] = coef_srce;
+    dps_ready_ns = 0u;
+}
+
+static void dps_set_raw(int32_t p, int32_t t)
+{
+    uint8_t *d = &dps.regs[DPS310_DATA_REG];
+    d[0] = (uint8_t)(p >> 16); d[1] = (uint8_t)(p >> 8); d[2] = (uint8_t)p;
+    d[3] = (uint8_t)(t >> 16); d[4] = (uint8_t)(t >> 8); d[5] = (uint8_t)t;
+}
+
+/* The bus sim only stores writes; resets and readiness are done here,
+ * between transfers. */
+static void models_update(void)
+{
+    if (bme.regs[BME280_REG_RESET] == BME280_RESET)
+    {
+        bme.regs[BME280_REG_RESET] = 0u;
+        bme.regs[BME280_REG_STATUS] = BME280_STATUS_IM_UPDATE;
+        bme_ready_ns = sim.now_ns + BME_RESET_NS;
+    }
+    if (sim.now_ns >= bme_ready_ns)
+    {
+        bme.regs[BME280_REG_STATUS] = 0u;
+    }
+    if (dps.regs[DPS310_REG_RESET] == DPS310_SOFT_RESET)
+    {
+        dps.regs[DPS310_REG_RESET] = 0u;
+        dps.regs[DPS310_REG_MEAS_CFG] = 0u;
+        dps_ready_ns = sim.now_ns + DPS_RESET_NS;
+    }
+    else if ((dps_ready_ns != 0u) && (sim.now_ns >= dps_ready_ns))
+    {
+        dps.regs[DPS310_REG_MEAS_CFG] |= DPS310_MEAS_RDY;
+        dps_ready_ns = 0u;
+    }
+}
+
+/*----------------------------------------------------------------- host io */
+static bool host_xfer(void *ctx, uint8_t addr, const uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len)
+{
+    i2c_txn_t t;
+    (void)ctx;
+
+    models_update();
+    i2c_txn_setup(&t, addr, tx, tx_len, rx, rx_len, NULL, NULL);
+    if (!i2c_bus_submit(&bus, &t))
+    {
+        return false;
+    }
+    while (!i2c_txn_finished(&t))
+    {
+        i2c_sim_run_until(&sim, sim.now_ns + 10000u);
+    }
+    xfers++;
+    return t.status == I2C_TXN_OK;
+}
+
+static void host_delay(void *ctx, uint32_t ms)
+{
+    (void)ctx;
+    i2c_sim_run_until(&sim, sim.now_ns + (uint64_t)ms * 1000000u);
+}
+
+static const sd_io_t io = { host_xfer, host_delay, NULL };
+
+static void setup(bool with_bme, uint8_t bme_id, bool with_dps)
+{
+    i2c_sim_init(&sim, &bus, I2C_BUS_HZ_FAST, TURNAROUND_NS);
+    bme_model_init(bme_id);
+    dps_model_init(0x80);
+    if (with_bme)
+    {
+        i2c_sim_attach(&sim, &bme);
+    }
+    if (with_dps)
+    {
+        i2c_sim_attach(&sim, &dps);
+    }
+}
+
+/*------------------------------------------------------ datasheet formulas */
+static double bme_t_ref(int32_t adc, double *t_fine)
+{
+    const bme280_cal_t *c = &bme_cal;
+    double v1 = (adc / 16384.0 - c->t1 / 1024.0) * c->t2;
+    double d = adc / 131072.0 - c->t1 / 8192.0;
+    double v2 = d * d * c->t3;
+    *t_fine = v1 + v2;
+    return (v1 + v2) / 5120.0;
+}
+
+static double bme_p_ref(int32_t adc, double t_fine)
+{
+    const bme280_cal_t *c = &bme_cal;
+    double v1 = t_fine / 2.0 - 64000.0;
+    double v2 = v1 * v1 * c->p6 / 32768.0;
+    v2 = v2 + v1 * c->p5 * 2.0;
+    v2 = v2 / 4.0 + c->p4 * 65536.0;
+    v1 = (c->p3 * v1 * v1 / 524288.0 + c->p2 * v1) / 524288.0;
+    v1 = (1.0 + v1 / 32768.0) * c->p1;
+    double p = 1048576.0 - adc;
+    p = (p - v2 / 4096.0) * 6250.0 / v1;
+    v1 = c->p9 * p * p / 2147483648.0;
+    v2 = p * c->p8 / 32768.0;
+    return p + (v1 + v2 + c->p7) / 16.0;
+}
+
+static double bme_h_ref(int32_t adc, double t_fine)
+{
+    const bme280_cal_t *c = &bme_cal;
+    double h = t_fine - 76800.0;
+    h = (adc - (c->h4 * 64.0 + c->h5 / 16384.0 * h)) *
+        (c->h2 / 65536.0 * (1.0 + c->h6 / 67108864.0 * h * (1.0 + c->h3 / 67108864.0 * h)));
+    h = h * (1.0 - c->h1 * h / 524288.0);
+    return (h > 100.0) ? 100.0 : ((h < 0.0) ? 0.0 : h);
+}
+
+static void dps_ref(int32_t praw, int32_t traw, double *p, double *t)
+{
+    const int32_t *c = dps_c;
+    double ps = praw / 253952.0, ts = traw / 524288.0;
+    *t = c[0] * 0.5 + c[1] * ts;
+    *p = c[2] + ps * (c[3] + ps * (c[6] + ps * c[8])) + ts * c[4] + ts * ps * (c[5] + ps * c[7]);
+}
+
+/*------------------------------------------------------------------- tests */
+static void test_init(void)
+{
+    sd_sensor_t s[SENSOR_COUNT];
+
+    setup(true, BME280_CHIP_ID, true);
+    check(sd_sensor_init(&s[SENSOR_BME280], SENSOR_BME280, &io), "bme280 init");
+    check(sd_sensor_init(&s[SENSOR_DPS310], SENSOR_DPS310, &io), "dps310 init");
+    check(bme.regs[BME280_REG_CTRL_HUM] == 0x01 && bme.regs[BME280_REG_CONFIG] == 0x28 &&
+          bme.regs[BME280_REG_CTRL_MEAS] == 0x57, "bme280 config registers");
+    check(dps.regs[DPS310_REG_TMP_CFG] == (DPS310_TMP_EXT | DPS310_TMP_CFG), "dps310 TMP_EXT copied from COEF_SRCE");
+    check(dps.regs[DPS310_REG_PRS_CFG] == DPS310_PRS_CFG && dps.regs[DPS310_REG_CFG] == DPS310_CFG_P_SHIFT &&
+          (dps.regs[DPS310_REG_MEAS_CFG] & 0x07) == DPS310_MEAS_CONT_PT, "dps310 config registers");
+    check(memcmp(&s[SENSOR_BME280].cal.bme280, &bme_cal, sizeof(bme_cal)) == 0, "bme280 calibration parsed");
+    const dps310_cal_t *dc = &s[SENSOR_DPS310].cal.dps310;
+    const float got[9] = { dc->c0, dc->c1, dc->c00, dc->c10, dc->c01, dc->c11, dc->c20, dc->c21, dc->c30 };
+    bool same = true;
+    for (int i = 0; i < 9; ++i)
+    {
+        same = same && (got[i] == (float)dps_c[i]);
+    }
+    check(same, "dps310 coefficients parsed");
+    printf("init     both present after %u transfers, %.1f ms (incl. reset waits)\n",
+           (unsigned)xfers, sim.now_ns / 1e6);
+
+    /* Not fitted, and a BMP280 (id 0x58) where a BME280 is expected */
+    setup(false, BME280_CHIP_ID, true);
+    check(!sd_sensor_init(&s[SENSOR_BME280], SENSOR_BME280, &io) && !s[SENSOR_BME280].present, "missing bme280 rejected");
+    setup(true, 0x58, false);
+    check(!sd_sensor_init(&s[SENSOR_BME280], SENSOR_BME280, &io), "bmp280 id rejected");
+    check(!sd_sensor_init(&s[SENSOR_DPS310], SENSOR_DPS310, &io), "missing dps310 rejected");
+    /* Internal temperature sensor: TMP_EXT stays clear */
+    setup(false, BME280_CHIP_ID, true);
+    dps.regs[DPS310_REG_COEF_SRCE] = 0x00;
+    check(sd_sensor_init(&s[SENSOR_DPS310], SENSOR_DPS310, &io) && dps.regs[DPS310_REG_TMP_CFG] == DPS310_TMP_CFG,
+          "dps310 internal temperature sensor");
+}
+
+static void test_convert(void)
+{
+    sd_sensor_t s[SENSOR_COUNT];
+    sd_reading_t r;
+    double worst_t = 0.0, worst_p = 0.0, worst_h = 0.0, worst_dt = 0.0, worst_dp = 0.0;
+
+    setup(true, BME280_CHIP_ID, true);
+    (void)sd_sensor_init(&s[SENSOR_BME280], SENSOR_BME280, &io);
+    (void)sd_sensor_init(&s[SENSOR_DPS310], SENSOR_DPS310, &io);
+
+    /* Datasheet: adc_T 519888, adc_P 415148 -> 25.08 degC, 100653.27 Pa */
+    bme_set_raw(415148, 519888, 30000);
+    sensor_desc[SENSOR_BME280].convert(&bme.regs[BME280_DATA_REG], &s[SENSOR_BME280].cal, &r);
+    check(r.temp_cdeg == 2508, "bme280 example temperature");
+    check(fabs(r.press_pa_q8 / 256.0 - 100653.27) < 0.05, "bme280 example pressure");
+    printf("bme280   example: %ld.%02ld degC %.2f Pa (datasheet 25.08, 100653.27)\n",
+           (long)(r.temp_cdeg / 100), (long)(r.temp_cdeg % 100), r.press_pa_q8 / 256.0);
+
+    srand(1);
+    for (int i = 0; i < 20000; ++i)
+    {
+        /* About -20..60 degC, 300..1100 hPa, 0..100 %RH with this trimming */
+        int32_t at = 440000 + rand() % 180000, ap = 250000 + rand() % 400000, ah = 20000 + rand() % 40000;
+        if ((at == 0x80000) || (ap == 0x80000))
+        {
+            continue;           /* the "skipped" code */
+        }
+        double tf, tr = bme_t_ref(at, &tf), pr, hr;
+        bme_set_raw(ap, at, ah);
+        sensor_desc[SENSOR_BME280].convert(&bme.regs[BME280_DATA_REG], &s[SENSOR_BME280].cal, &r);
+        /* The integer version continues with the integer t_fine */
+        tf = floor(tf);
+        pr = bme_p_ref(ap, tf);
+        hr = bme_h_ref(ah, tf);
+        worst_t = fmax(worst_t, fabs(r.temp_cdeg / 100.0 - tr));
+        worst_p = fmax(worst_p, fabs(r.press_pa_q8 / 256.0 - pr));
+        worst_h = fmax(worst_h, fabs(r.hum_pct_q10 / 1024.0 - hr));
+        check(r.has == (SD_HAS_TEMP | SD_HAS_PRESS | SD_HAS_HUM), "bme280 fields");
+
+        /* About 45..110 kPa and -40..85 degC with these coefficients */
+        int32_t pd = -150000 + rand() % 300000, td = -300000 + rand() % 600000;
+        double dp, dt;
+        dps_set_raw(pd & 0xFFFFFF, td & 0xFFFFFF);
+        dps_ref(pd, td, &dp, &dt);
+        sensor_desc[SENSOR_DPS310].convert(&dps.regs[DPS310_DATA_REG], &s[SENSOR_DPS310].cal, &r);
+        worst_dt = fmax(worst_dt, fabs(r.temp_cdeg / 100.0 - dt));
+        worst_dp = fmax(worst_dp, fabs(r.press_pa_q8 / 256.0 - dp));
+    }
+    check(worst_t <= 0.01, "bme280 temperature vs double");
+    check(worst_p <= 1.0, "bme280 pressure vs double");     /* sensor: +-12 Pa relative */
+    check(worst_h <= 0.05, "bme280 humidity vs double");
+    check(worst_dt <= 0.006, "dps310 temperature vs double");
+    check(worst_dp <= 0.1, "dps310 pressure vs double");
+    printf("bme280   worst vs double: T %.4f degC  P %.3f Pa  H %.4f %%RH\n", worst_t, worst_p, worst_h);
+    printf("dps310   worst vs double: T %.4f degC  P %.3f Pa\n", worst_dt, worst_dp);
+
+    /* Skipped humidity (oversampling off) */
+    bme_set_raw(415148, 519888, 0x8000);
+    sensor_desc[SENSOR_BME280].convert(&bme.regs[BME280_DATA_REG], &s[SENSOR_BME280].cal, &r);
+    check(r.has == (SD_HAS_TEMP | SD_HAS_PRESS), "bme280 skipped humidity");
+}
+
+static void test_sched(void)
+{
+    sd_sensor_t s[SENSOR_COUNT];
+    uint32_t got[SENSOR_COUNT] = { 0 };
+
+    setup(true, BME280_CHIP_ID, false);     /* DPS310 not fitted */
+    for (int i = 0; i < SENSOR_COUNT; ++i)
+    {
+        (void)sd_sensor_init(&s[i], (sensor_id_t)i, &io);
+    }
+    bme_set_raw(415148, 519888, 30000);
+
+    uint32_t txns0 = bus.txns;
+    uint64_t t0 = sim.now_ns;
+    for (uint32_t ms = 0; ms < 10000u; ms += 10u)
+    {
+        i2c_sim_run_until(&sim, t0 + (uint64_t)ms * 1000000u);
+        (void)sd_sched_run(s, SENSOR_COUNT, &bus, ms);
+        for (int i = 0; i < SENSOR_COUNT; ++i)
+        {
+            got[i] += sd_sensor_collect(&s[i]);
+        }
+    }
+    i2c_sim_run_until(&sim, sim.now_ns + 1000000u);
+    for (int i = 0; i < SENSOR_COUNT; ++i)
+    {
+        got[i] += sd_sensor_collect(&s[i]);
+    }
+    check(got[SENSOR_BME280] == 10u, "bme280 read once per period");
+    check(got[SENSOR_DPS310] == 0u && s[SENSOR_DPS310].errors == 0u, "absent dps310 not scheduled");
+    check(bus.txns - txns0 == got[SENSOR_BME280], "one burst per reading");
+    check(s[SENSOR_BME280].last.temp_cdeg == 2508, "scheduled reading converted");
+    printf("sched    10 s: bme280 %u readings, dps310 %u, %u bus transactions, %.1f bytes each\n",
+           (unsigned)got[SENSOR_BME280], (unsigned)got[SENSOR_DPS310], (unsigned)(bus.txns - txns0),
+           1.0 + BME280_DATA_LEN);
+}
+
+int main(void)
+{
+    test_init();
+    test_convert();
+    test_sched();
+    printf("%s\n", fail ? "FAILED" : "OK");
+    return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
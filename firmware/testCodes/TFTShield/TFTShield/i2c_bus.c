@@ -0,0 +1,171 @@
+/******************************************************************************
+* File Name:   i2c_bus.c
+*
+* Description: Shared asynchronous I2C bus queue, see i2c_bus.h.
+*
+*******************************************************************************/
+
+#include <stddef.h>
+#include "i2c_bus.h"
+
+#if defined(CY_USING_HAL)
+#include "cyhal_system.h"
+#define I2C_CRITICAL_ENTER(st)  ((st) = cyhal_system_critical_section_enter())
+#define I2C_CRITICAL_EXIT(st)   cyhal_system_critical_section_exit(st)
+#else
+/* The host simulator completes from the caller's thread. */
+#define I2C_CRITICAL_ENTER(st)  ((st) = 0u)
+#define I2C_CRITICAL_EXIT(st)   ((void)(st))
+#endif
+
+/* Start, address + R/W + ACK, 9 bits per byte, stop; a read after a write
+ * adds the repeated start and a second address byte. */
+uint32_t i2c_txn_bits(const i2c_txn_t *t)
+{
+    uint32_t bits = 2u;
+    if ((t->tx_len > 0u) || (t->rx_len == 0u))
+    {
+        bits += 9u * (1u + t->tx_len);
+    }
+    if (t->rx_len > 0u)
+    {
+        bits += 9u * (1u + t->rx_len) + ((t->tx_len > 0u) ? 1u : 0u);
+    }
+    return bits;
+}
+
+void i2c_bus_init(i2c_bus_t *bus, i2c_bus_start_t start, void *ctx, uint32_t hz)
+{
+    bus->start = start;
+    bus->ctx = ctx;
+    bus->hz = hz;
+    bus->head = NULL;
+    bus->tail = NULL;
+    bus->busy = false;
+    bus->txns = 0u;
+    bus->errors = 0u;
+    bus->bits = 0u;
+}
+
+void i2c_txn_setup(i2c_txn_t *t, uint8_t addr, const uint8_t *tx, uint16_t tx_len,
+                   uint8_t *rx, uint16_t rx_len, i2c_txn_done_t done, void *arg)
+{
+    t->addr = addr;
+    t->tx = tx;
+    t->tx_len = tx_len;
+    t->rx = rx;
+    t->rx_len = rx_len;
+    t->done = done;
+    t->arg = arg;
+    t->status = I2C_TXN_IDLE;
+    t->next = NULL;
+}
+
+/* Puts the head on the wire. Transactions that fail to start are unlinked
+ * and returned as a list, to be finished outside the critical section.
+ * Caller holds the critical section. */
+static i2c_txn_t *start_head(i2c_bus_t *bus)
+{
+    i2c_txn_t *failed = NULL;
+
+    while (bus->head != NULL)
+    {
+        i2c_txn_t *t = bus->head;
+        t->status = I2C_TXN_ACTIVE;
+        bus->busy = true;
+        if (bus->start(t, bus->ctx))
+        {
+            return failed;
+        }
+
+        bus->head = t->next;
+        if (bus->head == NULL)
+        {
+            bus->tail = NULL;
+        }
+        bus->errors++;
+        t->status = I2C_TXN_ERROR;
+        t->next = failed;
+        failed = t;
+    }
+    bus->busy = false;
+    return failed;
+}
+
+static void finish(i2c_txn_t *list)
+{
+    while (list != NULL)
+    {
+        i2c_txn_t *t = list;
+        list = t->next;
+        t->next = NULL;
+        if (t->done != NULL)
+        {
+            t->done(t, t->arg);
+        }
+    }
+}
+
+bool i2c_bus_submit(i2c_bus_t *bus, i2c_txn_t *t)
+{
+    uint32_t irq;
+    i2c_txn_t *failed = NULL;
+
+    I2C_CRITICAL_ENTER(irq);
+    if ((t->status == I2C_TXN_QUEUED) || (t->status == I2C_TXN_ACTIVE))
+    {
+        I2C_CRITICAL_EXIT(irq);
+        return false;
+    }
+    t->status = I2C_TXN_QUEUED;
+    t->next = NULL;
+    if (bus->tail != NULL)
+    {
+        bus->tail->next = t;
+    }
+    else
+    {
+        bus->head = t;
+    }
+    bus->tail = t;
+    if (!bus->busy)
+    {
+        failed = start_head(bus);
+    }
+    I2C_CRITICAL_EXIT(irq);
+
+    finish(failed);
+    return true;
+}
+
+void i2c_bus_complete(i2c_bus_t *bus, bool ok)
+{
+    uint32_t irq;
+
+    I2C_CRITICAL_ENTER(irq);
+    i2c_txn_t *t = bus->head;
+    if ((t == NULL) || !bus->busy)
+    {
+        I2C_CRITICAL_EXIT(irq);
+        return;
+    }
+    bus->head = t->next;
+    if (bus->head == NULL)
+    {
+        bus->tail = NULL;
+    }
+    bus->txns++;
+    bus->bits += i2c_txn_bits(t);
+    if (!ok)
+    {
+        bus->errors++;
+    }
+    t->status = ok ? I2C_TXN_OK : I2C_TXN_ERROR;
+
+    /* Next one goes on the wire before the callback runs. */
+    i2c_txn_t *failed = start_head(bus);
+    I2C_CRITICAL_EXIT(irq);
+
+    t->next = failed;
+    finish(t);
+}
@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name:   i2c_bus.h
+*
+* Description: Shared, asynchronous I2C bus. Drivers describe a transaction
+*              (write, read, or write + repeated start + read for register
+*              bursts) in a descriptor they own and submit it; the bus
+*              queues descriptors in submit order and runs them one at a
+*              time from the completion interrupt, so no caller blocks on
+*              another driver's transfer. Completion is reported through
+*              the descriptor's callback, in interrupt context: set a flag
+*              or notify a task there, don't do work.
+*
+*              Submitting is safe from tasks and ISRs. A descriptor must not
+*              be touched between submit and its callback.
+*
+*              The wire is behind a port:
+*                i2c_bus_hal.c         cyhal_i2c_master_transfer_async()
+*                host/i2c_bus_sim.c    simulated devices and bus timing
+*
+*******************************************************************************/
+
+#ifndef I2C_BUS_H_
+#define I2C_BUS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define I2C_BUS_HZ_STANDARD               (100000u)
+#define I2C_BUS_HZ_FAST                   (400000u)
+#define I2C_BUS_HZ_FAST_PLUS              (1000000u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef enum
+{
+    I2C_TXN_IDLE = 0,
+    I2C_TXN_QUEUED,
+    I2C_TXN_ACTIVE,
+    I2C_TXN_OK,
+    I2C_TXN_ERROR               /* NACK, arbitration loss or port failure */
+} i2c_txn_status_t;
+
+typedef struct i2c_txn i2c_txn_t;
+typedef void (*i2c_txn_done_t)(i2c_txn_t *t, void *arg);
+
+struct i2c_txn
+{
+    uint8_t          addr;      /* 7-bit */
+    const uint8_t   *tx;
+    uint16_t         tx_len;
+    uint8_t         *rx;
+    uint16_t         rx_len;
+    i2c_txn_done_t   done;      /* may be NULL, then poll status */
+    void            *arg;
+    volatile i2c_txn_status_t status;
+    i2c_txn_t       *next;      /* queue link, owned by the bus */
+};
+
+/* Starts t on the wire; the port calls i2c_bus_complete() when it is done,
+ * never from inside start. Returns false if it could not start (the
+ * transaction then fails). */
+typedef bool (*i2c_bus_start_t)(i2c_txn_t *t, void *ctx);
+
+typedef struct
+{
+    i2c_bus_start_t start;
+    void           *ctx;
+    uint32_t        hz;
+    i2c_txn_t      *head;       /* head is the active one while busy */
+    i2c_txn_t      *tail;
+    bool            busy;
+
+    /* Statistics: wire bits include start/stop, address and ACK bits. */
+    uint32_t        txns;
+    uint32_t        errors;
+    uint64_t        bits;
+} i2c_bus_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void i2c_bus_init(i2c_bus_t *bus, i2c_bus_start_t start, void *ctx, uint32_t hz);
+
+/* Fills a descriptor: tx_len bytes written, then rx_len bytes read after a
+ * repeated start. Either length may be zero. */
+void i2c_txn_setup(i2c_txn_t *t, uint8_t addr, const uint8_t *tx, uint16_t tx_len,
+                   uint8_t *rx, uint16_t rx_len, i2c_txn_done_t done, void *arg);
+
+/* Queues t. False if t is still queued or active. */
+bool i2c_bus_submit(i2c_bus_t *bus, i2c_txn_t *t);
+
+/* Called by the port, usually from its interrupt, for the active one. */
+void i2c_bus_complete(i2c_bus_t *bus, bool ok);
+
+/* Bits on the wire for t, including protocol overhead. */
+uint32_t i2c_txn_bits(const i2c_txn_t *t);
+
+/* True once t finished (either way). */
+static inline bool i2c_txn_finished(const i2c_txn_t *t)
+{
+    return (t->status == I2C_TXN_OK) || (t->status == I2C_TXN_ERROR);
+}
+
+#endif /* I2C_BUS_H_ */
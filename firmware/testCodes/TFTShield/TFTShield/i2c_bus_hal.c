@@ -0,0 +1,87 @@
+/******************************************************************************
+* File Name:   i2c_bus_hal.c
+*
+* Description: Target port of the shared I2C bus, see i2c_bus_hal.h.
+*
+*******************************************************************************/
+
+#include "i2c_bus_hal.h"
+
+/* Returned by i2c_bus_hal_transfer() when the transaction failed on the bus. */
+#define I2C_BUS_HAL_RSLT_ERR    CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_I2C, 0x80u)
+
+static cyhal_i2c_t i2c;
+static i2c_txn_t *active;
+
+static void i2c_event_cb(void *arg, cyhal_i2c_event_t event)
+{
+    i2c_bus_t *bus = (i2c_bus_t *)arg;
+
+    if ((event & CYHAL_I2C_MASTER_ERR_EVENT) != 0u)
+    {
+        i2c_bus_complete(bus, false);
+        return;
+    }
+    /* A write + read ends with the read; a plain write with the write. */
+    cyhal_i2c_event_t last = ((active != NULL) && (active->rx_len > 0u)) ?
+                             CYHAL_I2C_MASTER_RD_CMPLT_EVENT : CYHAL_I2C_MASTER_WR_CMPLT_EVENT;
+    if ((event & last) != 0u)
+    {
+        i2c_bus_complete(bus, true);
+    }
+}
+
+static bool hal_start(i2c_txn_t *t, void *ctx)
+{
+    (void)ctx;
+    active = t;
+    return cyhal_i2c_master_transfer_async(&i2c, t->addr, t->tx, t->tx_len,
+                                           t->rx, t->rx_len) == CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t i2c_bus_hal_init(i2c_bus_t *bus, cyhal_gpio_t sda, cyhal_gpio_t scl, uint32_t hz)
+{
+    cyhal_i2c_cfg_t cfg = { .is_slave = false, .address = 0, .frequencyhal_hz = hz };
+    cy_rslt_t rslt = cyhal_i2c_init(&i2c, sda, scl, NULL);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+    rslt = cyhal_i2c_configure(&i2c, &cfg);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        cyhal_i2c_free(&i2c);
+        return rslt;
+    }
+
+    i2c_bus_init(bus, hal_start, NULL, hz);
+    cyhal_i2c_register_callback(&i2c, i2c_event_cb, bus);
+    cyhal_i2c_enable_event(&i2c, (cyhal_i2c_event_t)(CYHAL_I2C_MASTER_WR_CMPLT_EVENT |
+                           CYHAL_I2C_MASTER_RD_CMPLT_EVENT | CYHAL_I2C_MASTER_ERR_EVENT),
+                           I2C_BUS_HAL_IRQ_PRIORITY, true);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t i2c_bus_hal_transfer(i2c_bus_t *bus, i2c_txn_t *t)
+{
+    if (!i2c_bus_submit(bus, t))
+    {
+        return I2C_BUS_HAL_RSLT_ERR;
+    }
+    /* WFI also returns if the completion lands between the check and it. */
+    for (;;)
+    {
+        __disable_irq();
+        bool finished = i2c_txn_finished(t);
+        if (!finished)
+        {
+            __WFI();
+        }
+        __enable_irq();
+        if (finished)
+        {
+            break;
+        }
+    }
+    return (t->status == I2C_TXN_OK) ? CY_RSLT_SUCCESS : I2C_BUS_HAL_RSLT_ERR;
+}
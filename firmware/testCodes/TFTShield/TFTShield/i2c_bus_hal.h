@@ -0,0 +1,30 @@
+/******************************************************************************
+* File Name:   i2c_bus_hal.h
+*
+* Description: Target port of the shared I2C bus on one SCB, using the HAL's
+*              interrupt-driven master transfers.
+*
+*******************************************************************************/
+
+#ifndef I2C_BUS_HAL_H_
+#define I2C_BUS_HAL_H_
+
+#include "cyhal.h"
+#include "i2c_bus.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define I2C_BUS_HAL_IRQ_PRIORITY          (3u)
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Claims the SCB on sda/scl at hz and initialises bus with this port. */
+cy_rslt_t i2c_bus_hal_init(i2c_bus_t *bus, cyhal_gpio_t sda, cyhal_gpio_t scl, uint32_t hz);
+
+/* Submits t and sleeps until it finished, for init code outside the hot
+ * path. Returns CY_RSLT_SUCCESS or a failure code. */
+cy_rslt_t i2c_bus_hal_transfer(i2c_bus_t *bus, i2c_txn_t *t);
+
+#endif /* I2C_BUS_HAL_H_ */
@@ -0,0 +1,337 @@
+/******************************************************************************
+* File Name:   imu_cal.c
+*
+* Description: IMU offset estimation and record format, see imu_cal.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "imu_cal.h"
+
+/* CRC-16/CCITT-FALSE (poly 0x1021), a nibble at a time. */
+static const uint16_t crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t ic_crc16(const uint8_t *p, size_t n, uint16_t crc)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (p[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crc_nibble[(crc >> 12) ^ (p[i] & 0x0Fu)]);
+    }
+    return crc;
+}
+
+void ic_record_seal(ic_record_t *r)
+{
+    r->magic = IC_MAGIC;
+    r->version = IC_VERSION;
+    r->crc = ic_crc16((const uint8_t *)r, offsetof(ic_record_t, crc), 0xFFFFu);
+}
+
+bool ic_record_check(const ic_record_t *r)
+{
+    return (r->magic == IC_MAGIC) && (r->version == IC_VERSION) &&
+           (r->crc == ic_crc16((const uint8_t *)r, offsetof(ic_record_t, crc), 0xFFFFu));
+}
+
+const ic_record_t *ic_record_pick(const ic_record_t *a, const ic_record_t *b)
+{
+    bool va = ic_record_check(a);
+    bool vb = ic_record_check(b);
+    if (va && vb)
+    {
+        return ((int32_t)(b->seq - a->seq) > 0) ? b : a;
+    }
+    return va ? a : (vb ? b : NULL);
+}
+
+ic_cfg_t ic_default_cfg(void)
+{
+    ic_cfg_t c = {
+        .window           = 200u,       /* 1 s */
+        .gyr_sd_max       = 6u,         /* 0.37 dps; BMI160 noise is ~1.5 counts */
+        .lsb_per_g        = 16384u,
+        .acc_tol_mg       = 50u,
+        .flat_tol_mg      = 100u,
+        .first_windows    = 2u,
+        .gyr_off_max      = 82u,        /* 5 dps, above the BMI160 zero-rate spec */
+        .track_max        = 16u,        /* 1 dps per still window */
+        .track_shift      = 3u,
+        .save_delta_q4    = 26u,        /* 0.1 dps */
+        .temp_step_raw    = 2 * IC_TEMP_LSB_PER_K,
+        .save_min_windows = 600u        /* 10 min */
+    };
+    return c;
+}
+
+static void clear_window(ic_cal_t *c)
+{
+    c->n = 0u;
+    memset(c->acc_sum, 0, sizeof(c->acc_sum));
+    memset(c->gyr_sum, 0, sizeof(c->gyr_sum));
+    memset(c->gyr_sq, 0, sizeof(c->gyr_sq));
+}
+
+static void clear_first(ic_cal_t *c)
+{
+    c->still_run = 0u;
+    memset(c->first_acc, 0, sizeof(c->first_acc));
+    memset(c->first_gyr, 0, sizeof(c->first_gyr));
+}
+
+void ic_init(ic_cal_t *c, const ic_cfg_t *cfg, const ic_record_t *stored)
+{
+    memset(c, 0, sizeof(*c));
+    c->cfg = *cfg;
+    if ((stored != NULL) && ic_record_check(stored))
+    {
+        c->rec = *stored;
+        c->saved = *stored;
+        c->has_saved = true;
+    }
+}
+
+bool ic_valid(const ic_cal_t *c)
+{
+    return (c->rec.flags & IC_FLAG_GYR) != 0u;
+}
+
+void ic_set_temp(ic_cal_t *c, int16_t temp_raw)
+{
+    c->temp_raw = temp_raw;
+    c->temp_known = true;
+}
+
+static int32_t div_round(int64_t num, int64_t den)
+{
+    return (int32_t)((num >= 0) ? ((num + den / 2) / den) : -((-num + den / 2) / den));
+}
+
+static uint32_t abs32(int32_t v)
+{
+    return (v < 0) ? (uint32_t)-v : (uint32_t)v;
+}
+
+/* Accel offsets (Q4) from a mean taken with the board flat: the axis along
+ * gravity should read +-1 g, the others 0. False if it is not flat. */
+static bool flat_offsets(const ic_cal_t *c, const int64_t sum[3], int64_t n, int32_t out_q4[3])
+{
+    int32_t mean[3];
+    int big = 0;
+    int32_t tol = (int32_t)(c->cfg.flat_tol_mg * c->cfg.lsb_per_g / 1000u);
+
+    for (int a = 0; a < 3; ++a)
+    {
+        mean[a] = div_round(sum[a] * 16, n);
+        if (abs32(mean[a]) > abs32(mean[big]))
+        {
+            big = a;
+        }
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        out_q4[a] = mean[a];
+        if (a == big)
+        {
+            out_q4[a] -= ((mean[a] < 0) ? -1 : 1) * (int32_t)c->cfg.lsb_per_g * 16;
+        }
+        if (abs32(out_q4[a]) > (uint32_t)tol * 16u)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool close_window(ic_cal_t *c)
+{
+    const ic_cfg_t *cfg = &c->cfg;
+    int64_t n = (int64_t)c->n;
+    bool still = true;
+    bool changed = false;
+
+    c->since_save++;
+
+    /* Spread: n * sum(x^2) - sum(x)^2 = n^2 * var */
+    uint64_t lim = (uint64_t)cfg->gyr_sd_max * cfg->gyr_sd_max * (uint64_t)(n * n);
+    for (int a = 0; a < 3; ++a)
+    {
+        uint64_t s2 = (uint64_t)(c->gyr_sum[a] * c->gyr_sum[a]);
+        uint64_t v = (uint64_t)n * c->gyr_sq[a];
+        still = still && (((v > s2) ? (v - s2) : 0u) <= lim);
+    }
+
+    /* |mean acc| = 1 g, compared squared in counts */
+    int64_t m2 = 0;
+    for (int a = 0; a < 3; ++a)
+    {
+        int64_t m = c->acc_sum[a] / n - ((c->rec.flags & IC_FLAG_ACC) ? (c->rec.acc_q4[a] / 16) : 0);
+        m2 += m * m;
+    }
+    int64_t g = cfg->lsb_per_g;
+    int64_t tol = (int64_t)(cfg->acc_tol_mg * cfg->lsb_per_g / 1000u);
+    still = still && (m2 >= (g - tol) * (g - tol)) && (m2 <= (g + tol) * (g + tol));
+
+    if (!still)
+    {
+        c->moving_windows++;
+        clear_first(c);
+        return false;
+    }
+    c->still_windows++;
+
+    if (!ic_valid(c))
+    {
+        /* First estimate: a few still windows in a row, offsets in range */
+        for (int a = 0; a < 3; ++a)
+        {
+            c->first_acc[a] += c->acc_sum[a];
+            c->first_gyr[a] += c->gyr_sum[a];
+        }
+        if (++c->still_run < cfg->first_windows)
+        {
+            return false;
+        }
+        int64_t total = (int64_t)c->still_run * n;
+        int32_t gyr[3];
+        for (int a = 0; a < 3; ++a)
+        {
+            gyr[a] = div_round(c->first_gyr[a] * 16, total);
+            if (abs32(gyr[a]) > cfg->gyr_off_max * 16u)
+            {
+                clear_first(c);
+                return false;
+            }
+        }
+        memcpy(c->rec.gyr_q4, gyr, sizeof(gyr));
+        c->rec.flags |= IC_FLAG_GYR;
+        if (flat_offsets(c, c->first_acc, total, c->rec.acc_q4))
+        {
+            c->rec.flags |= IC_FLAG_ACC;
+        }
+        c->rec.windows = c->still_run;
+        c->rec.temp_raw = c->temp_raw;
+        clear_first(c);
+        return true;
+    }
+
+    /* Tracking. After a temperature step the old offsets are suspect, so the
+     * first still window after it counts for half. */
+    uint8_t k = cfg->track_shift;
+    if (c->temp_known && (abs32((int32_t)c->temp_raw - c->rec.temp_raw) >= (uint32_t)cfg->temp_step_raw))
+    {
+        k = 1u;
+    }
+    int32_t mean[3];
+    for (int a = 0; a < 3; ++a)
+    {
+        mean[a] = div_round(c->gyr_sum[a] * 16, n);
+        if (abs32(mean[a] - c->rec.gyr_q4[a]) > cfg->track_max * 16u)
+        {
+            /* Turning slowly and smoothly, not still */
+            return false;
+        }
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        int32_t step = div_round((int64_t)mean[a] - c->rec.gyr_q4[a], (int64_t)1 << k);
+        c->rec.gyr_q4[a] += step;
+        changed = changed || (step != 0);
+    }
+    if (!(c->rec.flags & IC_FLAG_ACC))
+    {
+        /* Laid flat later on: take the accel offsets then */
+        if (flat_offsets(c, c->acc_sum, n, c->rec.acc_q4))
+        {
+            c->rec.flags |= IC_FLAG_ACC;
+            changed = true;
+        }
+    }
+    c->rec.windows++;
+    if (c->temp_known)
+    {
+        c->rec.temp_raw = c->temp_raw;
+    }
+    return changed;
+}
+
+bool ic_feed(ic_cal_t *c, const imu_sample_t *s, uint32_t n)
+{
+    bool changed = false;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            int32_t gv = s[i].gyr[a];
+            c->acc_sum[a] += s[i].acc[a];
+            c->gyr_sum[a] += gv;
+            c->gyr_sq[a] += (uint64_t)((int64_t)gv * gv);
+        }
+        if (++c->n >= c->cfg.window)
+        {
+            changed = close_window(c) || changed;
+            clear_window(c);
+        }
+    }
+    return changed;
+}
+
+static int16_t sub_sat(int16_t v, int32_t off_q4)
+{
+    int32_t r = (int32_t)v - ((off_q4 + 8) >> 4);
+    return (int16_t)((r > INT16_MAX) ? INT16_MAX : ((r < INT16_MIN) ? INT16_MIN : r));
+}
+
+void ic_apply(const ic_cal_t *c, imu_sample_t *s, uint32_t n)
+{
+    bool acc = (c->rec.flags & IC_FLAG_ACC) != 0u;
+
+    if (!ic_valid(c))
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            s[i].gyr[a] = sub_sat(s[i].gyr[a], c->rec.gyr_q4[a]);
+            if (acc)
+            {
+                s[i].acc[a] = sub_sat(s[i].acc[a], c->rec.acc_q4[a]);
+            }
+        }
+    }
+}
+
+bool ic_save_due(ic_cal_t *c, ic_record_t *out)
+{
+    const ic_cfg_t *cfg = &c->cfg;
+    bool due;
+
+    if (!ic_valid(c) || (c->has_saved && (c->since_save < cfg->save_min_windows)))
+    {
+        return false;
+    }
+    due = !c->has_saved || (c->rec.flags != c->saved.flags) ||
+          (abs32((int32_t)c->rec.temp_raw - c->saved.temp_raw) >= (uint32_t)cfg->temp_step_raw);
+    for (int a = 0; a < 3; ++a)
+    {
+        due = due || (abs32(c->rec.gyr_q4[a] - c->saved.gyr_q4[a]) >= cfg->save_delta_q4);
+    }
+    if (!due)
+    {
+        return false;
+    }
+
+    c->rec.seq = c->has_saved ? (c->saved.seq + 1u) : 1u;
+    ic_record_seal(&c->rec);
+    c->saved = c->rec;
+    c->has_saved = true;
+    c->since_save = 0u;
+    *out = c->rec;
+    return true;
+}
@@ -0,0 +1,138 @@
+/******************************************************************************
+* File Name:   imu_cal.h
+*
+* Description: IMU offset calibration that is estimated once, stored and
+*              then kept up to date while the device runs:
+*                - samples are judged per window (1 s): the board is still
+*                  if the gyro spread on every axis is below a limit and
+*                  the accel magnitude is 1 g,
+*                - the first still windows give the gyro offsets, and the
+*                  accel offsets if the board lies flat (one axis along
+*                  gravity, as the BMI160 fast offset compensation),
+*                - later still windows pull the gyro offsets along with a
+*                  first-order filter, so drift with temperature or age is
+*                  followed; the accel offset is not observable in an
+*                  unknown pose and stays,
+*                - the record is marked for saving when the offsets or the
+*                  temperature moved enough, at most once per interval.
+*
+*              The record is stored as-is (both the M4 and the host are
+*              little endian) with a CRC; imu_cal_flash.c keeps it in two
+*              flash rows. No HAL calls here.
+*
+*******************************************************************************/
+
+#ifndef IMU_CAL_H_
+#define IMU_CAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bmi160_fifo.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define IC_MAGIC                0x43554D49u     /* "IMUC" */
+#define IC_VERSION              (1u)
+#define IC_FLAG_GYR             0x0001u         /* gyro offsets estimated */
+#define IC_FLAG_ACC             0x0002u         /* accel offsets estimated */
+
+/* BMI160 TEMPERATURE: 0 = 23 C, 1/512 K per LSB */
+#define IC_TEMP_LSB_PER_K       (512)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    int16_t  temp_raw;          /* temperature at the last update */
+    int32_t  acc_q4[3];         /* offsets in 1/16 count */
+    int32_t  gyr_q4[3];
+    uint32_t seq;               /* incremented on every save */
+    uint32_t windows;           /* still windows that went into it */
+    uint16_t flags;             /* IC_FLAG_* */
+    uint16_t crc;               /* CRC-16/CCITT-FALSE of the bytes before it */
+} ic_record_t;
+
+_Static_assert(sizeof(ic_record_t) == 44u, "ic_record_t layout");
+
+typedef struct
+{
+    uint32_t window;            /* samples per still/moving decision */
+    uint32_t gyr_sd_max;        /* still: gyro spread below this, counts */
+    uint32_t lsb_per_g;
+    uint32_t acc_tol_mg;        /* still: |acc| within 1 g +- this */
+    uint32_t flat_tol_mg;       /* flat: other axes within this of 0 */
+    uint32_t first_windows;     /* still windows for the first estimate */
+    uint32_t gyr_off_max;       /* first estimate: offsets within this, counts */
+    uint32_t track_max;         /* tracking: window mean within this of the offset */
+    uint8_t  track_shift;       /* gyro tracking, weight 2^-k per window */
+    uint32_t save_delta_q4;     /* save when a gyro offset moved this far */
+    int32_t  temp_step_raw;     /* or the temperature did; also speeds up tracking */
+    uint32_t save_min_windows;  /* but not more often than this */
+} ic_cfg_t;
+
+typedef struct
+{
+    ic_cfg_t    cfg;
+    ic_record_t rec;            /* current offsets */
+    ic_record_t saved;          /* as last loaded or saved */
+    bool        has_saved;
+    int16_t     temp_raw;
+    bool        temp_known;
+
+    /* Current window */
+    uint32_t    n;
+    int64_t     acc_sum[3];
+    int64_t     gyr_sum[3];
+    uint64_t    gyr_sq[3];
+
+    /* First estimate: sums over consecutive still windows */
+    uint32_t    still_run;
+    int64_t     first_acc[3];
+    int64_t     first_gyr[3];
+
+    uint32_t    since_save;     /* windows */
+    uint32_t    still_windows;
+    uint32_t    moving_windows;
+} ic_cal_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Defaults for +-2 g, +-2000 dps at 200 Hz. */
+ic_cfg_t ic_default_cfg(void);
+
+/* Starts from a stored record, or from nothing if stored is NULL. */
+void ic_init(ic_cal_t *c, const ic_cfg_t *cfg, const ic_record_t *stored);
+
+/* True once there are gyro offsets (stored or estimated). */
+bool ic_valid(const ic_cal_t *c);
+
+/* Latest BMI160 TEMPERATURE reading. */
+void ic_set_temp(ic_cal_t *c, int16_t temp_raw);
+
+/* Feeds raw samples; returns true if the offsets changed. */
+bool ic_feed(ic_cal_t *c, const imu_sample_t *s, uint32_t n);
+
+/* Subtracts the offsets in place (saturating). */
+void ic_apply(const ic_cal_t *c, imu_sample_t *s, uint32_t n);
+
+/* True if the record should be written now; then *out is the record to
+ * store (sequence and CRC filled in) and it counts as saved. */
+bool ic_save_due(ic_cal_t *c, ic_record_t *out);
+
+/* Record format */
+void ic_record_seal(ic_record_t *r);
+bool ic_record_check(const ic_record_t *r);
+
+/* Of two stored copies, the valid one with the newest sequence; NULL if
+ * neither is valid. */
+const ic_record_t *ic_record_pick(const ic_record_t *a, const ic_record_t *b);
+
+uint16_t ic_crc16(const uint8_t *p, size_t n, uint16_t crc);
+
+#endif /* IMU_CAL_H_ */
@@ -0,0 +1,78 @@
+/******************************************************************************
+* File Name:   imu_cal_flash.c
+*
+* Description: IMU calibration record in flash, see imu_cal_flash.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "imu_cal_flash.h"
+
+#define IC_FLASH_RSLT_ERR       CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_ABSTRACTION_FLASH, 0x80u)
+
+static cyhal_flash_t flash;
+static uint32_t slot_addr[2];
+static uint32_t page_size;
+static uint8_t erase_value;
+static int newest = -1;                     /* slot of the newest valid copy */
+static uint32_t row[IC_FLASH_ROW_MAX / 4u];
+
+cy_rslt_t imu_cal_flash_init(void)
+{
+    cyhal_flash_info_t info;
+
+    cy_rslt_t rslt = cyhal_flash_init(&flash);
+    if (rslt != CY_RSLT_SUCCESS)
+    {
+        return rslt;
+    }
+    cyhal_flash_get_info(&flash, &info);
+
+    /* The last block is the work flash; the application does not use it */
+    const cyhal_flash_block_info_t *blk = &info.blocks[info.block_count - 1u];
+    if ((blk->page_size > IC_FLASH_ROW_MAX) || (blk->size < 2u * blk->page_size))
+    {
+        return IC_FLASH_RSLT_ERR;
+    }
+    page_size = blk->page_size;
+    erase_value = blk->erase_value;
+    slot_addr[0] = blk->start_address + blk->size - 2u * page_size;
+    slot_addr[1] = blk->start_address + blk->size - page_size;
+    return CY_RSLT_SUCCESS;
+}
+
+bool imu_cal_flash_load(ic_record_t *out)
+{
+    ic_record_t copy[2];
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (cyhal_flash_read(&flash, slot_addr[i], (uint8_t *)&copy[i], sizeof(copy[i])) != CY_RSLT_SUCCESS)
+        {
+            memset(&copy[i], 0, sizeof(copy[i]));
+        }
+    }
+    const ic_record_t *pick = ic_record_pick(&copy[0], &copy[1]);
+    if (pick == NULL)
+    {
+        newest = -1;
+        return false;
+    }
+    newest = (pick == &copy[0]) ? 0 : 1;
+    *out = *pick;
+    return true;
+}
+
+cy_rslt_t imu_cal_flash_save(const ic_record_t *rec)
+{
+    int slot = (newest == 0) ? 1 : 0;
+
+    memset(row, erase_value, page_size);
+    memcpy(row, rec, sizeof(*rec));
+    cy_rslt_t rslt = cyhal_flash_write(&flash, slot_addr[slot], row);
+    if (rslt == CY_RSLT_SUCCESS)
+    {
+        newest = slot;
+    }
+    return rslt;
+}
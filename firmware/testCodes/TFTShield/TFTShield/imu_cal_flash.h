@@ -0,0 +1,34 @@
+/******************************************************************************
+* File Name:   imu_cal_flash.h
+*
+* Description: Storage of the IMU calibration record in the last two rows of
+*              the auxiliary (work) flash. Saves alternate between the rows,
+*              so a reset during a write leaves the previous copy intact;
+*              loading takes the valid copy with the newest sequence.
+*
+*******************************************************************************/
+
+#ifndef IMU_CAL_FLASH_H_
+#define IMU_CAL_FLASH_H_
+
+#include <stdbool.h>
+#include "cyhal.h"
+#include "imu_cal.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define IC_FLASH_ROW_MAX        (512u)      /* PSoC 6 row */
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+cy_rslt_t imu_cal_flash_init(void);
+
+/* Copies the newest valid record to *out. False if there is none. */
+bool imu_cal_flash_load(ic_record_t *out);
+
+/* Writes rec (sealed) over the older copy; blocks for one row write. */
+cy_rslt_t imu_cal_flash_save(const ic_record_t *rec);
+
+#endif /* IMU_CAL_FLASH_H_ */
@@ -0,0 +1,307 @@
+/******************************************************************************
+* File Name:   imu_convert.c
+*
+* Description: Raw IMU samples to physical units, see imu_convert.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "imu_convert.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "cmsis_compiler.h"
+#endif
+#if defined(__SSE2__) || defined(CV_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+
+_Static_assert(sizeof(imu_sample_t) == 12u, "imu_sample_t is 3 words: gx gy | gz ax | ay az");
+
+#if defined(__SSE2__) || defined(CV_HAVE_AVX2)
+/* Outputs from sample i on, for the fixed-point tail after the vector loop */
+static cv_fx_t fx_at(const cv_fx_t *o, uint32_t i)
+{
+    cv_fx_t r;
+    for (int a = 0; a < 3; ++a)
+    {
+        r.gyr[a] = o->gyr[a] + i;
+        r.acc[a] = o->acc[a] + i;
+    }
+    return r;
+}
+#endif
+
+/*------------------------------------------------------------------- scalar */
+/* Also inlined into the vector paths for their tails, so the tail is built
+ * for the same instruction set as the loop: an SSE-encoded float loop after
+ * AVX code costs more than the tail itself. */
+static inline __attribute__((always_inline)) void f32_loop(const imu_sample_t *s, uint32_t i, uint32_t n,
+                                                           const cv_scale_f32_t *k, const cv_f32_t *out)
+{
+    for (; i < n; ++i)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            out->gyr[a][i] = (float)s[i].gyr[a] * k->gyr;
+            out->acc[a][i] = (float)s[i].acc[a] * k->acc;
+        }
+    }
+}
+
+void cv_f32_scalar(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out)
+{
+    f32_loop(s, 0u, n, k, out);
+}
+
+void cv_fx_scalar(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            out->gyr[a][i] = ((int32_t)s[i].gyr[a] * k->gyr) >> k->shift;
+            out->acc[a][i] = ((int32_t)s[i].acc[a] * k->acc) >> k->shift;
+        }
+    }
+}
+
+/*---------------------------------------------------------------- M4 (DSP) */
+#if defined(__ARM_FEATURE_DSP)
+/* A sample is three words. memcpy compiles to a plain LDR, which the M4
+ * allows unaligned; the halfwords are then picked by SXTH/ASR or by the
+ * multiplier. */
+static inline void words(const imu_sample_t *s, uint32_t w[3])
+{
+    memcpy(w, s, 12u);
+}
+
+void cv_f32_dsp(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out)
+{
+    const float kg = k->gyr, ka = k->acc;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t w[3];
+        words(&s[i], w);
+        out->gyr[0][i] = (float)(int16_t)w[0] * kg;
+        out->gyr[1][i] = (float)((int32_t)w[0] >> 16) * kg;
+        out->gyr[2][i] = (float)(int16_t)w[1] * kg;
+        out->acc[0][i] = (float)((int32_t)w[1] >> 16) * ka;
+        out->acc[1][i] = (float)(int16_t)w[2] * ka;
+        out->acc[2][i] = (float)((int32_t)w[2] >> 16) * ka;
+    }
+}
+
+void cv_fx_dsp(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out)
+{
+    /* SMUAD(w, c) = w.lo * c.lo + w.hi * c.hi: with k in one half of c and
+     * 0 in the other it is one exact 16x16 multiply of that half. */
+    const uint32_t g_lo = (uint16_t)k->gyr, g_hi = (uint32_t)(uint16_t)k->gyr << 16;
+    const uint32_t a_lo = (uint16_t)k->acc, a_hi = (uint32_t)(uint16_t)k->acc << 16;
+    const uint8_t sh = k->shift;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t w[3];
+        words(&s[i], w);
+        out->gyr[0][i] = (int32_t)__SMUAD(w[0], g_lo) >> sh;
+        out->gyr[1][i] = (int32_t)__SMUAD(w[0], g_hi) >> sh;
+        out->gyr[2][i] = (int32_t)__SMUAD(w[1], g_lo) >> sh;
+        out->acc[0][i] = (int32_t)__SMUAD(w[1], a_hi) >> sh;
+        out->acc[1][i] = (int32_t)__SMUAD(w[2], a_lo) >> sh;
+        out->acc[2][i] = (int32_t)__SMUAD(w[2], a_hi) >> sh;
+    }
+}
+#endif
+
+/*--------------------------------------------------------------------- SSE2 */
+#if defined(__SSE2__)
+/* Four samples are 12 words A0..A3 B0..B3 C0..C3, word j of sample i at
+ * 3i + j. Gathered per word: d0 = gx|gy, d1 = gz|ax, d2 = ay|az of samples
+ * 0..3. shufps takes two lanes from each operand, so via one step more. */
+static inline void split4(const imu_sample_t *s, __m128i d[3])
+{
+    const __m128i *p = (const __m128i *)(const void *)s;
+    __m128 a = _mm_castsi128_ps(_mm_loadu_si128(p));
+    __m128 b = _mm_castsi128_ps(_mm_loadu_si128(p + 1));
+    __m128 c = _mm_castsi128_ps(_mm_loadu_si128(p + 2));
+
+    __m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));      /* B2 B2 C1 C1 */
+    d[0] = _mm_castps_si128(_mm_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0)));
+    __m128 u = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));      /* A1 A1 B0 B0 */
+    __m128 v = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));      /* B3 B3 C2 C2 */
+    d[1] = _mm_castps_si128(_mm_shuffle_ps(u, v, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128 w = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));      /* A2 A2 B1 B1 */
+    d[2] = _mm_castps_si128(_mm_shuffle_ps(w, c, _MM_SHUFFLE(3, 0, 2, 0)));
+}
+
+static inline __m128 lo_f(__m128i d, __m128 k)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(d, 16), 16)), k);
+}
+
+static inline __m128 hi_f(__m128i d, __m128 k)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(d, 16)), k);
+}
+
+void cv_f32_sse2(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out)
+{
+    const __m128 kg = _mm_set1_ps(k->gyr), ka = _mm_set1_ps(k->acc);
+    uint32_t i = 0;
+
+    for (; i + 4u <= n; i += 4u)
+    {
+        __m128i d[3];
+        split4(&s[i], d);
+        _mm_storeu_ps(out->gyr[0] + i, lo_f(d[0], kg));
+        _mm_storeu_ps(out->gyr[1] + i, hi_f(d[0], kg));
+        _mm_storeu_ps(out->gyr[2] + i, lo_f(d[1], kg));
+        _mm_storeu_ps(out->acc[0] + i, hi_f(d[1], ka));
+        _mm_storeu_ps(out->acc[1] + i, lo_f(d[2], ka));
+        _mm_storeu_ps(out->acc[2] + i, hi_f(d[2], ka));
+    }
+    f32_loop(s, i, n, k, out);
+}
+
+void cv_fx_sse2(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out)
+{
+    /* pmaddwd with (k, 0) or (0, k) per word: one exact product per lane */
+    const __m128i g_lo = _mm_set1_epi32((uint16_t)k->gyr), g_hi = _mm_set1_epi32((int32_t)((uint32_t)(uint16_t)k->gyr << 16));
+    const __m128i a_lo = _mm_set1_epi32((uint16_t)k->acc), a_hi = _mm_set1_epi32((int32_t)((uint32_t)(uint16_t)k->acc << 16));
+    const __m128i sh = _mm_cvtsi32_si128(k->shift);
+    uint32_t i = 0;
+
+    for (; i + 4u <= n; i += 4u)
+    {
+        __m128i d[3];
+        split4(&s[i], d);
+        _mm_storeu_si128((__m128i *)(void *)(out->gyr[0] + i), _mm_sra_epi32(_mm_madd_epi16(d[0], g_lo), sh));
+        _mm_storeu_si128((__m128i *)(void *)(out->gyr[1] + i), _mm_sra_epi32(_mm_madd_epi16(d[0], g_hi), sh));
+        _mm_storeu_si128((__m128i *)(void *)(out->gyr[2] + i), _mm_sra_epi32(_mm_madd_epi16(d[1], g_lo), sh));
+        _mm_storeu_si128((__m128i *)(void *)(out->acc[0] + i), _mm_sra_epi32(_mm_madd_epi16(d[1], a_hi), sh));
+        _mm_storeu_si128((__m128i *)(void *)(out->acc[1] + i), _mm_sra_epi32(_mm_madd_epi16(d[2], a_lo), sh));
+        _mm_storeu_si128((__m128i *)(void *)(out->acc[2] + i), _mm_sra_epi32(_mm_madd_epi16(d[2], a_hi), sh));
+    }
+    cv_fx_t rest = fx_at(out, i);
+    cv_fx_scalar(&s[i], n - i, k, &rest);
+}
+#endif
+
+/*--------------------------------------------------------------------- AVX2 */
+#if defined(CV_HAVE_AVX2)
+#define AVX2 __attribute__((target("avx2")))
+
+bool cv_avx2_ok(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+/* As split4 on 8 samples: samples 0..3 in the low lane, 4..7 in the high
+ * lane, so the in-lane shuffles are the same. */
+static inline AVX2 void split8(const imu_sample_t *s, __m256i d[3])
+{
+    const __m128i *p = (const __m128i *)(const void *)s;
+    __m256 a = _mm256_castsi256_ps(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(p)), _mm_loadu_si128(p + 3), 1));
+    __m256 b = _mm256_castsi256_ps(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(p + 1)), _mm_loadu_si128(p + 4), 1));
+    __m256 c = _mm256_castsi256_ps(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(p + 2)), _mm_loadu_si128(p + 5), 1));
+
+    __m256 t = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+    d[0] = _mm256_castps_si256(_mm256_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0)));
+    __m256 u = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    __m256 v = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    d[1] = _mm256_castps_si256(_mm256_shuffle_ps(u, v, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m256 w = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    d[2] = _mm256_castps_si256(_mm256_shuffle_ps(w, c, _MM_SHUFFLE(3, 0, 2, 0)));
+}
+
+static inline AVX2 __m256 lo_f8(__m256i d, __m256 k)
+{
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(d, 16), 16)), k);
+}
+
+static inline AVX2 __m256 hi_f8(__m256i d, __m256 k)
+{
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(d, 16)), k);
+}
+
+AVX2 void cv_f32_avx2(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out)
+{
+    const __m256 kg = _mm256_set1_ps(k->gyr), ka = _mm256_set1_ps(k->acc);
+    uint32_t i = 0;
+
+    for (; i + 8u <= n; i += 8u)
+    {
+        __m256i d[3];
+        split8(&s[i], d);
+        _mm256_storeu_ps(out->gyr[0] + i, lo_f8(d[0], kg));
+        _mm256_storeu_ps(out->gyr[1] + i, hi_f8(d[0], kg));
+        _mm256_storeu_ps(out->gyr[2] + i, lo_f8(d[1], kg));
+        _mm256_storeu_ps(out->acc[0] + i, hi_f8(d[1], ka));
+        _mm256_storeu_ps(out->acc[1] + i, lo_f8(d[2], ka));
+        _mm256_storeu_ps(out->acc[2] + i, hi_f8(d[2], ka));
+    }
+    f32_loop(s, i, n, k, out);
+}
+
+AVX2 void cv_fx_avx2(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out)
+{
+    const __m256i g_lo = _mm256_set1_epi32((uint16_t)k->gyr), g_hi = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)k->gyr << 16));
+    const __m256i a_lo = _mm256_set1_epi32((uint16_t)k->acc), a_hi = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)k->acc << 16));
+    const __m128i sh = _mm_cvtsi32_si128(k->shift);
+    uint32_t i = 0;
+
+    for (; i + 8u <= n; i += 8u)
+    {
+        __m256i d[3];
+        split8(&s[i], d);
+        _mm256_storeu_si256((__m256i *)(void *)(out->gyr[0] + i), _mm256_sra_epi32(_mm256_madd_epi16(d[0], g_lo), sh));
+        _mm256_storeu_si256((__m256i *)(void *)(out->gyr[1] + i), _mm256_sra_epi32(_mm256_madd_epi16(d[0], g_hi), sh));
+        _mm256_storeu_si256((__m256i *)(void *)(out->gyr[2] + i), _mm256_sra_epi32(_mm256_madd_epi16(d[1], g_lo), sh));
+        _mm256_storeu_si256((__m256i *)(void *)(out->acc[0] + i), _mm256_sra_epi32(_mm256_madd_epi16(d[1], a_hi), sh));
+        _mm256_storeu_si256((__m256i *)(void *)(out->acc[1] + i), _mm256_sra_epi32(_mm256_madd_epi16(d[2], a_lo), sh));
+        _mm256_storeu_si256((__m256i *)(void *)(out->acc[2] + i), _mm256_sra_epi32(_mm256_madd_epi16(d[2], a_hi), sh));
+    }
+    cv_fx_t rest = fx_at(out, i);
+    cv_fx_scalar(&s[i], n - i, k, &rest);
+}
+#endif
+
+/*----------------------------------------------------------------- dispatch */
+void cv_f32(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out)
+{
+#if defined(__ARM_FEATURE_DSP)
+    cv_f32_dsp(s, n, k, out);
+#else
+#if defined(CV_HAVE_AVX2)
+    if (cv_avx2_ok())
+    {
+        cv_f32_avx2(s, n, k, out);
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    cv_f32_sse2(s, n, k, out);
+#else
+    cv_f32_scalar(s, n, k, out);
+#endif
+#endif
+}
+
+void cv_fx(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out)
+{
+#if defined(__ARM_FEATURE_DSP)
+    cv_fx_dsp(s, n, k, out);
+#else
+#if defined(CV_HAVE_AVX2)
+    if (cv_avx2_ok())
+    {
+        cv_fx_avx2(s, n, k, out);
+        return;
+    }
+#endif
+#if defined(__SSE2__)
+    cv_fx_sse2(s, n, k, out);
+#else
+    cv_fx_scalar(s, n, k, out);
+#endif
+#endif
+}
@@ -0,0 +1,105 @@
+/******************************************************************************
+* File Name:   imu_convert.h
+*
+* Description: Batch conversion of raw IMU samples (gyr x/y/z, acc x/y/z as
+*              int16, interleaved as they come out of the FIFO) to physical
+*              units in separate arrays per axis (structure of arrays), as
+*              float or as fixed point:
+*                f32:  out = (float)raw * scale
+*                fx:   out = (raw * k) >> shift,  k a 16-bit constant
+*              Every path gives bit-identical results to the scalar one:
+*              int16 -> float is exact and each output is a single
+*              multiply, rounded once. (Dividing by the LSB size instead is
+*              up to 1 ulp different for scales that are not a power of 2.)
+*
+*              Paths:
+*                scalar  reference, any target
+*                dsp     Cortex-M4: three word loads per sample, SMUAD
+*                        multiplies one halfword of a word by k
+*                sse2    x86: 4 samples per step, shufps de-interleave,
+*                        pmaddwd for the fixed point
+*                avx2    x86: the same on 8 samples (runtime choice, host)
+*              cv_f32()/cv_fx() take the best one built for the target, on
+*              x86 AVX2 when cv_avx2_ok() says the CPU has it.
+*
+*******************************************************************************/
+
+#ifndef IMU_CONVERT_H_
+#define IMU_CONVERT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bmi160_fifo.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Float scales at +-2 g and +-2000 dps */
+#define CV_ACC_G_PER_LSB        (1.0f / 16384.0f)
+#define CV_GYR_DPS_PER_LSB      (1.0f / 16.4f)
+
+/* Fixed point, Q16: acc exact (1/16384 g = 4/65536), gyro 3996/65536 dps
+ * (0.003 % low, far inside the BMI160 sensitivity tolerance) */
+#define CV_ACC_G_Q16_K          (4)
+#define CV_GYR_DPS_Q16_K        (3996)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CV_HAVE_AVX2            (1)
+#endif
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    float gyr;                  /* units per LSB */
+    float acc;
+} cv_scale_f32_t;
+
+typedef struct
+{
+    float *gyr[3];              /* x, y, z; n entries each */
+    float *acc[3];
+} cv_f32_t;
+
+typedef struct
+{
+    int16_t gyr;                /* out = (raw * k) >> shift */
+    int16_t acc;
+    uint8_t shift;
+} cv_scale_fx_t;
+
+typedef struct
+{
+    int32_t *gyr[3];
+    int32_t *acc[3];
+} cv_fx_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void cv_f32(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out);
+void cv_fx(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out);
+
+/* The separate paths, for benchmarks and checks */
+void cv_f32_scalar(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out);
+void cv_fx_scalar(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out);
+
+#if defined(__ARM_FEATURE_DSP)
+void cv_f32_dsp(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out);
+void cv_fx_dsp(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out);
+#endif
+
+#if defined(__SSE2__)
+void cv_f32_sse2(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out);
+void cv_fx_sse2(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out);
+#endif
+
+#if defined(CV_HAVE_AVX2)
+/* Only call these if cv_avx2_ok() */
+bool cv_avx2_ok(void);
+void cv_f32_avx2(const imu_sample_t *s, uint32_t n, const cv_scale_f32_t *k, const cv_f32_t *out);
+void cv_fx_avx2(const imu_sample_t *s, uint32_t n, const cv_scale_fx_t *k, const cv_fx_t *out);
+#endif
+
+#endif /* IMU_CONVERT_H_ */
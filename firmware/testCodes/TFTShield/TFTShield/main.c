@@ -1,6 +1,26 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include "cy_retarget_io.h"
+#include <math.h>
+#include "bmi160_fifo.h"
+#include "i2c_bus_hal.h"
+#include "sample_timing.h"
+#include "motion.h"
+#include "fusion.h"
+#include "bmm150_aux.h"
+#include "imu_cal.h"
+#include "imu_cal_flash.h"
+#include "imu_convert.h"
+#include "sensors.h"
+
+// IMU acquisitie:
+//   IMU_MODE_POLL  oude polling: twee register reads per sample, elke 500 ms
+//   IMU_MODE_FIFO  BMI160 buffert frames, één burst per watermark interrupt
+//   IMU_MODE_DRDY  data-ready interrupt per sample, timestamp in de ISR
+#define IMU_MODE_POLL       0
+#define IMU_MODE_FIFO       1
+#define IMU_MODE_DRDY       2
+#define IMU_MODE            IMU_MODE_FIFO
 
 // -------- BMI160 basis ------------
 #define IMU_ADDR            0x68     // 0x69 als SDO hoog is
@@ -13,24 +33,245 @@
 #define REG_GYR_RANGE       0x43     // 0x00 = ±2000 dps
 #define REG_GYR_DATA        0x0C     // 6 bytes: gx_l..gz_h
 #define REG_ACC_DATA        0x12     // 6 bytes: ax_l..az_h
+#define REG_PMU_STATUS      0x03     // acc [5:4], gyr [3:2]; 01 = normal
+#define REG_TEMPERATURE     0x20     // 2 bytes, 0 = 23 C, 1/512 K
+#define PMU_ACC_MASK        0x30
+#define PMU_ACC_NORMAL      0x10
+#define PMU_GYR_MASK        0x0C
+#define PMU_GYR_NORMAL      0x04
 
 // Schaal (standaard bij ±2g en ±2000 dps)
 #define ACC_LSB_PER_G       16384.0f
 #define GYR_LSB_PER_DPS     16.4f
 
-static cyhal_i2c_t i2c;
+// FIFO/DRDY mode: 200 Hz, INT1 naar Arduino D2; FIFO interrupt na 16 frames (80 ms)
+#define IMU_ODR             ODR_200HZ
+#define IMU_PERIOD_US       5000u
+#define IMU_WM_FRAMES       16u
+#define IMU_INT1_PIN        CYBSP_D2
+#define IMU_INT_PRIORITY    3u
+// watermark + marge voor frames die tijdens de read binnenkomen + sensortime
+#define IMU_FIFO_READ       ((IMU_WM_FRAMES + 4u) * IMU_FRAME_BYTES + 4u)
+// DRDY: timing-rapport elke seconde
+#define IMU_DRDY_REPORT     (1000000u / IMU_PERIOD_US)
+
+// Kalibratie: temperatuur elke 10 s naar de offset-tracker
+#define IMU_CAL_TEMP_SAMPLES (10u * 1000000u / IMU_PERIOD_US)
+
+// Gedeelde I2C bus (D14/D15), ook voor latere sensoren en display
+#define I2C_HZ              I2C_BUS_HZ_FAST
+
+static i2c_bus_t bus;
+
+#if IMU_MODE != IMU_MODE_POLL
+// "motion" voor het upload record: RMS van de dynamische versnelling per 10 s
+static me_engine_t motion;
+
+static void motion_print(const me_window_t *w) {
+    printf("motion %u.%02u m/s2  rms %u mg  piek %u mg  var %lu mg2  actief %lu/%lu\n",
+           (unsigned)(w->motion_cms2 / 100), (unsigned)(w->motion_cms2 % 100),
+           (unsigned)w->rms_mg, (unsigned)w->peak_mg, (unsigned long)w->var_mg2,
+           (unsigned long)w->active, (unsigned long)w->samples);
+}
+#endif
+
+#if IMU_MODE == IMU_MODE_FIFO
+static volatile bool fifo_ready;
+static const uint8_t fifo_reg = REG_FIFO_DATA;
+static uint8_t fifo_buf[IMU_FIFO_READ];
+static i2c_txn_t fifo_txn;
+static imu_block_t block;
+
+// Oriëntatie per sample; BMM150 (achter de BMI160) als die er is
+static fu_filter_t fusion;
+static bool have_mag;
+static const uint8_t mag_reg = REG_DATA_MAG;
+static uint8_t mag_buf[8];
+static i2c_txn_t mag_txn;
+
+// Blok in fysieke eenheden, per as een array (g en dps)
+static float phys_gyr[3][IMU_BLOCK_MAX], phys_acc[3][IMU_BLOCK_MAX];
+static const cv_f32_t phys = {
+    { phys_gyr[0], phys_gyr[1], phys_gyr[2] },
+    { phys_acc[0], phys_acc[1], phys_acc[2] },
+};
+static const cv_scale_f32_t phys_scale = { CV_GYR_DPS_PER_LSB, CV_ACC_G_PER_LSB };
 
+// Externe sensoren uit sensor_list.h (BME280, DPS310), gelezen tussen de
+// FIFO bursts door op dezelfde bus
+static sd_sensor_t env[SENSOR_COUNT];
+
+static void env_print(const sd_sensor_t *s) {
+    const sd_reading_t *r = &s->last;
+    printf("%s", s->desc->name);
+    if (r->has & SD_HAS_TEMP) printf("  T %.2f C", r->temp_cdeg / 100.0f);
+    if (r->has & SD_HAS_PRESS) printf("  P %.2f hPa", r->press_pa_q8 / 25600.0f);
+    if (r->has & SD_HAS_HUM) printf("  RH %.1f %%", r->hum_pct_q10 / 1024.0f);
+    printf("\n");
+}
+
+static void fifo_done(i2c_txn_t *t, void *arg) {
+    (void)t; (void)arg;
+    fifo_ready = true;
+}
+
+// FIFO burst en, met magnetometer, direct daarna DATA_MAG; de bus doet ze
+// op volgorde dus de laatste meldt dat alles binnen is
+static void fifo_submit(void) {
+    (void)i2c_bus_submit(&bus, &fifo_txn);
+    if (have_mag) (void)i2c_bus_submit(&bus, &mag_txn);
+}
+
+// Watermark: de burst gaat meteen in de bus-queue, main hoort het pas als
+// de data er is. Zolang main fifo_buf nog verwerkt niet; main kijkt daarna
+// zelf naar INT1.
+static void imu_int1_isr(void *arg, cyhal_gpio_event_t event) {
+    (void)arg; (void)event;
+    if (!fifo_ready) fifo_submit();
+}
+
+// Sensortime is 24 bits (655 s), hier doorgeteld naar 64 bits
+static uint64_t sensortime_us(uint32_t st) {
+    static uint32_t last;
+    static uint64_t ticks;
+    ticks += (st - last) & 0xFFFFFFu;
+    last = st;
+    return IMU_SENSORTIME_US(ticks);
+}
+#elif IMU_MODE == IMU_MODE_DRDY
+static cyhal_timer_t stamp_timer;           // 1 MHz, vrijlopend
+static volatile bool drdy_ready;
+static volatile uint32_t drdy_overruns;
+static uint32_t drdy_stamp;                 // van main zolang drdy_ready
+static const uint8_t data_reg = REG_GYR_DATA;
+static uint8_t data_buf[12];                // gyr + acc in één burst (0x0C..0x17)
+static i2c_txn_t data_txn;
+static st_stats_t timing;
+
+static void data_done(i2c_txn_t *t, void *arg) {
+    (void)t; (void)arg;
+    drdy_ready = true;
+}
+
+// Data-ready: eerst de tijd, dan de burst in de queue. Is de vorige sample
+// nog niet gelezen of verwerkt, dan gaat deze verloren (overrun).
+static void imu_int1_isr(void *arg, cyhal_gpio_event_t event) {
+    uint32_t now = cyhal_timer_read(&stamp_timer);
+    (void)arg; (void)event;
+    if (drdy_ready || (data_txn.status == I2C_TXN_QUEUED) || (data_txn.status == I2C_TXN_ACTIVE)) {
+        drdy_overruns++;
+        return;
+    }
+    drdy_stamp = now;
+    (void)i2c_bus_submit(&bus, &data_txn);
+}
+
+static cy_rslt_t stamp_timer_init(void) {
+    const cyhal_timer_cfg_t cfg = {
+        .is_continuous = true,
+        .direction     = CYHAL_TIMER_DIR_UP,
+        .is_compare    = false,
+        .period        = 0xFFFFFFFFu,       // 32-bit TCPWM nodig
+        .compare_value = 0u,
+        .value         = 0u
+    };
+    cy_rslt_t r = cyhal_timer_init(&stamp_timer, NC, NULL);
+    if (r == CY_RSLT_SUCCESS) r = cyhal_timer_configure(&stamp_timer, &cfg);
+    if (r == CY_RSLT_SUCCESS) r = cyhal_timer_set_frequency(&stamp_timer, 1000000u);
+    if (r == CY_RSLT_SUCCESS) r = cyhal_timer_start(&stamp_timer);
+    return r;
+}
+#endif
+
+#if IMU_MODE != IMU_MODE_POLL
+static cyhal_gpio_callback_data_t imu_int1_cb = {
+    .callback     = imu_int1_isr,
+    .callback_arg = NULL
+};
+#endif
+
+// Wachtende helpers voor init en de polling mode; wachten = slapen
 static cy_rslt_t i2c_write_u8(uint8_t dev, uint8_t reg, uint8_t val) {
     uint8_t b[2] = {reg, val};
-    return cyhal_i2c_master_write(&i2c, dev, b, 2, 0, true);
+    i2c_txn_t t;
+    i2c_txn_setup(&t, dev, b, 2, NULL, 0, NULL, NULL);
+    return i2c_bus_hal_transfer(&bus, &t);
 }
 
 static cy_rslt_t i2c_read(uint8_t dev, uint8_t reg, uint8_t *buf, size_t len) {
-    cy_rslt_t r = cyhal_i2c_master_write(&i2c, dev, &reg, 1, 0, false);
-    if (r != CY_RSLT_SUCCESS) return r;
-    return cyhal_i2c_master_read(&i2c, dev, buf, len, 0, true);
+    i2c_txn_t t;
+    i2c_txn_setup(&t, dev, &reg, 1, buf, (uint16_t)len, NULL, NULL);
+    return i2c_bus_hal_transfer(&bus, &t);
+}
+
+// Wacht tot (reg & mask) == val, per ms; max_ms is de oude vaste wachttijd
+static uint32_t imu_wait(uint8_t reg, uint8_t mask, uint8_t val, uint32_t max_ms) {
+    for (uint32_t ms = 0; ms < max_ms; ms++) {
+        uint8_t v = 0;
+        if (i2c_read(IMU_ADDR, reg, &v, 1) == CY_RSLT_SUCCESS && (v & mask) == val) return ms;
+        cyhal_system_delay_ms(1);
+    }
+    return max_ms;
+}
+
+#if IMU_MODE == IMU_MODE_FIFO
+// Wachtende I/O voor de init-tabellen van de sensoren
+static bool sd_xfer(void *ctx, uint8_t addr, const uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len) {
+    i2c_txn_t t;
+    (void)ctx;
+    i2c_txn_setup(&t, addr, tx, tx_len, rx, rx_len, NULL, NULL);
+    return i2c_bus_hal_transfer(&bus, &t) == CY_RSLT_SUCCESS;
+}
+
+static void sd_delay(void *ctx, uint32_t ms) {
+    (void)ctx;
+    cyhal_system_delay_ms(ms);
+}
+#endif
+
+#if IMU_MODE != IMU_MODE_POLL
+// Offsets uit flash; zonder record schat de tracker ze zodra het bord stil
+// ligt, er is geen kalibratie-pauze bij het opstarten
+static ic_cal_t cal;
+static bool cal_flash_ok;
+
+static void cal_start(void) {
+    ic_record_t rec;
+    bool loaded = false;
+    cal_flash_ok = (imu_cal_flash_init() == CY_RSLT_SUCCESS);
+    if (cal_flash_ok) loaded = imu_cal_flash_load(&rec);
+    ic_cfg_t ccfg = ic_default_cfg();
+    ic_init(&cal, &ccfg, loaded ? &rec : NULL);
+    if (loaded)
+        printf("kalibratie geladen (seq %lu): gyro offset [% .2f % .2f % .2f] dps\n", (unsigned long)rec.seq,
+               rec.gyr_q4[0] / (16.0f * GYR_LSB_PER_DPS), rec.gyr_q4[1] / (16.0f * GYR_LSB_PER_DPS),
+               rec.gyr_q4[2] / (16.0f * GYR_LSB_PER_DPS));
+    else
+        printf("geen kalibratie%s, schatten zodra het bord stil ligt\n", cal_flash_ok ? "" : " (flash fout)");
 }
 
+// Ruwe samples in, gecorrigeerde samples uit
+static void cal_process(imu_sample_t *s, uint32_t n) {
+    static uint32_t since_temp = IMU_CAL_TEMP_SAMPLES;
+    if ((since_temp += n) >= IMU_CAL_TEMP_SAMPLES) {
+        uint8_t t[2];
+        since_temp = 0;
+        if (i2c_read(IMU_ADDR, REG_TEMPERATURE, t, 2) == CY_RSLT_SUCCESS)
+            ic_set_temp(&cal, (int16_t)((t[1] << 8) | t[0]));
+    }
+    bool was_valid = ic_valid(&cal);
+    (void)ic_feed(&cal, s, n);
+    if (!was_valid && ic_valid(&cal)) printf("kalibratie geschat%s\n", (cal.rec.flags & IC_FLAG_ACC) ? " (acc+gyro)" : " (gyro)");
+    ic_apply(&cal, s, n);
+
+    ic_record_t rec;
+    if (cal_flash_ok && ic_save_due(&cal, &rec)) {
+        cy_rslt_t r = imu_cal_flash_save(&rec);
+        printf("kalibratie opgeslagen (seq %lu)%s\n", (unsigned long)rec.seq, r == CY_RSLT_SUCCESS ? "" : " FOUT");
+    }
+}
+#endif
+
 int main(void)
 {
     cy_rslt_t r = cybsp_init();
@@ -43,10 +284,7 @@ int main(void)
     printf("\nBMI160 HAL demo start\n");
 
     // I2C op Arduino D14/D15 => P6.1 (SDA), P6.0 (SCL)
-    r = cyhal_i2c_init(&i2c, P6_1, P6_0, NULL);
-    CY_ASSERT(r == CY_RSLT_SUCCESS);
-    cyhal_i2c_cfg_t cfg = { .is_slave=false, .address=0, .frequencyhal_hz=100000 }; // begin op 100 kHz
-    r = cyhal_i2c_configure(&i2c, &cfg);
+    r = i2c_bus_hal_init(&bus, P6_1, P6_0, I2C_HZ);
     CY_ASSERT(r == CY_RSLT_SUCCESS);
 
     // CHIP_ID check
@@ -55,14 +293,17 @@ int main(void)
     if (r != CY_RSLT_SUCCESS) { printf("CHIP_ID read fail (0x%08lX)\n",(unsigned long)r); for(;;); }
     printf("CHIP_ID = 0x%02X (verwacht 0xD1)\n", id);
 
-    // Soft reset + power modes
+    // Soft reset + power modes: niet meer vast 100 + 5 + 80 ms wachten
+    // maar tot de BMI160 zegt dat hij klaar is
     i2c_write_u8(IMU_ADDR, REG_CMD, CMD_SOFTRESET);
-    cyhal_system_delay_ms(100);
+    cyhal_system_delay_ms(1);
+    uint32_t ms = 1u + imu_wait(REG_CHIP_ID, 0xFF, 0xD1, 100);
 
     i2c_write_u8(IMU_ADDR, REG_CMD, CMD_ACC_NORMAL);
-    cyhal_system_delay_ms(5);
+    ms += imu_wait(REG_PMU_STATUS, PMU_ACC_MASK, PMU_ACC_NORMAL, 5);
     i2c_write_u8(IMU_ADDR, REG_CMD, CMD_GYR_NORMAL);
-    cyhal_system_delay_ms(80);
+    ms += imu_wait(REG_PMU_STATUS, PMU_GYR_MASK, PMU_GYR_NORMAL, 80);
+    printf("IMU klaar na ~%lu ms\n", (unsigned long)ms);
 
     // Ranges
     i2c_write_u8(IMU_ADDR, REG_ACC_RANGE, 0x03); // ±2g
@@ -70,6 +311,173 @@ int main(void)
 
     printf("IMU configured (±2g, ±2000 dps)\n");
 
+#if IMU_MODE != IMU_MODE_POLL
+    me_cfg_t mcfg = me_default_cfg();
+    me_init(&motion, &mcfg);
+    cal_start();
+#endif
+
+#if IMU_MODE == IMU_MODE_FIFO
+    // FIFO in header mode met acc+gyr frames en sensortime, watermark op INT1
+    i2c_write_u8(IMU_ADDR, REG_ACC_CONF, CONF_BWP_NORMAL | IMU_ODR);
+    i2c_write_u8(IMU_ADDR, REG_GYR_CONF, CONF_BWP_NORMAL | IMU_ODR);
+    i2c_write_u8(IMU_ADDR, REG_FIFO_CONFIG_0, (uint8_t)((IMU_WM_FRAMES * IMU_FRAME_BYTES + 3u) / 4u));
+    i2c_write_u8(IMU_ADDR, REG_FIFO_CONFIG_1,
+                 FIFO_CFG1_GYR_EN | FIFO_CFG1_ACC_EN | FIFO_CFG1_HEADER_EN | FIFO_CFG1_TIME_EN);
+    i2c_write_u8(IMU_ADDR, REG_INT_OUT_CTRL, INT_OUT_CTRL_INT1_PP_HI);
+    i2c_write_u8(IMU_ADDR, REG_INT_MAP_1, INT_MAP_1_INT1_FWM);
+    i2c_write_u8(IMU_ADDR, REG_INT_EN_1, INT_EN_1_FWM);
+    i2c_write_u8(IMU_ADDR, REG_CMD, CMD_FIFO_FLUSH);
+
+    have_mag = (bmm150_aux_init(&bus, IMU_ADDR) == CY_RSLT_SUCCESS);
+    printf("BMM150 %s\n", have_mag ? "gevonden, 9-assig" : "niet gevonden, 6-assig");
+    const sd_io_t sd_io = { sd_xfer, sd_delay, NULL };
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        bool ok = sd_sensor_init(&env[i], (sensor_id_t)i, &sd_io);
+        printf("%s op 0x%02X %s\n", sensor_desc[i].name, sensor_desc[i].addr, ok ? "gevonden" : "niet gevonden");
+    }
+    fu_cfg_t fcfg = fu_default_cfg(IMU_PERIOD_US);
+    fu_init(&fusion, &fcfg);
+
+    i2c_txn_setup(&fifo_txn, IMU_ADDR, &fifo_reg, 1, fifo_buf, sizeof fifo_buf, have_mag ? NULL : fifo_done, NULL);
+    i2c_txn_setup(&mag_txn, IMU_ADDR, &mag_reg, 1, mag_buf, sizeof mag_buf, fifo_done, NULL);
+
+    // DWT cycle counter om de kost van de fusie te meten
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    r = cyhal_gpio_init(IMU_INT1_PIN, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_NONE, false);
+    CY_ASSERT(r == CY_RSLT_SUCCESS);
+    cyhal_gpio_register_callback(IMU_INT1_PIN, &imu_int1_cb);
+    cyhal_gpio_enable_event(IMU_INT1_PIN, CYHAL_GPIO_IRQ_RISE, IMU_INT_PRIORITY, true);
+
+    printf("FIFO mode: %u Hz, watermark %u frames\n", (unsigned)(1000000u / IMU_PERIOD_US), (unsigned)IMU_WM_FRAMES);
+
+    for (;;)
+    {
+        // Slapen tot de burst binnen is; WFI wordt ook wakker als de
+        // interrupt tussen de check en de WFI valt
+        __disable_irq();
+        if (!fifo_ready) __WFI();
+        __enable_irq();
+        if (!fifo_ready) continue;
+
+        if (fifo_txn.status != I2C_TXN_OK) {
+            printf("fifo read err\n");
+        } else {
+            imu_fifo_parse(fifo_buf, sizeof fifo_buf, &block);
+        }
+        if (fifo_txn.status == I2C_TXN_OK && block.count > 0) {
+            // Tijd van de laatste sample in sensorklok. Zonder sensortime frame
+            // (FIFO niet leeg, main loopt achter) schuift de tijd door met de
+            // samples van dit blok plus de door overflow verloren frames
+            static int64_t t_last_us;
+            if (block.has_sensortime) t_last_us = (int64_t)sensortime_us(block.sensortime);
+            else t_last_us += (int64_t)(block.count + block.skipped) * IMU_PERIOD_US;
+            imu_fifo_stamp(&block, t_last_us, IMU_PERIOD_US);
+            cal_process(block.s, block.count);
+
+            me_window_t mw;
+            if (me_process(&motion, block.s, block.count, &mw)) motion_print(&mw);
+
+            int16_t mag[3];
+            bool mag_ok = have_mag && mag_txn.status == I2C_TXN_OK && bmm150_aux_parse(mag_buf, mag);
+            uint32_t c0 = DWT->CYCCNT;
+            fu_update_block(&fusion, block.s, block.count, mag_ok ? mag : NULL, NULL);
+            uint32_t cycles = (DWT->CYCCNT - c0) / block.count;
+
+            // Heel blok naar g/dps in één keer (DSP pad op de M4)
+            c0 = DWT->CYCCNT;
+            cv_f32(block.s, block.count, &phys_scale, &phys);
+            uint32_t conv = DWT->CYCCNT - c0;
+
+            uint32_t l = block.count - 1;
+            printf("t=%lu.%06lu n=%u skip=%u  A[g]=[% .3f % .3f % .3f]  G[dps]=[% .1f % .1f % .1f]  conv %lu cycles/blok\n",
+                   (unsigned long)(block.t_first_us / 1000000), (unsigned long)(block.t_first_us % 1000000),
+                   block.count, block.skipped,
+                   phys_acc[0][l], phys_acc[1][l], phys_acc[2][l],
+                   phys_gyr[0][l], phys_gyr[1][l], phys_gyr[2][l], (unsigned long)conv);
+
+            // Roll/pitch/yaw alleen voor de print; de fusie zelf is integer
+            float qw = fusion.q.w / (float)FU_ONE, qx = fusion.q.x / (float)FU_ONE;
+            float qy = fusion.q.y / (float)FU_ONE, qz = fusion.q.z / (float)FU_ONE;
+            float sp = 2.0f * (qw*qy - qz*qx);
+            printf("q=[% .4f % .4f % .4f % .4f] rpy=[% .1f % .1f % .1f] %s  %lu cycles/update\n",
+                   qw, qx, qy, qz,
+                   atan2f(2.0f * (qw*qx + qy*qz), 1.0f - 2.0f * (qx*qx + qy*qy)) * 57.29578f,
+                   asinf(sp > 1.0f ? 1.0f : (sp < -1.0f ? -1.0f : sp)) * 57.29578f,
+                   atan2f(2.0f * (qw*qz + qx*qy), 1.0f - 2.0f * (qy*qy + qz*qz)) * 57.29578f,
+                   mag_ok ? "9-as" : "6-as", (unsigned long)cycles);
+
+            // Sensoren: uitkomst van de vorige burst, dan wie aan de beurt
+            // is; de bursts gaan voor de volgende FIFO read op de bus
+            for (int i = 0; i < SENSOR_COUNT; i++) {
+                if (sd_sensor_collect(&env[i])) env_print(&env[i]);
+            }
+            (void)sd_sched_run(env, SENSOR_COUNT, &bus, (uint32_t)(block.t_first_us / 1000));
+        }
+
+        // INT1 blijft hoog zolang de FIFO boven de watermark zit: geen nieuwe
+        // flank, dus zelf de volgende burst starten
+        fifo_ready = false;
+        if (cyhal_gpio_read(IMU_INT1_PIN)) fifo_submit();
+    }
+#elif IMU_MODE == IMU_MODE_DRDY
+    // Data-ready op INT1, per sample één burst van gyr+acc
+    i2c_write_u8(IMU_ADDR, REG_ACC_CONF, CONF_BWP_NORMAL | IMU_ODR);
+    i2c_write_u8(IMU_ADDR, REG_GYR_CONF, CONF_BWP_NORMAL | IMU_ODR);
+    i2c_write_u8(IMU_ADDR, REG_INT_OUT_CTRL, INT_OUT_CTRL_INT1_PP_HI);
+    i2c_write_u8(IMU_ADDR, REG_INT_MAP_1, INT_MAP_1_INT1_DRDY);
+    i2c_write_u8(IMU_ADDR, REG_INT_EN_1, INT_EN_1_DRDY);
+
+    i2c_txn_setup(&data_txn, IMU_ADDR, &data_reg, 1, data_buf, sizeof data_buf, data_done, NULL);
+    st_init(&timing, IMU_PERIOD_US);
+
+    r = stamp_timer_init();
+    CY_ASSERT(r == CY_RSLT_SUCCESS);
+    r = cyhal_gpio_init(IMU_INT1_PIN, CYHAL_GPIO_DIR_INPUT, CYHAL_GPIO_DRIVE_NONE, false);
+    CY_ASSERT(r == CY_RSLT_SUCCESS);
+    cyhal_gpio_register_callback(IMU_INT1_PIN, &imu_int1_cb);
+    cyhal_gpio_enable_event(IMU_INT1_PIN, CYHAL_GPIO_IRQ_RISE, IMU_INT_PRIORITY, true);
+
+    printf("DRDY mode: %u Hz nominaal\n", (unsigned)(1000000u / IMU_PERIOD_US));
+
+    for (;;)
+    {
+        // Slapen tot er een sample is; de tijd komt uit de ISR, dus printf
+        // en deze lus hebben geen invloed op de sample-timing
+        __disable_irq();
+        if (!drdy_ready) __WFI();
+        __enable_irq();
+        if (!drdy_ready) continue;
+
+        uint32_t stamp = drdy_stamp;
+        bool ok = (data_txn.status == I2C_TXN_OK);
+        imu_sample_t sm;
+        for (int i = 0; i < 3; i++) {
+            sm.gyr[i] = (int16_t)((data_buf[2*i+1] << 8) | data_buf[2*i]);
+            sm.acc[i] = (int16_t)((data_buf[6+2*i+1] << 8) | data_buf[6+2*i]);
+        }
+        drdy_ready = false;
+        if (!ok) { printf("data read err\n"); continue; }
+
+        st_add(&timing, stamp);
+        cal_process(&sm, 1);
+
+        me_window_t mw;
+        if (me_process(&motion, &sm, 1, &mw)) motion_print(&mw);
+        if (timing.samples % IMU_DRDY_REPORT == 0) {
+            uint32_t mhz = st_rate_mhz(&timing);
+            printf("t=%lu us rate %lu.%03lu Hz  periode %.1f us  jitter %.2f us  min/max %lu/%lu  missed %lu overrun %lu  A[g]=[% .3f % .3f % .3f]\n",
+                   (unsigned long)stamp, (unsigned long)(mhz / 1000), (unsigned long)(mhz % 1000),
+                   st_mean_us(&timing), st_jitter_us(&timing),
+                   (unsigned long)timing.min_us, (unsigned long)timing.max_us,
+                   (unsigned long)timing.missed, (unsigned long)drdy_overruns,
+                   sm.acc[0]/ACC_LSB_PER_G, sm.acc[1]/ACC_LSB_PER_G, sm.acc[2]/ACC_LSB_PER_G);
+        }
+    }
+#else
     // Lees-lus
     for (;;)
     {
@@ -92,4 +500,5 @@ int main(void)
 
         cyhal_system_delay_ms(500);
     }
+#endif
 }
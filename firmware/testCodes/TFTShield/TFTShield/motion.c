@@ -0,0 +1,138 @@
+/******************************************************************************
+* File Name:   motion.c
+*
+* Description: Streaming motion metric, see motion.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "motion.h"
+
+#define G_CMS2_X1000        (980665u)       /* 1 g in 0.001 cm/s^2 */
+
+static uint16_t sat16(uint64_t v)
+{
+    return (v > 0xFFFFu) ? 0xFFFFu : (uint16_t)v;
+}
+
+uint32_t me_isqrt(uint32_t x)
+{
+    uint32_t r = 0u;
+    if (x == 0u)
+    {
+        return 0u;
+    }
+    /* Highest even power of four not above x; one bit of result per step. */
+    uint32_t b = 1u << ((31u - (uint32_t)__builtin_clz(x)) & ~1u);
+    while (b != 0u)
+    {
+        if (x >= r + b)
+        {
+            x -= r + b;
+            r = (r >> 1) + b;
+        }
+        else
+        {
+            r >>= 1;
+        }
+        b >>= 2;
+    }
+    return r;
+}
+
+/* Mean squares of large magnitudes pass 32 bits; two bits less is plenty. */
+static uint32_t isqrt64(uint64_t x)
+{
+    return (x <= 0xFFFFFFFFu) ? me_isqrt((uint32_t)x) : (me_isqrt((uint32_t)(x >> 2)) << 1);
+}
+
+me_cfg_t me_default_cfg(void)
+{
+    me_cfg_t c = {
+        .lsb_per_g      = 16384u,
+        .window_samples = 2000u,
+        .gravity_shift  = 9u,
+        .active_mg      = 50u
+    };
+    return c;
+}
+
+static void reset_window(me_engine_t *e)
+{
+    e->n = 0u;
+    e->sum = 0u;
+    e->sum_sq = 0u;
+    e->peak = 0u;
+    e->active = 0u;
+}
+
+void me_init(me_engine_t *e, const me_cfg_t *cfg)
+{
+    memset(e, 0, sizeof(*e));
+    e->cfg = *cfg;
+    e->active_lsb = (uint32_t)cfg->active_mg * cfg->lsb_per_g / 1000u;
+}
+
+static void close_window(const me_engine_t *e, me_window_t *w)
+{
+    uint32_t lsb = e->cfg.lsb_per_g;
+    uint64_t mean_sq = e->sum_sq / e->n;
+    uint64_t mean = e->sum / e->n;
+    uint64_t var = (mean_sq > mean * mean) ? (mean_sq - mean * mean) : 0u;
+    uint32_t rms = isqrt64(mean_sq);
+
+    w->samples = e->n;
+    w->rms_mg = sat16((uint64_t)rms * 1000u / lsb);
+    w->peak_mg = sat16((uint64_t)e->peak * 1000u / lsb);
+    w->var_mg2 = (uint32_t)(var * 1000000u / ((uint64_t)lsb * lsb));
+    w->active = e->active;
+    w->motion_cms2 = sat16((uint64_t)rms * G_CMS2_X1000 / ((uint64_t)lsb * 1000u));
+}
+
+bool me_process(me_engine_t *e, const imu_sample_t *s, uint32_t n, me_window_t *out)
+{
+    bool done = false;
+    const uint8_t k = e->cfg.gravity_shift;
+
+    if ((n > 0u) && !e->primed)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            e->g_q8[a] = (int32_t)s[0].acc[a] * 256;
+        }
+        e->primed = true;
+    }
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t mag_sq = 0u;
+        for (int a = 0; a < 3; ++a)
+        {
+            int32_t x = (int32_t)s[i].acc[a] * 256;
+            e->g_q8[a] += (x - e->g_q8[a]) >> k;
+            int32_t d = (x - e->g_q8[a]) >> 8;
+            uint32_t ud = (uint32_t)((d < 0) ? -d : d); /* <= 65535 */
+            mag_sq += (ud * ud) >> 2;                   /* >> 2 keeps 3 axes in 32 bits */
+        }
+        uint32_t mag = me_isqrt(mag_sq) << 1;           /* 2-count resolution */
+
+        e->sum += mag;
+        e->sum_sq += (uint64_t)mag * mag;
+        if (mag > e->peak)
+        {
+            e->peak = mag;
+        }
+        if (mag > e->active_lsb)
+        {
+            e->active++;
+        }
+
+        if (++e->n >= e->cfg.window_samples)
+        {
+            close_window(e, out);
+            reset_window(e);
+            done = true;
+        }
+    }
+    return done;
+}
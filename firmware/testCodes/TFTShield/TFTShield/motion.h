@@ -0,0 +1,75 @@
+/******************************************************************************
+* File Name:   motion.h
+*
+* Description: Streaming motion metric for the "motion" field of the upload
+*              record, in integer arithmetic on raw accelerometer counts.
+*              Per sample:
+*                - gravity is tracked per axis by a slow first-order
+*                  low-pass (shift 2^-k, Q8 state) and subtracted,
+*                - the magnitude of the remaining dynamic acceleration is
+*                  taken with an integer square root.
+*              Per window (e.g. the 10 s upload period): RMS, peak and
+*              variance of that magnitude and the number of samples above
+*              an activity threshold. motion = RMS in 0.01 m/s^2.
+*
+*              Blocks from the FIFO go in whole; no HAL calls.
+*
+*******************************************************************************/
+
+#ifndef MOTION_H_
+#define MOTION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bmi160_fifo.h"
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    uint32_t lsb_per_g;         /* 16384 at +-2 g */
+    uint32_t window_samples;    /* at least IMU_BLOCK_MAX */
+    uint8_t  gravity_shift;     /* low-pass time constant 2^k samples */
+    uint16_t active_mg;         /* activity threshold */
+} me_cfg_t;
+
+typedef struct
+{
+    uint32_t samples;
+    uint16_t rms_mg;            /* RMS dynamic acceleration */
+    uint16_t peak_mg;
+    uint32_t var_mg2;           /* variance of the dynamic magnitude */
+    uint32_t active;            /* samples above active_mg */
+    uint16_t motion_cms2;       /* the "motion" field, 0.01 m/s^2 */
+} me_window_t;
+
+typedef struct
+{
+    me_cfg_t cfg;
+    int32_t  g_q8[3];           /* gravity estimate, counts << 8 */
+    bool     primed;
+    uint32_t active_lsb;
+    uint32_t n;
+    uint64_t sum;               /* of |dyn| in counts */
+    uint64_t sum_sq;
+    uint32_t peak;
+    uint32_t active;
+} me_engine_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* Defaults for +-2 g at 200 Hz: 10 s windows, gravity tau 2.56 s, 50 mg. */
+me_cfg_t me_default_cfg(void);
+
+void me_init(me_engine_t *e, const me_cfg_t *cfg);
+
+/* Processes n samples. Returns true if a window completed inside them and
+ * fills *out; samples after it start the next window. */
+bool me_process(me_engine_t *e, const imu_sample_t *s, uint32_t n, me_window_t *out);
+
+/* Floor of the square root, exact for all inputs. */
+uint32_t me_isqrt(uint32_t x);
+
+#endif /* MOTION_H_ */
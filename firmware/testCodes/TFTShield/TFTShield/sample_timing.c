@@ -0,0 +1,78 @@
+/******************************************************************************
+* File Name:   sample_timing.c
+*
+* Description: Sample rate and jitter statistics, see sample_timing.h.
+*
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "sample_timing.h"
+
+void st_init(st_stats_t *s, uint32_t nominal_us)
+{
+    memset(s, 0, sizeof(*s));
+    s->nominal_us = nominal_us;
+    s->min_us = UINT32_MAX;
+}
+
+void st_add(st_stats_t *s, uint32_t stamp_us)
+{
+    if (s->samples++ == 0u)
+    {
+        s->first = stamp_us;
+        s->last = stamp_us;
+        return;
+    }
+
+    uint32_t period = stamp_us - s->last;
+    s->last = stamp_us;
+    s->span_us += period;
+
+    if ((uint64_t)period * 2u > (uint64_t)s->nominal_us * 3u)
+    {
+        /* Round to whole periods; the ones in between were lost. */
+        s->missed += (period + s->nominal_us / 2u) / s->nominal_us - 1u;
+        return;
+    }
+
+    int64_t dev = (int64_t)period - (int64_t)s->nominal_us;
+    s->periods++;
+    s->dev_sum += dev;
+    s->dev_sq_sum += (uint64_t)(dev * dev);
+    if (period < s->min_us)
+    {
+        s->min_us = period;
+    }
+    if (period > s->max_us)
+    {
+        s->max_us = period;
+    }
+}
+
+uint32_t st_rate_mhz(const st_stats_t *s)
+{
+    uint64_t n = (uint64_t)(s->samples - 1u) + s->missed;
+    if ((s->samples < 2u) || (s->span_us == 0u))
+    {
+        return 0u;
+    }
+    return (uint32_t)((n * 1000000000ull + s->span_us / 2u) / s->span_us);
+}
+
+double st_mean_us(const st_stats_t *s)
+{
+    return (s->periods > 0u) ? ((double)s->nominal_us + (double)s->dev_sum / (double)s->periods) : 0.0;
+}
+
+double st_jitter_us(const st_stats_t *s)
+{
+    if (s->periods < 2u)
+    {
+        return 0.0;
+    }
+    double n = (double)s->periods;
+    double sum = (double)s->dev_sum;
+    double var = ((double)s->dev_sq_sum - sum * sum / n) / (n - 1.0);
+    return (var > 0.0) ? sqrt(var) : 0.0;
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+* File Name:   sample_timing.h
+*
+* Description: Rate and jitter statistics for interrupt-timestamped samples.
+*              Stamps are microsecond counter values taken first thing in
+*              the data-ready ISR; the effective rate comes from the span
+*              over all periods, jitter from the spread of single periods,
+*              kept as integer sums of deviations from nominal so a sample
+*              costs a few integer ops. A period longer than 1.5 nominal
+*              means a sample was missed: it counts towards the rate but not
+*              the jitter.
+*
+*              No HAL calls; the host simulation feeds it the same way.
+*
+*******************************************************************************/
+
+#ifndef SAMPLE_TIMING_H_
+#define SAMPLE_TIMING_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    uint32_t nominal_us;
+    uint32_t first;             /* stamp of the first sample */
+    uint32_t last;
+    uint64_t span_us;           /* first to last, wrap-safe */
+    uint32_t samples;
+    uint32_t periods;           /* in the jitter statistics */
+    uint32_t missed;            /* estimated samples lost */
+    int64_t  dev_sum;           /* sum of (period - nominal) */
+    uint64_t dev_sq_sum;        /* sum of (period - nominal)^2 */
+    uint32_t min_us;
+    uint32_t max_us;
+} st_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+void st_init(st_stats_t *s, uint32_t nominal_us);
+
+/* Adds a sample stamped at stamp_us (32-bit counter, wraps). */
+void st_add(st_stats_t *s, uint32_t stamp_us);
+
+/* Effective rate in mHz over everything seen, 0 before two samples. */
+uint32_t st_rate_mhz(const st_stats_t *s);
+
+/* Mean single period and its standard deviation (jitter), in us. */
+double st_mean_us(const st_stats_t *s);
+double st_jitter_us(const st_stats_t *s);
+
+#endif /* SAMPLE_TIMING_H_ */
@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name:   sensor_bme280.c
+*
+* Description: BME280 descriptor parts, see sensor_bme280.h.
+*
+*******************************************************************************/
+
+#include "sensors.h"
+
+#define SKIPPED_PT              (0x80000)   /* 20-bit value of a skipped measurement */
+#define SKIPPED_H               (0x8000)
+
+const sd_step_t bme280_init[] =
+{
+    SD_EXPECT(BME280_REG_ID, 0xFF, BME280_CHIP_ID, 1u),
+    SD_WRITE(BME280_REG_RESET, BME280_RESET),
+    SD_DELAY(2u),
+    SD_EXPECT(BME280_REG_STATUS, BME280_STATUS_IM_UPDATE, 0x00, 10u),  /* NVM copied */
+    SD_READ(BME280_REG_CALIB_TP, BME280_CALIB_TP_LEN),
+    SD_READ(BME280_REG_CALIB_H, BME280_CALIB_H_LEN),
+    SD_WRITE(BME280_REG_CTRL_HUM, 0x01),    /* H x1; takes effect with CTRL_MEAS */
+    SD_WRITE(BME280_REG_CONFIG, 0x28),      /* standby 62.5 ms, IIR 4 */
+    SD_WRITE(BME280_REG_CTRL_MEAS, 0x57),   /* T x2, P x16, normal mode */
+    SD_END
+};
+
+bool bme280_prepare(const uint8_t *calib, size_t len, sd_cal_t *cal)
+{
+    bme280_cal_t *c = &cal->bme280;
+    const uint8_t *h = &calib[BME280_CALIB_TP_LEN];
+
+    if (len != BME280_CALIB_TP_LEN + BME280_CALIB_H_LEN)
+    {
+        return false;
+    }
+    c->t1 = sd_u16le(&calib[0]);
+    c->t2 = sd_s16le(&calib[2]);
+    c->t3 = sd_s16le(&calib[4]);
+    c->p1 = sd_u16le(&calib[6]);
+    c->p2 = sd_s16le(&calib[8]);
+    c->p3 = sd_s16le(&calib[10]);
+    c->p4 = sd_s16le(&calib[12]);
+    c->p5 = sd_s16le(&calib[14]);
+    c->p6 = sd_s16le(&calib[16]);
+    c->p7 = sd_s16le(&calib[18]);
+    c->p8 = sd_s16le(&calib[20]);
+    c->p9 = sd_s16le(&calib[22]);
+    c->h1 = calib[25];
+    c->h2 = sd_s16le(&h[0]);
+    c->h3 = h[2];
+    /* 12-bit H4 = E4[7:0] E5[3:0], H5 = E6[7:0] E5[7:4], both signed */
+    c->h4 = (int16_t)((int16_t)(int8_t)h[3] * 16 | (h[4] & 0x0F));
+    c->h5 = (int16_t)((int16_t)(int8_t)h[5] * 16 | (h[4] >> 4));
+    c->h6 = (int8_t)h[6];
+    return (c->t1 != 0u) && (c->p1 != 0u);
+}
+
+/* The datasheet's compensation (BME280 4.2.3), with shifts of signed values
+ * written as multiplies */
+static int32_t temp_fine(const bme280_cal_t *c, int32_t adc)
+{
+    int32_t v1 = (((adc >> 3) - ((int32_t)c->t1 << 1)) * c->t2) >> 11;
+    int32_t d = (adc >> 4) - (int32_t)c->t1;
+    int32_t v2 = (((d * d) >> 12) * c->t3) >> 14;
+    return v1 + v2;
+}
+
+static uint32_t press_q8(const bme280_cal_t *c, int32_t adc, int32_t t_fine)
+{
+    int64_t v1 = (int64_t)t_fine - 128000;
+    int64_t v2 = v1 * v1 * c->p6;
+    v2 += v1 * c->p5 * 131072;
+    v2 += (int64_t)c->p4 * ((int64_t)1 << 35);
+    v1 = ((v1 * v1 * c->p3) >> 8) + v1 * c->p2 * 4096;
+    v1 = ((((int64_t)1 << 47) + v1) * c->p1) >> 33;
+    if (v1 == 0)
+    {
+        return 0u;
+    }
+    int64_t p = 1048576 - adc;
+    p = ((p * ((int64_t)1 << 31)) - v2) * 3125 / v1;
+    v1 = ((int64_t)c->p9 * (p >> 13) * (p >> 13)) >> 25;
+    v2 = ((int64_t)c->p8 * p) >> 19;
+    p = ((p + v1 + v2) >> 8) + (int64_t)c->p7 * 16;
+    return (uint32_t)p;
+}
+
+static uint32_t hum_q10(const bme280_cal_t *c, int32_t adc, int32_t t_fine)
+{
+    int32_t x = t_fine - 76800;
+    x = ((((adc * 16384) - ((int32_t)c->h4 * 1048576) - ((int32_t)c->h5 * x)) + 16384) >> 15) *
+        (((((((x * c->h6) >> 10) * (((x * (int32_t)c->h3) >> 11) + 32768)) >> 10) + 2097152) * c->h2 + 8192) >> 14);
+    x -= ((((x >> 15) * (x >> 15)) >> 7) * (int32_t)c->h1) >> 4;
+    x = (x < 0) ? 0 : x;
+    x = (x > 419430400) ? 419430400 : x;
+    return (uint32_t)x >> 12;
+}
+
+void bme280_convert(const uint8_t *raw, const sd_cal_t *cal, sd_reading_t *out)
+{
+    const bme280_cal_t *c = &cal->bme280;
+    int32_t adc_p = (int32_t)(((uint32_t)raw[0] << 12) | ((uint32_t)raw[1] << 4) | (raw[2] >> 4));
+    int32_t adc_t = (int32_t)(((uint32_t)raw[3] << 12) | ((uint32_t)raw[4] << 4) | (raw[5] >> 4));
+    int32_t adc_h = (int32_t)(((uint32_t)raw[6] << 8) | raw[7]);
+
+    out->has = 0u;
+    if (adc_t == SKIPPED_PT)
+    {
+        return;             /* P and H need t_fine */
+    }
+    int32_t t_fine = temp_fine(c, adc_t);
+    out->temp_cdeg = (t_fine * 5 + 128) >> 8;
+    out->has |= SD_HAS_TEMP;
+    if (adc_p != SKIPPED_PT)
+    {
+        out->press_pa_q8 = press_q8(c, adc_p, t_fine);
+        out->has |= SD_HAS_PRESS;
+    }
+    if (adc_h != SKIPPED_H)
+    {
+        out->hum_pct_q10 = hum_q10(c, adc_h, t_fine);
+        out->has |= SD_HAS_HUM;
+    }
+}
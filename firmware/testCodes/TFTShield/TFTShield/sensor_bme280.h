@@ -0,0 +1,51 @@
+/******************************************************************************
+* File Name:   sensor_bme280.h
+*
+* Description: Bosch BME280 (temperature, pressure, humidity) for the sensor
+*              registry: normal mode, T x2, P x16, H x1, IIR 4, standby
+*              62.5 ms, so a reading about every 100 ms. Compensation is the
+*              datasheet's integer one (int64 for pressure).
+*
+*******************************************************************************/
+
+#ifndef SENSOR_BME280_H_
+#define SENSOR_BME280_H_
+
+#include "sensor_desc.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define BME280_ADDR             0x76        /* SDO low; 0x77 high */
+#define BME280_DATA_REG         0xF7        /* press[3] temp[3] hum[2] */
+#define BME280_DATA_LEN         (8u)
+
+#define BME280_REG_CALIB_TP     0x88        /* 0x88..0xA1, H1 last */
+#define BME280_CALIB_TP_LEN     (26u)
+#define BME280_REG_CALIB_H      0xE1        /* 0xE1..0xE7 */
+#define BME280_CALIB_H_LEN      (7u)
+#define BME280_REG_ID           0xD0
+#define BME280_CHIP_ID          0x60
+#define BME280_REG_RESET        0xE0
+#define BME280_RESET            0xB6
+#define BME280_REG_CTRL_HUM     0xF2
+#define BME280_REG_STATUS       0xF3
+#define BME280_STATUS_IM_UPDATE 0x01
+#define BME280_REG_CTRL_MEAS    0xF4
+#define BME280_REG_CONFIG       0xF5
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    uint16_t t1;
+    int16_t  t2, t3;
+    uint16_t p1;
+    int16_t  p2, p3, p4, p5, p6, p7, p8, p9;
+    uint8_t  h1, h3;
+    int16_t  h2, h4, h5;
+    int8_t   h6;
+} bme280_cal_t;
+
+#endif /* SENSOR_BME280_H_ */
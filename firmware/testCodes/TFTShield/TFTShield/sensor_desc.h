@@ -0,0 +1,94 @@
+/******************************************************************************
+* File Name:   sensor_desc.h
+*
+* Description: Building blocks for the descriptor-driven I2C sensors (see
+*              sensors.h): the init sequence as a table of steps, and the
+*              common reading the conversion routines produce. A sensor
+*              driver is data plus two pure functions; it does no I/O.
+*
+*              Init steps, run in order until SD_END:
+*                SD_WRITE(reg, val)              write one register
+*                SD_EXPECT(reg, mask, val, n)    read until (r & mask) == val,
+*                                                at most n reads 1 ms apart
+*                                                (chip id: n = 1)
+*                SD_READ(reg, len)               burst into the calibration
+*                                                buffer, after earlier reads
+*                SD_COPY(dst, src, mask, val)    write dst = val | (src & mask)
+*                SD_DELAY(ms)
+*
+*******************************************************************************/
+
+#ifndef SENSOR_DESC_H_
+#define SENSOR_DESC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define SD_CALIB_MAX            (48u)       /* bytes of all SD_READ steps */
+
+#define SD_WRITE(reg, val)              { SD_OP_WRITE, (reg), (val), 0u, 0u }
+#define SD_EXPECT(reg, mask, val, n)    { SD_OP_EXPECT, (reg), (val), (mask), (n) }
+#define SD_READ(reg, len)               { SD_OP_READ, (reg), (len), 0u, 0u }
+#define SD_COPY(dst, src, mask, val)    { SD_OP_COPY, (dst), (val), (mask), (src) }
+#define SD_DELAY(ms)                    { SD_OP_DELAY, 0u, (ms), 0u, 0u }
+#define SD_END                          { SD_OP_END, 0u, 0u, 0u, 0u }
+
+/* sd_reading_t.has */
+#define SD_HAS_TEMP             (0x01u)
+#define SD_HAS_PRESS            (0x02u)
+#define SD_HAS_HUM              (0x04u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef enum
+{
+    SD_OP_END = 0,
+    SD_OP_WRITE,
+    SD_OP_EXPECT,
+    SD_OP_READ,
+    SD_OP_COPY,
+    SD_OP_DELAY
+} sd_op_t;
+
+typedef struct
+{
+    uint8_t op;                 /* sd_op_t */
+    uint8_t reg;
+    uint8_t val;                /* value, expected value, length or ms */
+    uint8_t mask;
+    uint8_t arg;                /* EXPECT: tries; COPY: source register */
+} sd_step_t;
+
+typedef struct
+{
+    uint8_t  has;               /* SD_HAS_* */
+    int32_t  temp_cdeg;         /* 0.01 degC */
+    uint32_t press_pa_q8;       /* Pa, Q24.8 */
+    uint32_t hum_pct_q10;       /* %RH, Q22.10 */
+} sd_reading_t;
+
+/* Blocking transfers for the init sequence, outside the hot path. */
+typedef struct
+{
+    bool  (*xfer)(void *ctx, uint8_t addr, const uint8_t *tx, uint16_t tx_len, uint8_t *rx, uint16_t rx_len);
+    void  (*delay_ms)(void *ctx, uint32_t ms);
+    void   *ctx;
+} sd_io_t;
+
+/* Little-endian fields of calibration dumps */
+static inline uint16_t sd_u16le(const uint8_t *b)
+{
+    return (uint16_t)(b[0] | ((uint16_t)b[1] << 8));
+}
+
+static inline int16_t sd_s16le(const uint8_t *b)
+{
+    return (int16_t)sd_u16le(b);
+}
+
+#endif /* SENSOR_DESC_H_ */
@@ -0,0 +1,74 @@
+/******************************************************************************
+* File Name:   sensor_dps310.c
+*
+* Description: DPS310 descriptor parts, see sensor_dps310.h.
+*
+*******************************************************************************/
+
+#include <math.h>
+#include "sensors.h"
+
+const sd_step_t dps310_init[] =
+{
+    SD_EXPECT(DPS310_REG_ID, DPS310_PROD_ID_MASK, DPS310_PROD_ID, 1u),
+    SD_WRITE(DPS310_REG_RESET, DPS310_SOFT_RESET),
+    SD_DELAY(40u),
+    SD_EXPECT(DPS310_REG_MEAS_CFG, DPS310_MEAS_RDY, DPS310_MEAS_RDY, 50u),
+    SD_READ(DPS310_REG_COEF, DPS310_COEF_LEN),
+    /* Fuse-bit fix from Infineon's driver: affected parts read a wrong
+     * temperature without it, others ignore it */
+    SD_WRITE(0x0E, 0xA5),
+    SD_WRITE(0x0F, 0x96),
+    SD_WRITE(0x62, 0x02),
+    SD_WRITE(0x0E, 0x00),
+    SD_WRITE(0x0F, 0x00),
+    SD_WRITE(DPS310_REG_PRS_CFG, DPS310_PRS_CFG),
+    /* Temperature on the sensor the coefficients belong to */
+    SD_COPY(DPS310_REG_TMP_CFG, DPS310_REG_COEF_SRCE, DPS310_TMP_EXT, DPS310_TMP_CFG),
+    SD_WRITE(DPS310_REG_CFG, DPS310_CFG_P_SHIFT),
+    SD_WRITE(DPS310_REG_MEAS_CFG, DPS310_MEAS_CONT_PT),
+    SD_END
+};
+
+/* Sign-extends the low bits of v */
+static int32_t sext(uint32_t v, unsigned bits)
+{
+    uint32_t m = 1u << (bits - 1u);
+    return (int32_t)((v ^ m) - m);
+}
+
+bool dps310_prepare(const uint8_t *calib, size_t len, sd_cal_t *cal)
+{
+    dps310_cal_t *c = &cal->dps310;
+    const uint8_t *b = calib;
+
+    if (len != DPS310_COEF_LEN)
+    {
+        return false;
+    }
+    /* c0, c1: 12 bit; c00, c10: 20 bit; the rest 16 bit; big-endian */
+    c->c0  = (float)sext(((uint32_t)b[0] << 4) | (b[1] >> 4), 12);
+    c->c1  = (float)sext(((uint32_t)(b[1] & 0x0F) << 8) | b[2], 12);
+    c->c00 = (float)sext(((uint32_t)b[3] << 12) | ((uint32_t)b[4] << 4) | (b[5] >> 4), 20);
+    c->c10 = (float)sext(((uint32_t)(b[5] & 0x0F) << 16) | ((uint32_t)b[6] << 8) | b[7], 20);
+    c->c01 = (float)sext(((uint32_t)b[8] << 8) | b[9], 16);
+    c->c11 = (float)sext(((uint32_t)b[10] << 8) | b[11], 16);
+    c->c20 = (float)sext(((uint32_t)b[12] << 8) | b[13], 16);
+    c->c21 = (float)sext(((uint32_t)b[14] << 8) | b[15], 16);
+    c->c30 = (float)sext(((uint32_t)b[16] << 8) | b[17], 16);
+    return true;
+}
+
+void dps310_convert(const uint8_t *raw, const sd_cal_t *cal, sd_reading_t *out)
+{
+    const dps310_cal_t *c = &cal->dps310;
+    float p = (float)sext(((uint32_t)raw[0] << 16) | ((uint32_t)raw[1] << 8) | raw[2], 24) * (1.0f / DPS310_KP);
+    float t = (float)sext(((uint32_t)raw[3] << 16) | ((uint32_t)raw[4] << 8) | raw[5], 24) * (1.0f / DPS310_KT);
+
+    float tc = c->c0 * 0.5f + c->c1 * t;
+    float pc = c->c00 + p * (c->c10 + p * (c->c20 + p * c->c30)) + t * c->c01 + t * p * (c->c11 + p * c->c21);
+
+    out->temp_cdeg = (int32_t)lrintf(tc * 100.0f);
+    out->press_pa_q8 = (pc > 0.0f) ? (uint32_t)lrintf(pc * 256.0f) : 0u;
+    out->has = SD_HAS_TEMP | SD_HAS_PRESS;
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+* File Name:   sensor_dps310.h
+*
+* Description: Infineon DPS310 (pressure, temperature) for the sensor
+*              registry: continuous mode, pressure 16 Hz x16, temperature
+*              4 Hz x1 on the sensor the coefficients were trimmed for.
+*              Compensation is the datasheet's, in float (M4F).
+*
+*******************************************************************************/
+
+#ifndef SENSOR_DPS310_H_
+#define SENSOR_DPS310_H_
+
+#include "sensor_desc.h"
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+#define DPS310_ADDR             0x77        /* SDO high (default); 0x76 low */
+#define DPS310_DATA_REG         0x00        /* PSR_B2..B0, TMP_B2..B0 */
+#define DPS310_DATA_LEN         (6u)
+
+#define DPS310_REG_PRS_CFG      0x06
+#define DPS310_REG_TMP_CFG      0x07
+#define DPS310_REG_MEAS_CFG     0x08
+#define DPS310_REG_CFG          0x09
+#define DPS310_REG_RESET        0x0C
+#define DPS310_REG_ID           0x0D
+#define DPS310_REG_COEF         0x10        /* 0x10..0x21 */
+#define DPS310_COEF_LEN         (18u)
+#define DPS310_REG_COEF_SRCE    0x28
+
+#define DPS310_PROD_ID_MASK     0x0F
+#define DPS310_PROD_ID          0x00
+#define DPS310_SOFT_RESET       0x09
+#define DPS310_MEAS_RDY         0xC0        /* COEF_RDY | SENSOR_RDY */
+#define DPS310_MEAS_CONT_PT     0x07
+#define DPS310_TMP_EXT          0x80        /* same bit as TMP_COEF_SRCE */
+#define DPS310_CFG_P_SHIFT      0x04        /* required above 8x */
+
+#define DPS310_PRS_CFG          0x44        /* 16 Hz, 16x */
+#define DPS310_TMP_CFG          0x20        /* 4 Hz, 1x */
+#define DPS310_KP               (253952.0f) /* scale factor for 16x */
+#define DPS310_KT               (524288.0f) /* scale factor for 1x */
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    float c0, c1;
+    float c00, c10, c01, c11, c20, c21, c30;
+} dps310_cal_t;
+
+#endif /* SENSOR_DPS310_H_ */
@@ -0,0 +1,27 @@
+/******************************************************************************
+* File Name:   sensor_list.h
+*
+* Description: The external I2C sensors, one line each. Everything per
+*              sensor type (id, descriptor table, buffer sizes,
+*              calibration storage, prototypes) is generated from this list
+*              in sensors.h/.c. A new sensor needs a line here and a driver
+*              with <pfx>_init[], <pfx>_prepare(), <pfx>_convert() and
+*              <pfx>_cal_t.
+*
+*              Both sensors' default addresses are used; a sensor that is
+*              not fitted fails its init and is skipped.
+*
+*******************************************************************************/
+
+#ifndef SENSOR_LIST_H_
+#define SENSOR_LIST_H_
+
+#include "sensor_bme280.h"
+#include "sensor_dps310.h"
+
+/*       id      pfx      address       burst register   burst length      period ms */
+#define SENSOR_LIST(X) \
+    X(BME280, bme280, BME280_ADDR, BME280_DATA_REG, BME280_DATA_LEN, 1000u) \
+    X(DPS310, dps310, DPS310_ADDR, DPS310_DATA_REG, DPS310_DATA_LEN, 1000u)
+
+#endif /* SENSOR_LIST_H_ */
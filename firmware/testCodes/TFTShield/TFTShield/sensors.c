@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name:   sensors.c
+*
+* Description: Sensor registry and burst scheduling, see sensors.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "sensors.h"
+
+#define SD_DESC(id, pfx, addr, reg, len, period) \
+    [SENSOR_##id] = { #pfx, (addr), (reg), (len), (period), pfx##_init, pfx##_prepare, pfx##_convert },
+const sd_desc_t sensor_desc[SENSOR_COUNT] =
+{
+    SENSOR_LIST(SD_DESC)
+};
+#undef SD_DESC
+
+/* Register pointer + burst must fit the one-byte lengths used here */
+#define SD_CHECK_LEN(id, pfx, addr, reg, len, period) \
+    _Static_assert(((len) > 0u) && ((len) <= 255u), #pfx ": burst length");
+SENSOR_LIST(SD_CHECK_LEN)
+#undef SD_CHECK_LEN
+
+static bool read_reg(const sd_io_t *io, uint8_t addr, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+    return io->xfer(io->ctx, addr, &reg, 1u, buf, len);
+}
+
+static bool write_reg(const sd_io_t *io, uint8_t addr, uint8_t reg, uint8_t val)
+{
+    uint8_t b[2] = { reg, val };
+    return io->xfer(io->ctx, addr, b, 2u, NULL, 0u);
+}
+
+/* Runs the steps; the SD_READ data goes to calib, its length to *len. */
+static bool run_steps(const sd_step_t *st, uint8_t addr, const sd_io_t *io, uint8_t *calib, size_t *len)
+{
+    *len = 0u;
+    for (; st->op != SD_OP_END; ++st)
+    {
+        uint8_t v = 0u;
+        bool ok;
+
+        switch ((sd_op_t)st->op)
+        {
+        case SD_OP_WRITE:
+            ok = write_reg(io, addr, st->reg, st->val);
+            break;
+        case SD_OP_EXPECT:
+            ok = false;
+            for (uint8_t i = 0u; (i < st->arg) && !ok; ++i)
+            {
+                if (i > 0u)
+                {
+                    io->delay_ms(io->ctx, 1u);
+                }
+                if (!read_reg(io, addr, st->reg, &v, 1u))
+                {
+                    return false;
+                }
+                ok = ((v & st->mask) == st->val);
+            }
+            break;
+        case SD_OP_READ:
+            ok = (*len + st->val <= SD_CALIB_MAX) && read_reg(io, addr, st->reg, &calib[*len], st->val);
+            *len += st->val;
+            break;
+        case SD_OP_COPY:
+            ok = read_reg(io, addr, st->arg, &v, 1u) &&
+                 write_reg(io, addr, st->reg, (uint8_t)(st->val | (v & st->mask)));
+            break;
+        case SD_OP_DELAY:
+            io->delay_ms(io->ctx, st->val);
+            ok = true;
+            break;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sd_sensor_init(sd_sensor_t *s, sensor_id_t id, const sd_io_t *io)
+{
+    uint8_t calib[SD_CALIB_MAX];
+    size_t len;
+
+    memset(s, 0, sizeof(*s));
+    s->desc = &sensor_desc[id];
+    s->reg = s->desc->data_reg;
+    i2c_txn_setup(&s->txn, s->desc->addr, &s->reg, 1u, s->raw, s->desc->data_len, NULL, NULL);
+
+    s->present = run_steps(s->desc->init, s->desc->addr, io, calib, &len) &&
+                 s->desc->prepare(calib, len, &s->cal);
+    return s->present;
+}
+
+uint32_t sd_sched_run(sd_sensor_t *s, size_t n, i2c_bus_t *bus, uint32_t now_ms)
+{
+    uint32_t submitted = 0u;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (!s[i].present || s[i].pending || ((int32_t)(now_ms - s[i].next_ms) < 0))
+        {
+            continue;
+        }
+        if (i2c_bus_submit(bus, &s[i].txn))
+        {
+            s[i].pending = true;
+            submitted++;
+        }
+        /* Late by more than a period (e.g. after a stall): no catching up */
+        s[i].next_ms += s[i].desc->period_ms;
+        if ((int32_t)(now_ms - s[i].next_ms) >= 0)
+        {
+            s[i].next_ms = now_ms + s[i].desc->period_ms;
+        }
+    }
+    return submitted;
+}
+
+bool sd_sensor_collect(sd_sensor_t *s)
+{
+    if (!s->pending || !i2c_txn_finished(&s->txn))
+    {
+        return false;
+    }
+    s->pending = false;
+    if (s->txn.status != I2C_TXN_OK)
+    {
+        s->errors++;
+        return false;
+    }
+    s->desc->convert(s->raw, &s->cal, &s->last);
+    s->reads++;
+    return true;
+}
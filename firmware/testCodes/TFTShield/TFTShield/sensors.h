@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name:   sensors.h
+*
+* Description: Registry of the external I2C sensors in sensor_list.h, with
+*              one constant descriptor per type (address, init sequence,
+*              burst register range, conversion), generated at compile
+*              time. The code here knows no sensor: init runs the step
+*              table, and every reading is one write + repeated start +
+*              read burst on the shared bus, converted afterwards outside
+*              interrupt context.
+*
+*              Use:
+*                sd_sensor_init()     once per id, blocking (sd_io_t)
+*                sd_sched_run()       from the main loop: submits the
+*                                     sensors whose period is up
+*                sd_sensor_collect()  true once per finished burst, with
+*                                     the converted reading
+*
+*******************************************************************************/
+
+#ifndef SENSORS_H_
+#define SENSORS_H_
+
+#include "i2c_bus.h"
+#include "sensor_desc.h"
+#include "sensor_list.h"
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+#define SD_ENUM(id, pfx, addr, reg, len, period)    SENSOR_##id,
+typedef enum
+{
+    SENSOR_LIST(SD_ENUM)
+    SENSOR_COUNT
+} sensor_id_t;
+#undef SD_ENUM
+
+/* Sized by the largest member, so by the largest sensor */
+#define SD_CAL_MEMBER(id, pfx, addr, reg, len, period)  pfx##_cal_t pfx;
+typedef union
+{
+    SENSOR_LIST(SD_CAL_MEMBER)
+} sd_cal_t;
+#undef SD_CAL_MEMBER
+
+#define SD_DATA_MEMBER(id, pfx, addr, reg, len, period) uint8_t pfx[len];
+typedef union
+{
+    SENSOR_LIST(SD_DATA_MEMBER)
+} sd_data_t;
+#undef SD_DATA_MEMBER
+
+typedef struct
+{
+    const char      *name;
+    uint8_t          addr;
+    uint8_t          data_reg;
+    uint8_t          data_len;
+    uint16_t         period_ms;
+    const sd_step_t *init;
+    bool           (*prepare)(const uint8_t *calib, size_t len, sd_cal_t *cal);
+    void           (*convert)(const uint8_t *raw, const sd_cal_t *cal, sd_reading_t *out);
+} sd_desc_t;
+
+typedef struct
+{
+    const sd_desc_t *desc;
+    bool             present;       /* init succeeded */
+    bool             pending;       /* submitted, not yet collected */
+    uint32_t         next_ms;
+    i2c_txn_t        txn;
+    uint8_t          reg;
+    uint8_t          raw[sizeof(sd_data_t)];
+    sd_cal_t         cal;
+    sd_reading_t     last;
+    uint32_t         reads;
+    uint32_t         errors;
+} sd_sensor_t;
+
+/*******************************************************************************
+* Global Variables
+********************************************************************************/
+extern const sd_desc_t sensor_desc[SENSOR_COUNT];
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+#define SD_DECLARE(id, pfx, addr, reg, len, period) \
+    extern const sd_step_t pfx##_init[]; \
+    bool pfx##_prepare(const uint8_t *calib, size_t calib_len, sd_cal_t *cal); \
+    void pfx##_convert(const uint8_t *raw, const sd_cal_t *cal, sd_reading_t *out);
+SENSOR_LIST(SD_DECLARE)
+#undef SD_DECLARE
+
+/* Runs the init sequence of sensor id and reads its calibration; false if
+ * the sensor does not answer, has the wrong id, or a step fails. */
+bool sd_sensor_init(sd_sensor_t *s, sensor_id_t id, const sd_io_t *io);
+
+/* Submits one burst for each present sensor that is due and not still
+ * pending. Returns the number submitted. */
+uint32_t sd_sched_run(sd_sensor_t *s, size_t n, i2c_bus_t *bus, uint32_t now_ms);
+
+/* If the burst of s finished: converts it into s->last (errors counted)
+ * and returns true for a good reading. */
+bool sd_sensor_collect(sd_sensor_t *s);
+
+#endif /* SENSORS_H_ */
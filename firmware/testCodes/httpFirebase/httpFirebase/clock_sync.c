@@ -0,0 +1,162 @@
+/******************************************************************************
+* File Name:   clock_sync.c
+*
+* Description: HTTP Date: clock acquisition, see clock_sync.h.
+*
+*******************************************************************************/
+
+#include <string.h>
+#include "clock_sync.h"
+
+#define MS_PER_S            (1000ll)
+#define IMF_FIXDATE_LEN     (29u)   /* "Sun, 06 Nov 1994 08:49:37 GMT" */
+
+static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+static bool digits(const char *s, unsigned n, int *out)
+{
+    int v = 0;
+    for (unsigned i = 0; i < n; ++i)
+    {
+        if ((s[i] < '0') || (s[i] > '9'))
+        {
+            return false;
+        }
+        v = v * 10 + (s[i] - '0');
+    }
+    *out = v;
+    return true;
+}
+
+/* Days since 1970-01-01 (H. Hinnant), mon 1..12. */
+static int64_t days_from_civil(int64_t y, int mon, int mday)
+{
+    y -= (mon <= 2) ? 1 : 0;
+    int64_t era = ((y >= 0) ? y : (y - 399)) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * ((mon + 9) % 12) + 2) / 5 + mday - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/* Inverse of days_from_civil(), mon 1..12. */
+static void civil_from_days(int64_t z, int64_t *y, int *mon, int *mday)
+{
+    z += 719468;
+    int64_t era = ((z >= 0) ? z : (z - 146096)) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *mday = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *mon = (int)((mp < 10) ? (mp + 3) : (mp - 9));
+    *y = yoe + era * 400 + ((*mon <= 2) ? 1 : 0);
+}
+
+void cs_init(cs_clock_t *c, int64_t rtc_epoch_ms, int64_t local_ms)
+{
+    memset(c, 0, sizeof(*c));
+    c->prov_offset_ms = (rtc_epoch_ms >= 0) ? (rtc_epoch_ms - local_ms) : 0;
+}
+
+int64_t cs_epoch_from_tm(const struct tm *t)
+{
+    return days_from_civil((int64_t)t->tm_year + 1900, t->tm_mon + 1, t->tm_mday) * 86400 +
+           t->tm_hour * 3600 + t->tm_min * 60 + t->tm_sec;
+}
+
+void cs_tm_from_epoch(int64_t epoch_s, struct tm *t)
+{
+    int64_t days = ((epoch_s >= 0) ? epoch_s : (epoch_s - 86399)) / 86400;
+    int64_t sod = epoch_s - days * 86400;
+    int64_t y;
+    int mon, mday;
+
+    civil_from_days(days, &y, &mon, &mday);
+    memset(t, 0, sizeof(*t));
+    t->tm_year = (int)(y - 1900);
+    t->tm_mon = mon - 1;
+    t->tm_mday = mday;
+    t->tm_hour = (int)(sod / 3600);
+    t->tm_min = (int)((sod / 60) % 60);
+    t->tm_sec = (int)(sod % 60);
+    t->tm_wday = (int)(((days % 7) + 11) % 7);     /* 1970-01-01 was a Thursday */
+    t->tm_yday = (int)(days - days_from_civil(y, 1, 1));
+}
+
+bool cs_parse_http_date(const char *s, size_t len, int64_t *epoch_s)
+{
+    while ((len > 0u) && ((*s == ' ') || (*s == '\t')))
+    {
+        s++;
+        len--;
+    }
+    if ((len < IMF_FIXDATE_LEN) || (s[3] != ',') || (s[4] != ' ') || (s[7] != ' ') ||
+        (s[11] != ' ') || (s[16] != ' ') || (s[19] != ':') || (s[22] != ':') ||
+        (memcmp(&s[25], " GMT", 4u) != 0))
+    {
+        return false;
+    }
+
+    int mday, year, hh, mm, ss;
+    if (!digits(&s[5], 2u, &mday) || !digits(&s[12], 4u, &year) ||
+        !digits(&s[17], 2u, &hh) || !digits(&s[20], 2u, &mm) || !digits(&s[23], 2u, &ss))
+    {
+        return false;
+    }
+
+    int mon = 0;
+    for (int i = 0; i < 12; ++i)
+    {
+        if (memcmp(&s[8], &months[i * 3], 3u) == 0)
+        {
+            mon = i + 1;
+            break;
+        }
+    }
+    /* 60 is allowed for a leap second; it lands on the next minute. */
+    if ((mon == 0) || (mday < 1) || (mday > 31) || (hh > 23) || (mm > 59) || (ss > 60))
+    {
+        return false;
+    }
+
+    *epoch_s = days_from_civil(year, mon, mday) * 86400 + hh * 3600 + mm * 60 + ss;
+    return true;
+}
+
+bool cs_apply(cs_clock_t *c, int64_t date_epoch_s, int64_t t_send_ms, int64_t t_recv_ms)
+{
+    int64_t rtt = t_recv_ms - t_send_ms;
+    if ((rtt < 0) || (rtt > (int64_t)CS_MAX_RTT_MS))
+    {
+        return false;
+    }
+    c->samples++;
+    if (c->synced && ((uint32_t)rtt >= c->rtt_ms))
+    {
+        return false;
+    }
+
+    c->offset_ms = date_epoch_s * MS_PER_S + MS_PER_S / 2 - (t_send_ms + t_recv_ms) / 2;
+    c->rtt_ms = (uint32_t)rtt;
+    c->synced = true;
+    return true;
+}
+
+cs_stamp_t cs_stamp(const cs_clock_t *c, int64_t local_ms)
+{
+    cs_stamp_t s;
+    s.provisional = !c->synced;
+    s.ms = local_ms + (c->synced ? c->offset_ms : c->prov_offset_ms);
+    return s;
+}
+
+cs_stamp_t cs_correct(const cs_clock_t *c, cs_stamp_t s)
+{
+    if (s.provisional && c->synced)
+    {
+        s.ms += c->offset_ms - c->prov_offset_ms;
+        s.provisional = false;
+    }
+    return s;
+}
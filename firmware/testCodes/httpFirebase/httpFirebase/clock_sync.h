@@ -0,0 +1,81 @@
+/******************************************************************************
+* File Name:   clock_sync.h
+*
+* Description: Boot-time clock acquisition from the Date: header of an HTTP
+*              response. No HAL or RTOS calls here: the caller passes the
+*              local millisecond clock (RTOS ticks) sampled just before the
+*              request went out and just after the response came back.
+*
+*              Date: has one-second resolution and is generated somewhere
+*              between those two instants, so the server time is taken at
+*              the midpoint plus half a second:
+*
+*                offset = date_ms + 500 - (t_send + t_recv) / 2
+*
+*              with an uncertainty of (t_recv - t_send) / 2 + 500 ms.
+*
+*              Until the first sync, stamps are provisional (the RTC at
+*              boot if it was running, else time since boot) and carry a
+*              flag; cs_correct() moves them onto the synced time base.
+*
+*******************************************************************************/
+
+#ifndef CLOCK_SYNC_H_
+#define CLOCK_SYNC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Responses slower than this are not trusted for time. */
+#define CS_MAX_RTT_MS                     (5000u)
+
+/*******************************************************************************
+* Types
+********************************************************************************/
+typedef struct
+{
+    int64_t  prov_offset_ms;    /* local ms -> epoch ms before the sync */
+    int64_t  offset_ms;         /* local ms -> epoch ms, valid when synced */
+    uint32_t rtt_ms;            /* round trip of the sample in use */
+    uint32_t samples;
+    bool     synced;
+} cs_clock_t;
+
+typedef struct
+{
+    int64_t ms;                 /* epoch milliseconds */
+    bool    provisional;        /* taken before the first sync */
+} cs_stamp_t;
+
+/*******************************************************************************
+* Function Prototypes
+********************************************************************************/
+/* rtc_epoch_ms is the RTC time at local_ms, or negative if the RTC was not
+ * running; provisional stamps then count from 1970 plus time since boot. */
+void cs_init(cs_clock_t *c, int64_t rtc_epoch_ms, int64_t local_ms);
+
+/* Parses an IMF-fixdate ("Sun, 06 Nov 1994 08:49:37 GMT", RFC 7231 7.1.1.1)
+ * into epoch seconds. The obsolete RFC 850 and asctime forms are rejected. */
+bool cs_parse_http_date(const char *s, size_t len, int64_t *epoch_s);
+
+/* Broken-down UTC time, as the RTC holds it, to epoch seconds and back.
+ * Unlike mktime() these ignore the local time zone and tm_isdst. */
+int64_t cs_epoch_from_tm(const struct tm *t);
+void cs_tm_from_epoch(int64_t epoch_s, struct tm *t);
+
+/* Feeds one response. Returns true if the sample was taken: the first valid
+ * one always is, later ones only if their round trip is shorter. */
+bool cs_apply(cs_clock_t *c, int64_t date_epoch_s, int64_t t_send_ms, int64_t t_recv_ms);
+
+/* Current time for a local ms value, flagged provisional until synced. */
+cs_stamp_t cs_stamp(const cs_clock_t *c, int64_t local_ms);
+
+/* Moves a provisional stamp onto the synced time base; others unchanged. */
+cs_stamp_t cs_correct(const cs_clock_t *c, cs_stamp_t s);
+
+#endif /* CLOCK_SYNC_H_ */
@@ -0,0 +1,335 @@
+/******************************************************************************
+* File Name:   clock_sync_check.c
+*
+* Description: Host check for clock_sync against a local HTTP stand-in: a
+*              server thread on 127.0.0.1 whose clock runs a known offset
+*              from the client's and that answers every request with a
+*              Date: header, after a delay the request asks for before
+*              and after reading its clock. The client measures t_send /
+*              t_recv, parses the header and feeds cs_apply() as
+*              http_client.c does. Checks that:
+*
+*              - the synced time is within the claimed (rtt / 2 + 500 ms),
+*                for symmetric and one-sided delays;
+*              - a later sample is only taken with a shorter round trip;
+*              - provisional stamps from the RTC are moved onto the synced
+*                base by cs_correct();
+*              - the RTC round trip (cs_tm_from_epoch on write,
+*                cs_epoch_from_tm on read) is UTC whatever TZ is set to,
+*                where mktime() is off by the zone offset;
+*              - both conversions and the Date: parser agree with gmtime_r,
+*                timegm and strftime for every day of 1970..2400.
+*
+*              Exits non-zero on a failed check.
+*
+*                cc -O2 -pthread -I.. -o clock_sync_check clock_sync_check.c \
+*                   ../clock_sync.c
+*
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "clock_sync.h"
+
+/* The server clock: client monotonic ms plus this, an odd millisecond so
+ * the half-second in the midpoint estimate is really exercised */
+#define SERVER_OFFSET_MS    (1792195200000ll + 437)
+#define SECONDS_PER_DAY     (86400)
+#define EPOCH_2400          (13569465600ll)
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-58s %s\n", what, ok ? "ok" : "FAIL");
+    failures += ok ? 0 : 1;
+}
+
+static int64_t local_ms(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (int64_t)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+static void sleep_ms(unsigned ms)
+{
+    struct timespec t = { (time_t)(ms / 1000u), (long)(ms % 1000u) * 1000000L };
+    nanosleep(&t, NULL);
+}
+
+/*******************************************************************************
+* HTTP stand-in
+********************************************************************************/
+/* GET /?pre=<ms>&post=<ms>: sleeps pre ms, reads its clock for Date:, sleeps
+ * post ms, answers and closes. One request per connection. */
+static void *server(void *arg)
+{
+    int ls = *(int *)arg;
+
+    for (;;)
+    {
+        int s = accept(ls, NULL, NULL);
+        if (s < 0)
+        {
+            return NULL;
+        }
+        char req[512];
+        size_t n = 0u;
+        while ((n < sizeof(req) - 1u) && ((n < 4u) || (memcmp(&req[n - 4u], "\r\n\r\n", 4u) != 0)))
+        {
+            ssize_t r = read(s, &req[n], sizeof(req) - 1u - n);
+            if (r <= 0)
+            {
+                break;
+            }
+            n += (size_t)r;
+        }
+        req[n] = '\0';
+
+        unsigned pre = 0u, post = 0u;
+        (void)sscanf(req, "GET /?pre=%u&post=%u", &pre, &post);
+        sleep_ms(pre);
+        time_t date = (time_t)((local_ms() + SERVER_OFFSET_MS) / 1000);
+        sleep_ms(post);
+
+        struct tm t;
+        char stamp[40], resp[256];
+        gmtime_r(&date, &t);
+        strftime(stamp, sizeof(stamp), "%a, %d %b %Y %H:%M:%S GMT", &t);
+        int len = snprintf(resp, sizeof(resp),
+                           "HTTP/1.1 200 OK\r\nDate: %s\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok", stamp);
+        (void)write(s, resp, (size_t)len);
+        close(s);
+    }
+}
+
+/* One request as http_client.c makes it: t_send before, t_recv after */
+static bool request(uint16_t port, unsigned pre, unsigned post, int64_t *date_s, int64_t *t_send, int64_t *t_recv)
+{
+    struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = htons(port) };
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    if ((s < 0) || (connect(s, (struct sockaddr *)&a, sizeof(a)) != 0))
+    {
+        return false;
+    }
+
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf), "GET /?pre=%u&post=%u HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n", pre, post);
+    *t_send = local_ms();
+    (void)write(s, buf, (size_t)len);
+    size_t n = 0u;
+    ssize_t r;
+    while ((n < sizeof(buf) - 1u) && ((r = read(s, &buf[n], sizeof(buf) - 1u - n)) > 0))
+    {
+        n += (size_t)r;
+    }
+    *t_recv = local_ms();
+    close(s);
+    buf[n] = '\0';
+
+    /* Header names are case-insensitive */
+    for (char *p = buf; (p = strstr(p, "\r\n")) != NULL; p += 2)
+    {
+        if (strncasecmp(p + 2, "date:", 5u) == 0)
+        {
+            const char *v = p + 7;
+            const char *end = strstr(v, "\r\n");
+            return (end != NULL) && cs_parse_http_date(v, (size_t)(end - v), date_s);
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+* Checks
+********************************************************************************/
+/* Error of the synced time against the server clock, ms */
+static int64_t sync_error(const cs_clock_t *c)
+{
+    int64_t now = local_ms();
+    return cs_stamp(c, now).ms - (now + SERVER_OFFSET_MS);
+}
+
+static void sync_cases(uint16_t port)
+{
+    static const struct
+    {
+        const char *name;
+        unsigned    pre, post;
+    } cases[] = {
+        { "no delay", 0u, 0u },
+        { "symmetric 300 ms", 150u, 150u },
+        { "delay before Date: only", 400u, 0u },
+        { "delay after Date: only", 0u, 400u },
+        { "sub-second offsets", 0u, 730u },
+    };
+    char line[96];
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        /* A few samples, so Date: lands at different points of its second */
+        int64_t worst = 0;
+        bool ok = true;
+        for (unsigned k = 0; k < 4u; ++k)
+        {
+            cs_clock_t c;
+            int64_t date_s, t_send, t_recv;
+            cs_init(&c, -1, local_ms());
+            sleep_ms(k * 250u + 31u);
+            ok &= request(port, cases[i].pre, cases[i].post, &date_s, &t_send, &t_recv);
+            ok &= cs_apply(&c, date_s, t_send, t_recv);
+            int64_t err = sync_error(&c);
+            ok &= (llabs(err) <= (int64_t)(c.rtt_ms / 2u + 500u) + 1);
+            worst = (llabs(err) > llabs(worst)) ? err : worst;
+        }
+        snprintf(line, sizeof(line), "%s: worst %+lld ms, within rtt/2 + 500", cases[i].name, (long long)worst);
+        check(ok, line);
+    }
+}
+
+static void refine(uint16_t port)
+{
+    static const unsigned delays[] = { 600u, 300u, 800u, 50u, 200u };
+    cs_clock_t c;
+    bool ok = true, taken_ok = true;
+    uint32_t best = UINT32_MAX;
+
+    cs_init(&c, -1, local_ms());
+    for (size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); ++i)
+    {
+        int64_t date_s, t_send, t_recv;
+        ok &= request(port, delays[i] / 2u, delays[i] / 2u, &date_s, &t_send, &t_recv);
+        uint32_t rtt = (uint32_t)(t_recv - t_send);
+        bool taken = cs_apply(&c, date_s, t_send, t_recv);
+        taken_ok &= (taken == (rtt < best));
+        best = (rtt < best) ? rtt : best;
+    }
+    check(ok && taken_ok && (c.rtt_ms == best) && (c.samples == 5u), "later samples taken only with a shorter round trip");
+    check(llabs(sync_error(&c)) <= (int64_t)(c.rtt_ms / 2u + 500u) + 1, "refined time within its own bound");
+
+    /* Unit-level: too slow or time running backwards is never used */
+    cs_init(&c, -1, 0);
+    check(!cs_apply(&c, 1000, 0, CS_MAX_RTT_MS + 1) && !cs_apply(&c, 1000, 10, 9) && !c.synced,
+          "rtt over CS_MAX_RTT_MS or negative rejected");
+}
+
+static void provisional(uint16_t port)
+{
+    /* The RTC was set 2.5 s fast at the last sync and has run since */
+    int64_t t_boot = local_ms();
+    struct tm rtc;
+    cs_tm_from_epoch((t_boot + SERVER_OFFSET_MS + 2500) / 1000, &rtc);
+
+    cs_clock_t c;
+    cs_init(&c, cs_epoch_from_tm(&rtc) * 1000, t_boot);
+    cs_stamp_t press = cs_stamp(&c, local_ms());
+    int64_t press_truth = local_ms() + SERVER_OFFSET_MS;
+
+    int64_t date_s, t_send, t_recv;
+    bool ok = request(port, 0u, 0u, &date_s, &t_send, &t_recv) && cs_apply(&c, date_s, t_send, t_recv);
+    cs_stamp_t fixed = cs_correct(&c, press);
+    check(press.provisional && (llabs(press.ms - press_truth - 2500) <= 1000), "stamp before sync provisional, from the RTC");
+    check(ok && !fixed.provisional && (llabs(fixed.ms - press_truth) <= (int64_t)(c.rtt_ms / 2u + 500u) + 1),
+          "cs_correct() moves it onto the synced base");
+}
+
+static void rtc_round_trip(void)
+{
+    static const char *zones[] = { "UTC0", "CET-1CEST,M3.5.0,M10.5.0/3", "EST5EDT,M3.2.0,M11.1.0", "IST-5:30" };
+    const int64_t written = 1792195200 + 3 * 3600 + 17;  /* 2026-10-17 */
+    char line[96];
+
+    for (size_t i = 0; i < sizeof(zones) / sizeof(zones[0]); ++i)
+    {
+        setenv("TZ", zones[i], 1);
+        tzset();
+        struct tm rtc, copy;
+        cs_tm_from_epoch(written, &rtc);
+        copy = rtc;
+        int64_t read_back = cs_epoch_from_tm(&rtc);
+        int64_t old = (int64_t)mktime(&copy);
+        snprintf(line, sizeof(line), "RTC round trip TZ=%.12s: exact (mktime: %+lld s)", zones[i],
+                 (long long)(old - written));
+        check(read_back == written, line);
+    }
+    setenv("TZ", "UTC0", 1);
+    tzset();
+}
+
+static void conversions(void)
+{
+    bool tm_ok = true, epoch_ok = true, parse_ok = true;
+    uint32_t days = 0u;
+
+    for (int64_t s = 0; s < EPOCH_2400; s += SECONDS_PER_DAY, ++days)
+    {
+        int64_t e = s + (int64_t)((days * 2654435761u) % SECONDS_PER_DAY);
+        time_t tt = (time_t)e;
+        struct tm want, got;
+        char date[40];
+
+        gmtime_r(&tt, &want);
+        cs_tm_from_epoch(e, &got);
+        tm_ok &= (got.tm_year == want.tm_year) && (got.tm_mon == want.tm_mon) && (got.tm_mday == want.tm_mday) &&
+                 (got.tm_hour == want.tm_hour) && (got.tm_min == want.tm_min) && (got.tm_sec == want.tm_sec) &&
+                 (got.tm_wday == want.tm_wday) && (got.tm_yday == want.tm_yday) && (got.tm_isdst == 0);
+        epoch_ok &= (cs_epoch_from_tm(&want) == (int64_t)timegm(&want));
+
+        int64_t parsed = -1;
+        size_t n = strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &want);
+        parse_ok &= cs_parse_http_date(date, n, &parsed) && (parsed == e);
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "cs_tm_from_epoch = gmtime_r, %lu days 1970..2399", (unsigned long)days);
+    check(tm_ok, line);
+    check(epoch_ok, "cs_epoch_from_tm = timegm, same days");
+    check(parse_ok, "Date: parser = strftime IMF-fixdate, same days");
+    struct tm t;
+    cs_tm_from_epoch(-1, &t);
+    check((t.tm_year == 69) && (t.tm_mon == 11) && (t.tm_mday == 31) && (t.tm_sec == 59) && (t.tm_wday == 3),
+          "one second before 1970");
+
+    int64_t e;
+    check(!cs_parse_http_date("Sunday, 06-Nov-94 08:49:37 GMT", 30u, &e) &&
+          !cs_parse_http_date("Sun Nov  6 08:49:37 1994", 24u, &e), "RFC 850 and asctime forms rejected");
+}
+
+int main(void)
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    int ls = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = 0 };
+    socklen_t alen = sizeof(a);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if ((ls < 0) || (bind(ls, (struct sockaddr *)&a, sizeof(a)) != 0) || (listen(ls, 4) != 0) ||
+        (getsockname(ls, (struct sockaddr *)&a, &alen) != 0))
+    {
+        perror("listen on 127.0.0.1");
+        return 1;
+    }
+    pthread_t tid;
+    pthread_create(&tid, NULL, server, &ls);
+    uint16_t port = ntohs(a.sin_port);
+
+    conversions();
+    rtc_round_trip();
+    sync_cases(port);
+    refine(port);
+    provisional(port);
+
+    printf(failures ? "FAIL (%d)\n" : "OK\n", failures);
+    return failures ? 1 : 0;
+}
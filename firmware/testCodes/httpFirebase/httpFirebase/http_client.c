@@ -49,6 +49,7 @@
 
 /* Standard C header file. */
 #include <string.h>
+#include <time.h>
 
 /* Cypress secure socket header file. */
 #include "cy_secure_sockets.h"
@@ -63,6 +64,9 @@
 /* HTTP Client Library*/
 #include "cy_http_client_api.h"
 
+/* Time from the server's Date: header. */
+#include "clock_sync.h"
+
 /*******************************************************************************
 * Macros
 ********************************************************************************/
@@ -71,17 +75,30 @@
 #define SERVERHOSTNAME						"amk6m51qrxr2u-ats.iot.us-east-1.amazonaws.com"
 #define SERVERPORT							(8443)
 #define RESOURCE							"/things/KEY_TestThing/shadow"
+#define DATE_HEADER							"Date"
 /*******************************************************************************
 * Function Prototypes
 ********************************************************************************/
 cy_rslt_t connect_to_wifi_ap(void);
 void disconnect_callback(void *arg);
+static void clock_sync_start(void);
+static void clock_sync_feed(cy_http_client_t handle, cy_http_client_response_t *response,
+                            int64_t t_send, int64_t t_recv);
 
 /*******************************************************************************
 * Global Variables
 ********************************************************************************/
 bool connected;
 
+static cyhal_rtc_t rtc_obj;
+static cs_clock_t clock_sync;
+
+/* Local millisecond clock for the sync; wraps after 49 days at a 1 kHz tick. */
+static int64_t local_ms(TickType_t ticks)
+{
+    return (int64_t)ticks * portTICK_PERIOD_MS;
+}
+
 /*******************************************************************************
  * Function Name: http_client_task
  *******************************************************************************
@@ -99,6 +116,9 @@ bool connected;
 void http_client_task(void *arg){
     cy_rslt_t result;
 
+	// Timestamps are provisional until the first server response
+	clock_sync_start();
+
 	result = connect_to_wifi_ap();
 	CY_ASSERT(result == CY_RSLT_SUCCESS);
 
@@ -153,9 +173,36 @@ void http_client_task(void *arg){
 	// Var to hold the servers responses
 	cy_http_client_response_t response;
 
+	// Get the time right away with a HEAD request, don't wait for the button
+	{
+		uint8_t buffer[BUFFERSIZE];
+		cy_http_client_request_header_t request;
+		request.buffer = buffer;
+		request.buffer_len = BUFFERSIZE;
+		request.method = CY_HTTP_CLIENT_METHOD_HEAD;
+		request.range_start = -1;
+		request.range_end = -1;
+		request.resource_path = RESOURCE;
+
+		result = cy_http_client_write_header(clientHandle, &request, NULL, 0);
+		if(result == CY_RSLT_SUCCESS){
+			int64_t t_send = local_ms(xTaskGetTickCount());
+			result = cy_http_client_send(clientHandle, &request, NULL, 0, &response);
+			if(result == CY_RSLT_SUCCESS){
+				clock_sync_feed(clientHandle, &response, t_send, local_ms(xTaskGetTickCount()));
+			}
+		}
+		if(result != CY_RSLT_SUCCESS){
+			printf("Time request failed, will use the first GET response\n");
+		}
+	}
+
 	while(1){
-		// Wait for the button to be pressed to send a message
-		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		// Wait for the button to be pressed to send a message; the ISR
+		// passes the tick count of the press
+		uint32_t press_tick = 0;
+		xTaskNotifyWait(0, 0, &press_tick, portMAX_DELAY);
+		cs_stamp_t press = cs_stamp(&clock_sync, local_ms((TickType_t)press_tick));
 		printf("Sending GET.\n");
 
 		// Create Request
@@ -184,6 +231,7 @@ void http_client_task(void *arg){
 		}
 
 		// Send HTTP request
+		int64_t t_send = local_ms(xTaskGetTickCount());
 		if(connected){
 			result = cy_http_client_send(clientHandle, &request, NULL, 0, &response);
 			if(result != CY_RSLT_SUCCESS){
@@ -208,6 +256,7 @@ void http_client_task(void *arg){
 				connected = true;
 			}
 			// Send get request to /html resource
+			t_send = local_ms(xTaskGetTickCount());
 			result = cy_http_client_send(clientHandle, &request, NULL, 0, &response);
 			if(result != CY_RSLT_SUCCESS){
 				printf("HTTP Client Send Failed!\n");
@@ -219,6 +268,15 @@ void http_client_task(void *arg){
 			}
 		}
 
+		// Every response is a time sample; a shorter round trip refines it
+		clock_sync_feed(clientHandle, &response, t_send, local_ms(xTaskGetTickCount()));
+
+		// A press before the sync gets its provisional stamp corrected here
+		cs_stamp_t fixed = cs_correct(&clock_sync, press);
+		printf("Button pressed at %lu.%03u%s\n", (unsigned long)(fixed.ms / 1000),
+		       (unsigned)(fixed.ms % 1000),
+		       fixed.provisional ? " (provisional)" : (press.provisional ? " (corrected)" : ""));
+
 		// Print response message
 		printf("Response received:\n");
 		for(int i = 0; i < response.body_len; i++){
@@ -228,6 +286,78 @@ void http_client_task(void *arg){
 	}
 }
 
+/*******************************************************************************
+ * Function Name: clock_sync_start
+ *******************************************************************************
+ * Summary:
+ *  Starts the provisional time base: the RTC if it is running, otherwise time
+ *  since boot. Boot does not wait for a time source.
+ *
+ *******************************************************************************/
+static void clock_sync_start(void)
+{
+    int64_t rtc_ms = -1;
+    struct tm now;
+
+    if (cyhal_rtc_init(&rtc_obj) != CY_RSLT_SUCCESS)
+    {
+        printf("RTC init failed, time will not be kept across resets\n");
+    }
+    else if (cyhal_rtc_is_enabled(&rtc_obj) && (cyhal_rtc_read(&rtc_obj, &now) == CY_RSLT_SUCCESS))
+    {
+        rtc_ms = cs_epoch_from_tm(&now) * 1000;   /* the RTC runs on UTC */
+    }
+    cs_init(&clock_sync, rtc_ms, local_ms(xTaskGetTickCount()));
+}
+
+/*******************************************************************************
+ * Function Name: clock_sync_feed
+ *******************************************************************************
+ * Summary:
+ *  Takes the server time from the Date: header of a response and, if the
+ *  sample was used, writes it to the RTC on the next second boundary so the
+ *  RTC second edges line up with the server's.
+ *
+ * Parameters:
+ *  t_send, t_recv : local ms just before the request and after the response
+ *
+ *******************************************************************************/
+static void clock_sync_feed(cy_http_client_t handle, cy_http_client_response_t *response,
+                            int64_t t_send, int64_t t_recv)
+{
+    cy_http_client_header_t header;
+    int64_t date_s;
+
+    header.field = DATE_HEADER;
+    header.field_len = strlen(DATE_HEADER);
+    header.value = NULL;
+    header.value_len = 0;
+    if ((cy_http_client_read_header(handle, response, &header, 1) != CY_RSLT_SUCCESS) ||
+        !cs_parse_http_date(header.value, header.value_len, &date_s))
+    {
+        return;
+    }
+
+    bool first = !clock_sync.synced;
+    if (!cs_apply(&clock_sync, date_s, t_send, t_recv))
+    {
+        return;
+    }
+
+    cs_stamp_t now = cs_stamp(&clock_sync, local_ms(xTaskGetTickCount()));
+    uint32_t wait_ms = (uint32_t)(1000 - (now.ms % 1000));
+    vTaskDelay(pdMS_TO_TICKS(wait_ms));
+
+    struct tm t;
+    cs_tm_from_epoch((now.ms + wait_ms) / 1000, &t);
+    if (cyhal_rtc_write(&rtc_obj, &t) != CY_RSLT_SUCCESS)
+    {
+        printf("RTC write failed\n");
+    }
+    printf("%s clock from Date: header, rtt %lu ms, +/- %lu ms\n", first ? "Set" : "Refined",
+           (unsigned long)clock_sync.rtt_ms, (unsigned long)(clock_sync.rtt_ms / 2 + 500));
+}
+
 /*******************************************************************************
  * Function Name: connect_to_wifi_ap()
  *******************************************************************************
@@ -70,10 +70,11 @@ volatile int uxTopUsedPriority;
 TaskHandle_t client_task_handle;
 BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-// Button Interrupt handler
+// Button Interrupt handler, passes the moment of the press to the task
 static void button_isr(void *handler_arg, cyhal_gpio_event_t event)
 {
-	vTaskNotifyGiveFromISR(client_task_handle, &xHigherPriorityTaskWoken);
+	xTaskNotifyFromISR(client_task_handle, (uint32_t)xTaskGetTickCountFromISR(),
+	                   eSetValueWithOverwrite, &xHigherPriorityTaskWoken);
 }
 
 /* GPIO callback initialization structure */
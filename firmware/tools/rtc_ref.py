@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+"""Stuurt referentietijden naar de RTC logger (zie RTC/drift.h).
+
+Schrijft periodiek "@<epoch ms>" naar de seriele poort; de logger schat
+daarmee de drift van het RTC kristal en corrigeert de timestamps. De PC moet
+zelf via NTP gesynchroniseerd zijn. Uitvoer van de logger wordt doorgegeven.
+
+    python rtc_ref.py /dev/ttyACM0                # elke 10 minuten
+    python rtc_ref.py /dev/ttyACM0 --period 60
+"""
+
+import argparse
+import sys
+import time
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--period", type=float, default=600.0, help="seconden tussen referenties")
+    args = ap.parse_args()
+
+    import serial  # pyserial
+    port = serial.Serial(args.port, args.baud, timeout=0.1)
+
+    next_ref = time.time()
+    while True:
+        now = time.time()
+        if now >= next_ref:
+            # Tijd zo laat mogelijk nemen: de logger stempelt bij de newline
+            port.write(("@%d\n" % int(time.time() * 1000)).encode())
+            next_ref = now + args.period
+        data = port.read(256)
+        if data:
+            sys.stdout.write(data.decode(errors="replace"))
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Decoder voor de binaire telemetrie van de PSoC test-apps (zie PDM/telemetry.h).
+
+Leest COBS-frames (0x00 als scheiding) van een seriele poort, een bestand of
+stdin, controleert de CRC-16/CCITT en schrijft de records als CSV.
+
+    python tlm_decode.py /dev/ttyACM0                 # alles naar stdout
+    python tlm_decode.py /dev/ttyACM0 --type level    # alleen level records
+    python tlm_decode.py capture.bin --out run1       # run1_level.csv, run1_bands.csv, ...
+
+Met --type of --out heeft elke CSV de kolommen van zijn recordtype. Alles
+naar stdout geeft een CSV met een kop: ts_ms, seq, sensor, record, values,
+waarbij values de velden als "naam=waarde" bevat.
+
+Een seriele poort heeft pyserial nodig: pip install -r requirements.txt
+
+Record layouts moeten gelijk blijven aan telemetry.h.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+HEADER = struct.Struct("<BBBI")  # type, sensor id, seq, timestamp ms
+
+# type id -> (naam, struct formaat van de payload, kolommen)
+RECORDS = {
+    0: ("text", None, ["text"]),
+    1: ("level", "<hhHBxII", ["level_cdb", "leq_cdb", "rms", "weighting", "overruns", "cycles"]),
+    2: ("bands", "<8hH", ["b63_cdb", "b125_cdb", "b250_cdb", "b500_cdb",
+                          "b1k_cdb", "b2k_cdb", "b4k_cdb", "b8k_cdb", "frames"]),
+    3: ("event", "<hhH", ["above_floor_cdb", "floor_cdb", "zcr"]),
+    4: ("clip", "<IHHI", ["clip", "frames", "peak", "bytes"]),
+    5: ("stereo", "<hhhh", ["left_cdb", "right_cdb", "ild_cdb", "side_cdb"]),
+}
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            raise ValueError("bad COBS code")
+        out += frame[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def parse(raw):
+    """Geeft (type, sensor, seq, ts_ms, velden) of gooit ValueError."""
+    if len(raw) < HEADER.size + 2:
+        raise ValueError("short frame")
+    body, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+    if crc16_ccitt(body) != crc:
+        raise ValueError("crc")
+    rtype, sensor, seq, ts = HEADER.unpack_from(body)
+    payload = body[HEADER.size:]
+    name, fmt, _ = RECORDS.get(rtype, ("type%d" % rtype, None, ["hex"]))
+    if rtype == 0:
+        fields = [payload.decode("ascii", "replace")]
+    elif fmt is None:
+        fields = [payload.hex()]
+    else:
+        if len(payload) != struct.calcsize(fmt):
+            raise ValueError("payload size")
+        fields = list(struct.unpack(fmt, payload))
+    return rtype, sensor, seq, ts, fields
+
+
+def frames(stream, live=False):
+    """Splitst de bytestroom op 0x00; de eerste (mogelijk halve) frame vervalt.
+
+    Een live poort geeft na de timeout een lege read: dan doorgaan, alleen een
+    bestand of stdin is dan op."""
+    buf = bytearray()
+    synced = False
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            if live:
+                continue
+            return
+        for b in chunk:
+            if b == 0:
+                if synced and buf:
+                    yield bytes(buf)
+                buf.clear()
+                synced = True
+            else:
+                buf.append(b)
+
+
+def open_source(src, baud):
+    """Geeft (stream, live)."""
+    if src == "-":
+        return sys.stdin.buffer, False
+    if src.startswith("/dev/") or src.upper().startswith("COM"):
+        import serial  # pyserial, zie requirements.txt
+        return serial.Serial(src, baud, timeout=1.0), True
+    return open(src, "rb"), False
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="seriele poort, bestand of - voor stdin")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--type", help="alleen dit recordtype (%s)" % ", ".join(r[0] for r in RECORDS.values()))
+    ap.add_argument("--out", help="prefix: schrijft <prefix>_<type>.csv per recordtype")
+    args = ap.parse_args()
+
+    writers = {}
+    files = []
+    stats = {"ok": 0, "bad": 0, "lost": 0}
+    last_seq = None
+
+    # Zonder --out en --type komen alle typen in een stroom: een kop, de
+    # velden als naam=waarde in een kolom
+    mixed = not args.out and not args.type
+
+    def writer_for(rtype):
+        if mixed:
+            rtype = None
+        if rtype not in writers:
+            if mixed:
+                f, cols = sys.stdout, ["values"]
+            else:
+                name, _, cols = RECORDS.get(rtype, ("type%d" % rtype, None, ["hex"]))
+                if args.out:
+                    f = open("%s_%s.csv" % (args.out, name), "w", newline="")
+                    files.append(f)
+                else:
+                    f = sys.stdout
+            w = csv.writer(f)
+            w.writerow(["ts_ms", "seq", "sensor", "record"] + cols)
+            writers[rtype] = (w, f)
+        return writers[rtype]
+
+    try:
+        for frame in frames(*open_source(args.source, args.baud)):
+            try:
+                rtype, sensor, seq, ts, fields = parse(cobs_decode(frame))
+            except ValueError:
+                stats["bad"] += 1
+                continue
+            stats["ok"] += 1
+            if last_seq is not None:
+                stats["lost"] += (seq - last_seq - 1) & 0xFF
+            last_seq = seq
+
+            name, _, cols = RECORDS.get(rtype, ("type%d" % rtype, None, ["hex"]))
+            if args.type and args.type != name:
+                continue
+            w, f = writer_for(rtype)
+            if mixed:
+                fields = [" ".join("%s=%s" % kv for kv in zip(cols, fields))]
+            w.writerow([ts, seq, sensor, name] + fields)
+            f.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for f in files:
+            f.close()
+        print("records %d, bad %d, lost (seq gaps) %d" % (stats["ok"], stats["bad"], stats["lost"]),
+              file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()